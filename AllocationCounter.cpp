@@ -0,0 +1,109 @@
+#include "AllocationCounter.h"
+
+#ifdef _DEBUG
+#include <crtdbg.h>
+#endif
+
+#include <mutex>
+
+// Allocation counting scope depth for the current thread.
+static thread_local int s_ScopeDepth = 0;
+
+// Allocation counting suspension depth for the current thread.
+static thread_local int s_SuspendDepth = 0;
+
+// Number of allocations counted for the current thread.
+static thread_local long long s_ThreadCount = 0;
+
+// Number of allocations counted across all threads.
+static std::atomic<long long> s_TotalCount( 0 );
+
+// Call & allocation counts, by category name.
+static std::map<std::wstring, AllocationCounter::CategoryCount> s_CategoryCounts;
+
+// Category counts mutex.
+static std::mutex s_CategoryMutex;
+
+#ifdef _DEBUG
+
+// Any previously installed CRT allocation hook.
+static _CRT_ALLOC_HOOK s_PreviousAllocHook = nullptr;
+
+// CRT debug heap allocation hook.
+static int __cdecl AllocHook( int allocType, void* userData, size_t size, int blockType, long requestNumber, const unsigned char* filename, int lineNumber )
+{
+	if ( ( _CRT_BLOCK != blockType ) && ( ( _HOOK_ALLOC == allocType ) || ( _HOOK_REALLOC == allocType ) ) ) {
+		if ( ( s_ScopeDepth > 0 ) && ( 0 == s_SuspendDepth ) ) {
+			++s_ThreadCount;
+			++s_TotalCount;
+		}
+	}
+	return ( nullptr != s_PreviousAllocHook ) ? s_PreviousAllocHook( allocType, userData, size, blockType, requestNumber, filename, lineNumber ) : 1;
+}
+
+// Installs the allocation hook when the module is loaded.
+static const bool s_AllocHookInstalled = ( s_PreviousAllocHook = _CrtSetAllocHook( AllocHook ), true );
+
+#endif
+
+AllocationCounter::Scope::Scope() :
+	m_InitialCount( s_ThreadCount ),
+	m_Outermost( 0 == s_ScopeDepth )
+{
+	++s_ScopeDepth;
+}
+
+AllocationCounter::Scope::~Scope()
+{
+	--s_ScopeDepth;
+}
+
+long long AllocationCounter::Scope::GetCount() const
+{
+	return s_ThreadCount - m_InitialCount;
+}
+
+bool AllocationCounter::Scope::IsOutermost() const
+{
+	return m_Outermost;
+}
+
+AllocationCounter::Suspend::Suspend()
+{
+	++s_SuspendDepth;
+}
+
+AllocationCounter::Suspend::~Suspend()
+{
+	--s_SuspendDepth;
+}
+
+bool AllocationCounter::IsAvailable()
+{
+#ifdef _DEBUG
+	return s_AllocHookInstalled;
+#else
+	return false;
+#endif
+}
+
+long long AllocationCounter::GetTotalCount()
+{
+	return s_TotalCount;
+}
+
+void AllocationCounter::AddCategoryCount( const std::wstring& category, const long long calls, const long long allocations )
+{
+	// Updating the category counts can itself allocate, which is not counted.
+	const Suspend suspend;
+	std::lock_guard<std::mutex> lock( s_CategoryMutex );
+	CategoryCount& count = s_CategoryCounts[ category ];
+	count.Calls += calls;
+	count.Allocations += allocations;
+}
+
+std::map<std::wstring, AllocationCounter::CategoryCount> AllocationCounter::GetCategoryCounts()
+{
+	std::lock_guard<std::mutex> lock( s_CategoryMutex );
+	return s_CategoryCounts;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <map>
+#include <string>
+
+// Counts heap allocations made by the current thread while inside a counting scope.
+// Allocations are only counted in debug builds (using the CRT debug heap allocation hook), so the counts are always zero in release builds.
+class AllocationCounter
+{
+public:
+	// Counts allocations made by the current thread for the lifetime of the object (scopes can be nested).
+	class Scope
+	{
+	public:
+		Scope();
+
+		virtual ~Scope();
+
+		// Returns the number of allocations made by the current thread since the scope was created.
+		long long GetCount() const;
+
+		// Returns whether this is the outermost scope on the current thread.
+		bool IsOutermost() const;
+
+	private:
+		// Thread allocation count when the scope was created.
+		const long long m_InitialCount;
+
+		// Indicates whether this is the outermost scope on the current thread.
+		const bool m_Outermost;
+	};
+
+	// Suspends allocation counting on the current thread for the lifetime of the object (e.g. for code which is not expected to be allocation free).
+	class Suspend
+	{
+	public:
+		Suspend();
+
+		virtual ~Suspend();
+	};
+
+	// Returns whether allocation counting is available.
+	static bool IsAvailable();
+
+	// Returns the total number of allocations counted, across all threads.
+	static long long GetTotalCount();
+
+	// Call & allocation counts for a category of operation.
+	struct CategoryCount {
+		long long Calls = 0;				// Number of calls.
+		long long Allocations = 0;	// Number of allocations made during the calls.
+	};
+
+	// Adds to the counts for a category of operation (e.g. reads from a particular decoder type).
+	// 'category' - category name.
+	// 'calls' - number of calls made.
+	// 'allocations' - number of allocations made during the calls.
+	static void AddCategoryCount( const std::wstring& category, const long long calls, const long long allocations );
+
+	// Returns the call & allocation counts, by category name.
+	static std::map<std::wstring, CategoryCount> GetCategoryCounts();
+};
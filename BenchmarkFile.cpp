@@ -0,0 +1,430 @@
+#include "BenchmarkFile.h"
+
+#include "EncoderFlac.h"
+#include "EncoderOpus.h"
+#include "HandlerMAC.h"
+#include "HandlerOpus.h"
+#include "HandlerWavpack.h"
+#include "SampleConversion.h"
+#include "Utility.h"
+
+#include "All.h"
+#include "MACLib.h"
+
+#include "wavpack.h"
+
+extern "C"
+{
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#include <libavutil/channel_layout.h>
+}
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <map>
+#include <random>
+#include <tuple>
+#include <vector>
+
+// Reference file formats, with their names & file extensions (the FLAC & Opus extensions are added by the encoders).
+static const std::vector<std::tuple<BenchmarkFile::Format, std::wstring, std::wstring>> s_Formats = {
+	{ BenchmarkFile::Format::WAV,			L"WAV",			L".wav" },
+	{ BenchmarkFile::Format::FLAC,		L"FLAC",		L"" },
+	{ BenchmarkFile::Format::Opus,		L"Opus",		L"" },
+	{ BenchmarkFile::Format::WavPack,	L"WavPack",	L".wv" },
+	{ BenchmarkFile::Format::APE,			L"APE",			L".ape" },
+	{ BenchmarkFile::Format::ALAC,		L"ALAC",		L".m4a" },
+	{ BenchmarkFile::Format::AAC,			L"AAC",			L".m4a" }
+};
+
+// MP4 tag names, used for the ALAC & AAC files.
+static const std::map<Tag, std::string> s_MP4Tags = {
+	{ Tag::Album,		"album" },
+	{ Tag::Artist,	"artist" },
+	{ Tag::Comment,	"comment" },
+	{ Tag::Genre,		"genre" },
+	{ Tag::Title,		"title" },
+	{ Tag::Track,		"track" },
+	{ Tag::Year,		"date" }
+};
+
+// The number of sample frames to write at a time.
+constexpr long s_BlockFrames = 4096;
+
+// Frequency of the test tone on the first channel, in Hz (each subsequent channel is a harmonic).
+constexpr double s_ToneFrequency = 440.0;
+
+// Level of the test tone.
+constexpr double s_ToneLevel = 0.5;
+
+// Peak level of the noise added to the test tone.
+constexpr float s_NoiseLevel = 0.05f;
+
+// Noise generator seed (fixed, so that each file contains the same signal).
+constexpr unsigned int s_NoiseSeed = 0x1974;
+
+// Opus encoder settings (bitrate, in kbps).
+static const std::string s_OpusSettings = "128";
+
+// AAC encoder bitrate, in bits per second.
+constexpr int64_t s_AACBitrate = 192000;
+
+// Generates the test signal: a tone on each channel, with added noise (so that the lossless formats cannot compress the signal trivially).
+class TestSignal
+{
+public:
+	// 'sampleRate' - sample rate.
+	// 'channels' - number of channels.
+	TestSignal( const long sampleRate, const long channels ) :
+		m_SampleRate( sampleRate ),
+		m_Channels( channels ),
+		m_Generator( s_NoiseSeed ),
+		m_Noise( -s_NoiseLevel, s_NoiseLevel )
+	{
+	}
+
+	// Reads the next 'frames' of the signal into 'buffer' (interleaved, and scaled to +/-1.0f).
+	void Read( float* buffer, const long frames )
+	{
+		const double twoPi = 2 * std::acos( -1.0 );
+		for ( long frame = 0; frame < frames; frame++, m_Position++ ) {
+			for ( long channel = 0; channel < m_Channels; channel++ ) {
+				const double phase = twoPi * s_ToneFrequency * ( 1 + channel ) * m_Position / m_SampleRate;
+				*buffer++ = static_cast<float>( s_ToneLevel * std::sin( phase ) ) + m_Noise( m_Generator );
+			}
+		}
+	}
+
+private:
+	// Sample rate.
+	const long m_SampleRate;
+
+	// Number of channels.
+	const long m_Channels;
+
+	// Position of the next sample frame.
+	long long m_Position = 0;
+
+	// Noise generator.
+	std::mt19937 m_Generator;
+
+	// Noise distribution.
+	std::uniform_real_distribution<float> m_Noise;
+};
+
+// WavPack block output callback, writing to the output file stream 'id'.
+static int WriteWavPackBlock( void* id, void* data, int32_t bcount )
+{
+	std::ofstream* stream = static_cast<std::ofstream*>( id );
+	stream->write( static_cast<const char*>( data ), bcount );
+	return stream->good() ? TRUE : FALSE;
+}
+
+std::list<BenchmarkFile::Format> BenchmarkFile::GetFormats()
+{
+	std::list<Format> formats;
+	for ( const auto& [ format, name, extension ] : s_Formats ) {
+		formats.push_back( format );
+	}
+	return formats;
+}
+
+std::wstring BenchmarkFile::GetFormatName( const Format format )
+{
+	const auto entry = std::find_if( s_Formats.begin(), s_Formats.end(), [ format ] ( const auto& entry ) { return format == std::get<0>( entry ); } );
+	return ( s_Formats.end() != entry ) ? std::get<1>( *entry ) : std::wstring();
+}
+
+std::optional<BenchmarkFile::Format> BenchmarkFile::GetFormat( const std::wstring& name )
+{
+	const auto entry = std::find_if( s_Formats.begin(), s_Formats.end(), [ &name ] ( const auto& entry ) { return 0 == _wcsicmp( name.c_str(), std::get<1>( entry ).c_str() ); } );
+	return ( s_Formats.end() != entry ) ? std::make_optional( std::get<0>( *entry ) ) : std::nullopt;
+}
+
+std::wstring BenchmarkFile::Write( const std::filesystem::path& filename, const Format format, const long sampleRate, const long channels, const long frames, const Tags& tags )
+{
+	const auto entry = std::find_if( s_Formats.begin(), s_Formats.end(), [ format ] ( const auto& entry ) { return format == std::get<0>( entry ); } );
+	std::wstring outputFilename = filename.wstring() + ( ( s_Formats.end() != entry ) ? std::get<2>( *entry ) : std::wstring() );
+	bool success = ( sampleRate > 0 ) && ( channels > 0 ) && ( frames >= 0 );
+	if ( success ) {
+		switch ( format ) {
+			case Format::WAV : {
+				success = WriteWAV( outputFilename, sampleRate, channels, frames );
+				break;
+			}
+			case Format::FLAC : {
+				EncoderFlac encoder;
+				success = WriteEncoded( encoder, outputFilename, sampleRate, channels, frames, std::string(), tags );
+				break;
+			}
+			case Format::Opus : {
+				EncoderOpus encoder;
+				success = WriteEncoded( encoder, outputFilename, sampleRate, channels, frames, s_OpusSettings, tags );
+				if ( success && !tags.empty() ) {
+					// The Opus encoder does not write tags.
+					success = HandlerOpus().SetTags( outputFilename, tags );
+				}
+				break;
+			}
+			case Format::WavPack : {
+				success = WriteWavPack( outputFilename, sampleRate, channels, frames );
+				if ( success && !tags.empty() ) {
+					success = HandlerWavpack().SetTags( outputFilename, tags );
+				}
+				break;
+			}
+			case Format::APE : {
+				success = WriteAPE( outputFilename, sampleRate, channels, frames );
+				if ( success && !tags.empty() ) {
+					success = HandlerMAC().SetTags( outputFilename, tags );
+				}
+				break;
+			}
+			case Format::ALAC : {
+				success = WriteMP4( outputFilename, AV_CODEC_ID_ALAC, sampleRate, channels, frames, tags );
+				break;
+			}
+			case Format::AAC : {
+				success = WriteMP4( outputFilename, AV_CODEC_ID_AAC, sampleRate, channels, frames, tags );
+				break;
+			}
+		}
+	}
+	if ( !success ) {
+		_wunlink( outputFilename.c_str() );
+		outputFilename.clear();
+	}
+	return outputFilename;
+}
+
+bool BenchmarkFile::WriteWAV( const std::wstring& filename, const long sampleRate, const long channels, const long frames )
+{
+	const uint16_t bitsPerSample = 16;
+	const uint16_t blockAlign = static_cast<uint16_t>( channels * bitsPerSample / 8 );
+	const uint32_t dataSize = static_cast<uint32_t>( frames ) * blockAlign;
+
+	// Appends a little endian 'value' to 'data'.
+	auto append = [] ( std::vector<char>& data, const auto value )
+	{
+		for ( size_t byte = 0; byte < sizeof( value ); byte++ ) {
+			data.push_back( static_cast<char>( value >> ( 8 * byte ) ) );
+		}
+	};
+
+	std::vector<char> header;
+	header.insert( header.end(), { 'R', 'I', 'F', 'F' } );
+	append( header, static_cast<uint32_t>( 36 + dataSize ) );
+	header.insert( header.end(), { 'W', 'A', 'V', 'E', 'f', 'm', 't', ' ' } );
+	append( header, static_cast<uint32_t>( 16 ) );
+	append( header, static_cast<uint16_t>( 1 /*WAVE_FORMAT_PCM*/ ) );
+	append( header, static_cast<uint16_t>( channels ) );
+	append( header, static_cast<uint32_t>( sampleRate ) );
+	append( header, static_cast<uint32_t>( sampleRate * blockAlign ) );
+	append( header, blockAlign );
+	append( header, bitsPerSample );
+	header.insert( header.end(), { 'd', 'a', 't', 'a' } );
+	append( header, dataSize );
+
+	std::ofstream stream( filename, std::ios::binary | std::ios::trunc );
+	stream.write( header.data(), static_cast<std::streamsize>( header.size() ) );
+
+	TestSignal signal( sampleRate, channels );
+	std::vector<float> buffer( static_cast<size_t>( s_BlockFrames ) * channels );
+	std::vector<int16_t> output( buffer.size() );
+	for ( long position = 0; stream.good() && ( position < frames ); position += s_BlockFrames ) {
+		const long blockFrames = std::min( s_BlockFrames, frames - position );
+		const size_t blockSamples = static_cast<size_t>( blockFrames ) * channels;
+		signal.Read( buffer.data(), blockFrames );
+		std::transform( buffer.begin(), buffer.begin() + blockSamples, output.begin(), FloatTo16 );
+		stream.write( reinterpret_cast<const char*>( output.data() ), static_cast<std::streamsize>( blockSamples * sizeof( int16_t ) ) );
+	}
+	return stream.good();
+}
+
+bool BenchmarkFile::WriteEncoded( Encoder& encoder, std::wstring& filename, const long sampleRate, const long channels, const long frames, const std::string& settings, const Tags& tags )
+{
+	bool success = encoder.Open( filename, sampleRate, channels, 16 /*bitsPerSample*/, frames, settings, tags );
+	if ( success ) {
+		TestSignal signal( sampleRate, channels );
+		std::vector<float> buffer( static_cast<size_t>( s_BlockFrames ) * channels );
+		for ( long position = 0; success && ( position < frames ); position += s_BlockFrames ) {
+			const long blockFrames = std::min( s_BlockFrames, frames - position );
+			signal.Read( buffer.data(), blockFrames );
+			success = encoder.Write( buffer.data(), blockFrames );
+		}
+		encoder.Close();
+	}
+	return success;
+}
+
+bool BenchmarkFile::WriteWavPack( const std::wstring& filename, const long sampleRate, const long channels, const long frames )
+{
+	std::ofstream stream( filename, std::ios::binary | std::ios::trunc );
+	WavpackContext* context = stream.good() ? WavpackOpenFileOutput( WriteWavPackBlock, &stream, nullptr /*wvc_id*/ ) : nullptr;
+	bool success = ( nullptr != context );
+	if ( success ) {
+		WavpackConfig config = {};
+		config.bits_per_sample = 16;
+		config.bytes_per_sample = 2;
+		config.num_channels = channels;
+		config.channel_mask = ( 1 == channels ) ? 4 : ( ( 2 == channels ) ? 3 : 0 );
+		config.sample_rate = sampleRate;
+		success = WavpackSetConfiguration64( context, &config, frames, nullptr /*chan_ids*/ ) && WavpackPackInit( context );
+
+		TestSignal signal( sampleRate, channels );
+		std::vector<float> buffer( static_cast<size_t>( s_BlockFrames ) * channels );
+		std::vector<int32_t> output( buffer.size() );
+		for ( long position = 0; success && ( position < frames ); position += s_BlockFrames ) {
+			const long blockFrames = std::min( s_BlockFrames, frames - position );
+			signal.Read( buffer.data(), blockFrames );
+			std::transform( buffer.begin(), buffer.begin() + static_cast<size_t>( blockFrames ) * channels, output.begin(), FloatTo16 );
+			success = WavpackPackSamples( context, output.data(), static_cast<uint32_t>( blockFrames ) );
+		}
+		success = success && WavpackFlushSamples( context );
+		WavpackCloseFile( context );
+	}
+	stream.close();
+	return success && stream.good();
+}
+
+bool BenchmarkFile::WriteAPE( const std::wstring& filename, const long sampleRate, const long channels, const long frames )
+{
+	const int bitsPerSample = 16;
+	std::unique_ptr<APE::IAPECompress> compress( CreateIAPECompress() );
+	APE::WAVEFORMATEX format = {};
+	bool success = compress && ( ERROR_SUCCESS == FillWaveFormatEx( &format, WAVE_FORMAT_PCM, sampleRate, bitsPerSample, channels ) );
+	if ( success ) {
+		const APE::int64 audioBytes = static_cast<APE::int64>( frames ) * format.nBlockAlign;
+		success = ( ERROR_SUCCESS == compress->Start( filename.c_str(), &format, audioBytes, MAC_COMPRESSION_LEVEL_NORMAL, nullptr /*headerData*/, CREATE_WAV_HEADER_ON_DECOMPRESSION ) );
+		if ( success ) {
+			TestSignal signal( sampleRate, channels );
+			std::vector<float> buffer( static_cast<size_t>( s_BlockFrames ) * channels );
+			std::vector<int16_t> output( buffer.size() );
+			for ( long position = 0; success && ( position < frames ); position += s_BlockFrames ) {
+				const long blockFrames = std::min( s_BlockFrames, frames - position );
+				const size_t blockSamples = static_cast<size_t>( blockFrames ) * channels;
+				signal.Read( buffer.data(), blockFrames );
+				std::transform( buffer.begin(), buffer.begin() + blockSamples, output.begin(), FloatTo16 );
+				success = ( ERROR_SUCCESS == compress->AddData( reinterpret_cast<unsigned char*>( output.data() ), static_cast<APE::int64>( blockSamples * sizeof( int16_t ) ) ) );
+			}
+			success = ( ERROR_SUCCESS == compress->Finish( nullptr /*terminatingData*/, 0 /*terminatingBytes*/, 0 /*wavTerminatingBytes*/ ) ) && success;
+		}
+	}
+	return success;
+}
+
+bool BenchmarkFile::WriteMP4( const std::wstring& filename, const int codecID, const long sampleRate, const long channels, const long frames, const Tags& tags )
+{
+	bool success = false;
+
+	// Use planar float, 16-bit or 32-bit sample data (in order of preference), whichever the encoder supports.
+	const AVCodec* codec = avcodec_find_encoder( static_cast<AVCodecID>( codecID ) );
+	AVSampleFormat sampleFormat = AV_SAMPLE_FMT_NONE;
+	if ( ( nullptr != codec ) && ( nullptr != codec->sample_fmts ) ) {
+		for ( const AVSampleFormat preferredFormat : { AV_SAMPLE_FMT_FLTP, AV_SAMPLE_FMT_S16P, AV_SAMPLE_FMT_S32P } ) {
+			for ( const AVSampleFormat* supportedFormat = codec->sample_fmts; ( AV_SAMPLE_FMT_NONE == sampleFormat ) && ( AV_SAMPLE_FMT_NONE != *supportedFormat ); supportedFormat++ ) {
+				if ( preferredFormat == *supportedFormat ) {
+					sampleFormat = preferredFormat;
+				}
+			}
+		}
+	}
+
+	const std::string utf8Filename = WideStringToUTF8( filename );
+	AVFormatContext* formatContext = nullptr;
+	AVCodecContext* encoderContext = nullptr;
+	AVFrame* frame = av_frame_alloc();
+	AVPacket* packet = av_packet_alloc();
+	if ( ( AV_SAMPLE_FMT_NONE != sampleFormat ) && ( nullptr != frame ) && ( nullptr != packet ) && ( avformat_alloc_output_context2( &formatContext, nullptr, "ipod", utf8Filename.c_str() ) >= 0 ) ) {
+		AVStream* stream = avformat_new_stream( formatContext, nullptr );
+		encoderContext = avcodec_alloc_context3( codec );
+		if ( ( nullptr != stream ) && ( nullptr != encoderContext ) ) {
+			encoderContext->sample_fmt = sampleFormat;
+			encoderContext->sample_rate = sampleRate;
+			encoderContext->channels = channels;
+			encoderContext->channel_layout = av_get_default_channel_layout( channels );
+			encoderContext->time_base = { 1, sampleRate };
+			if ( AV_CODEC_ID_AAC == codec->id ) {
+				encoderContext->bit_rate = s_AACBitrate;
+			}
+			if ( 0 != ( formatContext->oformat->flags & AVFMT_GLOBALHEADER ) ) {
+				encoderContext->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+			}
+			if ( ( avcodec_open2( encoderContext, codec, nullptr ) >= 0 ) && ( avcodec_parameters_from_context( stream->codecpar, encoderContext ) >= 0 ) ) {
+				stream->time_base = encoderContext->time_base;
+				for ( const auto& [ tag, value ] : tags ) {
+					if ( const auto mp4Tag = s_MP4Tags.find( tag ); s_MP4Tags.end() != mp4Tag ) {
+						av_dict_set( &formatContext->metadata, mp4Tag->second.c_str(), value.c_str(), 0 );
+					}
+				}
+
+				const long frameSize = ( encoderContext->frame_size > 0 ) ? encoderContext->frame_size : s_BlockFrames;
+				frame->format = sampleFormat;
+				frame->sample_rate = sampleRate;
+				frame->channels = channels;
+				frame->channel_layout = encoderContext->channel_layout;
+				frame->nb_samples = frameSize;
+				success = ( av_frame_get_buffer( frame, 0 ) >= 0 ) && ( avio_open( &formatContext->pb, utf8Filename.c_str(), AVIO_FLAG_WRITE ) >= 0 ) && ( avformat_write_header( formatContext, nullptr ) >= 0 );
+				if ( success ) {
+					// Sends the 'input' frame to the encoder (or flushes the encoder, if the frame is null), and writes out the encoded packets.
+					// Returns whether the frame was encoded & written.
+					auto encode = [ formatContext, encoderContext, stream, packet ] ( const AVFrame* input )
+					{
+						bool encoded = ( avcodec_send_frame( encoderContext, input ) >= 0 );
+						while ( encoded && ( avcodec_receive_packet( encoderContext, packet ) >= 0 ) ) {
+							av_packet_rescale_ts( packet, encoderContext->time_base, stream->time_base );
+							packet->stream_index = stream->index;
+							encoded = ( av_interleaved_write_frame( formatContext, packet ) >= 0 );
+						}
+						return encoded;
+					};
+
+					TestSignal signal( sampleRate, channels );
+					std::vector<float> buffer( static_cast<size_t>( frameSize ) * channels );
+					for ( long position = 0; success && ( position < frames ); position += frameSize ) {
+						const long blockFrames = std::min( frameSize, frames - position );
+						signal.Read( buffer.data(), blockFrames );
+						success = ( av_frame_make_writable( frame ) >= 0 );
+						if ( success ) {
+							frame->nb_samples = blockFrames;
+							frame->pts = position;
+							for ( long channel = 0; channel < channels; channel++ ) {
+								const float* input = buffer.data() + channel;
+								for ( long sampleFrame = 0; sampleFrame < blockFrames; sampleFrame++, input += channels ) {
+									switch ( sampleFormat ) {
+										case AV_SAMPLE_FMT_FLTP : {
+											reinterpret_cast<float*>( frame->extended_data[ channel ] )[ sampleFrame ] = *input;
+											break;
+										}
+										case AV_SAMPLE_FMT_S16P : {
+											reinterpret_cast<int16_t*>( frame->extended_data[ channel ] )[ sampleFrame ] = FloatTo16( *input );
+											break;
+										}
+										default : {
+											reinterpret_cast<int32_t*>( frame->extended_data[ channel ] )[ sampleFrame ] = FloatTo24( *input ) * 256;
+											break;
+										}
+									}
+								}
+							}
+							success = encode( frame );
+						}
+					}
+					success = success && encode( nullptr /*flush*/ );
+					success = ( av_write_trailer( formatContext ) >= 0 ) && success;
+				}
+			}
+		}
+	}
+
+	av_packet_free( &packet );
+	av_frame_free( &frame );
+	avcodec_free_context( &encoderContext );
+	if ( nullptr != formatContext ) {
+		avio_closep( &formatContext->pb );
+		avformat_free_context( formatContext );
+	}
+	return success;
+}
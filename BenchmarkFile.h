@@ -0,0 +1,69 @@
+#pragma once
+
+#include "Encoder.h"
+#include "Tag.h"
+
+#include <filesystem>
+#include <list>
+#include <optional>
+#include <string>
+
+// Generates reference audio files for the benchmarks, so that results can be compared between builds (and machines) without a shared set of media files.
+// Every file contains the same deterministic test signal, so differences in throughput reflect the format & decoder rather than the content.
+class BenchmarkFile
+{
+public:
+	// Reference file formats.
+	enum class Format {
+		WAV,
+		FLAC,
+		Opus,
+		WavPack,
+		APE,
+		ALAC,
+		AAC
+	};
+
+	// Returns all the reference file formats.
+	static std::list<Format> GetFormats();
+
+	// Returns the name of the 'format'.
+	static std::wstring GetFormatName( const Format format );
+
+	// Returns the format with the (case insensitive) 'name', or nullopt if there is no such format.
+	static std::optional<Format> GetFormat( const std::wstring& name );
+
+	// Writes a reference file.
+	// 'filename' - file name, without a file extension (the extension for the 'format' is appended).
+	// 'format' - file format.
+	// 'sampleRate' - sample rate.
+	// 'channels' - number of channels.
+	// 'frames' - number of sample frames.
+	// 'tags' - metadata tags (which are not written to WAV files).
+	// Returns the name of the file written, or an empty string if the file could not be written.
+	static std::wstring Write( const std::filesystem::path& filename, const Format format, const long sampleRate, const long channels, const long frames, const Tags& tags );
+
+private:
+	// Writes a 16-bit WAV file.
+	// Returns whether the file was written.
+	static bool WriteWAV( const std::wstring& filename, const long sampleRate, const long channels, const long frames );
+
+	// Writes a file using one of the application 'encoder's.
+	// 'filename' - (in) file name without a file extension, (out) file name with the extension added by the encoder.
+	// 'settings' - encoder settings.
+	// Returns whether the file was written.
+	static bool WriteEncoded( Encoder& encoder, std::wstring& filename, const long sampleRate, const long channels, const long frames, const std::string& settings, const Tags& tags );
+
+	// Writes a WavPack file.
+	// Returns whether the file was written.
+	static bool WriteWavPack( const std::wstring& filename, const long sampleRate, const long channels, const long frames );
+
+	// Writes a Monkey's Audio file.
+	// Returns whether the file was written.
+	static bool WriteAPE( const std::wstring& filename, const long sampleRate, const long channels, const long frames );
+
+	// Writes an MP4 file using an FFmpeg encoder.
+	// 'codecID' - FFmpeg codec ID.
+	// Returns whether the file was written.
+	static bool WriteMP4( const std::wstring& filename, const int codecID, const long sampleRate, const long channels, const long frames, const Tags& tags );
+};
@@ -8,6 +8,7 @@
 
 #include <iomanip>
 #include <sstream>
+#include <thread>
 
 // Timer ID.
 static const long s_TimerID = 1212;
@@ -244,7 +245,7 @@ void Converter::EncodeHandler()
 				std::wstring filename = extractJoin ? m_JoinFilename : GetOutputFilename( track->Info );
 				conversionOK = !filename.empty();
 				if ( conversionOK ) {
-					const Decoder::Ptr decoder = OpenDecoder( *track );
+					const Decoder::Ptr decoder = OpenDecoder( *track, static_cast<long>( std::max( 1u, std::thread::hardware_concurrency() ) ) );
 					if ( extractJoin ) {
 						conversionOK = static_cast<bool>( decoder );
 					}
@@ -599,13 +600,13 @@ void Converter::WriteAlbumTags( const std::wstring& filename, const MediaInfo& m
 	}
 }
 
-Decoder::Ptr Converter::OpenDecoder( const Playlist::Item& item ) const
+Decoder::Ptr Converter::OpenDecoder( const Playlist::Item& item, const long threadCount ) const
 {
-	Decoder::Ptr decoder = m_Handlers.OpenDecoder( item.Info.GetFilename() );
+	Decoder::Ptr decoder = m_Handlers.OpenDecoder( item.Info.GetFilename(), threadCount );
 	if ( !decoder ) {
 		auto duplicate = item.Duplicates.begin();
 		while ( !decoder && ( item.Duplicates.end() != duplicate ) ) {
-			decoder = m_Handlers.OpenDecoder( *duplicate );
+			decoder = m_Handlers.OpenDecoder( *duplicate, threadCount );
 			++duplicate;
 		}
 	}
@@ -62,7 +62,8 @@ private:
 	void WriteAlbumTags( const std::wstring& filename, const MediaInfo& mediaInfo );
 
 	// Returns a decoder for the 'item', or nullptr if a decoder could not be opened.
-	Decoder::Ptr OpenDecoder( const Playlist::Item& item ) const;
+	// 'threadCount' - number of threads the decoder can use to decode the item.
+	Decoder::Ptr OpenDecoder( const Playlist::Item& item, const long threadCount = 1 ) const;
 
 	// Module instance handle.
 	HINSTANCE m_hInst;
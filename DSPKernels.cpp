@@ -0,0 +1,593 @@
+#include "DSPKernels.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <numeric>
+
+#if defined( _M_IX86 ) || defined( _M_X64 )
+#define DSPKERNELS_X86
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+// Maximum number of channels handled by the vectorised fade implementations (higher channel counts use the scalar implementation).
+constexpr long s_MaxVectorFadeChannels = 8;
+
+// Polynomial coefficients approximating sin( x * pi / 2 ) over the range 0 <= x <= 1.
+constexpr float s_SineCoefficient1 = 1.5707963268f;
+constexpr float s_SineCoefficient3 = 0.6459640975f;
+constexpr float s_SineCoefficient5 = 0.0796926262f;
+constexpr float s_SineCoefficient7 = 0.0046817541f;
+constexpr float s_SineCoefficient9 = 0.0001604411f;
+
+// The instruction set used by the kernels.
+static std::atomic<DSPKernels::InstructionSet> s_InstructionSet( DSPKernels::GetSupportedInstructionSet() );
+
+DSPKernels::InstructionSet DSPKernels::GetSupportedInstructionSet()
+{
+	InstructionSet instructionSet = InstructionSet::Scalar;
+#ifdef DSPKERNELS_X86
+	int info[ 4 ] = {};
+	__cpuid( info, 0 );
+	const int maxFunction = info[ 0 ];
+	if ( maxFunction >= 1 ) {
+		__cpuid( info, 1 );
+		const bool sse2 = ( 0 != ( info[ 3 ] & ( 1 << 26 ) ) );
+		const bool osxsave = ( 0 != ( info[ 2 ] & ( 1 << 27 ) ) );
+		const bool avx = ( 0 != ( info[ 2 ] & ( 1 << 28 ) ) );
+		if ( sse2 ) {
+			instructionSet = InstructionSet::SSE2;
+		}
+		if ( sse2 && osxsave && avx && ( maxFunction >= 7 ) ) {
+			// Check that the OS preserves the YMM registers.
+			if ( 6 == ( _xgetbv( 0 ) & 6 ) ) {
+				__cpuidex( info, 7, 0 );
+				if ( 0 != ( info[ 1 ] & ( 1 << 5 ) ) ) {
+					instructionSet = InstructionSet::AVX2;
+				}
+			}
+		}
+	}
+#endif
+	return instructionSet;
+}
+
+DSPKernels::InstructionSet DSPKernels::GetInstructionSet()
+{
+	return s_InstructionSet;
+}
+
+DSPKernels::InstructionSet DSPKernels::SetInstructionSet( const InstructionSet instructionSet )
+{
+	s_InstructionSet = std::min( instructionSet, GetSupportedInstructionSet() );
+	return s_InstructionSet;
+}
+
+void DSPKernels::Gain( float* buffer, const size_t count, const float gain )
+{
+	switch ( s_InstructionSet.load( std::memory_order_relaxed ) ) {
+		case InstructionSet::AVX2 : {
+			GainAVX2( buffer, count, gain );
+			break;
+		}
+		case InstructionSet::SSE2 : {
+			GainSSE2( buffer, count, gain );
+			break;
+		}
+		default : {
+			GainScalar( buffer, count, gain );
+			break;
+		}
+	}
+}
+
+void DSPKernels::GainClip( float* buffer, const size_t count, const float gain )
+{
+	switch ( s_InstructionSet.load( std::memory_order_relaxed ) ) {
+		case InstructionSet::AVX2 : {
+			GainClipAVX2( buffer, count, gain );
+			break;
+		}
+		case InstructionSet::SSE2 : {
+			GainClipSSE2( buffer, count, gain );
+			break;
+		}
+		default : {
+			GainClipScalar( buffer, count, gain );
+			break;
+		}
+	}
+}
+
+void DSPKernels::Fade( float* buffer, const size_t frames, const long channels, const float start, const float step, const FadeCurve curve )
+{
+	switch ( s_InstructionSet.load( std::memory_order_relaxed ) ) {
+		case InstructionSet::AVX2 : {
+			FadeAVX2( buffer, frames, channels, start, step, curve );
+			break;
+		}
+		case InstructionSet::SSE2 : {
+			FadeSSE2( buffer, frames, channels, start, step, curve );
+			break;
+		}
+		default : {
+			FadeScalar( buffer, frames, channels, start, step, curve );
+			break;
+		}
+	}
+}
+
+void DSPKernels::MixAdd( float* destination, const float* source, const size_t count )
+{
+	switch ( s_InstructionSet.load( std::memory_order_relaxed ) ) {
+		case InstructionSet::AVX2 : {
+			MixAddAVX2( destination, source, count );
+			break;
+		}
+		case InstructionSet::SSE2 : {
+			MixAddSSE2( destination, source, count );
+			break;
+		}
+		default : {
+			MixAddScalar( destination, source, count );
+			break;
+		}
+	}
+}
+
+float DSPKernels::DotProduct( const float* first, const float* second, const size_t count )
+{
+	switch ( s_InstructionSet.load( std::memory_order_relaxed ) ) {
+		case InstructionSet::AVX2 : {
+			return DotProductAVX2( first, second, count );
+		}
+		case InstructionSet::SSE2 : {
+			return DotProductSSE2( first, second, count );
+		}
+		default : {
+			return DotProductScalar( first, second, count );
+		}
+	}
+}
+
+size_t DSPKernels::FindFirstAbove( const float* buffer, const size_t count, const float threshold )
+{
+	switch ( s_InstructionSet.load( std::memory_order_relaxed ) ) {
+		case InstructionSet::AVX2 : {
+			return FindFirstAboveAVX2( buffer, count, threshold );
+		}
+		case InstructionSet::SSE2 : {
+			return FindFirstAboveSSE2( buffer, count, threshold );
+		}
+		default : {
+			return FindFirstAboveScalar( buffer, count, threshold );
+		}
+	}
+}
+
+size_t DSPKernels::FindLastAbove( const float* buffer, const size_t count, const float threshold )
+{
+	switch ( s_InstructionSet.load( std::memory_order_relaxed ) ) {
+		case InstructionSet::AVX2 : {
+			return FindLastAboveAVX2( buffer, count, threshold );
+		}
+		case InstructionSet::SSE2 : {
+			return FindLastAboveSSE2( buffer, count, threshold );
+		}
+		default : {
+			return FindLastAboveScalar( buffer, count, threshold );
+		}
+	}
+}
+
+float DSPKernels::GetFadeGain( const float position, const FadeCurve curve )
+{
+	const float x = std::clamp( position, 0.0f, 1.0f );
+	if ( FadeCurve::EqualPower == curve ) {
+		const float x2 = x * x;
+		return x * ( s_SineCoefficient1 - x2 * ( s_SineCoefficient3 - x2 * ( s_SineCoefficient5 - x2 * ( s_SineCoefficient7 - x2 * s_SineCoefficient9 ) ) ) );
+	}
+	return x;
+}
+
+void DSPKernels::GainScalar( float* buffer, const size_t count, const float gain )
+{
+	for ( size_t index = 0; index < count; index++ ) {
+		buffer[ index ] *= gain;
+	}
+}
+
+void DSPKernels::GainClipScalar( float* buffer, const size_t count, const float gain )
+{
+	for ( size_t index = 0; index < count; index++ ) {
+		buffer[ index ] = std::clamp( buffer[ index ] * gain, -1.0f, 1.0f );
+	}
+}
+
+void DSPKernels::FadeScalar( float* buffer, const size_t frames, const long channels, const float start, const float step, const FadeCurve curve )
+{
+	if ( channels > 0 ) {
+		for ( size_t frame = 0; frame < frames; frame++ ) {
+			const float gain = GetFadeGain( start + frame * step, curve );
+			for ( long channel = 0; channel < channels; channel++, buffer++ ) {
+				*buffer *= gain;
+			}
+		}
+	}
+}
+
+void DSPKernels::MixAddScalar( float* destination, const float* source, const size_t count )
+{
+	for ( size_t index = 0; index < count; index++ ) {
+		destination[ index ] += source[ index ];
+	}
+}
+
+float DSPKernels::DotProductScalar( const float* first, const float* second, const size_t count )
+{
+	float result = 0;
+	for ( size_t index = 0; index < count; index++ ) {
+		result += first[ index ] * second[ index ];
+	}
+	return result;
+}
+
+size_t DSPKernels::FindFirstAboveScalar( const float* buffer, const size_t count, const float threshold )
+{
+	size_t index = 0;
+	while ( ( index < count ) && !( std::fabs( buffer[ index ] ) > threshold ) ) {
+		index++;
+	}
+	return index;
+}
+
+size_t DSPKernels::FindLastAboveScalar( const float* buffer, const size_t count, const float threshold )
+{
+	size_t index = count;
+	while ( ( index > 0 ) && !( std::fabs( buffer[ index - 1 ] ) > threshold ) ) {
+		index--;
+	}
+	return index;
+}
+
+#ifdef DSPKERNELS_X86
+
+// Returns the index of the lowest set bit in a non-zero comparison 'mask'.
+static size_t GetFirstMaskIndex( unsigned int mask )
+{
+	size_t index = 0;
+	while ( 0 == ( mask & 1 ) ) {
+		mask >>= 1;
+		index++;
+	}
+	return index;
+}
+
+// Returns the index of the highest set bit in a non-zero comparison 'mask'.
+static size_t GetLastMaskIndex( unsigned int mask )
+{
+	size_t index = 0;
+	while ( 0 != ( mask >>= 1 ) ) {
+		index++;
+	}
+	return index;
+}
+
+void DSPKernels::GainSSE2( float* buffer, const size_t count, const float gain )
+{
+	const __m128 scale = _mm_set1_ps( gain );
+	size_t index = 0;
+	for ( ; ( index + 4 ) <= count; index += 4 ) {
+		_mm_storeu_ps( buffer + index, _mm_mul_ps( _mm_loadu_ps( buffer + index ), scale ) );
+	}
+	GainScalar( buffer + index, count - index, gain );
+}
+
+void DSPKernels::GainClipSSE2( float* buffer, const size_t count, const float gain )
+{
+	const __m128 scale = _mm_set1_ps( gain );
+	const __m128 maximum = _mm_set1_ps( 1.0f );
+	const __m128 minimum = _mm_set1_ps( -1.0f );
+	size_t index = 0;
+	for ( ; ( index + 4 ) <= count; index += 4 ) {
+		const __m128 samples = _mm_mul_ps( _mm_loadu_ps( buffer + index ), scale );
+		_mm_storeu_ps( buffer + index, _mm_max_ps( _mm_min_ps( samples, maximum ), minimum ) );
+	}
+	GainClipScalar( buffer + index, count - index, gain );
+}
+
+void DSPKernels::FadeSSE2( float* buffer, const size_t frames, const long channels, const float start, const float step, const FadeCurve curve )
+{
+	constexpr long kLanes = 4;
+	size_t framesProcessed = 0;
+	if ( ( channels > 0 ) && ( channels <= s_MaxVectorFadeChannels ) ) {
+		// The frame offset of each lane repeats after a 'period' of vectors, which covers a whole number of frames.
+		const long period = channels / std::gcd( channels, kLanes );
+		const size_t framesPerPeriod = static_cast<size_t>( period * kLanes / channels );
+		__m128 offsets[ s_MaxVectorFadeChannels ] = {};
+		for ( long vector = 0; vector < period; vector++ ) {
+			const long sample = vector * kLanes;
+			offsets[ vector ] = _mm_mul_ps( _mm_set_ps(
+				static_cast<float>( ( sample + 3 ) / channels ), static_cast<float>( ( sample + 2 ) / channels ),
+				static_cast<float>( ( sample + 1 ) / channels ), static_cast<float>( sample / channels ) ), _mm_set1_ps( step ) );
+		}
+
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 one = _mm_set1_ps( 1.0f );
+		const __m128 c1 = _mm_set1_ps( s_SineCoefficient1 );
+		const __m128 c3 = _mm_set1_ps( s_SineCoefficient3 );
+		const __m128 c5 = _mm_set1_ps( s_SineCoefficient5 );
+		const __m128 c7 = _mm_set1_ps( s_SineCoefficient7 );
+		const __m128 c9 = _mm_set1_ps( s_SineCoefficient9 );
+		float* samples = buffer;
+		for ( ; ( framesProcessed + framesPerPeriod ) <= frames; framesProcessed += framesPerPeriod ) {
+			const __m128 base = _mm_set1_ps( start + framesProcessed * step );
+			for ( long vector = 0; vector < period; vector++, samples += kLanes ) {
+				__m128 gain = _mm_min_ps( _mm_max_ps( _mm_add_ps( base, offsets[ vector ] ), zero ), one );
+				if ( FadeCurve::EqualPower == curve ) {
+					const __m128 x2 = _mm_mul_ps( gain, gain );
+					__m128 poly = _mm_sub_ps( c7, _mm_mul_ps( x2, c9 ) );
+					poly = _mm_sub_ps( c5, _mm_mul_ps( x2, poly ) );
+					poly = _mm_sub_ps( c3, _mm_mul_ps( x2, poly ) );
+					poly = _mm_sub_ps( c1, _mm_mul_ps( x2, poly ) );
+					gain = _mm_mul_ps( gain, poly );
+				}
+				_mm_storeu_ps( samples, _mm_mul_ps( _mm_loadu_ps( samples ), gain ) );
+			}
+		}
+	}
+	if ( channels > 0 ) {
+		FadeScalar( buffer + framesProcessed * channels, frames - framesProcessed, channels, start + framesProcessed * step, step, curve );
+	}
+}
+
+void DSPKernels::MixAddSSE2( float* destination, const float* source, const size_t count )
+{
+	size_t index = 0;
+	for ( ; ( index + 4 ) <= count; index += 4 ) {
+		_mm_storeu_ps( destination + index, _mm_add_ps( _mm_loadu_ps( destination + index ), _mm_loadu_ps( source + index ) ) );
+	}
+	MixAddScalar( destination + index, source + index, count - index );
+}
+
+float DSPKernels::DotProductSSE2( const float* first, const float* second, const size_t count )
+{
+	__m128 total = _mm_setzero_ps();
+	size_t index = 0;
+	for ( ; ( index + 4 ) <= count; index += 4 ) {
+		total = _mm_add_ps( total, _mm_mul_ps( _mm_loadu_ps( first + index ), _mm_loadu_ps( second + index ) ) );
+	}
+	total = _mm_add_ps( total, _mm_movehl_ps( total, total ) );
+	total = _mm_add_ss( total, _mm_shuffle_ps( total, total, 1 ) );
+	return _mm_cvtss_f32( total ) + DotProductScalar( first + index, second + index, count - index );
+}
+
+size_t DSPKernels::FindFirstAboveSSE2( const float* buffer, const size_t count, const float threshold )
+{
+	const __m128 signMask = _mm_set1_ps( -0.0f );
+	const __m128 limit = _mm_set1_ps( threshold );
+	size_t index = 0;
+	for ( ; ( index + 4 ) <= count; index += 4 ) {
+		if ( const int mask = _mm_movemask_ps( _mm_cmpgt_ps( _mm_andnot_ps( signMask, _mm_loadu_ps( buffer + index ) ), limit ) ); 0 != mask ) {
+			return index + GetFirstMaskIndex( static_cast<unsigned int>( mask ) );
+		}
+	}
+	return index + FindFirstAboveScalar( buffer + index, count - index, threshold );
+}
+
+size_t DSPKernels::FindLastAboveSSE2( const float* buffer, const size_t count, const float threshold )
+{
+	const __m128 signMask = _mm_set1_ps( -0.0f );
+	const __m128 limit = _mm_set1_ps( threshold );
+	size_t index = count;
+	for ( ; index >= 4; index -= 4 ) {
+		if ( const int mask = _mm_movemask_ps( _mm_cmpgt_ps( _mm_andnot_ps( signMask, _mm_loadu_ps( buffer + index - 4 ) ), limit ) ); 0 != mask ) {
+			return index - 4 + GetLastMaskIndex( static_cast<unsigned int>( mask ) ) + 1;
+		}
+	}
+	return FindLastAboveScalar( buffer, index, threshold );
+}
+
+void DSPKernels::GainAVX2( float* buffer, const size_t count, const float gain )
+{
+	const __m256 scale = _mm256_set1_ps( gain );
+	size_t index = 0;
+	for ( ; ( index + 8 ) <= count; index += 8 ) {
+		_mm256_storeu_ps( buffer + index, _mm256_mul_ps( _mm256_loadu_ps( buffer + index ), scale ) );
+	}
+	_mm256_zeroupper();
+	GainScalar( buffer + index, count - index, gain );
+}
+
+void DSPKernels::GainClipAVX2( float* buffer, const size_t count, const float gain )
+{
+	const __m256 scale = _mm256_set1_ps( gain );
+	const __m256 maximum = _mm256_set1_ps( 1.0f );
+	const __m256 minimum = _mm256_set1_ps( -1.0f );
+	size_t index = 0;
+	for ( ; ( index + 8 ) <= count; index += 8 ) {
+		const __m256 samples = _mm256_mul_ps( _mm256_loadu_ps( buffer + index ), scale );
+		_mm256_storeu_ps( buffer + index, _mm256_max_ps( _mm256_min_ps( samples, maximum ), minimum ) );
+	}
+	_mm256_zeroupper();
+	GainClipScalar( buffer + index, count - index, gain );
+}
+
+void DSPKernels::FadeAVX2( float* buffer, const size_t frames, const long channels, const float start, const float step, const FadeCurve curve )
+{
+	constexpr long kLanes = 8;
+	size_t framesProcessed = 0;
+	if ( ( channels > 0 ) && ( channels <= s_MaxVectorFadeChannels ) ) {
+		// The frame offset of each lane repeats after a 'period' of vectors, which covers a whole number of frames.
+		const long period = channels / std::gcd( channels, kLanes );
+		const size_t framesPerPeriod = static_cast<size_t>( period * kLanes / channels );
+		__m256 offsets[ s_MaxVectorFadeChannels ] = {};
+		for ( long vector = 0; vector < period; vector++ ) {
+			const long sample = vector * kLanes;
+			offsets[ vector ] = _mm256_mul_ps( _mm256_set_ps(
+				static_cast<float>( ( sample + 7 ) / channels ), static_cast<float>( ( sample + 6 ) / channels ),
+				static_cast<float>( ( sample + 5 ) / channels ), static_cast<float>( ( sample + 4 ) / channels ),
+				static_cast<float>( ( sample + 3 ) / channels ), static_cast<float>( ( sample + 2 ) / channels ),
+				static_cast<float>( ( sample + 1 ) / channels ), static_cast<float>( sample / channels ) ), _mm256_set1_ps( step ) );
+		}
+
+		const __m256 zero = _mm256_setzero_ps();
+		const __m256 one = _mm256_set1_ps( 1.0f );
+		const __m256 c1 = _mm256_set1_ps( s_SineCoefficient1 );
+		const __m256 c3 = _mm256_set1_ps( s_SineCoefficient3 );
+		const __m256 c5 = _mm256_set1_ps( s_SineCoefficient5 );
+		const __m256 c7 = _mm256_set1_ps( s_SineCoefficient7 );
+		const __m256 c9 = _mm256_set1_ps( s_SineCoefficient9 );
+		float* samples = buffer;
+		for ( ; ( framesProcessed + framesPerPeriod ) <= frames; framesProcessed += framesPerPeriod ) {
+			const __m256 base = _mm256_set1_ps( start + framesProcessed * step );
+			for ( long vector = 0; vector < period; vector++, samples += kLanes ) {
+				__m256 gain = _mm256_min_ps( _mm256_max_ps( _mm256_add_ps( base, offsets[ vector ] ), zero ), one );
+				if ( FadeCurve::EqualPower == curve ) {
+					const __m256 x2 = _mm256_mul_ps( gain, gain );
+					__m256 poly = _mm256_sub_ps( c7, _mm256_mul_ps( x2, c9 ) );
+					poly = _mm256_sub_ps( c5, _mm256_mul_ps( x2, poly ) );
+					poly = _mm256_sub_ps( c3, _mm256_mul_ps( x2, poly ) );
+					poly = _mm256_sub_ps( c1, _mm256_mul_ps( x2, poly ) );
+					gain = _mm256_mul_ps( gain, poly );
+				}
+				_mm256_storeu_ps( samples, _mm256_mul_ps( _mm256_loadu_ps( samples ), gain ) );
+			}
+		}
+		_mm256_zeroupper();
+	}
+	if ( channels > 0 ) {
+		FadeScalar( buffer + framesProcessed * channels, frames - framesProcessed, channels, start + framesProcessed * step, step, curve );
+	}
+}
+
+void DSPKernels::MixAddAVX2( float* destination, const float* source, const size_t count )
+{
+	size_t index = 0;
+	for ( ; ( index + 8 ) <= count; index += 8 ) {
+		_mm256_storeu_ps( destination + index, _mm256_add_ps( _mm256_loadu_ps( destination + index ), _mm256_loadu_ps( source + index ) ) );
+	}
+	_mm256_zeroupper();
+	MixAddScalar( destination + index, source + index, count - index );
+}
+
+float DSPKernels::DotProductAVX2( const float* first, const float* second, const size_t count )
+{
+	__m256 total = _mm256_setzero_ps();
+	size_t index = 0;
+	for ( ; ( index + 8 ) <= count; index += 8 ) {
+		total = _mm256_add_ps( total, _mm256_mul_ps( _mm256_loadu_ps( first + index ), _mm256_loadu_ps( second + index ) ) );
+	}
+	__m128 sum = _mm_add_ps( _mm256_castps256_ps128( total ), _mm256_extractf128_ps( total, 1 ) );
+	_mm256_zeroupper();
+	sum = _mm_add_ps( sum, _mm_movehl_ps( sum, sum ) );
+	sum = _mm_add_ss( sum, _mm_shuffle_ps( sum, sum, 1 ) );
+	return _mm_cvtss_f32( sum ) + DotProductScalar( first + index, second + index, count - index );
+}
+
+size_t DSPKernels::FindFirstAboveAVX2( const float* buffer, const size_t count, const float threshold )
+{
+	const __m256 signMask = _mm256_set1_ps( -0.0f );
+	const __m256 limit = _mm256_set1_ps( threshold );
+	size_t index = 0;
+	for ( ; ( index + 8 ) <= count; index += 8 ) {
+		if ( const int mask = _mm256_movemask_ps( _mm256_cmp_ps( _mm256_andnot_ps( signMask, _mm256_loadu_ps( buffer + index ) ), limit, _CMP_GT_OQ ) ); 0 != mask ) {
+			_mm256_zeroupper();
+			return index + GetFirstMaskIndex( static_cast<unsigned int>( mask ) );
+		}
+	}
+	_mm256_zeroupper();
+	return index + FindFirstAboveScalar( buffer + index, count - index, threshold );
+}
+
+size_t DSPKernels::FindLastAboveAVX2( const float* buffer, const size_t count, const float threshold )
+{
+	const __m256 signMask = _mm256_set1_ps( -0.0f );
+	const __m256 limit = _mm256_set1_ps( threshold );
+	size_t index = count;
+	for ( ; index >= 8; index -= 8 ) {
+		if ( const int mask = _mm256_movemask_ps( _mm256_cmp_ps( _mm256_andnot_ps( signMask, _mm256_loadu_ps( buffer + index - 8 ) ), limit, _CMP_GT_OQ ) ); 0 != mask ) {
+			_mm256_zeroupper();
+			return index - 8 + GetLastMaskIndex( static_cast<unsigned int>( mask ) ) + 1;
+		}
+	}
+	_mm256_zeroupper();
+	return FindLastAboveScalar( buffer, index, threshold );
+}
+
+#else
+
+// Non-x86 builds only have the scalar implementations.
+
+void DSPKernels::GainSSE2( float* buffer, const size_t count, const float gain )
+{
+	GainScalar( buffer, count, gain );
+}
+
+void DSPKernels::GainClipSSE2( float* buffer, const size_t count, const float gain )
+{
+	GainClipScalar( buffer, count, gain );
+}
+
+void DSPKernels::FadeSSE2( float* buffer, const size_t frames, const long channels, const float start, const float step, const FadeCurve curve )
+{
+	FadeScalar( buffer, frames, channels, start, step, curve );
+}
+
+void DSPKernels::MixAddSSE2( float* destination, const float* source, const size_t count )
+{
+	MixAddScalar( destination, source, count );
+}
+
+float DSPKernels::DotProductSSE2( const float* first, const float* second, const size_t count )
+{
+	return DotProductScalar( first, second, count );
+}
+
+size_t DSPKernels::FindFirstAboveSSE2( const float* buffer, const size_t count, const float threshold )
+{
+	return FindFirstAboveScalar( buffer, count, threshold );
+}
+
+size_t DSPKernels::FindLastAboveSSE2( const float* buffer, const size_t count, const float threshold )
+{
+	return FindLastAboveScalar( buffer, count, threshold );
+}
+
+void DSPKernels::GainAVX2( float* buffer, const size_t count, const float gain )
+{
+	GainScalar( buffer, count, gain );
+}
+
+void DSPKernels::GainClipAVX2( float* buffer, const size_t count, const float gain )
+{
+	GainClipScalar( buffer, count, gain );
+}
+
+void DSPKernels::FadeAVX2( float* buffer, const size_t frames, const long channels, const float start, const float step, const FadeCurve curve )
+{
+	FadeScalar( buffer, frames, channels, start, step, curve );
+}
+
+void DSPKernels::MixAddAVX2( float* destination, const float* source, const size_t count )
+{
+	MixAddScalar( destination, source, count );
+}
+
+float DSPKernels::DotProductAVX2( const float* first, const float* second, const size_t count )
+{
+	return DotProductScalar( first, second, count );
+}
+
+size_t DSPKernels::FindFirstAboveAVX2( const float* buffer, const size_t count, const float threshold )
+{
+	return FindFirstAboveScalar( buffer, count, threshold );
+}
+
+size_t DSPKernels::FindLastAboveAVX2( const float* buffer, const size_t count, const float threshold )
+{
+	return FindLastAboveScalar( buffer, count, threshold );
+}
+
+#endif
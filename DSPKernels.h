@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstddef>
+
+// Sample processing kernels for the output path.
+// Each kernel has a scalar implementation, along with SSE2 & AVX2 implementations which are selected at runtime, depending on processor support.
+class DSPKernels
+{
+public:
+	// Instruction sets.
+	enum class InstructionSet {
+		Scalar,
+		SSE2,
+		AVX2
+	};
+
+	// Fade curves.
+	enum class FadeCurve {
+		Linear,			// Linear amplitude ramp.
+		EqualPower	// Equal power (quarter sine) ramp.
+	};
+
+	// Returns the best instruction set supported by the processor.
+	static InstructionSet GetSupportedInstructionSet();
+
+	// Returns the instruction set used by the kernels.
+	static InstructionSet GetInstructionSet();
+
+	// Sets the 'instructionSet' used by the kernels (e.g. for comparing implementations), if it is supported by the processor.
+	// Returns the instruction set that is actually used.
+	static InstructionSet SetInstructionSet( const InstructionSet instructionSet );
+
+	// Scales samples by a gain value.
+	// 'buffer' - in/out, sample data.
+	// 'count' - number of samples.
+	// 'gain' - linear gain value.
+	static void Gain( float* buffer, const size_t count, const float gain );
+
+	// Scales samples by a gain value, then hard clips the samples to the range -1.0 to +1.0.
+	// 'buffer' - in/out, sample data.
+	// 'count' - number of samples.
+	// 'gain' - linear gain value.
+	static void GainClip( float* buffer, const size_t count, const float gain );
+
+	// Applies a fade ramp to interleaved sample data.
+	// 'buffer' - in/out, interleaved sample data.
+	// 'frames' - number of sample frames.
+	// 'channels' - number of channels.
+	// 'start' - fade position of the first frame, from 0.0 (silent) to 1.0 (full volume).
+	// 'step' - change in fade position per frame (negative to fade out).
+	// 'curve' - fade curve.
+	// Fade positions outside of the range 0.0 to 1.0 are clamped.
+	static void Fade( float* buffer, const size_t frames, const long channels, const float start, const float step, const FadeCurve curve );
+
+	// Adds samples to an existing buffer.
+	// 'destination' - in/out, sample data to mix into.
+	// 'source' - sample data to add.
+	// 'count' - number of samples.
+	static void MixAdd( float* destination, const float* source, const size_t count );
+
+	// Returns the dot product of two sample buffers (e.g. for applying FIR filter coefficients).
+	// 'first' - first sample buffer.
+	// 'second' - second sample buffer.
+	// 'count' - number of samples.
+	static float DotProduct( const float* first, const float* second, const size_t count );
+
+	// Returns the index of the first sample whose magnitude is above a threshold, or 'count' if there is no such sample.
+	// 'buffer' - sample data.
+	// 'count' - number of samples.
+	// 'threshold' - linear threshold value (samples at or below the threshold are considered silent).
+	static size_t FindFirstAbove( const float* buffer, const size_t count, const float threshold );
+
+	// Returns one past the index of the last sample whose magnitude is above a threshold, or zero if there is no such sample.
+	// 'buffer' - sample data.
+	// 'count' - number of samples.
+	// 'threshold' - linear threshold value (samples at or below the threshold are considered silent).
+	static size_t FindLastAbove( const float* buffer, const size_t count, const float threshold );
+
+private:
+	// Returns the gain for a fade 'position', using the fade 'curve'.
+	static float GetFadeGain( const float position, const FadeCurve curve );
+
+	// Scalar implementations.
+	static void GainScalar( float* buffer, const size_t count, const float gain );
+	static void GainClipScalar( float* buffer, const size_t count, const float gain );
+	static void FadeScalar( float* buffer, const size_t frames, const long channels, const float start, const float step, const FadeCurve curve );
+	static void MixAddScalar( float* destination, const float* source, const size_t count );
+	static float DotProductScalar( const float* first, const float* second, const size_t count );
+	static size_t FindFirstAboveScalar( const float* buffer, const size_t count, const float threshold );
+	static size_t FindLastAboveScalar( const float* buffer, const size_t count, const float threshold );
+
+	// SSE2 implementations.
+	static void GainSSE2( float* buffer, const size_t count, const float gain );
+	static void GainClipSSE2( float* buffer, const size_t count, const float gain );
+	static void FadeSSE2( float* buffer, const size_t frames, const long channels, const float start, const float step, const FadeCurve curve );
+	static void MixAddSSE2( float* destination, const float* source, const size_t count );
+	static float DotProductSSE2( const float* first, const float* second, const size_t count );
+	static size_t FindFirstAboveSSE2( const float* buffer, const size_t count, const float threshold );
+	static size_t FindLastAboveSSE2( const float* buffer, const size_t count, const float threshold );
+
+	// AVX2 implementations.
+	static void GainAVX2( float* buffer, const size_t count, const float gain );
+	static void GainClipAVX2( float* buffer, const size_t count, const float gain );
+	static void FadeAVX2( float* buffer, const size_t frames, const long channels, const float start, const float step, const FadeCurve curve );
+	static void MixAddAVX2( float* destination, const float* source, const size_t count );
+	static float DotProductAVX2( const float* first, const float* second, const size_t count );
+	static size_t FindFirstAboveAVX2( const float* buffer, const size_t count, const float threshold );
+	static size_t FindLastAboveAVX2( const float* buffer, const size_t count, const float threshold );
+};
@@ -2,12 +2,21 @@
 
 #include "Utility.h"
 
+#include <sstream>
+
+// The maximum number of statements to cache (statements released beyond this are finalised).
+constexpr size_t s_MaxCachedStatements = 256;
+
 Database::Database( const std::wstring& filename, const Mode mode ) :
 	m_Database( nullptr ),
 	m_Filename( filename ),
 	m_Mode( ( filename.empty() && ( Mode::Disk == mode ) ) ? Mode::Memory : mode ),
 	m_LogMutex(),
-	m_Log()
+	m_Log(),
+	m_StatementMutex(),
+	m_Statements(),
+	m_StatementPrepares( 0 ),
+	m_StatementReuses( 0 )
 {
 	int result = sqlite3_config( SQLITE_CONFIG_LOG, ErrorLogCallback, this );
 	result = sqlite3_initialize();
@@ -80,6 +89,7 @@ Database::Database( const std::wstring& filename, const Mode mode ) :
 
 Database::~Database()
 {
+	ClearStatements();
 	if ( nullptr != m_Database ) {
 		if ( !m_Filename.empty() && ( Mode::Disk != m_Mode ) ) {
 			// Write out the temporary database to disk.
@@ -128,3 +138,82 @@ void Database::AppendToErrorLog( const int errorCode, const std::string& message
 	std::lock_guard<std::mutex> lock( m_LogMutex );
 	m_Log.push_back( std::make_pair( errorCode, message ) );
 }
+
+Database::Statement::Statement( Database& database, const std::string& query ) :
+	m_Database( database ),
+	m_Query( query ),
+	m_Statement( database.AcquireStatement( query ) )
+{
+}
+
+Database::Statement::~Statement()
+{
+	if ( nullptr != m_Statement ) {
+		m_Database.ReleaseStatement( m_Query, m_Statement );
+	}
+}
+
+Database::Statement::operator sqlite3_stmt*() const
+{
+	return m_Statement;
+}
+
+sqlite3_stmt* Database::AcquireStatement( const std::string& query )
+{
+	sqlite3_stmt* statement = nullptr;
+	{
+		std::lock_guard<std::mutex> lock( m_StatementMutex );
+		if ( const auto iter = m_Statements.find( query ); m_Statements.end() != iter ) {
+			statement = iter->second;
+			m_Statements.erase( iter );
+		}
+	}
+	if ( nullptr != statement ) {
+		++m_StatementReuses;
+	} else if ( ( nullptr != m_Database ) && ( SQLITE_OK == sqlite3_prepare_v3( m_Database, query.c_str(), -1 /*nByte*/, SQLITE_PREPARE_PERSISTENT, &statement, nullptr /*tail*/ ) ) ) {
+		++m_StatementPrepares;
+	} else {
+		sqlite3_finalize( statement );
+		statement = nullptr;
+	}
+	return statement;
+}
+
+void Database::ReleaseStatement( const std::string& query, sqlite3_stmt* statement )
+{
+	sqlite3_reset( statement );
+	sqlite3_clear_bindings( statement );
+	{
+		std::lock_guard<std::mutex> lock( m_StatementMutex );
+		if ( m_Statements.size() < s_MaxCachedStatements ) {
+			m_Statements.insert( { query, statement } );
+			statement = nullptr;
+		}
+	}
+	sqlite3_finalize( statement );
+}
+
+void Database::ClearStatements()
+{
+	std::lock_guard<std::mutex> lock( m_StatementMutex );
+	for ( const auto& [ query, statement ] : m_Statements ) {
+		sqlite3_finalize( statement );
+	}
+	m_Statements.clear();
+}
+
+Database::StatementStatistics Database::GetStatementStatistics() const
+{
+	StatementStatistics statistics;
+	statistics.Prepares = m_StatementPrepares;
+	statistics.Reuses = m_StatementReuses;
+	return statistics;
+}
+
+std::wstring Database::GetStatementReport() const
+{
+	const StatementStatistics statistics = GetStatementStatistics();
+	std::wstringstream report;
+	report << L"Database statements: " << statistics.Prepares << L" prepared, " << statistics.Reuses << L" reused\r\n";
+	return report.str();
+}
@@ -4,7 +4,10 @@
 
 #include <sqlite3.h>
 
+#include <atomic>
+#include <cstdint>
 #include <list>
+#include <map>
 #include <mutex>
 #include <string>
 
@@ -28,7 +31,60 @@ public:
 	// Returns the SQLite database.
 	sqlite3* GetDatabase();
 
+	// A prepared statement, taken from the statement cache for the lifetime of the object (or prepared, if there is no cached statement for the query).
+	// The statement is reset, and returned to the cache, when the object is destroyed.
+	class Statement
+	{
+	public:
+		// 'database' - database.
+		// 'query' - SQL query.
+		Statement( Database& database, const std::string& query );
+
+		virtual ~Statement();
+
+		Statement( const Statement& ) = delete;
+		Statement& operator=( const Statement& ) = delete;
+
+		// Returns the SQLite statement, or nullptr if the query could not be prepared.
+		operator sqlite3_stmt*() const;
+
+	private:
+		// Database.
+		Database& m_Database;
+
+		// SQL query.
+		const std::string m_Query;
+
+		// SQLite statement.
+		sqlite3_stmt* m_Statement;
+	};
+
+	// Prepared statement cache statistics.
+	struct StatementStatistics {
+		// Number of statements prepared.
+		uint64_t Prepares = 0;
+
+		// Number of cached statements reused.
+		uint64_t Reuses = 0;
+	};
+
+	// Returns the prepared statement cache statistics.
+	StatementStatistics GetStatementStatistics() const;
+
+	// Returns a text report of the prepared statement cache statistics.
+	std::wstring GetStatementReport() const;
+
 private:
+	// Takes a statement for 'query' from the statement cache, or prepares a statement if there is no cached statement.
+	// Returns the statement, or nullptr if the query could not be prepared.
+	sqlite3_stmt* AcquireStatement( const std::string& query );
+
+	// Resets a 'statement' for 'query' and returns it to the statement cache.
+	void ReleaseStatement( const std::string& query, sqlite3_stmt* statement );
+
+	// Finalises all cached statements.
+	void ClearStatements();
+
 	// Appends an 'errorCode' & 'message' entry to the error log.
 	void AppendToErrorLog( const int errorCode, const std::string& message );
 
@@ -49,5 +105,17 @@ private:
 
 	// Error log, pairing a SQLite error code with the error description.
 	std::list<std::pair<int,std::string>> m_Log;
+
+	// Statement cache mutex.
+	std::mutex m_StatementMutex;
+
+	// Cached statements which are not currently in use, keyed by query (there can be more than one statement per query, if the query is used concurrently).
+	std::multimap<std::string, sqlite3_stmt*> m_Statements;
+
+	// Number of statements prepared.
+	std::atomic<uint64_t> m_StatementPrepares;
+
+	// Number of cached statements reused.
+	std::atomic<uint64_t> m_StatementReuses;
 };
 
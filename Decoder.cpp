@@ -1,5 +1,6 @@
 #include "Decoder.h"
 
+#include "DSPKernels.h"
 #include "Settings.h"
 
 #include "ebur128.h"
@@ -9,6 +10,9 @@
 #include <random>
 #include <string>
 
+// Number of sample frames to read at a time when skipping silence.
+constexpr long s_SilenceBlockSize = 4096;
+
 Decoder::Decoder() :
 	m_Duration( 0 ),
 	m_SampleRate( 0 ),
@@ -116,17 +120,32 @@ std::optional<float> Decoder::CalculateTrackGain( CanContinue canContinue, const
 	return trackGain;
 }
 
-void Decoder::SkipSilence()
+long long Decoder::SkipSilence( const float threshold, std::vector<float>& audible )
 {
+	long long silentFrames = 0;
+	audible.clear();
 	if ( m_Channels > 0 ) {
-		std::vector<float> buffer( m_Channels );
-		bool silence = true;
-		while ( silence && Read( buffer.data(), 1 /*sampleCount*/ ) > 0 ) {
-			for ( auto sample = buffer.begin(); silence && ( sample != buffer.end() ); sample++ ) {
-				silence = ( 0 == *sample );
+		std::vector<float> buffer( s_SilenceBlockSize * m_Channels );
+		long framesRead = Read( buffer.data(), s_SilenceBlockSize );
+		while ( framesRead > 0 ) {
+			const size_t blockSamples = static_cast<size_t>( framesRead ) * m_Channels;
+			if ( const size_t firstAudible = DSPKernels::FindFirstAbove( buffer.data(), blockSamples, threshold ); firstAudible < blockSamples ) {
+				// Hold on to the remainder of the block, starting from the first non-silent sample frame.
+				const size_t firstFrame = firstAudible / m_Channels;
+				silentFrames += firstFrame;
+				audible.assign( buffer.begin() + firstFrame * m_Channels, buffer.begin() + blockSamples );
+				break;
 			}
+			silentFrames += framesRead;
+			framesRead = Read( buffer.data(), s_SilenceBlockSize );
 		}
 	}
+	return silentFrames;
+}
+
+bool Decoder::SupportsSampleAccurateSeek() const
+{
+	return false;
 }
 
 bool Decoder::SupportsStreamTitles() const
@@ -138,3 +157,17 @@ std::pair<float /*seconds*/, std::wstring /*title*/> Decoder::GetStreamTitle()
 {
 	return {};
 }
+
+bool Decoder::SupportsSeekIndex() const
+{
+	return false;
+}
+
+SeekIndex::Ptr Decoder::GetSeekIndex() const
+{
+	return nullptr;
+}
+
+void Decoder::SetSeekIndex( SeekIndex::Ptr /*index*/ )
+{
+}
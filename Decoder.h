@@ -1,9 +1,12 @@
 #pragma once
 
+#include "SeekIndex.h"
+
 #include <functional>
 #include <memory>
 #include <optional>
 #include <stdexcept>
+#include <vector>
 
 // Decoder interface.
 class Decoder
@@ -49,8 +52,14 @@ public:
 	// 'secondslimit' - number of seconds to devote to calculating an estimate, or 0 to perform a complete calculation.
 	virtual std::optional<float> CalculateTrackGain( CanContinue canContinue, const float secondsLimit = 0 );
 
-	// Skips any leading silence.
-	void SkipSilence();
+	// Skips any leading silence, scanning the sample data a block at a time.
+	// 'threshold' - linear sample value at or below which a sample is considered silent.
+	// 'audible' - out, sample data from the first non-silent sample frame onwards, which has been read from the decoder and should be output before any further reads.
+	// Returns the number of silent sample frames which were skipped.
+	long long SkipSilence( const float threshold, std::vector<float>& audible );
+
+	// Returns whether the decoder seeks to the exact sample position requested (otherwise, a seek might land on a nearby frame or block boundary).
+	virtual bool SupportsSampleAccurateSeek() const;
 
 	// Returns whether stream titles are supported.
 	virtual bool SupportsStreamTitles() const;
@@ -58,6 +67,15 @@ public:
 	// Returns the current stream title, and the position (in seconds) at which the title last changed.
 	virtual std::pair<float /*seconds*/, std::wstring /*title*/> GetStreamTitle();
 
+	// Returns whether the decoder can use a seek index.
+	virtual bool SupportsSeekIndex() const;
+
+	// Returns a seek index built by decoding the whole stream from the start, or nullptr if the decoder has not built a complete index.
+	virtual SeekIndex::Ptr GetSeekIndex() const;
+
+	// Sets a previously built seek 'index' for the decoder to use when seeking.
+	virtual void SetSeekIndex( SeekIndex::Ptr index );
+
 protected:
 	// Sets the 'duration'.
 	void SetDuration( const float duration );
@@ -158,8 +158,7 @@ DecoderBass::DecoderBass( const std::wstring& filename ) :
 			BASS_ChannelSetSync( m_Handle, BASS_SYNC_META, 0 /*param*/, MetadataSyncProc, this );
 		}
 	} else {
-		const auto fileExt = GetFileExtension( filename );
-		if ( sMusicFileExtensions.end() != std::find( sMusicFileExtensions.begin(), sMusicFileExtensions.end(), fileExt ) ) {
+		if ( IsMusicFile( filename ) ) {
 			LoadMusic( filename );
 		} else {
 			// Try loading a stream.
@@ -308,6 +307,12 @@ std::pair<float /*seconds*/, std::wstring /*title*/> DecoderBass::GetStreamTitle
 	return m_StreamTitle;	
 }
 
+bool DecoderBass::IsMusicFile( const std::wstring& filename )
+{
+	const auto fileExt = GetFileExtension( filename );
+	return ( sMusicFileExtensions.end() != std::find( sMusicFileExtensions.begin(), sMusicFileExtensions.end(), fileExt ) );
+}
+
 void CALLBACK DecoderBass::MetadataSyncProc( HSYNC /*handle*/, DWORD channel, DWORD /*data*/, void *user )
 {
 	if ( DecoderBass* decoder = static_cast<DecoderBass*>( user ); nullptr != decoder ) {
@@ -38,6 +38,9 @@ public:
 	// Returns the current stream title, and the position (in seconds) at which the title last changed.
 	std::pair<float /*seconds*/, std::wstring /*title*/> GetStreamTitle() override;
 
+	// Returns whether 'filename' has a music file extension (music files are loaded as music, rather than as streams).
+	static bool IsMusicFile( const std::wstring& filename );
+
 private:
 	// URL stream metadata callback.
 	static void CALLBACK MetadataSyncProc( HSYNC handle, DWORD channel, DWORD data, void *user );
@@ -0,0 +1,275 @@
+#include "DecoderBenchmark.h"
+
+#include "AllocationCounter.h"
+#include "BenchmarkFile.h"
+#include "InputFile.h"
+#include "TrackAnalyser.h"
+#include "Utility.h"
+
+#include <Psapi.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <typeinfo>
+#include <vector>
+
+// The number of sample frames to read at a time.
+constexpr long s_BlockSize = 4096;
+
+// The number of random seeks to make for each file.
+constexpr int s_SeekCount = 32;
+
+// Random seek position generator seed (fixed, so that each run seeks to the same positions).
+constexpr unsigned int s_SeekSeed = 0x1974;
+
+// Sample rate of the generated reference files.
+constexpr long s_ReferenceSampleRate = 44100;
+
+// Number of channels in the generated reference files.
+constexpr long s_ReferenceChannels = 2;
+
+// Duration of the generated reference files, in seconds.
+constexpr long s_ReferenceSeconds = 60;
+
+// Returns the number of milliseconds elapsed since 'start'.
+static double GetElapsedMilliseconds( const std::chrono::steady_clock::time_point& start )
+{
+	return std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - start ).count();
+}
+
+DecoderBenchmark::DecoderBenchmark( const Handlers& handlers, const float silenceThreshold ) :
+	m_Handlers( handlers ),
+	m_SilenceThreshold( powf( 10.0f, silenceThreshold / 20.0f ) )
+{
+}
+
+DecoderBenchmark::~DecoderBenchmark()
+{
+}
+
+DecoderBenchmark::Result DecoderBenchmark::Run( const std::wstring& filename ) const
+{
+	Result result;
+	result.Filename = filename;
+	result.Mapped = InputFile::IsMappingEnabled();
+
+	// Time to first sample, including the decoder open.
+	const long long initialWorkingSet = GetWorkingSet();
+	std::vector<float> buffer;
+	auto start = std::chrono::steady_clock::now();
+	Decoder::Ptr decoder = m_Handlers.OpenDecoder( filename );
+	if ( decoder && ( decoder->GetChannels() > 0 ) && ( decoder->GetSampleRate() > 0 ) ) {
+		buffer.resize( static_cast<size_t>( s_BlockSize ) * decoder->GetChannels() );
+		decoder->Read( buffer.data(), s_BlockSize );
+		result.FirstSampleMilliseconds = GetElapsedMilliseconds( start );
+
+		std::string decoderType = typeid( *decoder ).name();
+		if ( const size_t pos = decoderType.find( ' ' ); std::string::npos != pos ) {
+			// Remove the 'class ' prefix.
+			decoderType = decoderType.substr( 1 + pos );
+		}
+		result.DecoderType = UTF8ToWideString( decoderType );
+		result.SampleRate = decoder->GetSampleRate();
+		result.Channels = decoder->GetChannels();
+	} else {
+		decoder.reset();
+	}
+
+	if ( decoder ) {
+		// Sequential decode throughput (from the start of the stream).
+		long long allocations = 0;
+		long long steadyStateAllocations = 0;
+		decoder->Seek( 0 );
+		start = std::chrono::steady_clock::now();
+		result.SampleFrames = ReadStream( *decoder, allocations, steadyStateAllocations );
+		double seconds = GetElapsedMilliseconds( start ) / 1000;
+		if ( seconds > 0 ) {
+			result.SampleFramesPerSecond = result.SampleFrames / seconds;
+			if ( AllocationCounter::IsAvailable() ) {
+				result.AllocationsPerSecond = allocations / seconds;
+			}
+		}
+		if ( AllocationCounter::IsAvailable() ) {
+			result.SteadyStateAllocations = steadyStateAllocations;
+		}
+
+		// Random seek latency.
+		const float duration = decoder->GetDuration();
+		if ( duration > 0 ) {
+			std::mt19937 generator( s_SeekSeed );
+			std::uniform_real_distribution<float> distribution( 0, duration );
+			double totalMilliseconds = 0;
+			for ( int seek = 0; seek < s_SeekCount; seek++ ) {
+				const float position = distribution( generator );
+				start = std::chrono::steady_clock::now();
+				decoder->Seek( position );
+				decoder->Read( buffer.data(), s_BlockSize );
+				const double milliseconds = GetElapsedMilliseconds( start );
+				totalMilliseconds += milliseconds;
+				result.SeekMaxMilliseconds = std::max( result.SeekMaxMilliseconds, milliseconds );
+			}
+			result.SeekMeanMilliseconds = totalMilliseconds / s_SeekCount;
+		}
+		result.WorkingSetGrowth = GetWorkingSet() - initialWorkingSet;
+		decoder.reset();
+
+		// Batch decode throughput (which is the same as the sequential throughput for decoders without batch support).
+		const long threadCount = std::max( 1l, static_cast<long>( std::thread::hardware_concurrency() ) );
+		if ( Decoder::Ptr batchDecoder = m_Handlers.OpenDecoder( filename, threadCount ); batchDecoder ) {
+			start = std::chrono::steady_clock::now();
+			const long long sampleFrames = ReadStream( *batchDecoder, allocations, steadyStateAllocations );
+			seconds = GetElapsedMilliseconds( start ) / 1000;
+			if ( seconds > 0 ) {
+				result.BatchSampleFramesPerSecond = sampleFrames / seconds;
+			}
+			result.WorkingSetGrowth = std::max( result.WorkingSetGrowth, GetWorkingSet() - initialWorkingSet );
+		}
+	}
+	return result;
+}
+
+bool DecoderBenchmark::Run( const std::list<std::wstring>& filenames, const std::wstring& outputFilename ) const
+{
+	std::ofstream stream( outputFilename, std::ios::binary | std::ios::trunc );
+	bool success = stream.good();
+	if ( success ) {
+		stream << "Filename\tDecoder\tInput\tSampleRate\tChannels\tSampleFrames\tFirstSampleMs\tSampleFramesPerSecond\tBatchSampleFramesPerSecond\tSeekMeanMs\tSeekMaxMs\tAllocationsPerSecond\tSteadyStateAllocations\tWorkingSetGrowth\r\n";
+		for ( const auto& filename : filenames ) {
+			for ( const bool mapped : { true, false } ) {
+				InputFile::SetMappingEnabled( mapped );
+				const Result result = Run( filename );
+				success = success && !result.DecoderType.empty();
+
+				// Fail the benchmark if the decoder allocated in the steady state (decoders should not allocate on the output thread once they have been primed).
+				success = success && ( 0 == result.SteadyStateAllocations.value_or( 0 ) );
+
+				std::stringstream row;
+				row << std::fixed << std::setprecision( 3 );
+				row << WideStringToUTF8( result.Filename ) << '\t' << WideStringToUTF8( result.DecoderType ) << '\t' << ( result.Mapped ? "Mapped" : "Buffered" ) << '\t' << result.SampleRate << '\t' << result.Channels << '\t' << result.SampleFrames << '\t' <<
+					result.FirstSampleMilliseconds << '\t' << result.SampleFramesPerSecond << '\t' << result.BatchSampleFramesPerSecond << '\t' <<
+					result.SeekMeanMilliseconds << '\t' << result.SeekMaxMilliseconds << '\t';
+				if ( result.AllocationsPerSecond.has_value() ) {
+					row << result.AllocationsPerSecond.value();
+				}
+				row << '\t';
+				if ( result.SteadyStateAllocations.has_value() ) {
+					row << result.SteadyStateAllocations.value();
+				}
+				row << '\t' << result.WorkingSetGrowth << "\r\n";
+				stream << row.str();
+			}
+			InputFile::SetMappingEnabled( true );
+		}
+
+		stream << "\r\nAnalysis\tThreads\tFiles\tMilliseconds\tFilesPerSecond\r\n";
+		const long threadCount = std::max( 1l, static_cast<long>( std::thread::hardware_concurrency() ) );
+		for ( const long threads : { 1l, threadCount } ) {
+			const AnalysisResult result = RunAnalysis( filenames, threads );
+			success = success && ( static_cast<long>( filenames.size() ) == result.Files );
+
+			std::stringstream row;
+			row << std::fixed << std::setprecision( 3 );
+			row << "Batch\t" << result.Threads << '\t' << result.Files << '\t' << result.Milliseconds << '\t' <<
+				( ( result.Milliseconds > 0 ) ? ( 1000 * result.Files / result.Milliseconds ) : 0.0 ) << "\r\n";
+			stream << row.str();
+		}
+		success = success && stream.good();
+	}
+	return success;
+}
+
+DecoderBenchmark::AnalysisResult DecoderBenchmark::RunAnalysis( const std::list<std::wstring>& filenames, const long threads ) const
+{
+	AnalysisResult result;
+	result.Threads = threads;
+
+	const std::vector<std::wstring> pending( filenames.begin(), filenames.end() );
+	std::atomic<size_t> nextFile = 0;
+	std::atomic<long> filesAnalysed = 0;
+	auto worker = [ this, &pending, &nextFile, &filesAnalysed ] ()
+	{
+		for ( size_t file = nextFile++; file < pending.size(); file = nextFile++ ) {
+			if ( TrackAnalyser::Analyse( pending[ file ], m_Handlers, m_SilenceThreshold, [] () { return true; } ).has_value() ) {
+				++filesAnalysed;
+			}
+		}
+	};
+
+	const auto start = std::chrono::steady_clock::now();
+	std::list<std::thread> workers;
+	for ( long thread = 1; thread < threads; thread++ ) {
+		workers.push_back( std::thread( worker ) );
+	}
+	worker();
+	for ( auto& thread : workers ) {
+		thread.join();
+	}
+	result.Milliseconds = GetElapsedMilliseconds( start );
+	result.Files = filesAnalysed;
+	return result;
+}
+
+bool DecoderBenchmark::RunReference( const std::wstring& outputFilename ) const
+{
+	const std::filesystem::path folder = GetReferenceFolder();
+	std::error_code error;
+	bool success = !folder.empty() && ( std::filesystem::create_directories( folder, error ) || std::filesystem::is_directory( folder, error ) );
+	std::list<std::wstring> filenames;
+	if ( success ) {
+		for ( const auto format : BenchmarkFile::GetFormats() ) {
+			const std::wstring formatName = BenchmarkFile::GetFormatName( format );
+			const Tags tags = { { Tag::Artist, "VUPlayer" }, { Tag::Title, WideStringToUTF8( formatName ) } };
+			const std::wstring filename = BenchmarkFile::Write( folder / ( L"Reference " + formatName ), format, s_ReferenceSampleRate, s_ReferenceChannels, s_ReferenceSampleRate * s_ReferenceSeconds, tags );
+			if ( filename.empty() ) {
+				success = false;
+			} else {
+				filenames.push_back( filename );
+			}
+		}
+	}
+	success = Run( filenames, outputFilename ) && success;
+	return success;
+}
+
+long long DecoderBenchmark::ReadStream( Decoder& decoder, long long& allocations, long long& steadyStateAllocations ) const
+{
+	std::vector<float> buffer( static_cast<size_t>( s_BlockSize ) * decoder.GetChannels() );
+	const AllocationCounter::Scope scope;
+
+	// The first read is allowed to allocate (e.g. to size decoder scratch buffers), as it is on the output path.
+	long samplesRead = decoder.Read( buffer.data(), s_BlockSize );
+	long long sampleFrames = samplesRead;
+	const long long firstReadAllocations = scope.GetCount();
+
+	while ( samplesRead > 0 ) {
+		samplesRead = decoder.Read( buffer.data(), s_BlockSize );
+		sampleFrames += samplesRead;
+	}
+	allocations = scope.GetCount();
+	steadyStateAllocations = allocations - firstReadAllocations;
+	return sampleFrames;
+}
+
+std::filesystem::path DecoderBenchmark::GetReferenceFolder()
+{
+	std::filesystem::path folder;
+	WCHAR pathName[ MAX_PATH ];
+	if ( 0 != GetTempPath( MAX_PATH, pathName ) ) {
+		folder = std::filesystem::path( pathName ) / L"VUPlayerDecoderBenchmark";
+	}
+	return folder;
+}
+
+long long DecoderBenchmark::GetWorkingSet()
+{
+	PROCESS_MEMORY_COUNTERS memProcess = {};
+	memProcess.cb = sizeof( PROCESS_MEMORY_COUNTERS );
+	return GetProcessMemoryInfo( GetCurrentProcess(), &memProcess, memProcess.cb ) ? static_cast<long long>( memProcess.WorkingSetSize ) : 0;
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "Handlers.h"
+
+#include <filesystem>
+#include <list>
+#include <optional>
+#include <string>
+
+// Measures decoder performance for a set of files, without creating the main window.
+// Results are written as tab separated values (one header row, then a row per file for mapped & buffered input), so that they can be compared between builds.
+class DecoderBenchmark
+{
+public:
+	// 'handlers' - audio format handlers.
+	// 'silenceThreshold' - silence threshold used by the track analysis, in dBFS.
+	DecoderBenchmark( const Handlers& handlers, const float silenceThreshold );
+
+	virtual ~DecoderBenchmark();
+
+	// Benchmark results for a file.
+	struct Result {
+		// File name.
+		std::wstring Filename;
+
+		// Decoder type (empty if the file could not be opened).
+		std::wstring DecoderType;
+
+		// Whether input files could be memory mapped (otherwise the decoders used buffered reads).
+		bool Mapped = true;
+
+		// Sample rate.
+		long SampleRate = 0;
+
+		// Number of channels.
+		long Channels = 0;
+
+		// Number of sample frames decoded.
+		long long SampleFrames = 0;
+
+		// Time taken to open the decoder and read the first block, in milliseconds.
+		double FirstSampleMilliseconds = 0;
+
+		// Decode throughput, in sample frames per second.
+		double SampleFramesPerSecond = 0;
+
+		// Decode throughput using a batch decoder (with a thread per processor), in sample frames per second.
+		double BatchSampleFramesPerSecond = 0;
+
+		// Mean time taken to seek to a random position and read the first block, in milliseconds.
+		double SeekMeanMilliseconds = 0;
+
+		// Maximum time taken to seek to a random position and read the first block, in milliseconds.
+		double SeekMaxMilliseconds = 0;
+
+		// Number of heap allocations made per second of decoding, or nullopt if allocations are not counted in this build.
+		std::optional<double> AllocationsPerSecond;
+
+		// Number of heap allocations made by sequential reads after the first read, or nullopt if allocations are not counted in this build.
+		// Decoders are expected not to allocate once the first read has sized their buffers, so this should be zero.
+		std::optional<long long> SteadyStateAllocations;
+
+		// Largest increase in the working set of the process while the file was being decoded, relative to the working set before the file was opened, in bytes.
+		// The working set is sampled at the end of each decode pass, while the decoder is still open.
+		long long WorkingSetGrowth = 0;
+	};
+
+	// Track analysis benchmark results, for a batch of files.
+	struct AnalysisResult {
+		// Number of threads analysing the files.
+		long Threads = 0;
+
+		// Number of files analysed.
+		long Files = 0;
+
+		// Time taken to analyse the files, in milliseconds.
+		double Milliseconds = 0;
+	};
+
+	// Benchmarks a file, with input files memory mapped or not according to InputFile::IsMappingEnabled.
+	// Returns the benchmark results (with an empty decoder type if the file could not be opened).
+	Result Run( const std::wstring& filename ) const;
+
+	// Benchmarks analysing 'filenames' as a batch, as the loudness precalculation does, using a number of worker 'threads' which each take the next file to analyse.
+	// Returns the benchmark results.
+	AnalysisResult RunAnalysis( const std::list<std::wstring>& filenames, const long threads ) const;
+
+	// Benchmarks 'filenames', writing the results to 'outputFilename'.
+	// Each file is benchmarked twice, with input files memory mapped and with buffered reads (decoders which do not read through an InputFile give the same results for both).
+	// The results for each file are followed by a blank row, then the results of analysing the files as a batch (with one thread, and with a thread per processor).
+	// Returns true if all the files were opened & analysed, no decoder allocated after its first read (in builds which count allocations), and the results were written.
+	bool Run( const std::list<std::wstring>& filenames, const std::wstring& outputFilename ) const;
+
+	// Benchmarks a generated reference file for each reference format (see BenchmarkFile), writing the results to 'outputFilename'.
+	// The reference files are left in the temporary folder, so that the same files can be benchmarked by another build (by passing them on the command line).
+	// Returns true if all the reference files were written & opened, and the results were written.
+	bool RunReference( const std::wstring& outputFilename ) const;
+
+private:
+	// Reads the whole stream from 'decoder'.
+	// 'allocations' - out, number of heap allocations made while reading.
+	// 'steadyStateAllocations' - out, number of heap allocations made after the first read.
+	// Returns the number of sample frames read.
+	long long ReadStream( Decoder& decoder, long long& allocations, long long& steadyStateAllocations ) const;
+
+	// Returns the folder to which the reference files are written.
+	static std::filesystem::path GetReferenceFolder();
+
+	// Returns the current working set of the process, in bytes.
+	static long long GetWorkingSet();
+
+	// Audio format handlers.
+	const Handlers& m_Handlers;
+
+	// Silence threshold used by the track analysis, as a linear sample value.
+	const float m_SilenceThreshold;
+};
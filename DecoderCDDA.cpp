@@ -1,7 +1,10 @@
 #include "DecoderCDDA.h"
 
+#include "SampleConversion.h"
 #include "Utility.h"
 
+#include <algorithm>
+
 DecoderCDDA::DecoderCDDA( const CDDAMedia& cddaMedia, const long track ) :
 	Decoder(),
 	m_CDDAMedia( cddaMedia ),
@@ -30,12 +33,12 @@ DecoderCDDA::~DecoderCDDA()
 long DecoderCDDA::Read( float* buffer, const long sampleCount )
 {
 	long samplesRead = 0;
-	long outputBufPos = 0;
 	while ( samplesRead < sampleCount ) {
-		if ( m_CurrentBufPos < m_Buffer.size() ) {
-			buffer[ outputBufPos++ ] = Signed16ToFloat( m_Buffer[ m_CurrentBufPos++ ] );
-			buffer[ outputBufPos++ ] = Signed16ToFloat( m_Buffer[ m_CurrentBufPos++ ] );
-			++samplesRead;
+		if ( ( m_CurrentBufPos + 1 ) < m_Buffer.size() ) {
+			const long frames = std::min( sampleCount - samplesRead, static_cast<long>( ( m_Buffer.size() - m_CurrentBufPos ) / 2 ) );
+			SampleConversion::ToFloat( reinterpret_cast<const int16_t*>( m_Buffer.data() + m_CurrentBufPos ), buffer + samplesRead * 2, frames * 2 );
+			m_CurrentBufPos += frames * 2;
+			samplesRead += frames;
 		} else {
 			if ( ( m_CurrentSector < m_SectorEnd ) && ( m_CDDAMedia.Read( m_Handle, m_CurrentSector++, true /*useCache*/, m_Buffer ) ) ) {
 				m_CurrentBufPos = 0;
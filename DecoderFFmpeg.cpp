@@ -1,7 +1,10 @@
 #include "DecoderFFmpeg.h"
 
+#include "SampleConversion.h"
 #include "Utility.h"
 
+#include <algorithm>
+
 extern "C"
 {
 #include <libavcodec/avcodec.h>
@@ -83,150 +86,137 @@ DecoderFFmpeg::~DecoderFFmpeg()
 	avformat_close_input( &m_FormatContext );
 }
 
-void DecoderFFmpeg::ConvertSampleData( const AVFrame* frame, std::vector<float>& buffer )
+void DecoderFFmpeg::ConvertSampleData( const AVFrame* frame, const int offset, const int frames, float* output )
 {
 	if ( nullptr != frame ) {
+		const long channels = frame->channels;
+		const size_t packedOffset = static_cast<size_t>( offset ) * channels;
+		const size_t packedCount = static_cast<size_t>( frames ) * channels;
 		switch ( frame->format ) {
 			// Non-planar sample formats
 			case AV_SAMPLE_FMT_U8 : {
-				uint8_t* data = frame->data[ 0 ];
-				for ( int pos = 0; pos < frame->channels * frame->nb_samples; pos++ ) {
-					buffer.push_back( Unsigned8ToFloat( data[ pos ] ) );
-				}
+				SampleConversion::ToFloat( frame->data[ 0 ] + packedOffset, output, packedCount );
 				break;
 			}
 			case AV_SAMPLE_FMT_S16 : {
-				int16_t* data = reinterpret_cast<int16_t*>( frame->data[ 0 ] );
-				for ( int pos = 0; pos < frame->channels * frame->nb_samples; pos++ ) {
-					buffer.push_back( Signed16ToFloat( data[ pos ] ) );
-				}
+				SampleConversion::ToFloat( reinterpret_cast<const int16_t*>( frame->data[ 0 ] ) + packedOffset, output, packedCount );
 				break;
 			}
 			case AV_SAMPLE_FMT_S32 : {
-				int32_t* data = reinterpret_cast<int32_t*>( frame->data[ 0 ] );
-				for ( int pos = 0; pos < frame->channels * frame->nb_samples; pos++ ) {
-					buffer.push_back( Signed32ToFloat( data[ pos ] ) );
-				}
+				SampleConversion::ToFloat( reinterpret_cast<const int32_t*>( frame->data[ 0 ] ) + packedOffset, output, packedCount );
 				break;
 			}
 			case AV_SAMPLE_FMT_S64 : {
-				int64_t* data = reinterpret_cast<int64_t*>( frame->data[ 0 ] );
-				for ( int pos = 0; pos < frame->channels * frame->nb_samples; pos++ ) {
-					buffer.push_back( Signed64ToFloat( data[ pos ] ) );
-				}
+				SampleConversion::ToFloat( reinterpret_cast<const int64_t*>( frame->data[ 0 ] ) + packedOffset, output, packedCount );
 				break;
 			}
 			case AV_SAMPLE_FMT_FLT : {
-				float* data = reinterpret_cast<float*>( frame->data[ 0 ] );
-				for ( int pos = 0; pos < frame->channels * frame->nb_samples; pos++ ) {
-					buffer.push_back( data[ pos ] );
-				}
+				SampleConversion::ToFloat( reinterpret_cast<const float*>( frame->data[ 0 ] ) + packedOffset, output, packedCount );
 				break;
 			}
 			case AV_SAMPLE_FMT_DBL : {
-				double* data = reinterpret_cast<double*>( frame->data[ 0 ] );
-				for ( int pos = 0; pos < frame->channels * frame->nb_samples; pos++ ) {
-					buffer.push_back( static_cast<float>( data[ pos ] ) );
-				}
+				SampleConversion::ToFloat( reinterpret_cast<const double*>( frame->data[ 0 ] ) + packedOffset, output, packedCount );
 				break;
 			}
 
-			// Planar sample formats
+			// Planar sample formats (using the extended data pointers, which also cover frames with more channels than there are data pointers)
 			case AV_SAMPLE_FMT_U8P : {
-				for ( int samplePos = 0; samplePos < frame->nb_samples; samplePos++ ) {
-					for ( int channel = 0; channel < frame->channels; channel++ ) {
-						uint8_t* data = frame->data[ channel ];
-						buffer.push_back( Unsigned8ToFloat( data[ samplePos ] ) );
-					}					
-				}
+				SampleConversion::InterleaveToFloat( frame->extended_data, offset, output, frames, channels );
 				break;
 			}
 			case AV_SAMPLE_FMT_S16P : {
-				for ( int samplePos = 0; samplePos < frame->nb_samples; samplePos++ ) {
-					for ( int channel = 0; channel < frame->channels; channel++ ) {
-						int16_t* data = reinterpret_cast<int16_t*>( frame->data[ channel ] );
-						buffer.push_back( Signed16ToFloat( data[ samplePos ] ) );
-					}					
-				}
+				SampleConversion::InterleaveToFloat( reinterpret_cast<const int16_t* const*>( frame->extended_data ), offset, output, frames, channels );
 				break;
 			}
 			case AV_SAMPLE_FMT_S32P : {
-				for ( int samplePos = 0; samplePos < frame->nb_samples; samplePos++ ) {
-					for ( int channel = 0; channel < frame->channels; channel++ ) {
-						int32_t* data = reinterpret_cast<int32_t*>( frame->data[ channel ] );
-						buffer.push_back( Signed32ToFloat( data[ samplePos ] ) );
-					}					
-				}
+				SampleConversion::InterleaveToFloat( reinterpret_cast<const int32_t* const*>( frame->extended_data ), offset, output, frames, channels );
 				break;
 			}
 			case AV_SAMPLE_FMT_S64P : {
-				for ( int samplePos = 0; samplePos < frame->nb_samples; samplePos++ ) {
-					for ( int channel = 0; channel < frame->channels; channel++ ) {
-						int64_t* data = reinterpret_cast<int64_t*>( frame->data[ channel ] );
-						buffer.push_back( Signed64ToFloat( data[ samplePos ] ) );
-					}					
-				}
+				SampleConversion::InterleaveToFloat( reinterpret_cast<const int64_t* const*>( frame->extended_data ), offset, output, frames, channels );
 				break;
 			}
 			case AV_SAMPLE_FMT_FLTP : {
-				for ( int samplePos = 0; samplePos < frame->nb_samples; samplePos++ ) {
-					for ( int channel = 0; channel < frame->channels; channel++ ) {
-						float* data = reinterpret_cast<float*>( frame->data[ channel ] );
-						buffer.push_back( data[ samplePos ] );
-					}					
-				}
+				SampleConversion::InterleaveToFloat( reinterpret_cast<const float* const*>( frame->extended_data ), offset, output, frames, channels );
 				break;
 			}
 			case AV_SAMPLE_FMT_DBLP : {
-				for ( int samplePos = 0; samplePos < frame->nb_samples; samplePos++ ) {
-					for ( int channel = 0; channel < frame->channels; channel++ ) {
-						double* data = reinterpret_cast<double*>( frame->data[ channel ] );
-						buffer.push_back( static_cast<float>( data[ samplePos ] ) );
-					}					
-				}
+				SampleConversion::InterleaveToFloat( reinterpret_cast<const double* const*>( frame->extended_data ), offset, output, frames, channels );
+				break;
+			}
+			default : {
+				std::fill( output, output + packedCount, 0.0f );
 				break;
 			}
 		}
 	}
 }
 
+void DecoderFFmpeg::RemixSampleData( const AVFrame* frame, const int offset, const int frames, float* output )
+{
+	const long channels = GetChannels();
+	const long frameChannels = ( nullptr != frame ) ? frame->channels : 0;
+	const long remixChannels = std::min( channels, frameChannels );
+	m_RemixBuffer.resize( static_cast<size_t>( frames ) * frameChannels );
+	ConvertSampleData( frame, offset, frames, m_RemixBuffer.data() );
+	const float* input = m_RemixBuffer.data();
+	for ( int sampleFrame = 0; sampleFrame < frames; sampleFrame++, input += frameChannels, output += channels ) {
+		std::copy_n( input, remixChannels, output );
+		std::fill( output + remixChannels, output + channels, 0.0f );
+	}
+}
+
 bool DecoderFFmpeg::Decode()
 {
-	m_Buffer.clear();
-	m_BufferPosition = 0;
-	while ( ( nullptr != m_Packet ) && m_Buffer.empty() ) {
-		if ( av_read_frame( m_FormatContext, m_Packet ) < 0 ) {
-			// Flush the decoder.
-			av_packet_free( &m_Packet );
-			m_Packet = nullptr;
-		}
-		if ( ( nullptr == m_Packet ) || ( m_StreamIndex == m_Packet->stream_index ) ) {
-			int result = avcodec_send_packet( m_DecoderContext, m_Packet );
-			while ( result >= 0 ) {
-				result = avcodec_receive_frame( m_DecoderContext, m_Frame );
-				if ( result >= 0 ) {
-					ConvertSampleData( m_Frame, m_Buffer );
-					av_frame_unref( m_Frame );
+	av_frame_unref( m_Frame );
+	m_FramePosition = 0;
+	while ( true ) {
+		const int result = avcodec_receive_frame( m_DecoderContext, m_Frame );
+		if ( result >= 0 ) {
+			if ( m_Frame->nb_samples > 0 ) {
+				return true;
+			}
+			av_frame_unref( m_Frame );
+		} else if ( ( AVERROR( EAGAIN ) != result ) || ( nullptr == m_Packet ) ) {
+			// The decoder has been flushed (or has failed).
+			return false;
+		} else {
+			// The decoder needs more data, so send it the next packet from the stream (or flush the decoder at the end of the stream).
+			bool sent = false;
+			while ( !sent ) {
+				if ( av_read_frame( m_FormatContext, m_Packet ) < 0 ) {
+					av_packet_free( &m_Packet );
+					m_Packet = nullptr;
+				}
+				if ( ( nullptr == m_Packet ) || ( m_StreamIndex == m_Packet->stream_index ) ) {
+					avcodec_send_packet( m_DecoderContext, m_Packet );
+					sent = true;
+				}
+				if ( nullptr != m_Packet ) {
+					av_packet_unref( m_Packet );
 				}
 			}
 		}
-		if ( nullptr != m_Packet ) {
-			av_packet_unref( m_Packet );
-		}
 	}
-	return !m_Buffer.empty();
 }
 
 long DecoderFFmpeg::Read( float* output, const long sampleCount )
 {
+	// Sample data is converted directly from the current decoded frame into the output buffer, with any remainder of the frame carried over to the next read.
+	const long channels = GetChannels();
 	long samplesRead = 0;
 	while ( samplesRead < sampleCount ) {
-		if ( m_BufferPosition < m_Buffer.size() ) {
-			const long bufferSamples = GetChannels() * std::min<long>( static_cast<long>( m_Buffer.size() - m_BufferPosition ) / GetChannels(), sampleCount - samplesRead );
-			std::copy( m_Buffer.begin() + m_BufferPosition, m_Buffer.begin() + m_BufferPosition + bufferSamples, output );
-			m_BufferPosition += bufferSamples;
-			output += bufferSamples;
-			samplesRead += bufferSamples / GetChannels();
+		if ( m_FramePosition < m_Frame->nb_samples ) {
+			const int frames = std::min( m_Frame->nb_samples - m_FramePosition, static_cast<int>( sampleCount - samplesRead ) );
+			if ( m_Frame->channels == channels ) {
+				ConvertSampleData( m_Frame, m_FramePosition, frames, output );
+			} else {
+				// The channel layout has changed since the stream was opened, so the frame cannot be converted directly into the output buffer (which is sized for the stream channel count).
+				RemixSampleData( m_Frame, m_FramePosition, frames, output );
+			}
+			m_FramePosition += frames;
+			output += static_cast<size_t>( frames ) * channels;
+			samplesRead += frames;
 		} else if ( !Decode() ) {
 			break;
 		}
@@ -236,8 +226,40 @@ long DecoderFFmpeg::Read( float* output, const long sampleCount )
 
 float DecoderFFmpeg::Seek( const float position )
 {
-	m_Buffer.clear();
-	m_BufferPosition = 0;
-	const int64_t ts( position * AV_TIME_BASE );
-	return ( avformat_seek_file( m_FormatContext, -1, INT64_MIN, ts, ts, 0 ) < 0 ) ? 0 : position;
+	float seekPosition = 0;
+	av_frame_unref( m_Frame );
+	m_FramePosition = 0;
+	if ( nullptr == m_Packet ) {
+		// The packet is freed at the end of the stream.
+		m_Packet = av_packet_alloc();
+	}
+	const AVStream* stream = m_FormatContext->streams[ m_StreamIndex ];
+	const int sampleRate = static_cast<int>( GetSampleRate() );
+	const int64_t startTime = ( AV_NOPTS_VALUE != stream->start_time ) ? stream->start_time : 0;
+	const int64_t target = startTime + av_rescale_q( static_cast<int64_t>( position * AV_TIME_BASE ), AVRational{ 1, AV_TIME_BASE }, stream->time_base );
+
+	// Seek to the stream position at or before the target, then decode forward to the frame which contains the target sample.
+	if ( ( nullptr != m_Packet ) && ( sampleRate > 0 ) && ( avformat_seek_file( m_FormatContext, m_StreamIndex, INT64_MIN, target, target, 0 ) >= 0 ) ) {
+		avcodec_flush_buffers( m_DecoderContext );
+		seekPosition = position;
+		const int64_t targetSample = static_cast<int64_t>( position * sampleRate );
+		while ( Decode() ) {
+			if ( AV_NOPTS_VALUE == m_Frame->best_effort_timestamp ) {
+				// The frame position is unknown, so settle for the stream position.
+				break;
+			}
+			const int64_t frameStart = av_rescale_q( m_Frame->best_effort_timestamp - startTime, stream->time_base, AVRational{ 1, sampleRate } );
+			if ( targetSample < ( frameStart + m_Frame->nb_samples ) ) {
+				m_FramePosition = static_cast<int>( std::max<int64_t>( 0, targetSample - frameStart ) );
+				seekPosition = static_cast<float>( frameStart + m_FramePosition ) / sampleRate;
+				break;
+			}
+		}
+	}
+	return seekPosition;
+}
+
+bool DecoderFFmpeg::SupportsSampleAccurateSeek() const
+{
+	return true;
 }
@@ -3,6 +3,7 @@
 #include "Decoder.h"
 
 #include <string>
+#include <vector>
 
 struct AVCodecContext;
 struct AVFormatContext;
@@ -28,12 +29,23 @@ public:
 	// Returns the new position in seconds.
 	float Seek( const float position ) override;
 
+	// Returns whether the decoder seeks to the exact sample position requested.
+	bool SupportsSampleAccurateSeek() const override;
+
 private:
-	// Deccodes the next chunk of data into the sample buffer, returning whether any data was decoded.
+	// Decodes the next frame of sample data, returning whether any data was decoded.
 	bool Decode();
 
-	// Converts data from the 'frame' into the sample 'buffer'.
-	static void ConvertSampleData( const AVFrame* frame, std::vector<float>& buffer ); 
+	// Converts sample data from a decoded 'frame' into an 'output' buffer (floating point format scaled to +/-1.0f).
+	// 'offset' - the first sample frame to convert.
+	// 'frames' - the number of sample frames to convert.
+	static void ConvertSampleData( const AVFrame* frame, const int offset, const int frames, float* output );
+
+	// Converts sample data from a decoded 'frame' which has a different number of channels to the stream into an 'output' buffer (floating point format scaled to +/-1.0f).
+	// Channels beyond the stream channel count are dropped, and any missing channels are silent.
+	// 'offset' - the first sample frame to convert.
+	// 'frames' - the number of sample frames to convert.
+	void RemixSampleData( const AVFrame* frame, const int offset, const int frames, float* output );
 
 	// FFmpeg format context.
 	AVFormatContext* m_FormatContext = nullptr;
@@ -44,15 +56,15 @@ private:
 	// FFmpeg current packet.
 	AVPacket* m_Packet = nullptr;
 
-	// FFmpeg current frame.
+	// FFmpeg current frame (holding any decoded sample data which has not yet been read).
 	AVFrame* m_Frame = nullptr;
 
 	// Index of the 'best' stream.
 	int m_StreamIndex = 0;
 
-	// Interleaved sample buffer.
-	std::vector<float> m_Buffer;
+	// The next sample frame to read from the current frame.
+	int m_FramePosition = 0;
 
-	// Current buffer position.
-	size_t m_BufferPosition = 0;
+	// Sample data converted from a frame whose channel count does not match the stream (e.g. after a mid-stream channel layout change).
+	std::vector<float> m_RemixBuffer;
 };
@@ -1,16 +1,23 @@
 #include "DecoderFlac.h"
 
+#include "SampleConversion.h"
+
+#include <array>
+
 DecoderFlac::DecoderFlac( const std::wstring& filename ) :
 	Decoder(),
 	FLAC::Decoder::Stream(),
-	m_FileStream(),
+	m_InputFile( filename ),
 	m_FLACFrame(),
 	m_FrameBuffer(),
 	m_FramePos( 0 ),
-	m_Valid( false )
+	m_Valid( false ),
+	m_TotalSamples( 0 ),
+	m_SeekIndex(),
+	m_IndexBuilder(),
+	m_IndexComplete( false )
 {
-	m_FileStream.open( filename, std::ios::binary | std::ios::in );
-	if ( m_FileStream.is_open() ) {
+	if ( m_InputFile.IsOpen() ) {
 		if ( init() == FLAC__STREAM_DECODER_INIT_STATUS_OK )	{
 			process_until_end_of_metadata();
 		}
@@ -18,9 +25,14 @@ DecoderFlac::DecoderFlac( const std::wstring& filename ) :
 
 	if ( m_Valid ) {
 		SetBitrate( CalculateBitrate() );
+
+		// Index the stream at one second intervals, starting with the first frame.
+		if ( FLAC__uint64 offset = 0; ( GetSampleRate() > 0 ) && get_decode_position( &offset ) ) {
+			m_IndexBuilder = std::make_shared<SeekIndex>( GetSampleRate() );
+			m_IndexBuilder->Add( 0, offset );
+		}
 	} else {
 		finish();
-		m_FileStream.close();
 		throw std::runtime_error( "DecoderFlac could not load file" );
 	}
 }
@@ -28,7 +40,6 @@ DecoderFlac::DecoderFlac( const std::wstring& filename ) :
 DecoderFlac::~DecoderFlac()
 {
 	finish();
-	m_FileStream.close();
 }
 
 long DecoderFlac::Read( float* buffer, const long sampleCount )
@@ -46,7 +57,9 @@ long DecoderFlac::Read( float* buffer, const long sampleCount )
     } else {
       m_FramePos = 0;
       m_FLACFrame = {};
-      if ( !process_single() || ( 0 == m_FLACFrame.header.blocksize ) ) {
+      const bool decoded = process_single() && ( 0 != m_FLACFrame.header.blocksize );
+      UpdateIndexBuilder( decoded );
+      if ( !decoded ) {
         break;
       }
     }
@@ -57,34 +70,106 @@ long DecoderFlac::Read( float* buffer, const long sampleCount )
 float DecoderFlac::Seek( const float position )
 {
 	float seekPosition = 0;
+	if ( ( GetSampleRate() > 0 ) && SeekToSample( static_cast<uint64_t>( position * GetSampleRate() ) ) ) {
+		seekPosition = static_cast<float>( m_FLACFrame.header.number.sample_number + m_FramePos ) / GetSampleRate();
+	}
+	return seekPosition;
+}
+
+bool DecoderFlac::SupportsSampleAccurateSeek() const
+{
+	return true;
+}
+
+bool DecoderFlac::SeekToSample( const uint64_t sample )
+{
 	m_FramePos = 0;
 	m_FLACFrame = {};
-	if ( ( GetSampleRate() > 0 ) && seek_absolute( static_cast<FLAC__uint64>( position * GetSampleRate() ) ) ) {
-		seekPosition = static_cast<float>( m_FLACFrame.header.number.sample_number ) / GetSampleRate();
-	}	else {
+	m_IndexBuilder.reset();
+	const bool success = SeekFromIndex( sample ) || seek_absolute( sample );
+	if ( !success ) {
 		reset();
-    process_until_end_of_metadata();
+		process_until_end_of_metadata();
+	}
+	return success;
+}
+
+uint64_t DecoderFlac::GetTotalSamples() const
+{
+	return m_TotalSamples;
+}
+
+bool DecoderFlac::SeekFromIndex( const FLAC__uint64 sample )
+{
+	bool success = false;
+	if ( const auto point = m_SeekIndex ? m_SeekIndex->Find( sample ) : std::nullopt; point && flush() && m_InputFile.Seek( static_cast<long long>( point->Offset ) ) ) {
+		// The index point is at the start of a frame, so decode forward to the frame which contains the sample.
+		while ( !success && process_single() && ( 0 != m_FLACFrame.header.blocksize ) ) {
+			const FLAC__uint64 frameStart = m_FLACFrame.header.number.sample_number;
+			if ( frameStart > sample ) {
+				break;
+			} else if ( sample < ( frameStart + m_FLACFrame.header.blocksize ) ) {
+				m_FramePos = static_cast<uint32_t>( sample - frameStart );
+				success = true;
+			} else {
+				m_FLACFrame = {};
+			}
+		}
+		if ( !success ) {
+			m_FramePos = 0;
+			m_FLACFrame = {};
+		}
+	}
+	return success;
+}
+
+void DecoderFlac::UpdateIndexBuilder( const bool decoded )
+{
+	if ( m_IndexBuilder && !m_IndexComplete ) {
+		if ( decoded ) {
+			if ( FLAC__uint64 offset = 0; get_decode_position( &offset ) ) {
+				m_IndexBuilder->Add( m_FLACFrame.header.number.sample_number + m_FLACFrame.header.blocksize, offset );
+			}
+		} else if ( FLAC__STREAM_DECODER_END_OF_STREAM == get_state() ) {
+			m_IndexComplete = true;
+		} else {
+			m_IndexBuilder.reset();
+		}
+	}
+}
+
+bool DecoderFlac::SupportsSeekIndex() const
+{
+	return true;
+}
+
+SeekIndex::Ptr DecoderFlac::GetSeekIndex() const
+{
+	return m_IndexComplete ? m_IndexBuilder : nullptr;
+}
+
+void DecoderFlac::SetSeekIndex( SeekIndex::Ptr index )
+{
+	m_SeekIndex = index;
+	if ( m_SeekIndex ) {
+		// There is no need to build an index which already exists.
+		m_IndexBuilder.reset();
 	}
-	return seekPosition;
 }
 
 std::optional<float> DecoderFlac::CalculateBitrate()
 {
 	std::optional<float> bitrate;
-	if ( const float duration = GetDuration(); ( duration > 0 ) && m_FileStream.good() ) {
-		const auto initial = m_FileStream.tellg();
-
-		m_FileStream.seekg( 0, std::ios_base::end );
-		const long long filesize = m_FileStream.tellg();
-		m_FileStream.seekg( 0, std::ios_base::beg );
-
-		std::vector<char> block( 4 );
-		m_FileStream.read( block.data(), 4 );
-		if ( ( 'f' == block[ 0 ] ) && ( 'L' == block[ 1 ] ) && ( 'a' ==  block[ 2 ] ) && ('C' == block[ 3 ] ) ) {
-			m_FileStream.read( block.data(), 4 );
-			while ( m_FileStream.good() ) {
-				const long long currentPos = m_FileStream.tellg();
-				const unsigned long blockSize = ( static_cast<unsigned char>( block[ 1 ] ) << 16 ) | ( static_cast<unsigned char>( block[ 2 ] ) << 8 ) | static_cast<unsigned char>( block[ 3 ] );
+	if ( const float duration = GetDuration(); duration > 0 ) {
+		const long long initial = m_InputFile.GetPosition();
+		const long long filesize = m_InputFile.GetSize();
+
+		// Walk the metadata block headers to find where the audio stream starts.
+		std::array<unsigned char, 4> block = {};
+		if ( m_InputFile.Seek( 0 ) && ( block.size() == m_InputFile.Read( block.data(), block.size() ) ) && ( 'f' == block[ 0 ] ) && ( 'L' == block[ 1 ] ) && ( 'a' ==  block[ 2 ] ) && ( 'C' == block[ 3 ] ) ) {
+			while ( block.size() == m_InputFile.Read( block.data(), block.size() ) ) {
+				const long long currentPos = m_InputFile.GetPosition();
+				const unsigned long blockSize = ( block[ 1 ] << 16 ) | ( block[ 2 ] << 8 ) | block[ 3 ];
 				if ( ( currentPos + blockSize ) < filesize ) {
 					const bool lastBlock = block[ 0 ] & 0x80;
 					if ( lastBlock ) {
@@ -95,15 +180,13 @@ std::optional<float> DecoderFlac::CalculateBitrate()
 				} else {
 					break;
 				}
-				m_FileStream.seekg( blockSize, std::ios_base::cur );
-				m_FileStream.read( block.data(), 4 );
-			};
+				if ( !m_InputFile.Seek( currentPos + blockSize ) ) {
+					break;
+				}
+			}
 		}
 
-		if ( !m_FileStream.good() ) {
-			m_FileStream.clear();
-		}
-		m_FileStream.seekg( initial );
+		m_InputFile.Seek( initial );
 	}
 	return bitrate;
 }
@@ -111,12 +194,11 @@ std::optional<float> DecoderFlac::CalculateBitrate()
 FLAC__StreamDecoderReadStatus DecoderFlac::read_callback( FLAC__byte buf[], size_t * size )
 {
 	FLAC__StreamDecoderReadStatus status = FLAC__STREAM_DECODER_READ_STATUS_ABORT;
-	if ( m_FileStream.eof() ) {
+	if ( m_InputFile.IsEOF() ) {
 		*size = 0;
 		status = FLAC__STREAM_DECODER_READ_STATUS_END_OF_STREAM;
 	} else {
-		m_FileStream.read( reinterpret_cast<char*>( buf ), *size );
-		*size = static_cast<size_t>( m_FileStream.gcount() );
+		*size = m_InputFile.Read( buf, *size );
 		if ( *size > 0 ) {
 			status = FLAC__STREAM_DECODER_READ_STATUS_CONTINUE;
 		}
@@ -126,37 +208,24 @@ FLAC__StreamDecoderReadStatus DecoderFlac::read_callback( FLAC__byte buf[], size
 
 FLAC__StreamDecoderSeekStatus DecoderFlac::seek_callback( FLAC__uint64 pos )
 {
-	if ( !m_FileStream.good() ) {
-		m_FileStream.clear();
-	}
-	m_FileStream.seekg( pos, std::ios_base::beg );
-	return FLAC__STREAM_DECODER_SEEK_STATUS_OK;
+	return m_InputFile.Seek( static_cast<long long>( pos ) ) ? FLAC__STREAM_DECODER_SEEK_STATUS_OK : FLAC__STREAM_DECODER_SEEK_STATUS_ERROR;
 }
 
 FLAC__StreamDecoderTellStatus DecoderFlac::tell_callback( FLAC__uint64 * pos )
 {
-	if ( !m_FileStream.good() ) {
-		m_FileStream.clear();
-	}
-	*pos = m_FileStream.tellg();
+	*pos = static_cast<FLAC__uint64>( m_InputFile.GetPosition() );
 	return FLAC__STREAM_DECODER_TELL_STATUS_OK;
 }
 
 FLAC__StreamDecoderLengthStatus DecoderFlac::length_callback( FLAC__uint64 * pos )
 {
-	if ( !m_FileStream.good() ) {
-		m_FileStream.clear();
-	}
-	const std::streampos currentPos = m_FileStream.tellg();
-	m_FileStream.seekg( 0, std::ios_base::end );
-	*pos = m_FileStream.tellg();
-	m_FileStream.seekg( currentPos );
+	*pos = static_cast<FLAC__uint64>( m_InputFile.GetSize() );
 	return FLAC__STREAM_DECODER_LENGTH_STATUS_OK;
 }
 
 bool DecoderFlac::eof_callback()
 {
-	const bool eof = m_FileStream.eof();
+	const bool eof = m_InputFile.IsEOF();
 	return eof;
 }
 
@@ -164,12 +233,7 @@ FLAC__StreamDecoderWriteStatus DecoderFlac::write_callback( const FLAC__Frame *
 {
   m_FLACFrame = *frame;
   m_FrameBuffer.resize( m_FLACFrame.header.blocksize * m_FLACFrame.header.channels );
-  uint32_t offset = 0;
-  for ( uint32_t sample = 0; sample < m_FLACFrame.header.blocksize; sample++ ) {
-	  for ( uint32_t channel = 0; channel < m_FLACFrame.header.channels; channel++ ) {
-	  	m_FrameBuffer[ offset++ ] = static_cast<float>( buffer[ channel ][ sample ] ) / ( 1ul << ( m_FLACFrame.header.bits_per_sample - 1ul ) );
-		}
-  }
+  SampleConversion::InterleaveToFloat( buffer, 0, m_FrameBuffer.data(), m_FLACFrame.header.blocksize, static_cast<long>( m_FLACFrame.header.channels ), static_cast<long>( m_FLACFrame.header.bits_per_sample ) );
   return FLAC__STREAM_DECODER_WRITE_STATUS_CONTINUE;
 }
 
@@ -179,6 +243,7 @@ void DecoderFlac::metadata_callback( const FLAC__StreamMetadata * metadata )
 		SetBPS( metadata->data.stream_info.bits_per_sample );
 		SetChannels( metadata->data.stream_info.channels );
 		SetSampleRate( metadata->data.stream_info.sample_rate );
+		m_TotalSamples = metadata->data.stream_info.total_samples;
 		if ( GetSampleRate() > 0 ) {
 			SetDuration( static_cast<float>( metadata->data.stream_info.total_samples ) / GetSampleRate() );
 		}
@@ -1,9 +1,9 @@
 #pragma once
 #include "Decoder.h"
+#include "InputFile.h"
 
 #include "FLAC++\all.h"
 
-#include <fstream>
 #include <vector>
 
 // FLAC decoder
@@ -26,6 +26,25 @@ public:
 	// Returns the new position in seconds.
 	float Seek( const float position ) override;
 
+	// Returns whether the decoder seeks to the exact sample position requested.
+	bool SupportsSampleAccurateSeek() const override;
+
+	// Seeks to an exact 'sample' position in the stream.
+	// Returns whether the seek was successful.
+	bool SeekToSample( const uint64_t sample );
+
+	// Returns the total number of sample frames in the stream, or zero if the total is unknown.
+	uint64_t GetTotalSamples() const;
+
+	// Returns whether the decoder can use a seek index.
+	bool SupportsSeekIndex() const override;
+
+	// Returns a seek index built by decoding the whole stream from the start, or nullptr if the decoder has not built a complete index.
+	SeekIndex::Ptr GetSeekIndex() const override;
+
+	// Sets a previously built seek 'index' for the decoder to use when seeking.
+	void SetSeekIndex( SeekIndex::Ptr index ) override;
+
 protected:
 	// FLAC callbacks
 	FLAC__StreamDecoderReadStatus read_callback( FLAC__byte [], size_t * ) override;
@@ -41,8 +60,16 @@ private:
 	// Calculates the bitrate of the FLAC stream (returns nullopt if the bitrate was not calculated).
 	std::optional<float> CalculateBitrate();
 
-	// Input file stream.
-	std::ifstream m_FileStream;
+	// Seeks to a 'sample' position by decoding forward from the preceding seek index point.
+	// Returns whether the seek was successful.
+	bool SeekFromIndex( const FLAC__uint64 sample );
+
+	// Adds the start of the next frame to the seek index being built, marking the index as complete at the end of the stream.
+	// 'decoded' - whether a frame was decoded.
+	void UpdateIndexBuilder( const bool decoded );
+
+	// Input file.
+	InputFile m_InputFile;
 
 	// Current FLAC frame.
 	FLAC__Frame m_FLACFrame;
@@ -55,5 +82,17 @@ private:
 
 	// Indicates whether this is a valid FLAC stream.
 	bool m_Valid;
+
+	// Total number of sample frames in the stream (or zero if unknown).
+	uint64_t m_TotalSamples;
+
+	// Seek index to use when seeking.
+	SeekIndex::Ptr m_SeekIndex;
+
+	// Seek index being built while the stream is decoded from the start (or nullptr if the stream has been seeked).
+	SeekIndex::Ptr m_IndexBuilder;
+
+	// Indicates whether the seek index being built covers the whole stream.
+	bool m_IndexComplete;
 };
 
@@ -0,0 +1,185 @@
+#include "DecoderFlacParallel.h"
+
+#include <algorithm>
+#include <functional>
+
+// The (approximate) number of samples in each segment, across all channels.
+constexpr uint64_t s_SegmentSize = 1 << 19;
+
+// The number of segments, per decoding thread, which can be decoded ahead of the segment being read.
+constexpr uint64_t s_LookaheadPerThread = 2;
+
+DecoderFlacParallel::DecoderFlacParallel( const std::wstring& filename, const long threadCount ) :
+	Decoder(),
+	m_Decoders(),
+	m_Threads(),
+	m_TotalSamples( 0 ),
+	m_SegmentSamples( 0 ),
+	m_Lookahead( 0 ),
+	m_StartSample( 0 ),
+	m_SegmentCount( 0 ),
+	m_DecodeSegment( 0 ),
+	m_ReadSegment( 0 ),
+	m_Segments(),
+	m_ReadBuffer(),
+	m_ReadOffset( 0 ),
+	m_StopDecoding( false ),
+	m_Sequential( false ),
+	m_Mutex(),
+	m_SegmentChanged()
+{
+	m_Decoders.push_back( std::make_unique<DecoderFlac>( filename ) );
+	const DecoderFlac& decoder = *m_Decoders.front();
+	m_TotalSamples = decoder.GetTotalSamples();
+	if ( ( 0 == m_TotalSamples ) || ( decoder.GetChannels() <= 0 ) || ( decoder.GetSampleRate() <= 0 ) ) {
+		// Segments cannot be located without knowing the stream length.
+		throw std::runtime_error( "DecoderFlacParallel could not load file" );
+	}
+
+	SetSampleRate( decoder.GetSampleRate() );
+	SetChannels( decoder.GetChannels() );
+	SetBPS( decoder.GetBPS() );
+	SetBitrate( decoder.GetBitrate() );
+	SetDuration( decoder.GetDuration() );
+
+	m_SegmentSamples = std::max<uint64_t>( 1, s_SegmentSize / decoder.GetChannels() );
+	const uint64_t segmentCount = ( m_TotalSamples + m_SegmentSamples - 1 ) / m_SegmentSamples;
+	const long decoderCount = static_cast<long>( std::min<uint64_t>( std::max( 1l, threadCount ), segmentCount ) );
+	while ( static_cast<long>( m_Decoders.size() ) < decoderCount ) {
+		m_Decoders.push_back( std::make_unique<DecoderFlac>( filename ) );
+	}
+	m_Lookahead = s_LookaheadPerThread * m_Decoders.size();
+
+	StartThreads();
+}
+
+DecoderFlacParallel::~DecoderFlacParallel()
+{
+	StopThreads();
+}
+
+long DecoderFlacParallel::Read( float* buffer, const long sampleCount )
+{
+	const long channels = GetChannels();
+	long samplesRead = 0;
+	while ( samplesRead < sampleCount ) {
+		if ( m_Sequential ) {
+			const long samples = m_Decoders.front()->Read( buffer + static_cast<size_t>( samplesRead ) * channels, sampleCount - samplesRead );
+			if ( samples <= 0 ) {
+				break;
+			}
+			samplesRead += samples;
+		} else if ( m_ReadOffset < m_ReadBuffer.size() ) {
+			const long samples = std::min( sampleCount - samplesRead, static_cast<long>( ( m_ReadBuffer.size() - m_ReadOffset ) / channels ) );
+			std::copy_n( m_ReadBuffer.data() + m_ReadOffset, static_cast<size_t>( samples ) * channels, buffer + static_cast<size_t>( samplesRead ) * channels );
+			m_ReadOffset += static_cast<size_t>( samples ) * channels;
+			samplesRead += samples;
+		} else if ( !NextSegment() ) {
+			break;
+		}
+	}
+	return samplesRead;
+}
+
+float DecoderFlacParallel::Seek( const float position )
+{
+	StopThreads();
+	m_StartSample = std::min( m_TotalSamples, static_cast<uint64_t>( std::max( 0.0f, position ) * GetSampleRate() ) );
+	StartThreads();
+	return static_cast<float>( m_StartSample ) / GetSampleRate();
+}
+
+bool DecoderFlacParallel::SupportsSampleAccurateSeek() const
+{
+	return true;
+}
+
+void DecoderFlacParallel::StartThreads()
+{
+	m_SegmentCount = ( m_TotalSamples - m_StartSample + m_SegmentSamples - 1 ) / m_SegmentSamples;
+	m_DecodeSegment = 0;
+	m_ReadSegment = 0;
+	m_ReadOffset = 0;
+	m_StopDecoding = false;
+	m_Sequential = false;
+	for ( const auto& decoder : m_Decoders ) {
+		m_Threads.push_back( std::thread( &DecoderFlacParallel::DecodeSegments, this, std::ref( *decoder ) ) );
+	}
+}
+
+void DecoderFlacParallel::StopThreads()
+{
+	{
+		std::lock_guard<std::mutex> lock( m_Mutex );
+		m_StopDecoding = true;
+	}
+	m_SegmentChanged.notify_all();
+	for ( auto& thread : m_Threads ) {
+		thread.join();
+	}
+	m_Threads.clear();
+	m_Segments.clear();
+	m_ReadBuffer.clear();
+	m_ReadOffset = 0;
+}
+
+void DecoderFlacParallel::DecodeSegments( DecoderFlac& decoder )
+{
+	const long channels = GetChannels();
+	std::unique_lock<std::mutex> lock( m_Mutex );
+	while ( !m_StopDecoding ) {
+		// Only decode a limited number of segments ahead of the reader, to bound the memory used.
+		m_SegmentChanged.wait( lock, [ this ] () { return m_StopDecoding || ( ( m_DecodeSegment < m_SegmentCount ) && ( m_DecodeSegment < ( m_ReadSegment + m_Lookahead ) ) ); } );
+		if ( m_StopDecoding ) {
+			break;
+		}
+		const uint64_t segment = m_DecodeSegment++;
+		lock.unlock();
+
+		// A segment which could not be fully decoded is returned short, for the reader to fall back to sequential decoding.
+		const uint64_t segmentStart = m_StartSample + segment * m_SegmentSamples;
+		const long segmentSamples = static_cast<long>( std::min( m_SegmentSamples, m_TotalSamples - segmentStart ) );
+		std::vector<float> samples( static_cast<size_t>( segmentSamples ) * channels );
+		long samplesRead = 0;
+		if ( decoder.SeekToSample( segmentStart ) ) {
+			long read = 0;
+			do {
+				read = decoder.Read( samples.data() + static_cast<size_t>( samplesRead ) * channels, segmentSamples - samplesRead );
+				samplesRead += read;
+			} while ( ( read > 0 ) && ( samplesRead < segmentSamples ) );
+		}
+		samples.resize( static_cast<size_t>( samplesRead ) * channels );
+
+		lock.lock();
+		m_Segments.insert( { segment, std::move( samples ) } );
+		m_SegmentChanged.notify_all();
+	}
+}
+
+bool DecoderFlacParallel::NextSegment()
+{
+	bool success = false;
+	std::unique_lock<std::mutex> lock( m_Mutex );
+	if ( m_ReadSegment < m_SegmentCount ) {
+		m_SegmentChanged.wait( lock, [ this ] () { return m_Segments.end() != m_Segments.find( m_ReadSegment ); } );
+		const auto segment = m_Segments.find( m_ReadSegment );
+		const uint64_t segmentStart = m_StartSample + m_ReadSegment * m_SegmentSamples;
+		const size_t segmentSize = static_cast<size_t>( std::min( m_SegmentSamples, m_TotalSamples - segmentStart ) ) * GetChannels();
+		if ( segmentSize == segment->second.size() ) {
+			m_ReadBuffer = std::move( segment->second );
+			m_ReadOffset = 0;
+			m_Segments.erase( segment );
+			++m_ReadSegment;
+			m_SegmentChanged.notify_all();
+			success = true;
+		} else {
+			// The segment is short because of a decoding error, so the rest of the stream cannot be spliced on after it.
+			// Decode sequentially from the start of the segment instead, so that the stream ends (or continues) exactly as it would without the decoding threads.
+			lock.unlock();
+			StopThreads();
+			m_Sequential = m_Decoders.front()->SeekToSample( segmentStart );
+			success = m_Sequential;
+		}
+	}
+	return success;
+}
@@ -0,0 +1,100 @@
+#pragma once
+#include "Decoder.h"
+#include "DecoderFlac.h"
+
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// FLAC decoder for reading whole streams as quickly as possible (e.g. for gain calculation & conversion).
+// The stream is split into fixed length segments, which are decoded on multiple threads (each with its own FLAC decoder seeking to the start of its segment), and returned in stream order.
+class DecoderFlacParallel : public Decoder
+{
+public:
+	// 'filename' - file name.
+	// 'threadCount' - number of decoding threads.
+	// Throws a std::runtime_error exception if the file could not be loaded.
+	DecoderFlacParallel( const std::wstring& filename, const long threadCount );
+
+	~DecoderFlacParallel() override;
+
+	// Reads sample data.
+	// 'buffer' - output buffer (floating point format scaled to +/-1.0f).
+	// 'sampleCount' - number of samples to read.
+	// Returns the number of samples read, or zero if the stream has ended.
+	long Read( float* buffer, const long sampleCount ) override;
+
+	// Seeks to a 'position' in the stream, in seconds.
+	// Returns the new position in seconds.
+	float Seek( const float position ) override;
+
+	// Returns whether the decoder seeks to the exact sample position requested.
+	bool SupportsSampleAccurateSeek() const override;
+
+private:
+	// Starts the decoding threads, from the current start position.
+	void StartThreads();
+
+	// Stops the decoding threads, discarding any decoded segments.
+	void StopThreads();
+
+	// Decoding thread function.
+	// 'decoder' - FLAC decoder owned by the thread.
+	void DecodeSegments( DecoderFlac& decoder );
+
+	// Waits for the next segment to be decoded, and makes it the current read segment.
+	// If the segment could not be fully decoded, the decoding threads are stopped and reading continues sequentially from the start of the segment instead.
+	// Returns false if there are no more segments.
+	bool NextSegment();
+
+	// FLAC decoders, one per decoding thread.
+	std::vector<std::unique_ptr<DecoderFlac>> m_Decoders;
+
+	// Decoding threads.
+	std::vector<std::thread> m_Threads;
+
+	// Total number of sample frames in the stream.
+	uint64_t m_TotalSamples;
+
+	// Number of sample frames in each segment.
+	uint64_t m_SegmentSamples;
+
+	// Maximum number of segments to decode ahead of the segment being read.
+	uint64_t m_Lookahead;
+
+	// Sample frame position at which the first segment starts.
+	uint64_t m_StartSample;
+
+	// Number of segments from the start position to the end of the stream.
+	uint64_t m_SegmentCount;
+
+	// Index of the next segment to decode.
+	uint64_t m_DecodeSegment;
+
+	// Index of the next segment to read.
+	uint64_t m_ReadSegment;
+
+	// Decoded segments which have not yet been read, keyed by segment index.
+	std::map<uint64_t, std::vector<float>> m_Segments;
+
+	// Segment currently being read.
+	std::vector<float> m_ReadBuffer;
+
+	// Offset of the next sample to read from the current segment.
+	size_t m_ReadOffset;
+
+	// Indicates whether the decoding threads should stop.
+	bool m_StopDecoding;
+
+	// Indicates whether reading has fallen back to sequential decoding (using the first FLAC decoder), because a segment could not be fully decoded.
+	bool m_Sequential;
+
+	// Segment state mutex.
+	std::mutex m_Mutex;
+
+	// Signalled when a segment has been decoded, or when a segment has been taken for reading.
+	std::condition_variable m_SegmentChanged;
+};
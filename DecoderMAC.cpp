@@ -1,10 +1,119 @@
 #include "DecoderMAC.h"
 
+#include "InputFile.h"
+#include "SampleConversion.h"
 #include "Utility.h"
 
+#include <algorithm>
+
+// APE input, for reading from an InputFile.
+class InputFileIO : public APE::CIO
+{
+public:
+	InputFileIO() :
+		CIO(),
+		m_InputFile(),
+		m_Filename()
+	{
+	}
+
+	~InputFileIO() override
+	{
+	}
+
+	int Open( const wchar_t* name, bool /*openReadOnly*/ ) override
+	{
+		m_Filename = ( nullptr != name ) ? name : std::wstring();
+		m_InputFile = std::make_unique<InputFile>( m_Filename );
+		if ( !m_InputFile->IsOpen() ) {
+			m_InputFile.reset();
+		}
+		return m_InputFile ? ERROR_SUCCESS : ERROR_INVALID_INPUT_FILE;
+	}
+
+	int Close() override
+	{
+		m_InputFile.reset();
+		return ERROR_SUCCESS;
+	}
+
+	int Read( void* buffer, unsigned int bytesToRead, unsigned int* bytesRead ) override
+	{
+		const unsigned int count = m_InputFile ? static_cast<unsigned int>( m_InputFile->Read( buffer, bytesToRead ) ) : 0;
+		if ( nullptr != bytesRead ) {
+			*bytesRead = count;
+		}
+		return m_InputFile ? ERROR_SUCCESS : ERROR_IO_READ;
+	}
+
+	int Write( const void* /*buffer*/, unsigned int /*bytesToWrite*/, unsigned int* /*bytesWritten*/ ) override
+	{
+		return ERROR_IO_WRITE;
+	}
+
+	APE::int64 PerformSeek() override
+	{
+		bool success = false;
+		if ( m_InputFile ) {
+			const APE::int64 origin = ( APE_FILE_CURRENT == m_nSeekMethod ) ? m_InputFile->GetPosition() : ( ( APE_FILE_END == m_nSeekMethod ) ? m_InputFile->GetSize() : 0 );
+			success = m_InputFile->Seek( origin + m_nSeekPosition );
+		}
+		return success ? ERROR_SUCCESS : ERROR_IO_READ;
+	}
+
+	int Create( const wchar_t* /*name*/ ) override
+	{
+		return ERROR_IO_WRITE;
+	}
+
+	int Delete() override
+	{
+		return ERROR_IO_WRITE;
+	}
+
+	int SetEOF() override
+	{
+		return ERROR_IO_WRITE;
+	}
+
+	APE::int64 GetPosition() override
+	{
+		return m_InputFile ? m_InputFile->GetPosition() : 0;
+	}
+
+	APE::int64 GetSize() override
+	{
+		return m_InputFile ? m_InputFile->GetSize() : 0;
+	}
+
+	int GetName( wchar_t* buffer ) override
+	{
+		// The buffer is assumed to hold MAX_PATH characters.
+		const size_t length = std::min<size_t>( m_Filename.size(), MAX_PATH - 1 );
+		std::copy( m_Filename.begin(), m_Filename.begin() + length, buffer );
+		buffer[ length ] = 0;
+		return ERROR_SUCCESS;
+	}
+
+private:
+	// Input file.
+	std::unique_ptr<InputFile> m_InputFile;
+
+	// File name.
+	std::wstring m_Filename;
+};
+
+// Opens 'filename' using the 'io' input, and returns an APE decompressor (or null if the file could not be decompressed).
+static APE::IAPEDecompress* CreateDecompressor( APE::CIO& io, const std::wstring& filename )
+{
+	return ( ERROR_SUCCESS == io.Open( filename.c_str() ) ) ? CreateIAPEDecompressEx( &io ) : nullptr;
+}
+
 DecoderMAC::DecoderMAC( const std::wstring& filename ) :
 	Decoder(),
-	m_decompress( CreateIAPEDecompress( filename.c_str() )  )
+	m_io( std::make_unique<InputFileIO>() ),
+	m_decompress( CreateDecompressor( *m_io, filename ) ),
+	m_buffer()
 {
 	if ( m_decompress ) {
 		const auto bps =  m_decompress->GetInfo( APE::APE_INFO_BITS_PER_SAMPLE );
@@ -32,40 +141,32 @@ long DecoderMAC::Read( float* destBuffer, const long sampleCount )
 	long samplesRead = 0;
 	const long blockAlign = static_cast<long>( m_decompress->GetInfo( APE::APE_INFO_BLOCK_ALIGN ) );
 	if ( blockAlign > 0 ) {
-		std::vector<char> srcBuffer( sampleCount * blockAlign );
+		const size_t bufferSize = static_cast<size_t>( sampleCount ) * blockAlign;
+		if ( m_buffer.size() < bufferSize ) {
+			m_buffer.resize( bufferSize );
+		}
 		long long blocksRead = 0;
-		m_decompress->GetData( srcBuffer.data(), sampleCount, &blocksRead );
+		m_decompress->GetData( m_buffer.data(), sampleCount, &blocksRead );
 		if ( blocksRead > 0 ) {
 			samplesRead = static_cast<long>( blocksRead );
 			const long channels = GetChannels();
 			const long bps = GetBPS().value_or( 0 );
+			const size_t count = static_cast<size_t>( blocksRead * channels );
 			switch ( bps ) {
 				case 8 : {
-					unsigned char* uBuf = reinterpret_cast<unsigned char*>( srcBuffer.data() );
-					for ( long long block = 0; block < blocksRead * channels; block++ ) {
-						*destBuffer++ = Unsigned8ToFloat( uBuf[ block ] );
-					}
+					SampleConversion::ToFloat( reinterpret_cast<const uint8_t*>( m_buffer.data() ), destBuffer, count );
 					break;
 				}
 				case 16 : {
-					short* sBuf = reinterpret_cast<short*>( srcBuffer.data() );
-					for ( long long block = 0; block < blocksRead * channels; block++ ) {
-						*destBuffer++ = Signed16ToFloat( sBuf[ block ] );
-					}
+					SampleConversion::ToFloat( reinterpret_cast<const int16_t*>( m_buffer.data() ), destBuffer, count );
 					break;
 				}
 				case 24 : {
-					unsigned char* uBuf = reinterpret_cast<unsigned char*>( srcBuffer.data() );
-					for ( long long block = 0; block < blocksRead * channels; block++ ) {
-						*destBuffer++ = Signed32ToFloat( ( uBuf[ block * 3 + 2 ] << 24 ) | ( uBuf[ block * 3 + 1 ] << 16 ) | ( uBuf[ block * 3 ] << 8 ) );
-					}
+					SampleConversion::Packed24ToFloat( reinterpret_cast<const uint8_t*>( m_buffer.data() ), destBuffer, count );
 					break;
 				}
 				case 32 : {
-					int32_t* iBuf = reinterpret_cast<int32_t*>( srcBuffer.data() );
-					for ( long long block = 0; block < blocksRead * channels; block++ ) {
-						*destBuffer++ = Signed32ToFloat( iBuf[ block ] );
-					}
+					SampleConversion::ToFloat( reinterpret_cast<const int32_t*>( m_buffer.data() ), destBuffer, count );
 					break;
 				}
 				default : {
@@ -82,5 +183,10 @@ float DecoderMAC::Seek( const float position )
 {
 	const long long blockOffset = static_cast<long long>( GetSampleRate() * position );
 	m_decompress->Seek( blockOffset );
-	return static_cast<float>( m_decompress->GetInfo( APE::APE_DECOMPRESS_CURRENT_MS ) ) / 1000;
+	return ( GetSampleRate() > 0 ) ? ( static_cast<float>( m_decompress->GetInfo( APE::APE_DECOMPRESS_CURRENT_BLOCK ) ) / GetSampleRate() ) : 0;
+}
+
+bool DecoderMAC::SupportsSampleAccurateSeek() const
+{
+	return true;
 }
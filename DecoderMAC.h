@@ -5,8 +5,10 @@
 #include "All.h"
 #include "maclib.h"
 #include "APETag.h"
+#include "IO.h"
 
 #include <string>
+#include <vector>
 
 class DecoderMAC : public Decoder
 {
@@ -25,7 +27,16 @@ public:
 	// Returns the new position in seconds.
 	float Seek( const float position ) override;
 
+	// Returns whether the decoder seeks to the exact sample position requested.
+	bool SupportsSampleAccurateSeek() const override;
+
 private:
+	// APE input (which must outlive the decompressor).
+	std::unique_ptr<APE::CIO> m_io;
+
 	// APE decompressor.
 	std::unique_ptr<APE::IAPEDecompress> m_decompress;
+
+	// Decompressed sample data (which only ever grows, so that reading does not allocate once it is large enough).
+	std::vector<char> m_buffer;
 };
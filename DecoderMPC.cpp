@@ -1,42 +1,63 @@
 #include "DecoderMPC.h"
 
+#include "SampleConversion.h"
 #include "Utility.h"
 
+#include <algorithm>
+
+// MPC reader callbacks, for reading from an InputFile.
+static mpc_int32_t ReaderRead( mpc_reader* reader, void* ptr, mpc_int32_t size )
+{
+	return ( size > 0 ) ? static_cast<mpc_int32_t>( static_cast<InputFile*>( reader->data )->Read( ptr, static_cast<size_t>( size ) ) ) : 0;
+}
+
+static mpc_bool_t ReaderSeek( mpc_reader* reader, mpc_int32_t offset )
+{
+	return static_cast<InputFile*>( reader->data )->Seek( offset ) ? MPC_TRUE : MPC_FALSE;
+}
+
+static mpc_int32_t ReaderTell( mpc_reader* reader )
+{
+	return static_cast<mpc_int32_t>( static_cast<InputFile*>( reader->data )->GetPosition() );
+}
+
+static mpc_int32_t ReaderGetSize( mpc_reader* reader )
+{
+	return static_cast<mpc_int32_t>( static_cast<InputFile*>( reader->data )->GetSize() );
+}
+
+static mpc_bool_t ReaderCanSeek( mpc_reader* /*reader*/ )
+{
+	return MPC_TRUE;
+}
+
 DecoderMPC::DecoderMPC( const std::wstring& filename ) :
 	Decoder(),
-	m_file( nullptr ),
-	m_reader(),
+	m_file( filename ),
+	m_reader( { ReaderRead, ReaderSeek, ReaderTell, ReaderGetSize, ReaderCanSeek, &m_file } ),
 	m_demux(),
 	m_buffer( MPC_DECODER_BUFFER_LENGTH ),
 	m_buffercount( 0 ),
 	m_bufferpos( 0 ),
 	m_eos( false )
 {
-	if ( 0 == _wfopen_s( &m_file, filename.c_str(), L"rb" ) && ( nullptr != m_file ) ) {
-		if ( MPC_STATUS_OK == mpc_reader_init_stdio_stream( &m_reader, m_file ) ) {
-			m_demux = mpc_demux_init( &m_reader );
-			if ( nullptr != m_demux ) {
-				mpc_streaminfo info = {};
-				mpc_demux_get_info( m_demux, &info );
-				SetChannels( static_cast<long>( info.channels ) );
-				SetSampleRate( static_cast<long>( info.sample_freq ) );
-				SetBitrate( static_cast<float>( info.average_bitrate ) / 1000 );
-				SetDuration( static_cast<float>( mpc_streaminfo_get_length( &info ) ) );
-				if ( ( 0 == GetChannels() ) || ( 0 == GetSampleRate() ) || ( GetDuration() <= 0 ) ) {
-					mpc_demux_exit( m_demux );
-					m_demux = nullptr;
-				}
-			}
-			if ( nullptr == m_demux ) {
-				mpc_reader_exit_stdio( &m_reader );
+	if ( m_file.IsOpen() ) {
+		m_demux = mpc_demux_init( &m_reader );
+		if ( nullptr != m_demux ) {
+			mpc_streaminfo info = {};
+			mpc_demux_get_info( m_demux, &info );
+			SetChannels( static_cast<long>( info.channels ) );
+			SetSampleRate( static_cast<long>( info.sample_freq ) );
+			SetBitrate( static_cast<float>( info.average_bitrate ) / 1000 );
+			SetDuration( static_cast<float>( mpc_streaminfo_get_length( &info ) ) );
+			if ( ( 0 == GetChannels() ) || ( 0 == GetSampleRate() ) || ( GetDuration() <= 0 ) ) {
+				mpc_demux_exit( m_demux );
+				m_demux = nullptr;
 			}
 		}
 	}
 
 	if ( nullptr == m_demux ) {
-		if ( nullptr != m_file ) {
-			fclose( m_file );
-		}
 		throw std::runtime_error( "DecoderMPC could not load file" );
 	}
 }
@@ -44,8 +65,6 @@ DecoderMPC::DecoderMPC( const std::wstring& filename ) :
 DecoderMPC::~DecoderMPC()
 {
 	mpc_demux_exit( m_demux );
-	mpc_reader_exit_stdio( &m_reader );
-	fclose( m_file );
 }
 
 long DecoderMPC::Read( float* destBuffer, const long sampleCount )
@@ -54,10 +73,11 @@ long DecoderMPC::Read( float* destBuffer, const long sampleCount )
 	const long channels = GetChannels();
 	while ( !m_eos && ( samplesRead < sampleCount ) ) {
 		if ( m_bufferpos < m_buffercount ) {
-			for ( long channel = 0; channel < channels; channel++ ) {
-				*destBuffer++ = m_buffer[ m_bufferpos++ ];
-			}
-			++samplesRead;
+			const long frames = std::min( sampleCount - samplesRead, static_cast<long>( ( m_buffercount - m_bufferpos ) / channels ) );
+			SampleConversion::ToFloat( m_buffer.data() + m_bufferpos, destBuffer, static_cast<size_t>( frames * channels ) );
+			destBuffer += frames * channels;
+			m_bufferpos += frames * channels;
+			samplesRead += frames;
 		} else {
 			m_bufferpos = 0;
 			m_buffercount = 0;
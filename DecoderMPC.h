@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Decoder.h"
+#include "InputFile.h"
 
 #include "mpc/streaminfo.h"
 #include "mpc/mpcdec.h"
@@ -27,8 +28,8 @@ public:
 	float Seek( const float position ) override;
 
 private:
-	// File handle.
-	FILE* m_file;
+	// Input file.
+	InputFile m_file;
 
 	// MPC reader.
 	mpc_reader m_reader;
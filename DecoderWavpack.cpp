@@ -1,15 +1,65 @@
 #include "DecoderWavpack.h"
 
-#include "Utility.h"
+#include "SampleConversion.h"
+
+// WavPack stream reader callbacks, for reading from an InputFile.
+static int32_t ReadBytes( void* id, void* data, int32_t bcount )
+{
+	return ( bcount > 0 ) ? static_cast<int32_t>( static_cast<InputFile*>( id )->Read( data, static_cast<size_t>( bcount ) ) ) : 0;
+}
+
+static int64_t GetPos( void* id )
+{
+	return static_cast<InputFile*>( id )->GetPosition();
+}
+
+static int SetPosAbs( void* id, int64_t pos )
+{
+	return static_cast<InputFile*>( id )->Seek( pos ) ? 0 : -1;
+}
+
+static int SetPosRel( void* id, int64_t delta, int mode )
+{
+	InputFile* inputFile = static_cast<InputFile*>( id );
+	const int64_t origin = ( SEEK_CUR == mode ) ? inputFile->GetPosition() : ( ( SEEK_END == mode ) ? inputFile->GetSize() : 0 );
+	return inputFile->Seek( origin + delta ) ? 0 : -1;
+}
+
+static int PushBackByte( void* id, int c )
+{
+	// Only ever called to push back the byte that was just read.
+	InputFile* inputFile = static_cast<InputFile*>( id );
+	return inputFile->Seek( inputFile->GetPosition() - 1 ) ? c : EOF;
+}
+
+static int64_t GetLength( void* id )
+{
+	return static_cast<InputFile*>( id )->GetSize();
+}
+
+static int CanSeek( void* /*id*/ )
+{
+	return 1;
+}
+
+// WavPack stream reader (the input files are owned by the decoder, so there is no close callback).
+static WavpackStreamReader64 s_StreamReader = { ReadBytes, nullptr /*write_bytes*/, GetPos, SetPosAbs, SetPosRel, PushBackByte, GetLength, CanSeek, nullptr /*truncate_here*/, nullptr /*close*/ };
 
 DecoderWavpack::DecoderWavpack( const std::wstring& filename ) :
 	Decoder(),
+	m_InputFile( std::make_unique<InputFile>( filename ) ),
+	m_CorrectionFile( std::make_unique<InputFile>( filename + L"c" ) ),
 	m_Context( nullptr )
 {
-	char* error = nullptr;
-	const int flags = OPEN_WVC | OPEN_NORMALIZE | OPEN_DSD_AS_PCM | OPEN_FILE_UTF8;
-	const int offset = 0;
-	m_Context = WavpackOpenFileInput( WideStringToUTF8( filename ).c_str(), error, flags, offset );
+	if ( !m_CorrectionFile->IsOpen() ) {
+		m_CorrectionFile.reset();
+	}
+	if ( m_InputFile->IsOpen() ) {
+		char error[ 80 ] = {};
+		const int flags = OPEN_WVC | OPEN_NORMALIZE | OPEN_DSD_AS_PCM;
+		const int offset = 0;
+		m_Context = WavpackOpenFileInputEx64( &s_StreamReader, m_InputFile.get(), m_CorrectionFile.get(), error, flags, offset );
+	}
 	if ( nullptr != m_Context ) {
 		SetBPS( static_cast<long>( WavpackGetBitsPerSample( m_Context ) ) );
 		SetChannels( static_cast<long>( WavpackGetNumChannels( m_Context ) ) );
@@ -32,12 +82,8 @@ long DecoderWavpack::Read( float* buffer, const long sampleCount )
 {
 	const long samplesRead = ( sampleCount > 0 ) ? static_cast<long>( WavpackUnpackSamples( m_Context, reinterpret_cast<int32_t*>( buffer ), sampleCount ) ) : 0;
 	if ( !( WavpackGetMode( m_Context ) & MODE_FLOAT ) ) {
-		int32_t* nativeBuffer = reinterpret_cast<int32_t*>( buffer );
-		const long bufferSize = samplesRead * GetChannels();
-		const int bitsPerSample = WavpackGetBytesPerSample( m_Context ) * 8;
-		for ( long index = 0; index < bufferSize; index++ ) {
-			buffer[ index ] = static_cast<float>( nativeBuffer[ index ] ) / ( 1 << ( bitsPerSample - 1 ) );
-		}
+		const long bitsPerSample = WavpackGetBytesPerSample( m_Context ) * 8;
+		SampleConversion::ToFloat( reinterpret_cast<const int32_t*>( buffer ), buffer, static_cast<size_t>( samplesRead * GetChannels() ), bitsPerSample );
 	}
 	return samplesRead;
 }
@@ -51,3 +97,8 @@ float DecoderWavpack::Seek( const float position )
 	}
 	return seekPosition;
 }
+
+bool DecoderWavpack::SupportsSampleAccurateSeek() const
+{
+	return true;
+}
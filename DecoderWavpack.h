@@ -1,9 +1,11 @@
 #pragma once
 
 #include "Decoder.h"
+#include "InputFile.h"
 
 #include "wavpack.h"
 
+#include <memory>
 #include <string>
 
 class DecoderWavpack : public Decoder
@@ -25,7 +27,16 @@ public:
 	// Returns the new position in seconds.
 	float Seek( const float position ) override;
 
+	// Returns whether the decoder seeks to the exact sample position requested.
+	bool SupportsSampleAccurateSeek() const override;
+
 private:
+	// Input file.
+	std::unique_ptr<InputFile> m_InputFile;
+
+	// Correction input file (or null if there is no correction file).
+	std::unique_ptr<InputFile> m_CorrectionFile;
+
 	// WavPack context.
 	WavpackContext* m_Context;
 };
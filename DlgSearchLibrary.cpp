@@ -0,0 +1,74 @@
+#include "DlgSearchLibrary.h"
+
+#include "resource.h"
+#include "Utility.h"
+
+INT_PTR CALLBACK DlgSearchLibrary::DialogProc( HWND hwnd, UINT message, WPARAM wParam, LPARAM lParam )
+{
+	switch ( message ) {
+		case WM_INITDIALOG : {
+			DlgSearchLibrary* dialog = reinterpret_cast<DlgSearchLibrary*>( lParam );
+			if ( nullptr != dialog ) {
+				SetWindowLongPtr( hwnd, DWLP_USER, lParam );
+				dialog->OnInitDialog( hwnd );
+				return TRUE;
+			}
+			break;
+		}
+		case WM_DESTROY : {
+			SetWindowLongPtr( hwnd, DWLP_USER, 0 );
+			break;
+		}
+		case WM_COMMAND : {
+			switch ( LOWORD( wParam ) ) {
+				case IDCANCEL : 
+				case IDOK : {
+					DlgSearchLibrary* dialog = reinterpret_cast<DlgSearchLibrary*>( GetWindowLongPtr( hwnd, DWLP_USER ) );
+					if ( nullptr != dialog ) {
+						dialog->OnClose( ( IDOK == LOWORD( wParam ) ) );
+					}
+					EndDialog( hwnd, 0 );
+					return TRUE;
+				}
+				default : {
+					break;
+				}
+			}
+			break;
+		}
+		default : {
+			break;
+		}
+	}
+	return FALSE;
+}
+
+DlgSearchLibrary::DlgSearchLibrary( const HINSTANCE instance, const HWND parent ) :
+	m_hInst( instance ),
+	m_hWnd( nullptr ),
+	m_Text()
+{
+	DialogBoxParam( instance, MAKEINTRESOURCE( IDD_SEARCH_LIBRARY ), parent, DialogProc, reinterpret_cast<LPARAM>( this ) );
+}
+
+void DlgSearchLibrary::OnInitDialog( const HWND hwnd )
+{
+	m_hWnd = hwnd;
+	CentreDialog( m_hWnd );
+}
+
+void DlgSearchLibrary::OnClose( const bool ok )
+{
+	if ( ok ) {
+		const int bufferSize = 2048;
+		WCHAR buffer[ bufferSize ] = {};
+		if ( 0 != GetDlgItemText( m_hWnd, IDC_SEARCH_TEXT, buffer, bufferSize ) ) {
+			m_Text = buffer;
+		}
+	}
+}
+
+const std::wstring& DlgSearchLibrary::GetText() const
+{
+	return m_Text;
+}
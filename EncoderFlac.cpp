@@ -1,12 +1,15 @@
 #include "EncoderFlac.h"
 
+#include "SampleConversion.h"
 #include "Utility.h"
 
 #include <vector>
 
 EncoderFlac::EncoderFlac() :
 	Encoder(),
-  FLAC::Encoder::File()
+  FLAC::Encoder::File(),
+	m_seekTable(),
+	m_buffer()
 {
 }
 
@@ -83,13 +86,12 @@ bool EncoderFlac::Open( std::wstring& filename, const long sampleRate, const lon
 bool EncoderFlac::Write( float* samples, const long sampleCount )
 {
 	const long bps = get_bits_per_sample();
-	const long bufferSize = sampleCount * get_channels();
-	std::vector<FLAC__int32> buffer( bufferSize );
-	for ( long sampleIndex = 0; sampleIndex < bufferSize; sampleIndex++ ) {
-		buffer[ sampleIndex ] = static_cast<FLAC__int32>( 
-			( 16 == bps ) ? FloatTo16( samples[ sampleIndex ] ) : ( ( 24 == bps ) ? FloatTo24( samples[ sampleIndex ] ) : FloatToSigned8( samples[ sampleIndex ] ) ) );
+	const size_t bufferSize = static_cast<size_t>( sampleCount ) * get_channels();
+	if ( m_buffer.size() < bufferSize ) {
+		m_buffer.resize( bufferSize );
 	}
-	const bool success = process_interleaved( buffer.data(), sampleCount );
+	SampleConversion::FromFloat( samples, m_buffer.data(), bufferSize, ( ( 16 == bps ) || ( 24 == bps ) ) ? bps : 8 );
+	const bool success = process_interleaved( m_buffer.data(), sampleCount );
 	return success;
 }
 
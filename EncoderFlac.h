@@ -4,6 +4,8 @@
 
 #include "FLAC++/all.h"
 
+#include <vector>
+
 // FLAC encoder
 class EncoderFlac : public Encoder, public FLAC::Encoder::File
 {
@@ -46,6 +48,9 @@ private:
 	// Seek table metadata object.
 	std::unique_ptr<FLAC::Metadata::SeekTable> m_seekTable;
 
+	// Sample data in the encoder format (which only ever grows, so that writing does not allocate once it is large enough).
+	std::vector<FLAC__int32> m_buffer;
+
 	// Padding metadata object.
 	std::unique_ptr<FLAC::Metadata::Padding> m_padding;
 
@@ -1,5 +1,6 @@
 #include "EncoderPCM.h"
 
+#include "SampleConversion.h"
 #include "Utility.h"
 
 #include <assert.h>
@@ -156,9 +157,7 @@ bool EncoderPCM::Write( float* samples, const long sampleCount )
 	switch ( m_bitsPerSample ) {
 		case 8 : {		
 			m_buffer8.resize( outputBufferSize );
-			for ( size_t sampleIndex = 0; sampleIndex < outputBufferSize; sampleIndex++ ) {
-				m_buffer8[ sampleIndex ] = FloatToUnsigned8( samples[ sampleIndex ] );
-			}
+			SampleConversion::FromFloat( samples, m_buffer8.data(), outputBufferSize );
 			success = ( outputBufferSize == fwrite( m_buffer8.data(), 1, outputBufferSize, m_file ) );
 			if ( success ) {
 				m_dataBytesWritten += outputBufferSize;
@@ -167,9 +166,7 @@ bool EncoderPCM::Write( float* samples, const long sampleCount )
 		}
 		case 16 : {
 			m_buffer16.resize( outputBufferSize );
-			for ( size_t sampleIndex = 0; sampleIndex < outputBufferSize; sampleIndex++ ) {
-				m_buffer16[ sampleIndex ] = FloatTo16( samples[ sampleIndex ] );
-			}
+			SampleConversion::FromFloat( samples, m_buffer16.data(), outputBufferSize );
 			success = ( outputBufferSize == fwrite( m_buffer16.data(), 2, outputBufferSize, m_file ) );
 			if ( success ) {
 				m_dataBytesWritten += 2 * outputBufferSize;
@@ -178,12 +175,7 @@ bool EncoderPCM::Write( float* samples, const long sampleCount )
 		}
 		case 24 : {
 			m_buffer8.resize( 3 * outputBufferSize );
-			for ( size_t sampleIndex = 0; sampleIndex < outputBufferSize; sampleIndex++ ) {
-				const int32_t value = FloatTo24( samples[ sampleIndex ] );
-				m_buffer8[ sampleIndex * 3 ] = value & 0xff;
-				m_buffer8[ sampleIndex * 3 + 1 ] = ( value >> 8 ) & 0xff;
-				m_buffer8[ sampleIndex * 3 + 2 ] = ( value >> 16 ) & 0xff;
-			}
+			SampleConversion::FloatToPacked24( samples, m_buffer8.data(), outputBufferSize );
 			success = ( outputBufferSize == fwrite( m_buffer8.data(), 3, outputBufferSize, m_file ) );
 			if ( success ) {
 				m_dataBytesWritten += 3 * outputBufferSize;
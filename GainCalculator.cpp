@@ -116,9 +116,12 @@ void GainCalculator::Handler()
 			// Update track gain for all items.
 			Playlist::ItemList processedItems;
 			const size_t threadCount = std::min<size_t>( pendingItems.size(), std::max<size_t>( 1, std::thread::hardware_concurrency() ) );
+
+			// When there are fewer items than processor cores, each item can be decoded on multiple threads.
+			const long decoderThreadCount = static_cast<long>( std::max<size_t>( 1, std::thread::hardware_concurrency() / threadCount ) );
 			std::list<std::thread> threads;
 			for ( size_t threadIndex = 0; threadIndex < threadCount; threadIndex++ ) {
-				threads.push_back( std::thread( [ &pendingItems, &processedItems, &itemMutex, &r128States, &r128StatesMutex, canContinue, this ]() 
+				threads.push_back( std::thread( [ &pendingItems, &processedItems, &itemMutex, &r128States, &r128StatesMutex, canContinue, decoderThreadCount, this ]() 
 				{
 					Playlist::Item item = {};
 					{
@@ -130,7 +133,7 @@ void GainCalculator::Handler()
 					}
 
 					while ( 0 != item.ID ) {					
-						Decoder::Ptr decoder = OpenDecoder( item );
+						Decoder::Ptr decoder = OpenDecoder( item, decoderThreadCount );
 						if ( decoder ) {
 							const unsigned int channels = static_cast<unsigned int>( decoder->GetChannels() );
 							const unsigned long samplerate = static_cast<unsigned long>( decoder->GetSampleRate() );
@@ -227,15 +230,15 @@ int GainCalculator::GetPendingCount() const
 	return m_PendingCount.load();
 }
 
-Decoder::Ptr GainCalculator::OpenDecoder( const Playlist::Item& item ) const
+Decoder::Ptr GainCalculator::OpenDecoder( const Playlist::Item& item, const long threadCount ) const
 {
 	Decoder::Ptr decoder;
 	if ( !IsURL( item.Info.GetFilename() ) ) {
-		decoder = m_Handlers.OpenDecoder( item.Info.GetFilename() );
+		decoder = m_Handlers.OpenDecoder( item.Info.GetFilename(), threadCount );
 		if ( !decoder ) {
 			auto duplicate = item.Duplicates.begin();
 			while ( !decoder && ( item.Duplicates.end() != duplicate ) ) {
-				decoder = m_Handlers.OpenDecoder( *duplicate );
+				decoder = m_Handlers.OpenDecoder( *duplicate, threadCount );
 				++duplicate;
 			}
 		}
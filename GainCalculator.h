@@ -50,7 +50,8 @@ private:
 	void AddPending( const Playlist::Item& item );
 
 	// Returns a decoder for the 'item', or nullptr if a decoder could not be opened.
-	Decoder::Ptr OpenDecoder( const Playlist::Item& item ) const;
+	// 'threadCount' - number of threads the decoder can use to decode the item.
+	Decoder::Ptr OpenDecoder( const Playlist::Item& item, const long threadCount = 1 ) const;
 
 	// Media library.
 	Library& m_Library;
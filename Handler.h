@@ -8,6 +8,7 @@
 #include <list>
 #include <map>
 #include <memory>
+#include <optional>
 #include <set>
 #include <string>
 
@@ -31,6 +32,15 @@ public:
 	// A list of handlers.
 	typedef std::list<Ptr> List;
 
+	// Stream properties, as read by a probe.
+	struct StreamProperties {
+		long SampleRate = 0;
+		long Channels = 0;
+		std::optional<long> BitsPerSample;
+		float Duration = 0;
+		std::optional<float> Bitrate;
+	};
+
 	// Returns a description of the handler.
 	virtual std::wstring GetDescription() const = 0;
 
@@ -46,6 +56,43 @@ public:
 	// Returns a decoder for 'filename', or nullptr if a decoder cannot be created.
 	virtual Decoder::Ptr OpenDecoder( const std::wstring& filename ) const = 0;
 
+	// Returns a decoder for reading the whole of 'filename' as quickly as possible (e.g. for gain calculation or conversion), or nullptr if a decoder cannot be created.
+	// 'threadCount' - number of threads the decoder can use.
+	// The default implementation returns a standard decoder.
+	virtual Decoder::Ptr OpenBatchDecoder( const std::wstring& filename, const long /*threadCount*/ ) const
+	{
+		return OpenDecoder( filename );
+	}
+
+	// Reads the stream properties (and optionally the tags) from a file, without decoding any audio.
+	// 'filename' - file name.
+	// 'properties' - out, stream properties.
+	// 'tags' - out, tags, or nullptr if the tags are not required (the tags are cleared if they could not be read).
+	// 'tagsRead' - out, whether the tags were read.
+	// Returns true if the stream properties were read.
+	// The default implementation opens a decoder, then reads the tags separately.
+	// Handlers which can parse both from the file header & metadata blocks should override this, so that the file is only opened once.
+	virtual bool Probe( const std::wstring& filename, StreamProperties& properties, Tags* tags, bool& tagsRead ) const
+	{
+		bool success = false;
+		tagsRead = false;
+		if ( const Decoder::Ptr decoder = OpenDecoder( filename ); decoder ) {
+			properties.SampleRate = decoder->GetSampleRate();
+			properties.Channels = decoder->GetChannels();
+			properties.BitsPerSample = decoder->GetBPS();
+			properties.Duration = decoder->GetDuration();
+			properties.Bitrate = decoder->GetBitrate();
+			success = true;
+		}
+		if ( success && ( nullptr != tags ) ) {
+			tagsRead = GetTags( filename, *tags );
+			if ( !tagsRead ) {
+				tags->clear();
+			}
+		}
+		return success;
+	}
+
 	// Returns an encoder, or nullptr if an encoder cannot be created.
 	virtual Encoder::Ptr OpenEncoder() const = 0;
 
@@ -6,6 +6,7 @@
 
 #include "vcedit.h"
 
+#include <algorithm>
 #include <list>
 #include <sstream>
 
@@ -81,38 +82,77 @@ bool HandlerBass::GetTags( const std::wstring& filename, Tags& tags ) const
 		flags = BASS_UNICODE;
 		const HSTREAM stream = BASS_StreamCreateFile( FALSE /*mem*/, filename.c_str(), 0 /*offset*/, 0 /*length*/, flags );
 		if ( stream != 0 ) {
-			BASS_CHANNELINFO info = {};
-			BASS_ChannelGetInfo( stream, &info );
-			if ( BASS_CTYPE_STREAM_OGG == info.ctype ) {
-				const char* oggTags = BASS_ChannelGetTags( stream, BASS_TAG_OGG );
-				if ( nullptr != oggTags ) {
-					ReadOggTags( oggTags, tags );
-					success = true;
-				}
-			} else if ( BASS_CTYPE_STREAM_MIDI == info.ctype ) {
-				const char* midiTags = BASS_ChannelGetTags( stream, BASS_TAG_MIDI_TRACK );
-				if ( ( nullptr != midiTags ) && ( strlen( midiTags ) > 0 ) ) {
-					tags.insert( Tags::value_type( Tag::Title, midiTags ) );
-					success = true;
-				}
-			} else if ( BASS_CTYPE_STREAM_DSD == info.ctype ) {
-				const char* dsdArtist = BASS_ChannelGetTags( stream, BASS_TAG_DSD_ARTIST );
-				if ( ( nullptr != dsdArtist ) && ( strlen( dsdArtist ) > 0 ) ) {
-					tags.insert( Tags::value_type( Tag::Artist, dsdArtist ) );
-					success = true;
-				}
-				const char* dsdTitle = BASS_ChannelGetTags( stream, BASS_TAG_DSD_TITLE );
-				if ( ( nullptr != dsdTitle ) && ( strlen( dsdTitle ) > 0 ) ) {
-					tags.insert( Tags::value_type( Tag::Title, dsdTitle ) );
-					success = true;
-				}
-			}
+			success = ReadStreamTags( stream, tags );
 			BASS_StreamFree( stream );
 		}
 	}
 	return success;
 }
 
+bool HandlerBass::Probe( const std::wstring& filename, StreamProperties& properties, Tags* tags, bool& tagsRead ) const
+{
+	bool success = false;
+	tagsRead = false;
+	const bool isMusic = DecoderBass::IsMusicFile( filename );
+	const HSTREAM stream = ( IsURL( filename ) || isMusic ) ? 0 : BASS_StreamCreateFile( FALSE /*mem*/, filename.c_str(), 0 /*offset*/, 0 /*length*/, BASS_UNICODE | BASS_SAMPLE_FLOAT | BASS_STREAM_DECODE );
+	if ( 0 != stream ) {
+		// The stream length & bitrate are taken from the stream headers (e.g. the MP3 Xing/VBRI/LAME header), without decoding any audio.
+		BASS_CHANNELINFO info = {};
+		BASS_ChannelGetInfo( stream, &info );
+		properties.SampleRate = static_cast<long>( info.freq );
+		properties.BitsPerSample = static_cast<long>( info.origres );
+		properties.Channels = static_cast<long>( info.chans );
+		if ( const QWORD bytes = BASS_ChannelGetLength( stream, BASS_POS_BYTE ); -1 != bytes ) {
+			properties.Duration = static_cast<float>( BASS_ChannelBytes2Seconds( stream, bytes ) );
+		}
+		float bitrate = 0;
+		if ( TRUE == BASS_ChannelGetAttribute( stream, BASS_ATTRIB_BITRATE, &bitrate ) ) {
+			properties.Bitrate = bitrate;
+		}
+		if ( nullptr != tags ) {
+			tags->clear();
+			tagsRead = ReadStreamTags( stream, *tags );
+		}
+		BASS_StreamFree( stream );
+		success = true;
+	} else {
+		success = Handler::Probe( filename, properties, tags, tagsRead );
+	}
+	return success;
+}
+
+bool HandlerBass::ReadStreamTags( const HSTREAM stream, Tags& tags ) const
+{
+	bool success = false;
+	BASS_CHANNELINFO info = {};
+	BASS_ChannelGetInfo( stream, &info );
+	if ( BASS_CTYPE_STREAM_OGG == info.ctype ) {
+		const char* oggTags = BASS_ChannelGetTags( stream, BASS_TAG_OGG );
+		if ( nullptr != oggTags ) {
+			ReadOggTags( oggTags, tags );
+			success = true;
+		}
+	} else if ( BASS_CTYPE_STREAM_MIDI == info.ctype ) {
+		const char* midiTags = BASS_ChannelGetTags( stream, BASS_TAG_MIDI_TRACK );
+		if ( ( nullptr != midiTags ) && ( strlen( midiTags ) > 0 ) ) {
+			tags.insert( Tags::value_type( Tag::Title, midiTags ) );
+			success = true;
+		}
+	} else if ( BASS_CTYPE_STREAM_DSD == info.ctype ) {
+		const char* dsdArtist = BASS_ChannelGetTags( stream, BASS_TAG_DSD_ARTIST );
+		if ( ( nullptr != dsdArtist ) && ( strlen( dsdArtist ) > 0 ) ) {
+			tags.insert( Tags::value_type( Tag::Artist, dsdArtist ) );
+			success = true;
+		}
+		const char* dsdTitle = BASS_ChannelGetTags( stream, BASS_TAG_DSD_TITLE );
+		if ( ( nullptr != dsdTitle ) && ( strlen( dsdTitle ) > 0 ) ) {
+			tags.insert( Tags::value_type( Tag::Title, dsdTitle ) );
+			success = true;
+		}
+	}
+	return success;
+}
+
 bool HandlerBass::SetTags( const std::wstring& filename, const Tags& tags ) const
 {
 	bool success = false;
@@ -29,6 +29,11 @@ public:
 	// Returns a decoder for 'filename', or nullptr if a decoder cannot be created.
 	Decoder::Ptr OpenDecoder( const std::wstring& filename ) const override;
 
+	// Reads the stream 'properties' and 'tags' from 'filename' using a single BASS stream, returning true if the stream properties were read.
+	// 'tags' - out, tags, or nullptr if the tags are not required.
+	// 'tagsRead' - out, whether the tags were read.
+	bool Probe( const std::wstring& filename, StreamProperties& properties, Tags* tags, bool& tagsRead ) const override;
+
 	// Returns an encoder, or nullptr if an encoder cannot be created.
 	Encoder::Ptr OpenEncoder() const override;
 
@@ -60,6 +65,9 @@ private:
 	// 'tags' - out, tag information.
 	void ReadOggTags( const char* oggTags, Tags& tags ) const;
 
+	// Reads tags from a BASS 'stream' into 'tags', returning true if any tags were read.
+	bool ReadStreamTags( const HSTREAM stream, Tags& tags ) const;
+
 	// Writes Ogg 'tags' to 'filename', returning true if the tags were written.
 	// 'tags' - out, tag information.
 	bool WriteOggTags( const std::wstring& filename, const Tags& tags ) const;
@@ -1,10 +1,13 @@
 #include "HandlerFlac.h"
 
 #include "DecoderFlac.h"
+#include "DecoderFlacParallel.h"
 #include "EncoderFlac.h"
 
 #include "Utility.h"
 
+#include <filesystem>
+
 // Amount of padding to add when writing out FLAC files that don't contain any padding.
 constexpr uint32_t kPaddingSize = 1024;
 
@@ -35,67 +38,121 @@ bool HandlerFlac::GetTags( const std::wstring& filename, Tags& tags ) const
 	FLAC::Metadata::SimpleIterator iterator;
 	if ( iterator.is_valid() &&	iterator.init( WideStringToUTF8( filename ).c_str(), true /*readOnly*/, true /*preserveFileStats*/ ) ) {
 		success = true;
+		do {
+			ReadTags( iterator, tags );
+		} while ( iterator.next() );
+	}
+	return success;
+}
+
+bool HandlerFlac::Probe( const std::wstring& filename, StreamProperties& properties, Tags* tags, bool& tagsRead ) const
+{
+	bool success = false;
+	tagsRead = false;
+	if ( nullptr != tags ) {
+		tags->clear();
+	}
+	FLAC::Metadata::SimpleIterator iterator;
+	if ( iterator.is_valid() &&	iterator.init( WideStringToUTF8( filename ).c_str(), true /*readOnly*/, true /*preserveFileStats*/ ) ) {
+		long long audioOffset = 0;
 		do {
 			const FLAC__MetadataType blockType = iterator.get_block_type();
-			if ( FLAC__METADATA_TYPE_VORBIS_COMMENT == blockType ) {
+			if ( FLAC__METADATA_TYPE_STREAMINFO == blockType ) {
 				FLAC::Metadata::Prototype* block = iterator.get_block();
 				if ( nullptr != block ) {
-					FLAC::Metadata::VorbisComment* vorbisComment = dynamic_cast<FLAC::Metadata::VorbisComment*>( block );
-					if ( ( nullptr != vorbisComment ) && ( vorbisComment->is_valid() ) ) {
-						const unsigned char* vendor = vorbisComment->get_vendor_string();
-						if ( ( nullptr != vendor ) && ( vendor[ 0 ] != 0 ) ) {
-							tags.insert( Tags::value_type( Tag::Version, reinterpret_cast<const char*>( vendor ) ) );
-						}
-						const unsigned int commentCount = vorbisComment->get_num_comments();
-						for ( unsigned int commentIndex = 0; commentIndex < commentCount; commentIndex++ ) {
-							const FLAC::Metadata::VorbisComment::Entry entry = vorbisComment->get_comment( commentIndex );
-							if ( ( entry.is_valid() ) && ( entry.get_field_name_length() != 0 ) && ( entry.get_field_value_length() != 0 ) ) {
-								const char* field = entry.get_field_name();
-								if ( 0 == _stricmp( field, "ARTIST" ) ) {
-									tags.insert( Tags::value_type( Tag::Artist, entry.get_field_value() ) );
-								} else if ( 0 == _stricmp( field, "TITLE" ) ) {
-									tags.insert( Tags::value_type( Tag::Title, entry.get_field_value() ) );
-								} else if ( 0 == _stricmp( field, "ALBUM" ) ) {
-									tags.insert( Tags::value_type( Tag::Album, entry.get_field_value() ) );
-								} else if ( 0 == _stricmp( field, "GENRE" ) ) {
-									tags.insert( Tags::value_type( Tag::Genre, entry.get_field_value() ) );
-								} else if ( ( 0 == _stricmp( field, "YEAR" ) ) || ( 0 == _stricmp( field, "DATE" ) ) ) {
-									tags.insert( Tags::value_type( Tag::Year, entry.get_field_value() ) );
-								} else if ( 0 == _stricmp( field, "COMMENT" ) ) {
-									tags.insert( Tags::value_type( Tag::Comment, entry.get_field_value() ) );
-								} else if ( ( 0 == _stricmp( field, "TRACK" ) ) || ( 0 == _stricmp( field, "TRACKNUMBER" ) ) ) {
-									tags.insert( Tags::value_type( Tag::Track, entry.get_field_value() ) );
-								} else if ( 0 == _stricmp( field, "REPLAYGAIN_TRACK_GAIN" ) ) {
-									tags.insert( Tags::value_type( Tag::GainTrack, entry.get_field_value() ) );
-								} else if ( 0 == _stricmp( field, "REPLAYGAIN_ALBUM_GAIN" ) ) {
-									tags.insert( Tags::value_type( Tag::GainAlbum, entry.get_field_value() ) );
-								}
-							}
+					FLAC::Metadata::StreamInfo* streamInfo = dynamic_cast<FLAC::Metadata::StreamInfo*>( block );
+					if ( ( nullptr != streamInfo ) && ( streamInfo->is_valid() ) ) {
+						properties.SampleRate = static_cast<long>( streamInfo->get_sample_rate() );
+						properties.Channels = static_cast<long>( streamInfo->get_channels() );
+						properties.BitsPerSample = static_cast<long>( streamInfo->get_bits_per_sample() );
+						if ( properties.SampleRate > 0 ) {
+							properties.Duration = static_cast<float>( streamInfo->get_total_samples() ) / properties.SampleRate;
 						}
+						success = true;
 					}
 					delete block;
 					block = nullptr;
 				}
-			} else if ( FLAC__METADATA_TYPE_PICTURE == blockType ) {
-				FLAC::Metadata::Prototype* block = iterator.get_block();
-				if ( nullptr != block ) {
-					FLAC::Metadata::Picture* picture = dynamic_cast<FLAC::Metadata::Picture*>( block );
-					if ( ( nullptr != picture ) && ( picture->is_valid() ) && ( FLAC__STREAM_METADATA_PICTURE_TYPE_FRONT_COVER == picture->get_type() ) ) {
-						const int dataLength = static_cast<int>( picture->get_data_length() );
-						if ( dataLength > 0 ) {
-							const std::string encodedImage = Base64Encode( reinterpret_cast<const BYTE*>( picture->get_data() ), dataLength );
-							if ( !encodedImage.empty() ) {
-								tags.insert( Tags::value_type( Tag::Artwork, encodedImage ) );
-							}
+			} else if ( nullptr != tags ) {
+				ReadTags( iterator, *tags );
+			}
+			if ( iterator.is_last() ) {
+				// The audio stream starts after the last metadata block (the offset is that of the block header, which is 4 bytes).
+				audioOffset = static_cast<long long>( iterator.get_block_offset() ) + 4 + iterator.get_block_length();
+			}
+		} while ( iterator.next() );
+
+		if ( success ) {
+			tagsRead = ( nullptr != tags );
+			std::error_code ec;
+			const long long filesize = static_cast<long long>( std::filesystem::file_size( filename, ec ) );
+			if ( !ec && ( properties.Duration > 0 ) && ( audioOffset > 0 ) && ( audioOffset < filesize ) ) {
+				properties.Bitrate = ( ( filesize - audioOffset ) * 8 ) / ( properties.Duration * 1000 );
+			}
+		}
+	}
+	return success;
+}
+
+void HandlerFlac::ReadTags( FLAC::Metadata::SimpleIterator& iterator, Tags& tags )
+{
+	const FLAC__MetadataType blockType = iterator.get_block_type();
+	if ( FLAC__METADATA_TYPE_VORBIS_COMMENT == blockType ) {
+		FLAC::Metadata::Prototype* block = iterator.get_block();
+		if ( nullptr != block ) {
+			FLAC::Metadata::VorbisComment* vorbisComment = dynamic_cast<FLAC::Metadata::VorbisComment*>( block );
+			if ( ( nullptr != vorbisComment ) && ( vorbisComment->is_valid() ) ) {
+				const unsigned char* vendor = vorbisComment->get_vendor_string();
+				if ( ( nullptr != vendor ) && ( vendor[ 0 ] != 0 ) ) {
+					tags.insert( Tags::value_type( Tag::Version, reinterpret_cast<const char*>( vendor ) ) );
+				}
+				const unsigned int commentCount = vorbisComment->get_num_comments();
+				for ( unsigned int commentIndex = 0; commentIndex < commentCount; commentIndex++ ) {
+					const FLAC::Metadata::VorbisComment::Entry entry = vorbisComment->get_comment( commentIndex );
+					if ( ( entry.is_valid() ) && ( entry.get_field_name_length() != 0 ) && ( entry.get_field_value_length() != 0 ) ) {
+						const char* field = entry.get_field_name();
+						if ( 0 == _stricmp( field, "ARTIST" ) ) {
+							tags.insert( Tags::value_type( Tag::Artist, entry.get_field_value() ) );
+						} else if ( 0 == _stricmp( field, "TITLE" ) ) {
+							tags.insert( Tags::value_type( Tag::Title, entry.get_field_value() ) );
+						} else if ( 0 == _stricmp( field, "ALBUM" ) ) {
+							tags.insert( Tags::value_type( Tag::Album, entry.get_field_value() ) );
+						} else if ( 0 == _stricmp( field, "GENRE" ) ) {
+							tags.insert( Tags::value_type( Tag::Genre, entry.get_field_value() ) );
+						} else if ( ( 0 == _stricmp( field, "YEAR" ) ) || ( 0 == _stricmp( field, "DATE" ) ) ) {
+							tags.insert( Tags::value_type( Tag::Year, entry.get_field_value() ) );
+						} else if ( 0 == _stricmp( field, "COMMENT" ) ) {
+							tags.insert( Tags::value_type( Tag::Comment, entry.get_field_value() ) );
+						} else if ( ( 0 == _stricmp( field, "TRACK" ) ) || ( 0 == _stricmp( field, "TRACKNUMBER" ) ) ) {
+							tags.insert( Tags::value_type( Tag::Track, entry.get_field_value() ) );
+						} else if ( 0 == _stricmp( field, "REPLAYGAIN_TRACK_GAIN" ) ) {
+							tags.insert( Tags::value_type( Tag::GainTrack, entry.get_field_value() ) );
+						} else if ( 0 == _stricmp( field, "REPLAYGAIN_ALBUM_GAIN" ) ) {
+							tags.insert( Tags::value_type( Tag::GainAlbum, entry.get_field_value() ) );
 						}
 					}
-					delete block;
-					block = nullptr;
 				}
 			}
-		} while ( iterator.next() );
+			delete block;
+			block = nullptr;
+		}
+	} else if ( FLAC__METADATA_TYPE_PICTURE == blockType ) {
+		FLAC::Metadata::Prototype* block = iterator.get_block();
+		if ( nullptr != block ) {
+			FLAC::Metadata::Picture* picture = dynamic_cast<FLAC::Metadata::Picture*>( block );
+			if ( ( nullptr != picture ) && ( picture->is_valid() ) && ( FLAC__STREAM_METADATA_PICTURE_TYPE_FRONT_COVER == picture->get_type() ) ) {
+				const int dataLength = static_cast<int>( picture->get_data_length() );
+				if ( dataLength > 0 ) {
+					const std::string encodedImage = Base64Encode( reinterpret_cast<const BYTE*>( picture->get_data() ), dataLength );
+					if ( !encodedImage.empty() ) {
+						tags.insert( Tags::value_type( Tag::Artwork, encodedImage ) );
+					}
+				}
+			}
+			delete block;
+			block = nullptr;
+		}
 	}
-	return success;
 }
 
 bool HandlerFlac::SetTags( const std::wstring& filename, const Tags& tags ) const
@@ -319,6 +376,18 @@ Decoder::Ptr HandlerFlac::OpenDecoder( const std::wstring& filename ) const
 	return stream;
 }
 
+Decoder::Ptr HandlerFlac::OpenBatchDecoder( const std::wstring& filename, const long threadCount ) const
+{
+	Decoder::Ptr decoder;
+	if ( threadCount > 1 ) {
+		try {
+			decoder = std::make_shared<DecoderFlacParallel>( filename, threadCount );
+		} catch ( const std::runtime_error& ) {
+		}
+	}
+	return decoder ? decoder : OpenDecoder( filename );
+}
+
 Encoder::Ptr HandlerFlac::OpenEncoder() const
 {
 	Encoder::Ptr encoder( new EncoderFlac() );
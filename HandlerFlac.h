@@ -26,6 +26,14 @@ public:
 	// Returns a decoder for 'filename', or nullptr if a decoder cannot be created.
 	Decoder::Ptr OpenDecoder( const std::wstring& filename ) const override;
 
+	// Returns a decoder which splits 'filename' into segments decoded on 'threadCount' threads, or a standard decoder if that is not possible.
+	Decoder::Ptr OpenBatchDecoder( const std::wstring& filename, const long threadCount ) const override;
+
+	// Reads the stream 'properties' and 'tags' from the FLAC metadata blocks of 'filename', returning true if the stream properties were read.
+	// 'tags' - out, tags, or nullptr if the tags are not required.
+	// 'tagsRead' - out, whether the tags were read.
+	bool Probe( const std::wstring& filename, StreamProperties& properties, Tags* tags, bool& tagsRead ) const override;
+
 	// Returns an encoder, or nullptr if an encoder cannot be created.
 	Encoder::Ptr OpenEncoder() const override;
 
@@ -47,4 +55,8 @@ public:
 
 	// Called when the application 'settings' have changed.
 	void SettingsChanged( Settings& settings ) override;
+
+private:
+	// Reads any tags from the current metadata block of the 'iterator' into 'tags'.
+	static void ReadTags( FLAC::Metadata::SimpleIterator& iterator, Tags& tags );
 };
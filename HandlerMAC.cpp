@@ -34,32 +34,64 @@ std::set<std::wstring> HandlerMAC::GetSupportedFileExtensions() const
 	return { L"ape", L"apl" };
 }
 
+// Reads the APE tags from 'decompress' into 'tags'.
+static void ReadAPETags( APE::IAPEDecompress& decompress, Tags& tags )
+{
+	auto apeTag = reinterpret_cast<APE::CAPETag*>( decompress.GetInfo( APE::APE_INFO_TAG ) );
+	if ( ( nullptr != apeTag ) && apeTag->GetHasAPETag() ) {
+		int tagIndex = 0;
+		auto tagField = apeTag->GetTagField( tagIndex );
+		while ( nullptr != tagField ) {
+			const auto fieldName = tagField->GetFieldName();
+			const auto tagIter = ( nullptr != fieldName ) ? s_SupportedAPETags.find( fieldName ) : s_SupportedAPETags.end();
+			if ( s_SupportedAPETags.end() != tagIter ) {
+				const auto fieldValue = tagField->GetFieldValue();
+				const int fieldValueSize = tagField->GetFieldValueSize();
+				if ( ( nullptr != fieldValue ) && ( fieldValueSize > 0 ) && tagField->GetIsUTF8Text() ) {
+					const std::string value( fieldValue, fieldValueSize );
+					if ( !value.empty() ) {
+						tags.insert( Tags::value_type( tagIter->second, value ) );
+					}
+				}
+			}
+			tagField = apeTag->GetTagField( ++tagIndex );
+		}
+	}
+}
+
 bool HandlerMAC::GetTags( const std::wstring& filename, Tags& tags ) const
 {
 	bool success = false;
 	std::unique_ptr<APE::IAPEDecompress> decompress( CreateIAPEDecompress( filename.c_str() ) );
 	if ( decompress ) {
-		auto apeTag = reinterpret_cast<APE::CAPETag*>( decompress->GetInfo( APE::APE_INFO_TAG ) );
-		if ( ( nullptr != apeTag ) && apeTag->GetHasAPETag() ) {
-			int tagIndex = 0;
-			auto tagField = apeTag->GetTagField( tagIndex );
-			while ( nullptr != tagField ) {
-				const auto fieldName = tagField->GetFieldName();
-				const auto tagIter = ( nullptr != fieldName ) ? s_SupportedAPETags.find( fieldName ) : s_SupportedAPETags.end();
-				if ( s_SupportedAPETags.end() != tagIter ) {
-					const auto fieldValue = tagField->GetFieldValue();
-					const int fieldValueSize = tagField->GetFieldValueSize();
-					if ( ( nullptr != fieldValue ) && ( fieldValueSize > 0 ) && tagField->GetIsUTF8Text() ) {
-						const std::string value( fieldValue, fieldValueSize );
-						if ( !value.empty() ) {
-							tags.insert( Tags::value_type( tagIter->second, value ) );
-						}
-					}
-				}
-				tagField = apeTag->GetTagField( ++tagIndex );
+		ReadAPETags( *decompress, tags );
+		success = true;
+	}
+	return success;
+}
+
+bool HandlerMAC::Probe( const std::wstring& filename, StreamProperties& properties, Tags* tags, bool& tagsRead ) const
+{
+	bool success = false;
+	tagsRead = false;
+	std::unique_ptr<APE::IAPEDecompress> decompress( CreateIAPEDecompress( filename.c_str() ) );
+	if ( decompress ) {
+		const auto bps = decompress->GetInfo( APE::APE_INFO_BITS_PER_SAMPLE );
+		const auto channels = decompress->GetInfo( APE::APE_INFO_CHANNELS );
+		const auto blockAlign = decompress->GetInfo( APE::APE_INFO_BLOCK_ALIGN );
+		if ( ( channels > 0 ) && ( ( 8 == bps ) || ( 16 == bps ) || ( 24 == bps ) || ( 32 == bps ) ) && ( blockAlign == bps * channels / 8 ) ) {
+			properties.BitsPerSample = static_cast<long>( bps );
+			properties.Channels = static_cast<long>( channels );
+			properties.SampleRate = static_cast<long>( decompress->GetInfo( APE::APE_INFO_SAMPLE_RATE ) );
+			properties.Duration = static_cast<float>( decompress->GetInfo( APE::APE_DECOMPRESS_LENGTH_MS ) ) / 1000;
+			properties.Bitrate = static_cast<float>( decompress->GetInfo( APE::APE_DECOMPRESS_AVERAGE_BITRATE ) );
+			if ( nullptr != tags ) {
+				tags->clear();
+				ReadAPETags( *decompress, *tags );
+				tagsRead = true;
 			}
+			success = true;
 		}
-		success = true;
 	}
 	return success;
 }
@@ -62,44 +62,10 @@ bool HandlerOpus::GetTags( const std::wstring& filename, Tags& tags ) const
 			const std::string& field = comment.first;
 			const std::string& value = comment.second;
 			if ( !field.empty() && !value.empty() ) {
-				if ( 0 == _stricmp( field.c_str(), "ARTIST" ) ) {
-					tags.insert( Tags::value_type( Tag::Artist, value ) );
-				} else if ( 0 == _stricmp( field.c_str(), "TITLE" ) ) {
-					tags.insert( Tags::value_type( Tag::Title, value ) );
-				} else if ( 0 == _stricmp( field.c_str(), "ALBUM" ) ) {
-					tags.insert( Tags::value_type( Tag::Album, value ) );
-				} else if ( 0 == _stricmp( field.c_str(), "GENRE" ) ) {
-					tags.insert( Tags::value_type( Tag::Genre, value ) );
-				} else if ( ( 0 == _stricmp( field.c_str(), "YEAR" ) ) || ( 0 == _stricmp( field.c_str(), "DATE" ) ) ) {
-					tags.insert( Tags::value_type( Tag::Year, value ) );
-				} else if ( 0 == _stricmp( field.c_str(), "COMMENT" ) ) {
-					tags.insert( Tags::value_type( Tag::Comment, value ) );
-				} else if ( ( 0 == _stricmp( field.c_str(), "TRACK" ) ) || ( 0 == _stricmp( field.c_str(), "TRACKNUMBER" ) ) ) {
-					tags.insert( Tags::value_type( Tag::Track, value ) );
-				} else if ( 0 == _stricmp( field.c_str(), "R128_ALBUM_GAIN" ) ) {
-					const std::string gain = R128ToGain( value );
-					if ( !gain.empty() ) {
-						tags.insert( Tags::value_type( Tag::GainAlbum, gain ) );
-					}
-				} else if ( 0 == _stricmp( field.c_str(), "R128_TRACK_GAIN" ) ) {
-					const std::string gain = R128ToGain( value );
-					if ( !gain.empty() ) {
-						tags.insert( Tags::value_type( Tag::GainTrack, gain ) );
-					}
-				} else if ( 0 == _stricmp( field.c_str(), "METADATA_BLOCK_PICTURE" ) ) {
-					std::string mimeType;
-					std::string description;
-					uint32_t width = 0;
-					uint32_t height = 0;
-					uint32_t depth = 0;
-					uint32_t colours = 0;
-					std::vector<uint8_t> picture;
-					if ( opusComment.GetPicture( 3, mimeType, description, width, height, depth, colours, picture ) ) {
-						const std::string encodedImage = Base64Encode( &picture[ 0 ], static_cast<int>( picture.size() ) );
-						if ( !encodedImage.empty() ) {
-							tags.insert( Tags::value_type( Tag::Artwork, encodedImage ) );
-						}
-					}
+				if ( 0 == _stricmp( field.c_str(), "METADATA_BLOCK_PICTURE" ) ) {
+					AddPictureTag( value, tags );
+				} else {
+					AddTag( field, value, tags );
 				}
 			}
 		}
@@ -109,6 +75,91 @@ bool HandlerOpus::GetTags( const std::wstring& filename, Tags& tags ) const
 	return success;
 }
 
+bool HandlerOpus::Probe( const std::wstring& filename, StreamProperties& properties, Tags* tags, bool& tagsRead ) const
+{
+	bool success = false;
+	tagsRead = false;
+	int error = 0;
+	OggOpusFile* opusFile = op_open_file( WideStringToUTF8( filename ).c_str(), &error );
+	if ( nullptr != opusFile ) {
+		if ( const OpusHead* head = op_head( opusFile, -1 /*link*/ ); nullptr != head ) {
+			properties.SampleRate = 48000;
+			properties.Channels = head->channel_count;
+			properties.Duration = static_cast<float>( op_pcm_total( opusFile, -1 /*link*/ ) ) / 48000;
+			if ( const opus_int32 bitrate = op_bitrate( opusFile, -1 /*link*/ ); bitrate > 0 ) {
+				properties.Bitrate = static_cast<float>( bitrate ) / 1000;
+			}
+			success = true;
+		}
+
+		if ( success && ( nullptr != tags ) ) {
+			tags->clear();
+			if ( const OpusTags* opusTags = op_tags( opusFile, -1 /*link*/ ); nullptr != opusTags ) {
+				if ( ( nullptr != opusTags->vendor ) && ( 0 != opusTags->vendor[ 0 ] ) ) {
+					tags->insert( Tags::value_type( Tag::Version, opusTags->vendor ) );
+				}
+				for ( int commentIndex = 0; commentIndex < opusTags->comments; commentIndex++ ) {
+					const std::string comment( opusTags->user_comments[ commentIndex ], opusTags->comment_lengths[ commentIndex ] );
+					if ( const size_t delimiter = comment.find( '=' ); ( std::string::npos != delimiter ) && ( delimiter > 0 ) && ( delimiter + 1 < comment.size() ) ) {
+						const std::string field = comment.substr( 0, delimiter );
+						const std::string value = comment.substr( delimiter + 1 );
+						if ( 0 == _stricmp( field.c_str(), "METADATA_BLOCK_PICTURE" ) ) {
+							AddPictureTag( value, *tags );
+						} else {
+							AddTag( field, value, *tags );
+						}
+					}
+				}
+			}
+			tagsRead = true;
+		}
+		op_free( opusFile );
+	}
+	return success;
+}
+
+void HandlerOpus::AddPictureTag( const std::string& value, Tags& tags )
+{
+	OpusPictureTag picture = {};
+	opus_picture_tag_init( &picture );
+	if ( ( 0 == opus_picture_tag_parse( &picture, value.c_str() ) ) && ( 3 == picture.type ) && ( OP_PIC_FORMAT_URL != picture.format ) && ( picture.data_length > 0 ) ) {
+		const std::string encodedImage = Base64Encode( picture.data, static_cast<int>( picture.data_length ) );
+		if ( !encodedImage.empty() ) {
+			tags.insert( Tags::value_type( Tag::Artwork, encodedImage ) );
+		}
+	}
+	opus_picture_tag_clear( &picture );
+}
+
+void HandlerOpus::AddTag( const std::string& field, const std::string& value, Tags& tags )
+{
+	if ( 0 == _stricmp( field.c_str(), "ARTIST" ) ) {
+		tags.insert( Tags::value_type( Tag::Artist, value ) );
+	} else if ( 0 == _stricmp( field.c_str(), "TITLE" ) ) {
+		tags.insert( Tags::value_type( Tag::Title, value ) );
+	} else if ( 0 == _stricmp( field.c_str(), "ALBUM" ) ) {
+		tags.insert( Tags::value_type( Tag::Album, value ) );
+	} else if ( 0 == _stricmp( field.c_str(), "GENRE" ) ) {
+		tags.insert( Tags::value_type( Tag::Genre, value ) );
+	} else if ( ( 0 == _stricmp( field.c_str(), "YEAR" ) ) || ( 0 == _stricmp( field.c_str(), "DATE" ) ) ) {
+		tags.insert( Tags::value_type( Tag::Year, value ) );
+	} else if ( 0 == _stricmp( field.c_str(), "COMMENT" ) ) {
+		tags.insert( Tags::value_type( Tag::Comment, value ) );
+	} else if ( ( 0 == _stricmp( field.c_str(), "TRACK" ) ) || ( 0 == _stricmp( field.c_str(), "TRACKNUMBER" ) ) ) {
+		tags.insert( Tags::value_type( Tag::Track, value ) );
+	} else if ( 0 == _stricmp( field.c_str(), "R128_ALBUM_GAIN" ) ) {
+		const std::string gain = R128ToGain( value );
+		if ( !gain.empty() ) {
+			tags.insert( Tags::value_type( Tag::GainAlbum, gain ) );
+		}
+	} else if ( 0 == _stricmp( field.c_str(), "R128_TRACK_GAIN" ) ) {
+		const std::string gain = R128ToGain( value );
+		if ( !gain.empty() ) {
+			tags.insert( Tags::value_type( Tag::GainTrack, gain ) );
+		}
+	}
+}
+
 bool HandlerOpus::SetTags( const std::wstring& filename, const Tags& tags ) const
 {
 	bool success = false;
@@ -27,6 +27,11 @@ public:
 	// Returns a decoder for 'filename', or nullptr if a decoder cannot be created.
 	Decoder::Ptr OpenDecoder( const std::wstring& filename ) const override;
 
+	// Reads the stream 'properties' and 'tags' from the Opus headers of 'filename', returning true if the stream properties were read.
+	// 'tags' - out, tags, or nullptr if the tags are not required.
+	// 'tagsRead' - out, whether the tags were read.
+	bool Probe( const std::wstring& filename, StreamProperties& properties, Tags* tags, bool& tagsRead ) const override;
+
 	// Returns an encoder, or nullptr if an encoder cannot be created.
 	Encoder::Ptr OpenEncoder() const override;
 
@@ -71,6 +76,12 @@ private:
 	// Converts the R128 value to an appropriate gain string (returns an empty string if the value could not be converted).
 	static std::string R128ToGain( const std::string& gain );
 
+	// Adds the front cover artwork from a METADATA_BLOCK_PICTURE comment 'value' to 'tags', if the comment contains a front cover image.
+	static void AddPictureTag( const std::string& value, Tags& tags );
+
+	// Adds the Opus comment 'field' & 'value' to 'tags', if it is a supported (non-picture) field.
+	static void AddTag( const std::string& field, const std::string& value, Tags& tags );
+
 	// Called when the encoder configuration dialog is initialised.
 	// 'hwnd' - dialog window handle.
 	// 'settings' - configuration settings.
@@ -40,70 +40,79 @@ std::set<std::wstring> HandlerWavpack::GetSupportedFileExtensions() const
 	return { L"wv" };
 }
 
-bool HandlerWavpack::GetTags( const std::wstring& filename, Tags& tags ) const
+// Returns whether 'filename' starts with a WavPack block header.
+static bool HasWavpackHeader( const std::wstring& filename )
 {
-	bool success = false;
-	
 	bool foundHeader = false;
 	if ( std::ifstream testStream( filename, std::ios::binary | std::ios::in ); testStream.is_open() ) {
 		std::array<char, 4> header = {};
 		testStream.read( header.data(), 4 );
 		foundHeader = ( 'w' == header[ 0 ] ) && ( 'v' == header[ 1 ] ) && ( 'p' == header[ 2 ] ) && ( 'k' == header[ 3 ] );
 	}
+	return foundHeader;
+}
+
+// Reads the tags from the WavPack 'context' into 'tags'.
+static void ReadWavpackTags( WavpackContext* context, Tags& tags )
+{
+	for ( const auto& tagIter : s_SupportedTags ) {
+		const std::string& tagField = tagIter.second;
+		const int tagLength = WavpackGetTagItem( context, tagField.c_str(), nullptr /*buffer*/, 0 /*bufferSize*/ );
+		if ( tagLength > 0 ) {
+			std::vector<char> buffer( tagLength + 1, 0 );
+			if ( tagLength == WavpackGetTagItem( context, tagField.c_str(), buffer.data(), tagLength + 1 ) ) {
+				tags.insert( Tags::value_type( tagIter.first, buffer.data() ) );
+			}
+		}
+	}
+
+	const unsigned char format = WavpackGetFileFormat( context );
+	UINT stringID = 0;
+	switch ( format ) {
+		case WP_FORMAT_WAV : {
+			const int mode = WavpackGetMode( context );
+			stringID = ( mode & MODE_LOSSLESS ) ? ( ( mode & MODE_HYBRID ) ? IDS_WAVPACK_HYBRID : IDS_WAVPACK_LOSSLESS ) : IDS_WAVPACK_LOSSY;
+			break;
+		}
+		case WP_FORMAT_W64 : {
+			stringID = IDS_WAVPACK_W64;
+			break;
+		}
+		case WP_FORMAT_CAF : {
+			stringID = IDS_WAVPACK_CAF;
+			break;
+		}
+		case WP_FORMAT_DFF : {
+			stringID = IDS_WAVPACK_DFF;
+			break;
+		}
+		case WP_FORMAT_DSF : {
+			stringID = IDS_WAVPACK_DSD;
+			break;
+		}
+		default : {
+			break;
+		}
+	}
+	if ( 0 != stringID ) {
+		const int bufferSize = 32;
+		char buffer[ bufferSize ] = {};
+		if ( 0 != LoadStringA( GetModuleHandle( NULL ), stringID, buffer, bufferSize ) ) {
+			tags.insert( Tags::value_type( Tag::Version, buffer ) );
+		}
+	}
+}
 
-	if ( foundHeader ) {
-		char* error = nullptr;
+bool HandlerWavpack::GetTags( const std::wstring& filename, Tags& tags ) const
+{
+	bool success = false;
+	if ( HasWavpackHeader( filename ) ) {
+		char error[ 80 ] = {};
 		const int flags = OPEN_TAGS | OPEN_WVC | OPEN_NORMALIZE | OPEN_DSD_AS_PCM | OPEN_FILE_UTF8;
 		const int offset = 0;
 		WavpackContext* context = WavpackOpenFileInput( WideStringToUTF8( filename ).c_str(), error, flags, offset );
 		if ( nullptr != context ) {
-			for ( const auto& tagIter : s_SupportedTags ) {
-				const std::string& tagField = tagIter.second;
-				const int tagLength = WavpackGetTagItem( context, tagField.c_str(), nullptr /*buffer*/, 0 /*bufferSize*/ );
-				if ( tagLength > 0 ) {
-					std::vector<char> buffer( tagLength + 1, 0 );
-					if ( tagLength == WavpackGetTagItem( context, tagField.c_str(), buffer.data(), tagLength + 1 ) ) {
-						tags.insert( Tags::value_type( tagIter.first, buffer.data() ) );
-					}
-				}
-			}
-
-			const unsigned char format = WavpackGetFileFormat( context );
-			UINT stringID = 0;
-			switch ( format ) {
-				case WP_FORMAT_WAV : {
-					const int mode = WavpackGetMode( context );
-					stringID = ( mode & MODE_LOSSLESS ) ? ( ( mode & MODE_HYBRID ) ? IDS_WAVPACK_HYBRID : IDS_WAVPACK_LOSSLESS ) : IDS_WAVPACK_LOSSY;
-					break;
-				}
-				case WP_FORMAT_W64 : {
-					stringID = IDS_WAVPACK_W64;
-					break;
-				}
-				case WP_FORMAT_CAF : {
-					stringID = IDS_WAVPACK_CAF;
-					break;
-				}
-				case WP_FORMAT_DFF : {
-					stringID = IDS_WAVPACK_DFF;
-					break;
-				}
-				case WP_FORMAT_DSF : {
-					stringID = IDS_WAVPACK_DSD;
-					break;
-				}
-				default : {
-					break;
-				}
-			}
-			if ( 0 != stringID ) {
-				const int bufferSize = 32;
-				char buffer[ bufferSize ] = {};
-				if ( 0 != LoadStringA( GetModuleHandle( NULL ), stringID, buffer, bufferSize ) ) {
-					tags.insert( Tags::value_type( Tag::Version, buffer ) );
-				}
-			}
-
+			ReadWavpackTags( context, tags );
 			WavpackCloseFile( context );
 			success = true;
 		}
@@ -111,6 +120,34 @@ bool HandlerWavpack::GetTags( const std::wstring& filename, Tags& tags ) const
 	return success;
 }
 
+bool HandlerWavpack::Probe( const std::wstring& filename, StreamProperties& properties, Tags* tags, bool& tagsRead ) const
+{
+	bool success = false;
+	tagsRead = false;
+	const bool readTags = ( nullptr != tags ) && HasWavpackHeader( filename );
+	char error[ 80 ] = {};
+	const int flags = ( readTags ? OPEN_TAGS : 0 ) | OPEN_WVC | OPEN_NORMALIZE | OPEN_DSD_AS_PCM | OPEN_FILE_UTF8;
+	const int offset = 0;
+	WavpackContext* context = WavpackOpenFileInput( WideStringToUTF8( filename ).c_str(), error, flags, offset );
+	if ( nullptr != context ) {
+		properties.BitsPerSample = static_cast<long>( WavpackGetBitsPerSample( context ) );
+		properties.Channels = static_cast<long>( WavpackGetNumChannels( context ) );
+		properties.SampleRate = static_cast<long>( WavpackGetSampleRate( context ) );
+		if ( properties.SampleRate > 0 ) {
+			properties.Duration = static_cast<float>( WavpackGetNumSamples64( context ) ) / properties.SampleRate;
+		}
+		properties.Bitrate = static_cast<float>( WavpackGetAverageBitrate( context, TRUE /*count_wvc*/ ) / 1000 );
+		if ( readTags ) {
+			tags->clear();
+			ReadWavpackTags( context, *tags );
+			tagsRead = true;
+		}
+		WavpackCloseFile( context );
+		success = true;
+	}
+	return success;
+}
+
 bool HandlerWavpack::SetTags( const std::wstring& filename, const Tags& tags ) const
 {
 	bool success = false;
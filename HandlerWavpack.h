@@ -24,6 +24,11 @@ public:
 	// Returns a decoder for 'filename', or nullptr if a decoder cannot be created.
 	Decoder::Ptr OpenDecoder( const std::wstring& filename ) const override;
 
+	// Reads the stream 'properties' and 'tags' from the WavPack header & tags of 'filename', returning true if the stream properties were read.
+	// 'tags' - out, tags, or nullptr if the tags are not required.
+	// 'tagsRead' - out, whether the tags were read.
+	bool Probe( const std::wstring& filename, StreamProperties& properties, Tags* tags, bool& tagsRead ) const override;
+
 	// Returns an encoder, or nullptr if an encoder cannot be created.
 	Encoder::Ptr OpenEncoder() const override;
 
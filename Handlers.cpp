@@ -15,6 +15,66 @@
 #include "ShellMetadata.h"
 #include "Utility.h"
 
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string_view>
+
+// Number of bytes to read when determining the content type of a file.
+constexpr size_t s_SniffSize = 64;
+
+// Returns the file extension which corresponds to the content type of 'filename', determined from the file signature, or an empty string if the content type was not recognised.
+static std::wstring SniffFileExtension( const std::wstring& filename )
+{
+	std::wstring extension;
+	if ( std::ifstream stream( filename, std::ios::binary | std::ios::in ); stream.is_open() ) {
+		std::array<unsigned char, s_SniffSize> header = {};
+		stream.read( reinterpret_cast<char*>( header.data() ), header.size() );
+		size_t headerSize = static_cast<size_t>( stream.gcount() );
+
+		if ( ( headerSize >= 10 ) && ( 0 == memcmp( header.data(), "ID3", 3 ) ) ) {
+			// Skip over an ID3v2 tag (the size is a synchsafe integer which excludes the header, and the footer if present).
+			const long long tagSize = 10 + ( ( header[ 5 ] & 0x10 ) ? 10 : 0 ) +
+				( ( header[ 6 ] & 0x7f ) << 21 ) + ( ( header[ 7 ] & 0x7f ) << 14 ) + ( ( header[ 8 ] & 0x7f ) << 7 ) + ( header[ 9 ] & 0x7f );
+			stream.clear();
+			stream.seekg( tagSize );
+			stream.read( reinterpret_cast<char*>( header.data() ), header.size() );
+			headerSize = static_cast<size_t>( stream.gcount() );
+		}
+
+		const auto matches = [ &header, headerSize ] ( const size_t offset, const std::string_view signature )
+		{
+			return ( ( offset + signature.size() ) <= headerSize ) && ( 0 == memcmp( header.data() + offset, signature.data(), signature.size() ) );
+		};
+
+		if ( matches( 0, "fLaC" ) ) {
+			extension = L"flac";
+		} else if ( matches( 0, "OggS" ) ) {
+			// The first page of an Ogg stream contains the codec identification header.
+			if ( matches( 28, "OpusHead" ) ) {
+				extension = L"opus";
+			} else if ( matches( 28, "\x01" "vorbis" ) ) {
+				extension = L"ogg";
+			}
+		} else if ( matches( 0, "MAC " ) ) {
+			extension = L"ape";
+		} else if ( matches( 0, "wvpk" ) ) {
+			extension = L"wv";
+		} else if ( matches( 0, "MPCK" ) || matches( 0, "MP+" ) ) {
+			extension = L"mpc";
+		} else if ( matches( 0, "RIFF" ) && matches( 8, "WAVE" ) ) {
+			extension = L"wav";
+		} else if ( ( headerSize >= 2 ) && ( 0xff == header[ 0 ] ) && ( 0xe0 == ( header[ 1 ] & 0xe0 ) ) && ( 0 != ( header[ 1 ] & 0x06 ) ) ) {
+			// MPEG audio frame sync (excluding layer 0, which is used by ADTS AAC).
+			extension = L"mp3";
+		}
+	}
+	return extension;
+}
+
 Handlers::Handlers() :
 	m_HandlerBASS( new HandlerBass() ),
 	m_HandlerFFmpeg( new HandlerFFmpeg() ),
@@ -30,12 +90,16 @@ Handlers::Handlers() :
 		Handler::Ptr( m_HandlerFFmpeg )
 		} ),
 	m_Decoders(),
-	m_Encoders()
+	m_Encoders(),
+	m_DecoderExtensions(),
+	m_OpenStatistics(),
+	m_OpenStatisticsMutex()
 {
 	for ( const auto& handler : m_Handlers ) {
 		if ( handler ) {
 			if ( handler->IsDecoder() ) {
 				m_Decoders.push_back( handler );
+				AddDecoderExtensions( handler );
 			}
 			if ( handler->IsEncoder() ) {
 				m_Encoders.push_back( handler );
@@ -49,54 +113,164 @@ Handlers::~Handlers()
 }
 
 Handler::Ptr Handlers::FindDecoderHandler( const std::wstring& filename ) const
+{
+	const auto handler = m_DecoderExtensions.find( GetFileExtension( filename ) );
+	return ( m_DecoderExtensions.end() != handler ) ? handler->second : nullptr;
+}
+
+Handler::Ptr Handlers::SniffDecoderHandler( const std::wstring& filename, const Handler::Ptr& rejectedHandler ) const
 {
 	Handler::Ptr handler;
-	const std::wstring extension = GetFileExtension( filename );
-	for ( auto decoder = m_Decoders.begin(); !handler && ( decoder != m_Decoders.end() ); decoder++ ) {
-		std::set<std::wstring> extensions = decoder->get()->GetSupportedFileExtensions();
-		const auto foundHandler = std::find( extensions.begin(), extensions.end(), extension );
-		if ( extensions.end() != foundHandler ) {
-			handler = *decoder;
-			break;
+	if ( const std::wstring extension = SniffFileExtension( filename ); !extension.empty() ) {
+		if ( const auto match = m_DecoderExtensions.find( extension ); ( m_DecoderExtensions.end() != match ) && ( rejectedHandler != match->second ) ) {
+			handler = match->second;
 		}
 	}
 	return handler;
 }
 
-Decoder::Ptr Handlers::OpenDecoder( const std::wstring& filename ) const
+void Handlers::AddDecoderExtensions( const Handler::Ptr& handler )
+{
+	for ( const auto& extension : handler->GetSupportedFileExtensions() ) {
+		m_DecoderExtensions.insert( { extension, handler } );
+	}
+}
+
+Decoder::Ptr Handlers::OpenDecoder( const std::wstring& filename, const long threadCount ) const
 {
 	Decoder::Ptr decoder;
 	if ( IsURL( filename ) ) {
 		decoder = m_HandlerBASS ? m_HandlerBASS->OpenDecoder( filename ) : nullptr;
 	} else if ( !filename.empty() ) {
-		Handler::Ptr handler = FindDecoderHandler( filename );
-		if ( handler ) {
-			decoder = handler->OpenDecoder( filename );
+		const Handler::Ptr extensionHandler = FindDecoderHandler( filename );
+		if ( extensionHandler ) {
+			decoder = OpenDecoder( extensionHandler, filename, threadCount );
 		}
-		if ( !decoder && m_HandlerFFmpeg && ( handler != m_HandlerFFmpeg ) ) {
+		Handler::Ptr sniffedHandler;
+		if ( !decoder ) {
+			// Only check the file signature if the extension was not recognised, or its handler rejected the file.
+			sniffedHandler = SniffDecoderHandler( filename, extensionHandler );
+			if ( sniffedHandler ) {
+				decoder = OpenDecoder( sniffedHandler, filename, threadCount );
+			}
+		}
+		if ( !decoder && m_HandlerFFmpeg && ( m_HandlerFFmpeg != extensionHandler ) && ( m_HandlerFFmpeg != sniffedHandler ) ) {
 			// Try the FFmpeg handler as a catch all.
-			decoder = m_HandlerFFmpeg->OpenDecoder( filename );
+			decoder = OpenDecoder( m_HandlerFFmpeg, filename, threadCount );
 		}
 	}
 	return decoder;
 }
 
+Decoder::Ptr Handlers::OpenDecoder( const Handler::Ptr& handler, const std::wstring& filename, const long threadCount ) const
+{
+	const auto start = std::chrono::steady_clock::now();
+	Decoder::Ptr decoder = ( threadCount > 1 ) ? handler->OpenBatchDecoder( filename, threadCount ) : handler->OpenDecoder( filename );
+	RecordOpen( handler, static_cast<bool>( decoder ), std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now() - start ).count() );
+	return decoder;
+}
+
+bool Handlers::Probe( const Handler::Ptr& handler, const std::wstring& filename, Handler::StreamProperties& properties, Tags* tags, bool& tagsRead ) const
+{
+	const auto start = std::chrono::steady_clock::now();
+	const bool success = handler->Probe( filename, properties, tags, tagsRead );
+	RecordOpen( handler, success, std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now() - start ).count() );
+	return success;
+}
+
+void Handlers::RecordOpen( const Handler::Ptr& handler, const bool success, const uint64_t microseconds ) const
+{
+	std::lock_guard<std::mutex> lock( m_OpenStatisticsMutex );
+	OpenStatistics& statistics = m_OpenStatistics[ handler ];
+	if ( success ) {
+		++statistics.Opens;
+	} else {
+		++statistics.Failures;
+	}
+	statistics.TotalMicroseconds += microseconds;
+	statistics.MaxMicroseconds = std::max( statistics.MaxMicroseconds, microseconds );
+}
+
+std::map<std::wstring, Handlers::OpenStatistics> Handlers::GetOpenStatistics() const
+{
+	std::map<std::wstring, OpenStatistics> result;
+	std::lock_guard<std::mutex> lock( m_OpenStatisticsMutex );
+	for ( const auto& [ handler, statistics ] : m_OpenStatistics ) {
+		result.insert( { handler->GetDescription(), statistics } );
+	}
+	return result;
+}
+
+std::wstring Handlers::GetOpenReport() const
+{
+	std::wstringstream report;
+	for ( const auto& [ description, statistics ] : GetOpenStatistics() ) {
+		if ( const uint64_t count = statistics.Opens + statistics.Failures; count > 0 ) {
+			report << L"Decoder opens (" << description << L"): " << statistics.Opens << L" opened, " << statistics.Failures << L" failed, mean " <<
+				( statistics.TotalMicroseconds / count ) << L"us, max " << statistics.MaxMicroseconds << L"us\r\n";
+		}
+	}
+	return report.str();
+}
+
 bool Handlers::GetTags( const std::wstring& filename, Tags& tags ) const
 {
 	bool success = false;
 	if ( !IsURL( filename ) ) {
 		tags.clear();
-		Handler::Ptr handler = FindDecoderHandler( filename );
-		if ( handler ) {
-			success = handler->GetTags( filename, tags );
+		const Handler::Ptr extensionHandler = FindDecoderHandler( filename );
+		if ( extensionHandler ) {
+			success = extensionHandler->GetTags( filename, tags );
+		}
+		if ( !success ) {
+			// Only check the file signature if the extension was not recognised, or its handler rejected the file.
+			if ( const Handler::Ptr sniffedHandler = SniffDecoderHandler( filename, extensionHandler ); sniffedHandler ) {
+				tags.clear();
+				success = sniffedHandler->GetTags( filename, tags );
+			}
 		}
 		if ( !success ) {
+			tags.clear();
 			success = ShellMetadata::Get( filename, tags );
 		}
 	}
 	return success;
 }
 
+bool Handlers::Probe( const std::wstring& filename, Handler::StreamProperties& properties, Tags* tags, bool& tagsRead ) const
+{
+	bool success = false;
+	tagsRead = false;
+	if ( IsURL( filename ) ) {
+		success = m_HandlerBASS ? m_HandlerBASS->Probe( filename, properties, nullptr /*tags*/, tagsRead ) : false;
+	} else if ( !filename.empty() ) {
+		const Handler::Ptr extensionHandler = FindDecoderHandler( filename );
+		if ( extensionHandler ) {
+			success = Probe( extensionHandler, filename, properties, tags, tagsRead );
+		}
+		Handler::Ptr sniffedHandler;
+		if ( !success ) {
+			// Only check the file signature if the extension was not recognised, or its handler rejected the file.
+			sniffedHandler = SniffDecoderHandler( filename, extensionHandler );
+			if ( sniffedHandler ) {
+				success = Probe( sniffedHandler, filename, properties, tags, tagsRead );
+			}
+		}
+		if ( !success && m_HandlerFFmpeg && ( m_HandlerFFmpeg != extensionHandler ) && ( m_HandlerFFmpeg != sniffedHandler ) ) {
+			// Try the FFmpeg handler as a catch all.
+			success = Probe( m_HandlerFFmpeg, filename, properties, nullptr /*tags*/, tagsRead );
+			if ( const Handler::Ptr tagHandler = sniffedHandler ? sniffedHandler : extensionHandler; success && tagHandler && ( nullptr != tags ) ) {
+				tagsRead = tagHandler->GetTags( filename, *tags );
+			}
+		}
+		if ( success && ( nullptr != tags ) && !tagsRead ) {
+			tags->clear();
+			tagsRead = ShellMetadata::Get( filename, *tags );
+		}
+	}
+	return success;
+}
+
 bool Handlers::SetTags( const MediaInfo& mediaInfo, Library& library ) const
 {
 	bool success = true;
@@ -127,8 +301,13 @@ bool Handlers::SetTags( const MediaInfo& mediaInfo, Library& library ) const
 
     if ( !tagsToWrite.empty() ) {
 		  const FILETIME lastModified = m_PreserveLastModifiedTime ? GetLastModifiedTime( filename ) : FILETIME();
-		  Handler::Ptr handler = FindDecoderHandler( filename );
-      success = handler ? handler->SetTags( filename, tagsToWrite ) : false;
+		  const Handler::Ptr extensionHandler = FindDecoderHandler( filename );
+      success = extensionHandler ? extensionHandler->SetTags( filename, tagsToWrite ) : false;
+		  if ( !success ) {
+			  // Use the handler for the content type if the extension was not recognised, or its handler rejected the file.
+			  const Handler::Ptr sniffedHandler = SniffDecoderHandler( filename, extensionHandler );
+			  success = sniffedHandler ? sniffedHandler->SetTags( filename, tagsToWrite ) : false;
+		  }
 		  if ( !success ) {
 			  success = ShellMetadata::Set( filename, tagsToWrite );
 		  }
@@ -143,9 +322,8 @@ bool Handlers::SetTags( const MediaInfo& mediaInfo, Library& library ) const
 std::set<std::wstring> Handlers::GetAllSupportedFileExtensions() const
 {
 	std::set<std::wstring> fileExtensions;
-	for ( const auto& handler : m_Decoders ) {
-		std::set<std::wstring> handlerExtensions = handler->GetSupportedFileExtensions();
-		fileExtensions.insert( handlerExtensions.begin(), handlerExtensions.end() );
+	for ( const auto& [ extension, handler ] : m_DecoderExtensions ) {
+		fileExtensions.insert( extension );
 	}
 	return fileExtensions;
 }
@@ -168,6 +346,7 @@ void Handlers::AddHandler( Handler::Ptr handler )
 		m_Handlers.push_back( handler );
 		if ( handler->IsDecoder() ) {
 			m_Decoders.push_back( handler );
+			AddDecoderExtensions( handler );
 		}
 		if ( handler->IsEncoder() ) {
 			m_Encoders.push_back( handler );
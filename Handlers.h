@@ -2,7 +2,10 @@
 
 #include "Handler.h"
 
+#include <cstdint>
 #include <list>
+#include <map>
+#include <mutex>
 
 class Library;
 class MediaInfo;
@@ -15,14 +18,38 @@ public:
 
 	virtual ~Handlers();
 
+	// Decoder open statistics for a handler.
+	struct OpenStatistics {
+		// Number of successful opens.
+		uint64_t Opens = 0;
+
+		// Number of failed opens.
+		uint64_t Failures = 0;
+
+		// Total time taken by all opens, in microseconds.
+		uint64_t TotalMicroseconds = 0;
+
+		// Maximum time taken by an open, in microseconds.
+		uint64_t MaxMicroseconds = 0;
+	};
+
 	// Opens a decoder.
 	// 'filename' - file to open.
+	// 'threadCount' - number of threads the decoder can use, if the whole stream is to be read as quickly as possible (e.g. for gain calculation or conversion).
 	// Returns the decoder, or nullptr if the stream could not be opened.
-	Decoder::Ptr OpenDecoder( const std::wstring& filename ) const;
+	Decoder::Ptr OpenDecoder( const std::wstring& filename, const long threadCount = 1 ) const;
 
 	// Reads 'tags' from 'filename', returning true if the tags were read.
 	bool GetTags( const std::wstring& filename, Tags& tags ) const;
 
+	// Reads the stream properties (and optionally the tags) from a file, without decoding any audio.
+	// 'filename' - file to probe.
+	// 'properties' - out, stream properties.
+	// 'tags' - out, tags, or nullptr if the tags are not required.
+	// 'tagsRead' - out, whether the tags were read.
+	// Returns true if the stream properties were read.
+	bool Probe( const std::wstring& filename, Handler::StreamProperties& properties, Tags* tags, bool& tagsRead ) const;
+
 	// Writes tags for 'mediaInfo' using the media 'library', returning true if the tags were written.
 	bool SetTags( const MediaInfo& mediaInfo, Library& library ) const;
 
@@ -48,10 +75,35 @@ public:
 	// Initialises the handlers with the application 'settings'.
 	void Init( Settings& settings );
 
+	// Returns the decoder open (and probe) statistics, by handler description.
+	std::map<std::wstring, OpenStatistics> GetOpenStatistics() const;
+
+	// Returns a text report of the decoder open (and probe) statistics.
+	std::wstring GetOpenReport() const;
+
 private:
 	// Returns a decoder handler supported by the 'filename' extension, or nullptr of there was no match.
 	Handler::Ptr FindDecoderHandler( const std::wstring& filename ) const;
 
+	// Returns a decoder handler for the content type of 'filename', determined from the file signature, or nullptr if the content type was not recognised.
+	// 'rejectedHandler' - handler which has already failed for 'filename' (nullptr is returned if the content type matches this handler).
+	Handler::Ptr SniffDecoderHandler( const std::wstring& filename, const Handler::Ptr& rejectedHandler ) const;
+
+	// Opens a decoder for 'filename' using 'handler', recording the open statistics.
+	// 'threadCount' - number of threads the decoder can use (a batch decoder is opened if more than one).
+	Decoder::Ptr OpenDecoder( const Handler::Ptr& handler, const std::wstring& filename, const long threadCount ) const;
+
+	// Probes 'filename' using 'handler', recording the open statistics.
+	bool Probe( const Handler::Ptr& handler, const std::wstring& filename, Handler::StreamProperties& properties, Tags* tags, bool& tagsRead ) const;
+
+	// Records a decoder open by 'handler'.
+	// 'success' - whether the open was successful.
+	// 'microseconds' - time taken by the open.
+	void RecordOpen( const Handler::Ptr& handler, const bool success, const uint64_t microseconds ) const;
+
+	// Adds the file extensions supported by a decoder 'handler' to the extension table (extensions already in the table are not replaced).
+	void AddDecoderExtensions( const Handler::Ptr& handler );
+
 	// BASS Handler.
 	Handler::Ptr m_HandlerBASS;
 
@@ -67,6 +119,15 @@ private:
 	// Available encoders.
 	Handler::List m_Encoders;
 
+	// Maps a lowercase file extension to the decoder handler which supports it.
+	std::map<std::wstring, Handler::Ptr> m_DecoderExtensions;
+
+	// Decoder open statistics, by handler.
+	mutable std::map<Handler::Ptr, OpenStatistics> m_OpenStatistics;
+
+	// Open statistics mutex.
+	mutable std::mutex m_OpenStatisticsMutex;
+
   // Whether to allow writing of metadata tags to file.
   mutable bool m_WriteTags = false;
 
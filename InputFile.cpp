@@ -0,0 +1,196 @@
+#include "InputFile.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <vector>
+
+// Maximum size of file to memory map (limited for 32-bit builds, so that large files do not exhaust the address space).
+constexpr long long s_MaxMappedSize = ( sizeof( void* ) > 4 ) ? ( 1ll << 40 ) : ( 1ll << 29 );
+
+// Stream buffer size, in bytes, when not mapped.
+constexpr size_t s_StreamBufferSize = 0x10000;
+
+// Whether files on local fixed drives are memory mapped.
+static std::atomic<bool> s_MappingEnabled = true;
+
+// Copies 'size' bytes of mapped file data from 'source' to 'destination'.
+// Returns false if the mapped data could not be read (reading a mapped file raises an in-page error exception if the underlying data is unavailable).
+static bool CopyMappedData( void* destination, const void* source, const size_t size )
+{
+	bool success = true;
+	__try {
+		std::memcpy( destination, source, size );
+	} __except ( ( EXCEPTION_IN_PAGE_ERROR == GetExceptionCode() ) ? EXCEPTION_EXECUTE_HANDLER : EXCEPTION_CONTINUE_SEARCH ) {
+		success = false;
+	}
+	return success;
+}
+
+InputFile::InputFile( const std::wstring& filename ) :
+	m_Filename( filename ),
+	m_FileHandle( INVALID_HANDLE_VALUE ),
+	m_MappingHandle( nullptr ),
+	m_Data( nullptr ),
+	m_Stream( nullptr ),
+	m_Size( 0 ),
+	m_Position( 0 )
+{
+	if ( !IsMappingEnabled() || !CanMap( filename ) || !OpenMapped( filename ) ) {
+		OpenBuffered( filename );
+	}
+}
+
+InputFile::~InputFile()
+{
+	CloseMapped();
+	if ( nullptr != m_Stream ) {
+		fclose( m_Stream );
+	}
+}
+
+void InputFile::SetMappingEnabled( const bool enabled )
+{
+	s_MappingEnabled = enabled;
+}
+
+bool InputFile::IsMappingEnabled()
+{
+	return s_MappingEnabled;
+}
+
+bool InputFile::IsOpen() const
+{
+	return ( nullptr != m_Data ) || ( nullptr != m_Stream );
+}
+
+bool InputFile::IsMapped() const
+{
+	return ( nullptr != m_Data );
+}
+
+size_t InputFile::Read( void* buffer, const size_t size )
+{
+	size_t bytesRead = 0;
+	if ( nullptr != m_Data ) {
+		if ( m_Position < m_Size ) {
+			const size_t bytesToRead = static_cast<size_t>( std::min<long long>( size, m_Size - m_Position ) );
+			if ( CopyMappedData( buffer, m_Data + m_Position, bytesToRead ) ) {
+				bytesRead = bytesToRead;
+				m_Position += bytesRead;
+			} else {
+				// Fall back to buffered reads from the current position, which report a failure to read rather than raising an exception.
+				const long long position = m_Position;
+				CloseMapped();
+				if ( OpenBuffered( m_Filename ) && Seek( position ) ) {
+					bytesRead = fread( buffer, 1, size, m_Stream );
+				}
+			}
+		}
+	} else if ( nullptr != m_Stream ) {
+		bytesRead = fread( buffer, 1, size, m_Stream );
+	}
+	return bytesRead;
+}
+
+bool InputFile::Seek( const long long position )
+{
+	bool success = false;
+	if ( position >= 0 ) {
+		if ( nullptr != m_Data ) {
+			m_Position = position;
+			success = true;
+		} else if ( nullptr != m_Stream ) {
+			success = ( 0 == _fseeki64( m_Stream, position, SEEK_SET ) );
+		}
+	}
+	return success;
+}
+
+long long InputFile::GetPosition() const
+{
+	long long position = 0;
+	if ( nullptr != m_Data ) {
+		position = m_Position;
+	} else if ( nullptr != m_Stream ) {
+		position = _ftelli64( m_Stream );
+	}
+	return position;
+}
+
+long long InputFile::GetSize() const
+{
+	return m_Size;
+}
+
+bool InputFile::IsEOF() const
+{
+	return GetPosition() >= m_Size;
+}
+
+bool InputFile::CanMap( const std::wstring& filename )
+{
+	bool canMap = false;
+	std::vector<wchar_t> volume( MAX_PATH );
+	if ( FALSE != GetVolumePathName( filename.c_str(), volume.data(), static_cast<DWORD>( volume.size() ) ) ) {
+		// Only map files on local fixed drives, as reading from a mapped file which becomes unavailable raises an exception.
+		canMap = ( DRIVE_FIXED == GetDriveType( volume.data() ) );
+	}
+	return canMap;
+}
+
+bool InputFile::OpenMapped( const std::wstring& filename )
+{
+	// Writers are not allowed while the file is mapped (so that a tag update cannot change the file underneath the decoder), and a file which is already open for writing is not mapped.
+	// Tags which cannot be written while a file is playing are held as pending by the library.
+	m_FileHandle = CreateFile( filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL /*securityAttributes*/, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL /*template*/ );
+	if ( INVALID_HANDLE_VALUE != m_FileHandle ) {
+		LARGE_INTEGER fileSize = {};
+		if ( ( FALSE != GetFileSizeEx( m_FileHandle, &fileSize ) ) && ( fileSize.QuadPart > 0 ) && ( fileSize.QuadPart <= s_MaxMappedSize ) ) {
+			m_MappingHandle = CreateFileMapping( m_FileHandle, NULL /*attributes*/, PAGE_READONLY, 0 /*maxSizeHigh*/, 0 /*maxSizeLow*/, NULL /*name*/ );
+			if ( nullptr != m_MappingHandle ) {
+				m_Data = static_cast<const uint8_t*>( MapViewOfFile( m_MappingHandle, FILE_MAP_READ, 0 /*offsetHigh*/, 0 /*offsetLow*/, 0 /*bytesToMap*/ ) );
+				if ( nullptr != m_Data ) {
+					m_Size = fileSize.QuadPart;
+				} else {
+					CloseHandle( m_MappingHandle );
+					m_MappingHandle = nullptr;
+				}
+			}
+		}
+		if ( nullptr == m_Data ) {
+			CloseHandle( m_FileHandle );
+			m_FileHandle = INVALID_HANDLE_VALUE;
+		}
+	}
+	return ( nullptr != m_Data );
+}
+
+void InputFile::CloseMapped()
+{
+	if ( nullptr != m_Data ) {
+		UnmapViewOfFile( m_Data );
+		m_Data = nullptr;
+	}
+	if ( nullptr != m_MappingHandle ) {
+		CloseHandle( m_MappingHandle );
+		m_MappingHandle = nullptr;
+	}
+	if ( INVALID_HANDLE_VALUE != m_FileHandle ) {
+		CloseHandle( m_FileHandle );
+		m_FileHandle = INVALID_HANDLE_VALUE;
+	}
+}
+
+bool InputFile::OpenBuffered( const std::wstring& filename )
+{
+	m_Stream = _wfsopen( filename.c_str(), L"rb", _SH_DENYNO );
+	if ( nullptr != m_Stream ) {
+		setvbuf( m_Stream, nullptr, _IOFBF, s_StreamBufferSize );
+		if ( 0 == _fseeki64( m_Stream, 0, SEEK_END ) ) {
+			m_Size = _ftelli64( m_Stream );
+		}
+		_fseeki64( m_Stream, 0, SEEK_SET );
+	}
+	return ( nullptr != m_Stream );
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "stdafx.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+// Read-only file input for the decoders.
+// Files on local fixed drives are memory mapped, so that reading does not need a system call, or a copy through an intermediate file buffer.
+// Other files (e.g. on network or removable drives), or files which could not be mapped, fall back to buffered reads.
+// Mapped files also fall back to buffered reads if the mapped data cannot be read.
+class InputFile
+{
+public:
+	// 'filename' - file name.
+	explicit InputFile( const std::wstring& filename );
+
+	virtual ~InputFile();
+
+	// Sets whether files on local fixed drives are memory mapped (which they are by default), so that mapped & buffered reads can be compared.
+	// Only affects files opened after the call.
+	static void SetMappingEnabled( const bool enabled );
+
+	// Returns whether files on local fixed drives are memory mapped.
+	static bool IsMappingEnabled();
+
+	// Returns whether the file is open.
+	bool IsOpen() const;
+
+	// Returns whether the file is memory mapped.
+	bool IsMapped() const;
+
+	// Reads data from the current position.
+	// 'buffer' - out, data.
+	// 'size' - number of bytes to read.
+	// Returns the number of bytes read, which is less than 'size' at the end of the file.
+	size_t Read( void* buffer, const size_t size );
+
+	// Seeks to an absolute 'position', in bytes.
+	// Returns whether the seek was successful.
+	bool Seek( const long long position );
+
+	// Returns the current position, in bytes.
+	long long GetPosition() const;
+
+	// Returns the file size, in bytes.
+	long long GetSize() const;
+
+	// Returns whether the current position is at (or beyond) the end of the file.
+	bool IsEOF() const;
+
+private:
+	// Returns whether a file should be memory mapped, based on the type of drive that it is on.
+	// 'filename' - file name.
+	static bool CanMap( const std::wstring& filename );
+
+	// Attempts to memory map a file.
+	// 'filename' - file name.
+	// Returns whether the file was mapped.
+	bool OpenMapped( const std::wstring& filename );
+
+	// Attempts to open a file for buffered reads.
+	// 'filename' - file name.
+	// Returns whether the file was opened.
+	bool OpenBuffered( const std::wstring& filename );
+
+	// Unmaps & closes the file, if it is mapped.
+	void CloseMapped();
+
+	// File name.
+	const std::wstring m_Filename;
+
+	// File handle, when mapped.
+	HANDLE m_FileHandle;
+
+	// File mapping handle, when mapped.
+	HANDLE m_MappingHandle;
+
+	// Mapped file data.
+	const uint8_t* m_Data;
+
+	// Buffered file stream, when not mapped.
+	FILE* m_Stream;
+
+	// File size, in bytes.
+	long long m_Size;
+
+	// Current position, in bytes (when mapped).
+	long long m_Position;
+};
@@ -1,12 +1,21 @@
 #include "Library.h"
 
+#include "MediaSearch.h"
+#include "TrackAnalyser.h"
 #include "Utility.h"
 #include "VUPlayer.h"
 
+#include <array>
 #include <iomanip>
 #include <list>
 #include <sstream>
 
+// The maximum number of writes in a batch transaction.
+constexpr int s_MaxBatchWrites = 500;
+
+// The maximum time for which a batch transaction is left open, before the writes are committed.
+constexpr std::chrono::milliseconds s_MaxBatchInterval( 1000 );
+
 Library::Library( Database& database, const Handlers& handlers ) :
 	m_Database( database ),
 	m_Handlers( handlers ),
@@ -33,7 +42,12 @@ Library::Library( Database& database, const Handlers& handlers ) :
 		Columns::value_type( "GainTrack", Column::GainTrack ),
 		Columns::value_type( "GainAlbum", Column::GainAlbum ),
 		Columns::value_type( "Artwork", Column::Artwork ),
-		Columns::value_type( "Bitrate", Column::Bitrate )
+		Columns::value_type( "Bitrate", Column::Bitrate ),
+		Columns::value_type( "SamplePeak", Column::SamplePeak ),
+		Columns::value_type( "LeadingSilence", Column::LeadingSilence ),
+		Columns::value_type( "TrailingSilence", Column::TrailingSilence ),
+		Columns::value_type( "CrossfadePosition", Column::CrossfadePosition ),
+		Columns::value_type( "AnalysisVersion", Column::AnalysisVersion )
 	} ),
 	m_CDDAColumns( {
 		Columns::value_type( "CDDB", Column::CDDB ),
@@ -49,13 +63,28 @@ Library::Library( Database& database, const Handlers& handlers ) :
 		Columns::value_type( "GainTrack", Column::GainTrack ),
 		Columns::value_type( "GainAlbum", Column::GainAlbum ),
 		Columns::value_type( "Artwork", Column::Artwork )
-	} )
+	} ),
+	m_MediaReplaceQuery( GetUpsertQuery( "Media", m_MediaColumns, "Filename" ) ),
+	m_CDDAReplaceQuery( GetReplaceQuery( "CDDA", m_CDDAColumns ) ),
+	m_BatchDepth( 0 ),
+	m_BatchThread(),
+	m_BatchWrites( 0 ),
+	m_BatchStartTime(),
+	m_BatchNotifications(),
+	m_BatchMutex()
 {
 	UpdateDatabase();
 }
 
 Library::~Library()
 {
+	// Commit any outstanding batch writes.
+	if ( m_BatchDepth > 0 ) {
+		m_BatchDepth = 0;
+		m_BatchNotifications.clear();
+		CommitBatch( false /*beginNext*/ );
+	}
+
 	for ( const auto& filename : m_PendingTags ) {
     if ( MediaInfo mediaInfo( filename ); GetMediaInfo( mediaInfo, false /*checkFileAttributes*/, false /*scanMedia*/, false /*sendNotification*/ ) ) {
 		  if ( m_Handlers.SetTags( mediaInfo, *this ) ) {
@@ -72,6 +101,9 @@ void Library::UpdateDatabase()
 	UpdateMediaTable();
 	UpdateCDDATable();
 	UpdateArtworkTable();
+	UpdateSeekIndexTable();
+	UpdateDirectoryTable();
+	UpdateSearchTable();
 	CreateIndices();
 }
 
@@ -215,6 +247,31 @@ void Library::UpdateArtworkTable()
 	}
 }
 
+void Library::UpdateSeekIndexTable()
+{
+	sqlite3* database = m_Database.GetDatabase();
+	if ( nullptr != database ) {
+		// Create the seek index table (if necessary).
+		const std::string seekIndexTableQuery = "CREATE TABLE IF NOT EXISTS SeekIndex(Filename,Filetime,Filesize,Data, PRIMARY KEY(Filename));";
+		sqlite3_exec( database, seekIndexTableQuery.c_str(), NULL /*callback*/, NULL /*arg*/, NULL /*errMsg*/ );
+	}
+}
+
+void Library::UpdateDirectoryTable()
+{
+	sqlite3* database = m_Database.GetDatabase();
+	if ( nullptr != database ) {
+		// Create the directory journal table (if necessary).
+		const std::string directoryTableQuery = "CREATE TABLE IF NOT EXISTS Directories(Path,Modified,Entries,Hash, PRIMARY KEY(Path));";
+		sqlite3_exec( database, directoryTableQuery.c_str(), NULL /*callback*/, NULL /*arg*/, NULL /*errMsg*/ );
+	}
+}
+
+void Library::UpdateSearchTable()
+{
+	MediaSearch::CreateIndex( m_Database.GetDatabase() );
+}
+
 void Library::CreateIndices()
 {
 	sqlite3* database = m_Database.GetDatabase();
@@ -231,8 +288,8 @@ bool Library::GetMediaInfo( MediaInfo& mediaInfo, const bool checkFileAttributes
 	if ( nullptr != database ) {
 		MediaInfo info( mediaInfo );
 		const std::string query = ( MediaInfo::Source::CDDA == info.GetSource() ) ? "SELECT * FROM CDDA WHERE CDDB=?1 AND Track=?2;" : "SELECT * FROM Media WHERE Filename=?1;";
-		sqlite3_stmt* stmt = nullptr;
-		success = ( SQLITE_OK == sqlite3_prepare_v2( database, query.c_str(), -1 /*nByte*/, &stmt, nullptr /*tail*/ ) );
+		Database::Statement stmt( m_Database, query );
+		success = ( nullptr != stmt );
 		if ( success ) {
 			success = ( MediaInfo::Source::CDDA == mediaInfo.GetSource() ) ?
 				( ( SQLITE_OK == sqlite3_bind_int( stmt, 1 /*param*/, static_cast<int>( info.GetCDDB() ) ) ) && ( SQLITE_OK == sqlite3_bind_int( stmt, 2 /*param*/, static_cast<int>( info.GetTrack() ) ) ) ) :
@@ -250,6 +307,7 @@ bool Library::GetMediaInfo( MediaInfo& mediaInfo, const bool checkFileAttributes
 						success = ( info.GetFiletime() == filetime ) && ( info.GetFilesize() == filesize );
 						if ( !success ) {
 							info = mediaInfo;
+							info.ClearAnalysis();
 						}
 					}
 				}
@@ -259,10 +317,7 @@ bool Library::GetMediaInfo( MediaInfo& mediaInfo, const bool checkFileAttributes
 					if ( success ) {
 						success = UpdateMediaLibrary( info );
 						if ( success && sendNotification ) {
-							VUPlayer* vuplayer = VUPlayer::Get();
-							if ( nullptr != vuplayer ) {
-								vuplayer->OnMediaUpdated( mediaInfo /*previousInfo*/, info /*updatedInfo*/ );
-							}
+							NotifyMediaUpdated( mediaInfo /*previousInfo*/, info /*updatedInfo*/ );
 						}
 					} else if ( removeMissing ) {
 						RemoveFromLibrary( info );
@@ -273,12 +328,25 @@ bool Library::GetMediaInfo( MediaInfo& mediaInfo, const bool checkFileAttributes
 					mediaInfo = info;
 				}
 			}
-			sqlite3_finalize( stmt );
 		}
 	}
 	return success;
 }
 
+bool Library::ScanMedia( MediaInfo& mediaInfo )
+{
+	return ( MediaInfo::Source::File == mediaInfo.GetSource() ) && GetDecoderInfo( mediaInfo, true /*getTags*/ );
+}
+
+bool Library::AddScannedMedia( const MediaInfo& previousInfo, const MediaInfo& scannedInfo, const bool sendNotification )
+{
+	const bool success = UpdateMediaLibrary( scannedInfo );
+	if ( success && sendNotification ) {
+		NotifyMediaUpdated( previousInfo, scannedInfo );
+	}
+	return success;
+}
+
 bool Library::GetFileInfo( const std::wstring& filename, long long& lastModified, long long& fileSize ) const
 {
 	bool success = false;
@@ -306,20 +374,19 @@ bool Library::GetFileInfo( const std::wstring& filename, long long& lastModified
 bool Library::GetDecoderInfo( MediaInfo& mediaInfo, const bool getTags )
 {
 	bool success = false;
-	Decoder::Ptr stream = m_Handlers.OpenDecoder( mediaInfo.GetFilename() );
-	if ( stream ) {
-		mediaInfo.SetBitsPerSample( stream->GetBPS() );
-		mediaInfo.SetChannels( stream->GetChannels() );
-		mediaInfo.SetDuration( stream->GetDuration() );
-		mediaInfo.SetSampleRate( stream->GetSampleRate() );
-		mediaInfo.SetBitrate( stream->GetBitrate() );
-
-    if ( getTags ) {
-		  Tags tags;
-		  if ( m_Handlers.GetTags( mediaInfo.GetFilename(), tags ) ) {
-			  UpdateMediaInfoFromTags( mediaInfo, tags );
-		  }
-    }
+	Handler::StreamProperties properties;
+	Tags tags;
+	bool tagsRead = false;
+	if ( m_Handlers.Probe( mediaInfo.GetFilename(), properties, getTags ? &tags : nullptr, tagsRead ) ) {
+		mediaInfo.SetBitsPerSample( properties.BitsPerSample );
+		mediaInfo.SetChannels( properties.Channels );
+		mediaInfo.SetDuration( properties.Duration );
+		mediaInfo.SetSampleRate( properties.SampleRate );
+		mediaInfo.SetBitrate( properties.Bitrate );
+
+		if ( tagsRead ) {
+			UpdateMediaInfoFromTags( mediaInfo, tags );
+		}
 
 		long long filetime = 0;
 		long long filesize = 0;
@@ -337,6 +404,7 @@ void Library::ExtractMediaInfo( sqlite3_stmt* stmt, MediaInfo& mediaInfo )
 	if ( nullptr != stmt ) {
 		const int columnCount = sqlite3_column_count( stmt );
 		const Columns& columns = GetColumns( mediaInfo.GetSource() );
+		bool isAnalysisCurrent = false;
 		for ( int columnIndex = 0; columnIndex < columnCount; columnIndex++ ) {
 			const auto columnIter = columns.find( sqlite3_column_name( stmt, columnIndex ) );
 			if ( columnIter != columns.end() ) {
@@ -441,9 +509,41 @@ void Library::ExtractMediaInfo( sqlite3_stmt* stmt, MediaInfo& mediaInfo )
 						}
 						break;
 					}
+					case Column::SamplePeak : {
+						if ( SQLITE_NULL != sqlite3_column_type( stmt, columnIndex ) ) {
+							mediaInfo.SetSamplePeak( static_cast<float>( sqlite3_column_double( stmt, columnIndex ) ) );
+						}
+						break;
+					}
+					case Column::LeadingSilence : {
+						if ( SQLITE_NULL != sqlite3_column_type( stmt, columnIndex ) ) {
+							mediaInfo.SetLeadingSilence( static_cast<float>( sqlite3_column_double( stmt, columnIndex ) ) );
+						}
+						break;
+					}
+					case Column::TrailingSilence : {
+						if ( SQLITE_NULL != sqlite3_column_type( stmt, columnIndex ) ) {
+							mediaInfo.SetTrailingSilence( static_cast<float>( sqlite3_column_double( stmt, columnIndex ) ) );
+						}
+						break;
+					}
+					case Column::CrossfadePosition : {
+						if ( SQLITE_NULL != sqlite3_column_type( stmt, columnIndex ) ) {
+							mediaInfo.SetCrossfadePosition( static_cast<float>( sqlite3_column_double( stmt, columnIndex ) ) );
+						}
+						break;
+					}
+					case Column::AnalysisVersion : {
+						isAnalysisCurrent = ( SQLITE_NULL != sqlite3_column_type( stmt, columnIndex ) ) && ( TrackAnalyser::s_Version == sqlite3_column_int( stmt, columnIndex ) );
+						break;
+					}
 				}
 			}
 		}
+		if ( !isAnalysisCurrent ) {
+			// Ignore any results from an earlier version of the track analyser.
+			mediaInfo.ClearAnalysis();
+		}
 	}
 }
 
@@ -455,21 +555,10 @@ bool Library::UpdateMediaLibrary( const MediaInfo& mediaInfo )
 	if ( nullptr != database ) {
 
 		const Columns& columnMap = GetColumns( mediaInfo.GetSource() );
-		const std::string tableName = ( MediaInfo::Source::CDDA == mediaInfo.GetSource() ) ? "CDDA" : "Media";
-
-		std::string columns = " (";
-		std::string values = " VALUES (";
-		int param = 0;
-		for ( const auto& iter : columnMap ) {
-			columns += iter.first + ",";
-			values += "?" + std::to_string( ++param ) + ",";
-		}
-		columns.back() = ')';
-		values.back() = ')';
-		const std::string query = "REPLACE INTO " + tableName + columns + values + ";";
-		sqlite3_stmt* stmt = nullptr;
-		if ( SQLITE_OK == sqlite3_prepare_v2( database, query.c_str(), -1 /*nByte*/, &stmt, nullptr /*tail*/ ) ) {
-			param = 0;
+		const std::string& query = ( MediaInfo::Source::CDDA == mediaInfo.GetSource() ) ? m_CDDAReplaceQuery : m_MediaReplaceQuery;
+		Database::Statement stmt( m_Database, query );
+		if ( nullptr != stmt ) {
+			int param = 0;
 			for ( const auto& iter : columnMap ) {
 				switch ( iter.second ) {
 					case Column::Album : {
@@ -572,6 +661,50 @@ bool Library::UpdateMediaLibrary( const MediaInfo& mediaInfo )
 						}
 						break;
 					}
+					case Column::SamplePeak : {
+						const auto peak = mediaInfo.GetSamplePeak();
+						if ( peak.has_value() ) {
+							sqlite3_bind_double( stmt, ++param, peak.value() );
+						} else {
+							sqlite3_bind_null( stmt, ++param );
+						}
+						break;
+					}
+					case Column::LeadingSilence : {
+						const auto position = mediaInfo.GetLeadingSilence();
+						if ( position.has_value() ) {
+							sqlite3_bind_double( stmt, ++param, position.value() );
+						} else {
+							sqlite3_bind_null( stmt, ++param );
+						}
+						break;
+					}
+					case Column::TrailingSilence : {
+						const auto position = mediaInfo.GetTrailingSilence();
+						if ( position.has_value() ) {
+							sqlite3_bind_double( stmt, ++param, position.value() );
+						} else {
+							sqlite3_bind_null( stmt, ++param );
+						}
+						break;
+					}
+					case Column::CrossfadePosition : {
+						const auto position = mediaInfo.GetCrossfadePosition();
+						if ( position.has_value() ) {
+							sqlite3_bind_double( stmt, ++param, position.value() );
+						} else {
+							sqlite3_bind_null( stmt, ++param );
+						}
+						break;
+					}
+					case Column::AnalysisVersion : {
+						if ( TrackAnalyser::HasAnalysis( mediaInfo ) ) {
+							sqlite3_bind_int( stmt, ++param, TrackAnalyser::s_Version );
+						} else {
+							sqlite3_bind_null( stmt, ++param );
+						}
+						break;
+					}
 					default : {
 						break;
 					}
@@ -579,9 +712,11 @@ bool Library::UpdateMediaLibrary( const MediaInfo& mediaInfo )
 			}
 			const int result = sqlite3_step( stmt );
 			success = ( SQLITE_DONE == result );
-			sqlite3_finalize( stmt );
 		}
 	}
+	if ( success ) {
+		OnBatchWrite();
+	}
 	return success;
 }
 
@@ -604,10 +739,7 @@ void Library::UpdateMediaTags( const MediaInfo& previousMediaInfo, const MediaIn
 		WriteFileTags( mediaInfo );
 	  UpdateMediaLibrary( mediaInfo );
 
-		VUPlayer* vuplayer = VUPlayer::Get();
-		if ( nullptr != vuplayer ) {
-			vuplayer->OnMediaUpdated( previousMediaInfo, mediaInfo );
-		}
+		NotifyMediaUpdated( previousMediaInfo, mediaInfo );
 	}
 }
 
@@ -631,17 +763,19 @@ bool Library::AddArtwork( const std::wstring& id, const std::vector<BYTE>& image
 	if ( !image.empty() ) {
 		sqlite3* database = m_Database.GetDatabase();
 		if ( nullptr != database ) {
-			sqlite3_stmt* stmt = nullptr;
 			const std::string insertQuery = "REPLACE INTO Artwork (ID,Size,Image) VALUES (?1,?2,?3);";
-			if ( SQLITE_OK == sqlite3_prepare_v2( database, insertQuery.c_str(), -1 /*nByte*/, &stmt, nullptr /*tail*/ ) ) {
+			Database::Statement stmt( m_Database, insertQuery );
+			if ( nullptr != stmt ) {
 				sqlite3_bind_text( stmt, 1, WideStringToUTF8( id ).c_str(), -1 /*strLen*/, SQLITE_TRANSIENT );
 				sqlite3_bind_int( stmt, 2, static_cast<int>( image.size() ) );
 				sqlite3_bind_blob( stmt, 3, &image[ 0 ], static_cast<int>( image.size() ), SQLITE_STATIC );
 				success = ( SQLITE_DONE == sqlite3_step( stmt ) );
-				sqlite3_finalize( stmt );
 			}
 		}
 	}
+	if ( success ) {
+		OnBatchWrite();
+	}
 	return success;
 }
 
@@ -651,8 +785,8 @@ std::wstring Library::FindArtwork( const std::vector<BYTE>& image )
 	sqlite3* database = m_Database.GetDatabase();
 	if ( nullptr != database ) {
 		std::string query = "SELECT ID,Image FROM Artwork WHERE Size=?1;";
-		sqlite3_stmt* stmt = nullptr;
-		if ( SQLITE_OK == sqlite3_prepare_v2( database, query.c_str(), -1 /*nByte*/, &stmt, nullptr /*tail*/ ) ) {
+		Database::Statement stmt( m_Database, query );
+		if ( nullptr != stmt ) {
 			if ( SQLITE_OK == sqlite3_bind_int( stmt, 1 /*param*/, static_cast<int>( image.size() ) ) ) {
 				while ( SQLITE_ROW == sqlite3_step( stmt ) ) {
 					const size_t numBytes = static_cast<size_t>( sqlite3_column_bytes( stmt, 1 /*columnIndex*/ ) );
@@ -669,8 +803,6 @@ std::wstring Library::FindArtwork( const std::vector<BYTE>& image )
 					}
 				}
 			}
-			sqlite3_finalize( stmt );
-			stmt = nullptr;
 		}
 	}
 	return result;
@@ -684,8 +816,8 @@ std::vector<BYTE> Library::GetMediaArtwork( const MediaInfo& mediaInfo )
 		sqlite3* database = m_Database.GetDatabase();
 		if ( nullptr != database ) {
 			const std::string query = "SELECT Image FROM Artwork WHERE ID=?1;";
-			sqlite3_stmt* stmt = nullptr;
-			if ( SQLITE_OK == sqlite3_prepare_v2( database, query.c_str(), -1 /*nByte*/, &stmt, nullptr /*tail*/ ) ) {
+			Database::Statement stmt( m_Database, query );
+			if ( nullptr != stmt ) {
 				if ( SQLITE_OK == sqlite3_bind_text( stmt, 1 /*param*/, WideStringToUTF8( artworkID ).c_str(), -1 /*strLen*/, SQLITE_TRANSIENT ) ) {
 					if ( SQLITE_ROW == sqlite3_step( stmt ) ) {
 						const size_t numBytes = static_cast<size_t>( sqlite3_column_bytes( stmt, 0 /*columnIndex*/ ) );
@@ -698,8 +830,6 @@ std::vector<BYTE> Library::GetMediaArtwork( const MediaInfo& mediaInfo )
 						}
 					}
 				}
-				sqlite3_finalize( stmt );
-				stmt = nullptr;
 			}
 		}
 	}
@@ -731,8 +861,8 @@ std::set<std::wstring> Library::GetArtists()
 	sqlite3* database = m_Database.GetDatabase();
 	if ( nullptr != database ) {
 		const std::string query = "SELECT DISTINCT Artist FROM Media;";
-		sqlite3_stmt* stmt = nullptr;
-		if ( SQLITE_OK == sqlite3_prepare_v2( database, query.c_str(), -1 /*nByte*/, &stmt, nullptr /*tail*/ ) ) {
+		Database::Statement stmt( m_Database, query );
+		if ( nullptr != stmt ) {
 			while ( SQLITE_ROW == sqlite3_step( stmt ) ) {
 				if ( const char* text = reinterpret_cast<const char*>( sqlite3_column_text( stmt, 0 /*columnIndex*/ ) ); nullptr != text ) {
 					const std::wstring artist = UTF8ToWideString( text );
@@ -741,8 +871,6 @@ std::set<std::wstring> Library::GetArtists()
 					}
 				}
 			}
-			sqlite3_finalize( stmt );
-			stmt = nullptr;
 		}
 	}
 	return artists;
@@ -754,8 +882,8 @@ std::set<std::wstring> Library::GetAlbums()
 	sqlite3* database = m_Database.GetDatabase();
 	if ( nullptr != database ) {
 		const std::string query = "SELECT DISTINCT Album FROM Media;";
-		sqlite3_stmt* stmt = nullptr;
-		if ( SQLITE_OK == sqlite3_prepare_v2( database, query.c_str(), -1 /*nByte*/, &stmt, nullptr /*tail*/ ) ) {
+		Database::Statement stmt( m_Database, query );
+		if ( nullptr != stmt ) {
 			while ( SQLITE_ROW == sqlite3_step( stmt ) ) {
 				if ( const char* text = reinterpret_cast<const char*>( sqlite3_column_text( stmt, 0 /*columnIndex*/ ) ); nullptr != text ) {
 					const std::wstring album = UTF8ToWideString( text );
@@ -764,8 +892,6 @@ std::set<std::wstring> Library::GetAlbums()
 					}
 				}
 			}
-			sqlite3_finalize( stmt );
-			stmt = nullptr;
 		}
 	}
 	return albums;
@@ -777,8 +903,8 @@ std::set<std::wstring> Library::GetAlbums( const std::wstring artist )
 	sqlite3* database = m_Database.GetDatabase();
 	if ( nullptr != database ) {
 		const std::string query = "SELECT Album FROM Media WHERE Artist=?1;";
-		sqlite3_stmt* stmt = nullptr;
-		if ( SQLITE_OK == sqlite3_prepare_v2( database, query.c_str(), -1 /*nByte*/, &stmt, nullptr /*tail*/ ) ) {
+		Database::Statement stmt( m_Database, query );
+		if ( nullptr != stmt ) {
 			if ( SQLITE_OK == sqlite3_bind_text( stmt, 1 /*param*/, WideStringToUTF8( artist ).c_str(), -1 /*strLen*/, SQLITE_TRANSIENT ) ) {
 				while ( SQLITE_ROW == sqlite3_step( stmt ) ) {
 					if ( const char* text = reinterpret_cast<const char*>( sqlite3_column_text( stmt, 0 /*columnIndex*/ ) ); nullptr != text ) {
@@ -789,8 +915,6 @@ std::set<std::wstring> Library::GetAlbums( const std::wstring artist )
 					}
 				}
 			}
-			sqlite3_finalize( stmt );
-			stmt = nullptr;
 		}
 	}
 	return albums;
@@ -802,8 +926,8 @@ std::set<std::wstring> Library::GetGenres()
 	sqlite3* database = m_Database.GetDatabase();
 	if ( nullptr != database ) {
 		const std::string query = "SELECT DISTINCT Genre FROM Media;";
-		sqlite3_stmt* stmt = nullptr;
-		if ( SQLITE_OK == sqlite3_prepare_v2( database, query.c_str(), -1 /*nByte*/, &stmt, nullptr /*tail*/ ) ) {
+		Database::Statement stmt( m_Database, query );
+		if ( nullptr != stmt ) {
 			while ( SQLITE_ROW == sqlite3_step( stmt ) ) {
 				if ( const char* text = reinterpret_cast<const char*>( sqlite3_column_text( stmt, 0 /*columnIndex*/ ) ); nullptr != text ) {
 					const std::wstring genre = UTF8ToWideString( text );
@@ -812,8 +936,6 @@ std::set<std::wstring> Library::GetGenres()
 					}
 				}
 			}
-			sqlite3_finalize( stmt );
-			stmt = nullptr;
 		}
 	}
 	return genres;
@@ -825,16 +947,14 @@ std::set<long> Library::GetYears()
 	sqlite3* database = m_Database.GetDatabase();
 	if ( nullptr != database ) {
 		const std::string query = "SELECT DISTINCT Year FROM Media;";
-		sqlite3_stmt* stmt = nullptr;
-		if ( SQLITE_OK == sqlite3_prepare_v2( database, query.c_str(), -1 /*nByte*/, &stmt, nullptr /*tail*/ ) ) {
+		Database::Statement stmt( m_Database, query );
+		if ( nullptr != stmt ) {
 			while ( SQLITE_ROW == sqlite3_step( stmt ) ) {
 				const long year = static_cast<long>( sqlite3_column_int( stmt, 0 /*columnIndex*/ ) );
 				if ( ( year >= MINYEAR ) && ( year <= MAXYEAR ) ) { 
 					years.insert( year );
 				}
 			}
-			sqlite3_finalize( stmt );
-			stmt = nullptr;
 		}
 	}
 	return years;
@@ -846,8 +966,8 @@ MediaInfo::List Library::GetMediaByArtist( const std::wstring& artist )
 	sqlite3* database = m_Database.GetDatabase();
 	if ( nullptr != database ) {
 		const std::string query = "SELECT * FROM Media WHERE Artist=?1 ORDER BY Filename;";
-		sqlite3_stmt* stmt = nullptr;
-		if ( SQLITE_OK == sqlite3_prepare_v2( database, query.c_str(), -1 /*nByte*/, &stmt, nullptr /*tail*/ ) ) {
+		Database::Statement stmt( m_Database, query );
+		if ( nullptr != stmt ) {
 			if ( SQLITE_OK == sqlite3_bind_text( stmt, 1 /*param*/, WideStringToUTF8( artist ).c_str(), -1 /*strLen*/, SQLITE_TRANSIENT ) ) {
 				while ( SQLITE_ROW == sqlite3_step( stmt ) ) {
 					MediaInfo mediaInfo;
@@ -855,8 +975,6 @@ MediaInfo::List Library::GetMediaByArtist( const std::wstring& artist )
 					mediaList.push_back( mediaInfo );
 				}
 			}
-			sqlite3_finalize( stmt );
-			stmt = nullptr;
 		}
 	}
 	return mediaList;
@@ -868,8 +986,8 @@ MediaInfo::List Library::GetMediaByAlbum( const std::wstring& album )
 	sqlite3* database = m_Database.GetDatabase();
 	if ( nullptr != database ) {
 		const std::string query = "SELECT * FROM Media WHERE Album=?1 ORDER BY Filename;";
-		sqlite3_stmt* stmt = nullptr;
-		if ( SQLITE_OK == sqlite3_prepare_v2( database, query.c_str(), -1 /*nByte*/, &stmt, nullptr /*tail*/ ) ) {
+		Database::Statement stmt( m_Database, query );
+		if ( nullptr != stmt ) {
 			if ( SQLITE_OK == sqlite3_bind_text( stmt, 1 /*param*/, WideStringToUTF8( album ).c_str(), -1 /*strLen*/, SQLITE_TRANSIENT ) ) {
 				while ( SQLITE_ROW == sqlite3_step( stmt ) ) {
 					MediaInfo mediaInfo;
@@ -877,8 +995,6 @@ MediaInfo::List Library::GetMediaByAlbum( const std::wstring& album )
 					mediaList.push_back( mediaInfo );
 				}
 			}
-			sqlite3_finalize( stmt );
-			stmt = nullptr;
 		}
 	}
 	return mediaList;
@@ -890,8 +1006,8 @@ MediaInfo::List Library::GetMediaByArtistAndAlbum( const std::wstring& artist, c
 	sqlite3* database = m_Database.GetDatabase();
 	if ( nullptr != database ) {
 		const std::string query = "SELECT * FROM Media WHERE Artist=?1 AND Album=?2 ORDER BY Filename;";
-		sqlite3_stmt* stmt = nullptr;
-		if ( SQLITE_OK == sqlite3_prepare_v2( database, query.c_str(), -1 /*nByte*/, &stmt, nullptr /*tail*/ ) ) {
+		Database::Statement stmt( m_Database, query );
+		if ( nullptr != stmt ) {
 			if ( ( SQLITE_OK == sqlite3_bind_text( stmt, 1 /*param*/, WideStringToUTF8( artist ).c_str(), -1 /*strLen*/, SQLITE_TRANSIENT ) ) &&
 					( SQLITE_OK == sqlite3_bind_text( stmt, 2 /*param*/, WideStringToUTF8( album ).c_str(), -1 /*strLen*/, SQLITE_TRANSIENT ) ) ) {
 				while ( SQLITE_ROW == sqlite3_step( stmt ) ) {
@@ -900,8 +1016,6 @@ MediaInfo::List Library::GetMediaByArtistAndAlbum( const std::wstring& artist, c
 					mediaList.push_back( mediaInfo );
 				}
 			}
-			sqlite3_finalize( stmt );
-			stmt = nullptr;
 		}
 	}
 	return mediaList;
@@ -913,8 +1027,8 @@ MediaInfo::List Library::GetMediaByGenre( const std::wstring& genre )
 	sqlite3* database = m_Database.GetDatabase();
 	if ( nullptr != database ) {
 		const std::string query = "SELECT * FROM Media WHERE Genre=?1 ORDER BY Filename;";
-		sqlite3_stmt* stmt = nullptr;
-		if ( SQLITE_OK == sqlite3_prepare_v2( database, query.c_str(), -1 /*nByte*/, &stmt, nullptr /*tail*/ ) ) {
+		Database::Statement stmt( m_Database, query );
+		if ( nullptr != stmt ) {
 			if ( SQLITE_OK == sqlite3_bind_text( stmt, 1 /*param*/, WideStringToUTF8( genre ).c_str(), -1 /*strLen*/, SQLITE_TRANSIENT ) ) {
 				while ( SQLITE_ROW == sqlite3_step( stmt ) ) {
 					MediaInfo mediaInfo;
@@ -922,8 +1036,6 @@ MediaInfo::List Library::GetMediaByGenre( const std::wstring& genre )
 					mediaList.push_back( mediaInfo );
 				}
 			}
-			sqlite3_finalize( stmt );
-			stmt = nullptr;
 		}
 	}
 	return mediaList;
@@ -936,8 +1048,8 @@ MediaInfo::List Library::GetMediaByYear( const long year )
 		sqlite3* database = m_Database.GetDatabase();
 		if ( nullptr != database ) {
 			const std::string query = "SELECT * FROM Media WHERE Year=?1 ORDER BY Filename;";
-			sqlite3_stmt* stmt = nullptr;
-			if ( SQLITE_OK == sqlite3_prepare_v2( database, query.c_str(), -1 /*nByte*/, &stmt, nullptr /*tail*/ ) ) {
+			Database::Statement stmt( m_Database, query );
+			if ( nullptr != stmt ) {
 				if ( SQLITE_OK == sqlite3_bind_int( stmt, 1 /*param*/, static_cast<int>( year ) ) ) {
 					while ( SQLITE_ROW == sqlite3_step( stmt ) ) {
 						MediaInfo mediaInfo;
@@ -945,8 +1057,6 @@ MediaInfo::List Library::GetMediaByYear( const long year )
 						mediaList.push_back( mediaInfo );
 					}
 				}
-				sqlite3_finalize( stmt );
-				stmt = nullptr;
 			}
 		}
 	}
@@ -959,15 +1069,13 @@ MediaInfo::List Library::GetAllMedia()
 	sqlite3* database = m_Database.GetDatabase();
 	if ( nullptr != database ) {
 		const std::string query = "SELECT * FROM Media ORDER BY Filename;";
-		sqlite3_stmt* stmt = nullptr;
-		if ( SQLITE_OK == sqlite3_prepare_v2( database, query.c_str(), -1 /*nByte*/, &stmt, nullptr /*tail*/ ) ) {
+		Database::Statement stmt( m_Database, query );
+		if ( nullptr != stmt ) {
 			while ( SQLITE_ROW == sqlite3_step( stmt ) ) {
 				MediaInfo mediaInfo;
 				ExtractMediaInfo( stmt, mediaInfo );
 				mediaList.push_back( mediaInfo );
 			}
-			sqlite3_finalize( stmt );
-			stmt = nullptr;
 		}
 	}
 	return mediaList;
@@ -979,15 +1087,35 @@ MediaInfo::List Library::GetStreams()
 	sqlite3* database = m_Database.GetDatabase();
 	if ( nullptr != database ) {
 		const std::string query = "SELECT * FROM Media WHERE Filename LIKE 'http:%' OR Filename LIKE 'https:%' OR Filename LIKE 'ftp:%' ORDER BY Filename COLLATE NOCASE;";
-		sqlite3_stmt* stmt = nullptr;
-		if ( SQLITE_OK == sqlite3_prepare_v2( database, query.c_str(), -1 /*nByte*/, &stmt, nullptr /*tail*/ ) ) {
+		Database::Statement stmt( m_Database, query );
+		if ( nullptr != stmt ) {
 			while ( SQLITE_ROW == sqlite3_step( stmt ) ) {
 				MediaInfo mediaInfo;
 				ExtractMediaInfo( stmt, mediaInfo );
 				mediaList.push_back( mediaInfo );
 			}
-			sqlite3_finalize( stmt );
-			stmt = nullptr;
+		}
+	}
+	return mediaList;
+}
+
+MediaInfo::List Library::Search( const std::wstring& text, const int limit )
+{
+	MediaInfo::List mediaList;
+	sqlite3* database = m_Database.GetDatabase();
+	const std::string matchQuery = MediaSearch::GetMatchQuery( WideStringToUTF8( text ) );
+	if ( ( nullptr != database ) && !matchQuery.empty() && ( limit > 0 ) ) {
+		const bool ranked = MediaSearch::CanRank( database, matchQuery );
+		Database::Statement stmt( m_Database, MediaSearch::GetSelectQuery( ranked ) );
+		if ( nullptr != stmt ) {
+			if ( ( SQLITE_OK == sqlite3_bind_text( stmt, 1 /*param*/, matchQuery.c_str(), -1 /*strLen*/, SQLITE_TRANSIENT ) ) &&
+					( SQLITE_OK == sqlite3_bind_int( stmt, 2 /*param*/, limit ) ) ) {
+				while ( SQLITE_ROW == sqlite3_step( stmt ) ) {
+					MediaInfo mediaInfo;
+					ExtractMediaInfo( stmt, mediaInfo );
+					mediaList.push_back( mediaInfo );
+				}
+			}
 		}
 	}
 	return mediaList;
@@ -999,11 +1127,10 @@ bool Library::GetArtistExists( const std::wstring& artist )
 	sqlite3* database = m_Database.GetDatabase();
 	if ( nullptr != database ) {
 		const std::string query = "SELECT 1 FROM Media WHERE EXISTS( SELECT 1 FROM Media WHERE Artist=?1 );";
-		sqlite3_stmt* stmt = nullptr;
-		exists = ( SQLITE_OK == sqlite3_prepare_v2( database, query.c_str(), -1 /*nByte*/, &stmt, nullptr /*tail*/ ) ) &&
+		Database::Statement stmt( m_Database, query );
+		exists = ( nullptr != stmt ) &&
 				( SQLITE_OK == sqlite3_bind_text( stmt, 1 /*param*/, WideStringToUTF8( artist ).c_str(), -1 /*strLen*/, SQLITE_TRANSIENT ) ) &&
 				( SQLITE_ROW == sqlite3_step( stmt ) );
-		sqlite3_finalize( stmt );
 	}
 	return exists;
 }
@@ -1014,11 +1141,10 @@ bool Library::GetAlbumExists( const std::wstring& album )
 	sqlite3* database = m_Database.GetDatabase();
 	if ( nullptr != database ) {
 		const std::string query = "SELECT 1 FROM Media WHERE EXISTS( SELECT 1 FROM Media WHERE Album=?1 );";
-		sqlite3_stmt* stmt = nullptr;
-		exists = ( SQLITE_OK == sqlite3_prepare_v2( database, query.c_str(), -1 /*nByte*/, &stmt, nullptr /*tail*/ ) ) &&
+		Database::Statement stmt( m_Database, query );
+		exists = ( nullptr != stmt ) &&
 				( SQLITE_OK == sqlite3_bind_text( stmt, 1 /*param*/, WideStringToUTF8( album ).c_str(), -1 /*strLen*/, SQLITE_TRANSIENT ) ) &&
 				( SQLITE_ROW == sqlite3_step( stmt ) );
-		sqlite3_finalize( stmt );
 	}
 	return exists;
 }
@@ -1029,12 +1155,11 @@ bool Library::GetArtistAndAlbumExists( const std::wstring& artist, const std::ws
 	sqlite3* database = m_Database.GetDatabase();
 	if ( nullptr != database ) {
 		const std::string query = "SELECT 1 FROM Media WHERE EXISTS( SELECT 1 FROM Media WHERE Artist=?1 AND Album=?2 );";
-		sqlite3_stmt* stmt = nullptr;
-		exists = ( SQLITE_OK == sqlite3_prepare_v2( database, query.c_str(), -1 /*nByte*/, &stmt, nullptr /*tail*/ ) ) &&
+		Database::Statement stmt( m_Database, query );
+		exists = ( nullptr != stmt ) &&
 				( SQLITE_OK == sqlite3_bind_text( stmt, 1 /*param*/, WideStringToUTF8( artist ).c_str(), -1 /*strLen*/, SQLITE_TRANSIENT ) ) &&
 				( SQLITE_OK == sqlite3_bind_text( stmt, 2 /*param*/, WideStringToUTF8( album ).c_str(), -1 /*strLen*/, SQLITE_TRANSIENT ) ) &&
 				( SQLITE_ROW == sqlite3_step( stmt ) );
-		sqlite3_finalize( stmt );
 	}
 	return exists;
 }
@@ -1045,11 +1170,10 @@ bool Library::GetGenreExists( const std::wstring& genre )
 	sqlite3* database = m_Database.GetDatabase();
 	if ( nullptr != database ) {
 		const std::string query = "SELECT 1 FROM Media WHERE EXISTS( SELECT 1 FROM Media WHERE Genre=?1 );";
-		sqlite3_stmt* stmt = nullptr;
-		exists = ( SQLITE_OK == sqlite3_prepare_v2( database, query.c_str(), -1 /*nByte*/, &stmt, nullptr /*tail*/ ) ) &&
+		Database::Statement stmt( m_Database, query );
+		exists = ( nullptr != stmt ) &&
 				( SQLITE_OK == sqlite3_bind_text( stmt, 1 /*param*/, WideStringToUTF8( genre ).c_str(), -1 /*strLen*/, SQLITE_TRANSIENT ) ) &&
 				( SQLITE_ROW == sqlite3_step( stmt ) );
-		sqlite3_finalize( stmt );
 	}
 	return exists;
 }
@@ -1061,11 +1185,10 @@ bool Library::GetYearExists( const long year )
 		sqlite3* database = m_Database.GetDatabase();
 		if ( nullptr != database ) {
 			const std::string query = "SELECT 1 FROM Media WHERE EXISTS( SELECT 1 FROM Media WHERE Year=?1 );";
-			sqlite3_stmt* stmt = nullptr;
-			exists = ( SQLITE_OK == sqlite3_prepare_v2( database, query.c_str(), -1 /*nByte*/, &stmt, nullptr /*tail*/ ) ) &&
+			Database::Statement stmt( m_Database, query );
+			exists = ( nullptr != stmt ) &&
 					( SQLITE_OK == sqlite3_bind_int( stmt, 1 /*param*/, static_cast<int>( year ) ) ) &&
 					( SQLITE_ROW == sqlite3_step( stmt ) );
-			sqlite3_finalize( stmt );
 		}
 	}
 	return exists;
@@ -1078,15 +1201,18 @@ bool Library::RemoveFromLibrary( const MediaInfo& mediaInfo )
 	const std::wstring& filename = mediaInfo.GetFilename();
 	if ( ( nullptr != database ) && !filename.empty() && ( MediaInfo::Source::File == mediaInfo.GetSource() ) ) {
 		const std::string query = "DELETE FROM Media WHERE Filename=?1;";
-		sqlite3_stmt* stmt = nullptr;
-		if ( SQLITE_OK == sqlite3_prepare_v2( database, query.c_str(), -1 /*nByte*/, &stmt, nullptr /*tail*/ ) ) {
+		Database::Statement stmt( m_Database, query );
+		if ( nullptr != stmt ) {
 			if ( SQLITE_OK == sqlite3_bind_text( stmt, 1 /*param*/, WideStringToUTF8( filename ).c_str(), -1 /*strLen*/, SQLITE_TRANSIENT ) ) {
 				// Should be a maximum of one entry.
 				removed = ( SQLITE_DONE == sqlite3_step( stmt ) );
 			}
-			sqlite3_finalize( stmt );
 		}
 	}
+	if ( removed ) {
+		RemoveSeekIndex( WideStringToUTF8( filename ) );
+		OnBatchWrite();
+	}
 	return removed;
 }
 
@@ -1096,6 +1222,39 @@ const Library::Columns& Library::GetColumns( const MediaInfo::Source source ) co
 	return columns;
 }
 
+std::string Library::GetReplaceQuery( const std::string& table, const Columns& columns )
+{
+	std::string columnList = " (";
+	std::string values = " VALUES (";
+	int param = 0;
+	for ( const auto& iter : columns ) {
+		columnList += iter.first + ",";
+		values += "?" + std::to_string( ++param ) + ",";
+	}
+	columnList.back() = ')';
+	values.back() = ')';
+	return "REPLACE INTO " + table + columnList + values + ";";
+}
+
+std::string Library::GetUpsertQuery( const std::string& table, const Columns& columns, const std::string& key )
+{
+	std::string columnList = " (";
+	std::string values = " VALUES (";
+	std::string updates;
+	int param = 0;
+	for ( const auto& iter : columns ) {
+		columnList += iter.first + ",";
+		values += "?" + std::to_string( ++param ) + ",";
+		if ( key != iter.first ) {
+			updates += iter.first + "=excluded." + iter.first + ",";
+		}
+	}
+	columnList.back() = ')';
+	values.back() = ')';
+	updates.pop_back();
+	return "INSERT INTO " + table + columnList + values + " ON CONFLICT(" + key + ") DO UPDATE SET " + updates + ";";
+}
+
 void Library::UpdateMediaInfoFromTags( MediaInfo& mediaInfo, const Tags& tags )
 {
 	for ( const auto& iter : tags ) {
@@ -1201,8 +1360,8 @@ bool Library::UpdateTrackGain( const MediaInfo& previousInfo, const MediaInfo& u
 			const std::string query = ( MediaInfo::Source::CDDA == updatedInfo.GetSource() ) ?
 				"UPDATE CDDA SET GainTrack=?1 WHERE CDDB=?2 AND Track=?3;" :
 				"UPDATE Media SET GainTrack=?1 WHERE Filename=?2;";
-			sqlite3_stmt* stmt = nullptr;
-			updated = ( SQLITE_OK == sqlite3_prepare_v2( database, query.c_str(), -1 /*nByte*/, &stmt, nullptr /*tail*/ ) );
+			Database::Statement stmt( m_Database, query );
+			updated = ( nullptr != stmt );
 			if ( updated ) {
 				const auto gain = updatedInfo.GetGainTrack();
 				updated = gain.has_value() ? ( SQLITE_OK == sqlite3_bind_double( stmt, 1 /*param*/, gain.value() ) ) : ( SQLITE_OK == sqlite3_bind_null( stmt, 1 /*param*/ ) );
@@ -1217,19 +1376,145 @@ bool Library::UpdateTrackGain( const MediaInfo& previousInfo, const MediaInfo& u
 						updated = ( SQLITE_DONE == sqlite3_step( stmt ) );
 					}
 				}
-				sqlite3_finalize( stmt );
 			}
 		}
 	}
-	if ( updated && sendNotification ) {
-		VUPlayer* vuplayer = VUPlayer::Get();
-		if ( nullptr != vuplayer ) {
-			vuplayer->OnMediaUpdated( previousInfo, updatedInfo );
+	if ( updated ) {
+		OnBatchWrite();
+		if ( sendNotification ) {
+			NotifyMediaUpdated( previousInfo, updatedInfo );
+		}
+	}
+	return updated;
+}
+
+bool Library::UpdateTrackAnalysis( const MediaInfo& previousInfo, const MediaInfo& updatedInfo, const bool sendNotification )
+{
+	bool updated = false;
+	const bool analysisChanged = 
+		( previousInfo.GetGainTrack() != updatedInfo.GetGainTrack() ) ||
+		( previousInfo.GetSamplePeak() != updatedInfo.GetSamplePeak() ) ||
+		( previousInfo.GetLeadingSilence() != updatedInfo.GetLeadingSilence() ) ||
+		( previousInfo.GetTrailingSilence() != updatedInfo.GetTrailingSilence() ) ||
+		( previousInfo.GetCrossfadePosition() != updatedInfo.GetCrossfadePosition() );
+	if ( analysisChanged && ( MediaInfo::Source::File == updatedInfo.GetSource() ) ) {
+		sqlite3* database = m_Database.GetDatabase();
+		if ( nullptr != database ) {
+			const std::string query = "UPDATE Media SET GainTrack=?1,SamplePeak=?2,LeadingSilence=?3,TrailingSilence=?4,CrossfadePosition=?5,AnalysisVersion=?6 WHERE Filename=?7 AND Filetime=?8 AND Filesize=?9;";
+			Database::Statement stmt( m_Database, query );
+			updated = ( nullptr != stmt );
+			if ( updated ) {
+				const std::array values = { updatedInfo.GetGainTrack(), updatedInfo.GetSamplePeak(), updatedInfo.GetLeadingSilence(), updatedInfo.GetTrailingSilence(), updatedInfo.GetCrossfadePosition() };
+				int param = 0;
+				for ( auto value = values.begin(); updated && ( values.end() != value ); value++ ) {
+					updated = value->has_value() ? ( SQLITE_OK == sqlite3_bind_double( stmt, ++param, value->value() ) ) : ( SQLITE_OK == sqlite3_bind_null( stmt, ++param ) );
+				}
+				updated = updated &&
+					( SQLITE_OK == ( TrackAnalyser::HasAnalysis( updatedInfo ) ? sqlite3_bind_int( stmt, ++param, TrackAnalyser::s_Version ) : sqlite3_bind_null( stmt, ++param ) ) ) &&
+					( SQLITE_OK == sqlite3_bind_text( stmt, ++param, WideStringToUTF8( updatedInfo.GetFilename() ).c_str(), -1 /*strLen*/, SQLITE_TRANSIENT ) ) &&
+					( SQLITE_OK == sqlite3_bind_int64( stmt, ++param, static_cast<sqlite3_int64>( updatedInfo.GetFiletime() ) ) ) &&
+					( SQLITE_OK == sqlite3_bind_int64( stmt, ++param, static_cast<sqlite3_int64>( updatedInfo.GetFilesize() ) ) );
+				if ( updated ) {
+					updated = ( SQLITE_DONE == sqlite3_step( stmt ) ) && ( sqlite3_changes( database ) > 0 );
+				}
+			}
+		}
+	}
+	if ( updated ) {
+		OnBatchWrite();
+		if ( sendNotification ) {
+			NotifyMediaUpdated( previousInfo, updatedInfo );
 		}
 	}
 	return updated;
 }
 
+bool Library::GetCrossfadeInfo( const std::wstring& filename, float& crossfadePosition, float& leadingSilence )
+{
+	bool success = false;
+	long long filetime = 0;
+	long long filesize = 0;
+	sqlite3* database = m_Database.GetDatabase();
+	if ( ( nullptr != database ) && GetFileInfo( filename, filetime, filesize ) ) {
+		const std::string query = "SELECT CrossfadePosition,LeadingSilence FROM Media WHERE Filename=?1 AND Filetime=?2 AND Filesize=?3 AND AnalysisVersion=?4;";
+		Database::Statement stmt( m_Database, query );
+		success = ( nullptr != stmt );
+		if ( success ) {
+			success = ( SQLITE_OK == sqlite3_bind_text( stmt, 1 /*param*/, WideStringToUTF8( filename ).c_str(), -1 /*strLen*/, SQLITE_TRANSIENT ) ) &&
+				( SQLITE_OK == sqlite3_bind_int64( stmt, 2 /*param*/, static_cast<sqlite3_int64>( filetime ) ) ) &&
+				( SQLITE_OK == sqlite3_bind_int64( stmt, 3 /*param*/, static_cast<sqlite3_int64>( filesize ) ) ) &&
+				( SQLITE_OK == sqlite3_bind_int( stmt, 4 /*param*/, TrackAnalyser::s_Version ) );
+			if ( success ) {
+				success = ( SQLITE_ROW == sqlite3_step( stmt ) ) && ( SQLITE_NULL != sqlite3_column_type( stmt, 0 /*columnIndex*/ ) ) && ( SQLITE_NULL != sqlite3_column_type( stmt, 1 /*columnIndex*/ ) );
+				if ( success ) {
+					crossfadePosition = static_cast<float>( sqlite3_column_double( stmt, 0 /*columnIndex*/ ) );
+					leadingSilence = static_cast<float>( sqlite3_column_double( stmt, 1 /*columnIndex*/ ) );
+				}
+			}
+		}
+	}
+	return success;
+}
+
+SeekIndex::Ptr Library::GetSeekIndex( const std::wstring& filename )
+{
+	SeekIndex::Ptr index;
+	long long filetime = 0;
+	long long filesize = 0;
+	sqlite3* database = m_Database.GetDatabase();
+	if ( ( nullptr != database ) && GetFileInfo( filename, filetime, filesize ) ) {
+		const std::string query = "SELECT Data FROM SeekIndex WHERE Filename=?1 AND Filetime=?2 AND Filesize=?3;";
+		Database::Statement stmt( m_Database, query );
+		if ( nullptr != stmt ) {
+			if ( ( SQLITE_OK == sqlite3_bind_text( stmt, 1 /*param*/, WideStringToUTF8( filename ).c_str(), -1 /*strLen*/, SQLITE_TRANSIENT ) ) &&
+					( SQLITE_OK == sqlite3_bind_int64( stmt, 2 /*param*/, static_cast<sqlite3_int64>( filetime ) ) ) &&
+					( SQLITE_OK == sqlite3_bind_int64( stmt, 3 /*param*/, static_cast<sqlite3_int64>( filesize ) ) ) &&
+					( SQLITE_ROW == sqlite3_step( stmt ) ) ) {
+				const int numBytes = sqlite3_column_bytes( stmt, 0 /*columnIndex*/ );
+				if ( const BYTE* bytes = static_cast<const BYTE*>( sqlite3_column_blob( stmt, 0 /*columnIndex*/ ) ); ( nullptr != bytes ) && ( numBytes > 0 ) ) {
+					index = SeekIndex::FromData( std::vector<uint8_t>( bytes, bytes + numBytes ) );
+				}
+			}
+		}
+	}
+	return index;
+}
+
+bool Library::SetSeekIndex( const std::wstring& filename, const SeekIndex& index )
+{
+	bool success = false;
+	long long filetime = 0;
+	long long filesize = 0;
+	sqlite3* database = m_Database.GetDatabase();
+	if ( ( nullptr != database ) && !index.IsEmpty() && GetFileInfo( filename, filetime, filesize ) ) {
+		const std::vector<uint8_t> data = index.GetData();
+		const std::string query = "REPLACE INTO SeekIndex (Filename,Filetime,Filesize,Data) VALUES (?1,?2,?3,?4);";
+		Database::Statement stmt( m_Database, query );
+		if ( nullptr != stmt ) {
+			sqlite3_bind_text( stmt, 1 /*param*/, WideStringToUTF8( filename ).c_str(), -1 /*strLen*/, SQLITE_TRANSIENT );
+			sqlite3_bind_int64( stmt, 2 /*param*/, static_cast<sqlite3_int64>( filetime ) );
+			sqlite3_bind_int64( stmt, 3 /*param*/, static_cast<sqlite3_int64>( filesize ) );
+			sqlite3_bind_blob( stmt, 4 /*param*/, data.data(), static_cast<int>( data.size() ), SQLITE_STATIC );
+			success = ( SQLITE_DONE == sqlite3_step( stmt ) );
+		}
+	}
+	if ( success ) {
+		OnBatchWrite();
+	}
+	return success;
+}
+
+void Library::RemoveSeekIndex( const std::string& filename )
+{
+	const std::string query = "DELETE FROM SeekIndex WHERE Filename=?1;";
+	Database::Statement stmt( m_Database, query );
+	if ( nullptr != stmt ) {
+		if ( SQLITE_OK == sqlite3_bind_text( stmt, 1 /*param*/, filename.c_str(), -1 /*strLen*/, SQLITE_TRANSIENT ) ) {
+			sqlite3_step( stmt );
+		}
+	}
+}
+
 void Library::UpdateMediaInfoFromDecoder( MediaInfo& mediaInfo, const Decoder& decoder, const bool sendNotification )
 {
 	MediaInfo originalInfo( mediaInfo );
@@ -1250,10 +1535,7 @@ void Library::UpdateMediaInfoFromDecoder( MediaInfo& mediaInfo, const Decoder& d
 	if ( updated ) {
 		updated = UpdateMediaLibrary( mediaInfo );
 		if ( updated && sendNotification ) {
-			VUPlayer* vuplayer = VUPlayer::Get();
-			if ( nullptr != vuplayer ) {
-				vuplayer->OnMediaUpdated( originalInfo, mediaInfo );
-			}
+			NotifyMediaUpdated( originalInfo, mediaInfo );
 		}
 	}
 }
@@ -1284,3 +1566,155 @@ bool Library::HasRecentlyWrittenTag( const std::wstring& filename ) const
 	}
 	return recentTagWrite;
 }
+
+Library::Batch::Batch( Library& library ) :
+	m_Library( library ),
+	m_Started( library.BeginBatch() )
+{
+}
+
+Library::Batch::~Batch()
+{
+	if ( m_Started ) {
+		m_Library.EndBatch();
+	}
+}
+
+bool Library::BeginBatch()
+{
+	std::lock_guard<std::mutex> lock( m_BatchMutex );
+	const bool started = ( 0 == m_BatchDepth ) || ( std::this_thread::get_id() == m_BatchThread );
+	if ( started && ( 0 == m_BatchDepth++ ) ) {
+		if ( sqlite3* database = m_Database.GetDatabase(); ( nullptr != database ) && ( 0 != sqlite3_get_autocommit( database ) ) ) {
+			sqlite3_exec( database, "BEGIN TRANSACTION;", NULL /*callback*/, NULL /*arg*/, NULL /*errMsg*/ );
+		}
+		m_BatchThread = std::this_thread::get_id();
+		m_BatchWrites = 0;
+		m_BatchStartTime = std::chrono::steady_clock::now();
+	}
+	return started;
+}
+
+void Library::EndBatch()
+{
+	bool commit = false;
+	{
+		std::lock_guard<std::mutex> lock( m_BatchMutex );
+		commit = ( m_BatchDepth > 0 ) && ( 0 == --m_BatchDepth );
+	}
+	if ( commit ) {
+		CommitBatch( false /*beginNext*/ );
+	}
+}
+
+void Library::OnBatchWrite()
+{
+	bool commit = false;
+	{
+		std::lock_guard<std::mutex> lock( m_BatchMutex );
+		if ( m_BatchDepth > 0 ) {
+			// A write from another thread shares the batch transaction (as there is a single database connection), so commit it straight away rather than holding it back.
+			commit = ( std::this_thread::get_id() != m_BatchThread ) || ( ++m_BatchWrites >= s_MaxBatchWrites ) || ( ( std::chrono::steady_clock::now() - m_BatchStartTime ) >= s_MaxBatchInterval );
+			if ( sqlite3* database = m_Database.GetDatabase(); !commit && ( nullptr != database ) && ( 0 != sqlite3_get_autocommit( database ) ) ) {
+				// Another writer on the same connection has committed the batch transaction, so begin a new one.
+				sqlite3_exec( database, "BEGIN TRANSACTION;", NULL /*callback*/, NULL /*arg*/, NULL /*errMsg*/ );
+			}
+		}
+	}
+	if ( commit ) {
+		CommitBatch( true /*beginNext*/ );
+	}
+}
+
+void Library::CommitBatch( const bool beginNext )
+{
+	MediaUpdates notifications;
+	{
+		std::lock_guard<std::mutex> lock( m_BatchMutex );
+		if ( sqlite3* database = m_Database.GetDatabase(); nullptr != database ) {
+			// The transaction could already have been committed by another writer on the same connection.
+			if ( 0 == sqlite3_get_autocommit( database ) ) {
+				sqlite3_exec( database, "COMMIT TRANSACTION;", NULL /*callback*/, NULL /*arg*/, NULL /*errMsg*/ );
+			}
+			if ( beginNext && ( m_BatchDepth > 0 ) && ( 0 != sqlite3_get_autocommit( database ) ) ) {
+				sqlite3_exec( database, "BEGIN TRANSACTION;", NULL /*callback*/, NULL /*arg*/, NULL /*errMsg*/ );
+			}
+		}
+		m_BatchWrites = 0;
+		m_BatchStartTime = std::chrono::steady_clock::now();
+		notifications.swap( m_BatchNotifications );
+	}
+
+	if ( !notifications.empty() ) {
+		if ( VUPlayer* vuplayer = VUPlayer::Get(); nullptr != vuplayer ) {
+			vuplayer->OnMediaUpdated( notifications );
+		}
+	}
+}
+
+void Library::NotifyMediaUpdated( const MediaInfo& previousInfo, const MediaInfo& updatedInfo )
+{
+	bool pending = false;
+	{
+		std::lock_guard<std::mutex> lock( m_BatchMutex );
+		pending = ( m_BatchDepth > 0 ) && ( std::this_thread::get_id() == m_BatchThread );
+		if ( pending ) {
+			m_BatchNotifications.push_back( { previousInfo, updatedInfo } );
+		}
+	}
+	if ( VUPlayer* vuplayer = VUPlayer::Get(); !pending && ( nullptr != vuplayer ) ) {
+		vuplayer->OnMediaUpdated( previousInfo, updatedInfo );
+	}
+}
+
+Library::DirectoryJournal Library::GetDirectoryJournal()
+{
+	DirectoryJournal journal;
+	sqlite3* database = m_Database.GetDatabase();
+	if ( nullptr != database ) {
+		const std::string query = "SELECT Path,Modified,Entries,Hash FROM Directories;";
+		Database::Statement stmt( m_Database, query );
+		if ( nullptr != stmt ) {
+			while ( SQLITE_ROW == sqlite3_step( stmt ) ) {
+				if ( const char* path = reinterpret_cast<const char*>( sqlite3_column_text( stmt, 0 /*columnIndex*/ ) ); nullptr != path ) {
+					DirectoryEntry entry;
+					entry.Modified = sqlite3_column_int64( stmt, 1 /*columnIndex*/ );
+					entry.Entries = sqlite3_column_int64( stmt, 2 /*columnIndex*/ );
+					entry.Hash = sqlite3_column_int64( stmt, 3 /*columnIndex*/ );
+					journal.insert( { UTF8ToWideString( path ), entry } );
+				}
+			}
+		}
+	}
+	return journal;
+}
+
+bool Library::UpdateDirectoryJournal( const DirectoryJournal& updated, const std::set<std::wstring>& removed )
+{
+	bool success = false;
+	sqlite3* database = m_Database.GetDatabase();
+	if ( nullptr != database ) {
+		const Batch batch( *this );
+		const std::string removeQuery = "DELETE FROM Directories WHERE Path=?1;";
+		Database::Statement removeStmt( m_Database, removeQuery );
+		success = ( nullptr != removeStmt );
+		for ( auto path = removed.begin(); success && ( removed.end() != path ); path++ ) {
+			success = ( SQLITE_OK == sqlite3_bind_text( removeStmt, 1 /*param*/, WideStringToUTF8( *path ).c_str(), -1 /*strLen*/, SQLITE_TRANSIENT ) ) &&
+				( SQLITE_DONE == sqlite3_step( removeStmt ) );
+			sqlite3_reset( removeStmt );
+		}
+
+		const std::string updateQuery = "REPLACE INTO Directories (Path,Modified,Entries,Hash) VALUES (?1,?2,?3,?4);";
+		Database::Statement updateStmt( m_Database, updateQuery );
+		success = success && ( nullptr != updateStmt );
+		for ( auto entry = updated.begin(); success && ( updated.end() != entry ); entry++ ) {
+			success = ( SQLITE_OK == sqlite3_bind_text( updateStmt, 1 /*param*/, WideStringToUTF8( entry->first ).c_str(), -1 /*strLen*/, SQLITE_TRANSIENT ) ) &&
+				( SQLITE_OK == sqlite3_bind_int64( updateStmt, 2 /*param*/, static_cast<sqlite3_int64>( entry->second.Modified ) ) ) &&
+				( SQLITE_OK == sqlite3_bind_int64( updateStmt, 3 /*param*/, static_cast<sqlite3_int64>( entry->second.Entries ) ) ) &&
+				( SQLITE_OK == sqlite3_bind_int64( updateStmt, 4 /*param*/, static_cast<sqlite3_int64>( entry->second.Hash ) ) ) &&
+				( SQLITE_DONE == sqlite3_step( updateStmt ) );
+			sqlite3_reset( updateStmt );
+		}
+	}
+	return success;
+}
@@ -3,7 +3,11 @@
 #include "Database.h"
 #include "Handlers.h"
 #include "MediaInfo.h"
+#include "SeekIndex.h"
 
+#include <chrono>
+#include <list>
+#include <thread>
 #include <vector>
 
 // Media library
@@ -16,6 +20,29 @@ public:
 
 	virtual ~Library();
 
+	// Media updates, pairing the previous media information with the updated media information.
+	using MediaUpdates = std::list<std::pair<MediaInfo, MediaInfo>>;
+
+	// Groups the library writes made by the calling thread during the lifetime of the object (e.g. during a library scan) into transactions.
+	// A transaction is committed once a number of writes have been made, or an interval has elapsed, and when the last batch object is destroyed.
+	// Media update notifications from the calling thread are held back until the updates have been committed, and then sent together.
+	// Only one thread can batch writes at a time (a batch object created on another thread has no effect), and a write from any other thread commits the current transaction straight away.
+	class Batch
+	{
+	public:
+		// 'library' - media library.
+		explicit Batch( Library& library );
+
+		virtual ~Batch();
+
+	private:
+		// Media library.
+		Library& m_Library;
+
+		// Whether this object started (or joined) a batch on the calling thread.
+		const bool m_Started;
+	};
+
 	// Media library column type.
 	enum class Column {
 		Filename = 1,
@@ -40,6 +67,11 @@ public:
 		Artwork = 20,
 		CDDB = 21,
 		Bitrate = 22,
+		SamplePeak = 23,
+		LeadingSilence = 24,
+		TrailingSilence = 25,
+		CrossfadePosition = 26,
+		AnalysisVersion = 27,
 
 		_Undefined
 	};
@@ -53,6 +85,18 @@ public:
 	// Returns true if media information was returned.
 	bool GetMediaInfo( MediaInfo& mediaInfo, const bool checkFileAttributes = true, const bool scanMedia = true, const bool sendNotification = true, const bool removeMissing = false );
 
+	// Reads the stream properties & tags for 'mediaInfo' from file, without updating the library (e.g. for probing files concurrently during a library scan).
+	// 'mediaInfo' - in/out, media information containing the filename to scan.
+	// Returns true if the file was scanned.
+	bool ScanMedia( MediaInfo& mediaInfo );
+
+	// Adds media information which has been scanned from file to the library.
+	// 'previousInfo' - previous media information.
+	// 'scannedInfo' - scanned media information.
+	// 'sendNotification' - whether to notify the main application if the library has been updated.
+	// Returns true if the library was updated.
+	bool AddScannedMedia( const MediaInfo& previousInfo, const MediaInfo& scannedInfo, const bool sendNotification = true );
+
 	// Updates media information and writes out tag information to file.
 	// 'previousMediaInfo' - previous media information.
 	// 'updatedMediaInfo' - updated media information.
@@ -104,6 +148,11 @@ public:
 	// Returns all network streams contained in the media library.
 	MediaInfo::List GetStreams();
 
+	// Returns the media information matching the search 'text', ordered by relevance (artist, title & album matches rank above genre, comment & filename matches).
+	// Each word of the 'text' matches as a prefix, and all words must match (a search with thousands of matches, such as a single letter, is returned in library order rather than ranked).
+	// 'limit' - maximum number of results.
+	MediaInfo::List Search( const std::wstring& text, const int limit = 1000 );
+
 	// Returns whether the 'artist' exists in the media library.
 	bool GetArtistExists( const std::wstring& artist );
 
@@ -136,6 +185,31 @@ public:
 	// Returns whether the library was updated.
 	bool UpdateTrackGain( const MediaInfo& previousInfo, const MediaInfo& updatedInfo, const bool sendNotification = true );
 
+	// Updates the track analysis information (track gain, sample peak, silence & crossfade positions), if necessary.
+	// The library is only updated if the file time & size of 'updatedInfo' still match the library entry.
+	// 'previousInfo' - previous media information.
+	// 'updatedInfo' - updated media information.
+	// 'sendNotification' - whether to notify the main application if the library has been updated.
+	// Returns whether the library was updated.
+	bool UpdateTrackAnalysis( const MediaInfo& previousInfo, const MediaInfo& updatedInfo, const bool sendNotification = true );
+
+	// Gets the stored crossfade information for a file, as long as the file has not been modified since it was analysed.
+	// 'filename' - media filename.
+	// 'crossfadePosition' - out, crossfade position, in seconds from the start of the track.
+	// 'leadingSilence' - out, position of the first non-silent sample, in seconds.
+	// Returns true if crossfade information was returned.
+	bool GetCrossfadeInfo( const std::wstring& filename, float& crossfadePosition, float& leadingSilence );
+
+	// Returns the stored seek index for a file, or nullptr if there is no index or the file has been modified since the index was built.
+	// 'filename' - media filename.
+	SeekIndex::Ptr GetSeekIndex( const std::wstring& filename );
+
+	// Stores the seek index for a file, keyed on the current file time & size.
+	// 'filename' - media filename.
+	// 'index' - seek index.
+	// Returns true if the seek index was stored.
+	bool SetSeekIndex( const std::wstring& filename, const SeekIndex& index );
+
 	// Updates 'mediaInfo' with 'decoder' information.
 	// 'sendNotification' - whether to notify the main application if the library has been updated.
 	void UpdateMediaInfoFromDecoder( MediaInfo& mediaInfo, const Decoder& decoder, const bool sendNotification = true );
@@ -143,6 +217,30 @@ public:
 	// Returns whether there has been a recent attempt to write the tags for the 'filename'.
 	bool HasRecentlyWrittenTag( const std::wstring& filename ) const;
 
+	// The state of a folder when it was last scanned by the library maintainer.
+	struct DirectoryEntry {
+		// Folder last write time.
+		long long Modified = 0;
+
+		// Number of supported files & subfolders in the folder.
+		long long Entries = 0;
+
+		// Hash of the names, sizes & last write times of the supported files & subfolders in the folder.
+		long long Hash = 0;
+	};
+
+	// Directory journal, mapping a (lowercase) folder path to the state of the folder when it was last scanned.
+	using DirectoryJournal = std::map<std::wstring, DirectoryEntry>;
+
+	// Returns the directory journal.
+	DirectoryJournal GetDirectoryJournal();
+
+	// Updates the directory journal.
+	// 'updated' - folders to add or update.
+	// 'removed' - folders to remove.
+	// Returns true if the journal was updated.
+	bool UpdateDirectoryJournal( const DirectoryJournal& updated, const std::set<std::wstring>& removed );
+
 private:
 	// Media library columns.
 	using Columns = std::map<std::string, Column>;
@@ -159,16 +257,28 @@ private:
 	// Updates the artwork table if necessary.
 	void UpdateArtworkTable();
 
+	// Updates the seek index table if necessary.
+	void UpdateSeekIndexTable();
+
+	// Updates the directory journal table if necessary.
+	void UpdateDirectoryTable();
+
+	// Removes any stored seek index for 'filename'.
+	void RemoveSeekIndex( const std::string& filename );
+
+	// Creates the media search index if necessary.
+	void UpdateSearchTable();
+
 	// Creates indices if necessary.
 	void CreateIndices();
 
 	// Gets the 'lastModified' time and 'fileSize' of 'filename', returning true if the file could be opened.
 	bool GetFileInfo( const std::wstring& filename, long long& lastModified, long long& fileSize ) const;
 
-	// Queries the decoders for media information.
+	// Probes the handlers for media information.
 	// 'mediaInfo' - in/out, media information containing the filename to query.
   // 'getTags' - whether to read file tags.
-	// Returns true if the file was successfully opened by a decoder.
+	// Returns true if the file was successfully probed by a handler.
 	bool GetDecoderInfo( MediaInfo& mediaInfo, const bool getTags );
 
 	// Updates the media library.
@@ -195,12 +305,38 @@ private:
 	// Returns the library columns corresponding to 'source'.
 	const Columns& GetColumns( const MediaInfo::Source source ) const;
 
+	// Returns the query which replaces all the columns of a library row, for the 'columns' in 'table'.
+	static std::string GetReplaceQuery( const std::string& table, const Columns& columns );
+
+	// Returns the query which adds a library row, or updates all the columns of an existing row in place (so that it keeps its row ID), for the 'columns' in 'table'.
+	// 'key' - the column which identifies an existing row.
+	static std::string GetUpsertQuery( const std::string& table, const Columns& columns, const std::string& key );
+
 	// Updates 'mediaInfo' with the 'tags'.
 	void UpdateMediaInfoFromTags( MediaInfo& mediaInfo, const Tags& tags );
 
 	// Updates the time at which the last attempt was made to write the tags for the 'filename'.
 	void SetRecentlyWrittenTag( const std::wstring& filename );
 
+	// Starts a batch of library writes on the calling thread (batches can be nested).
+	// Returns false if another thread owns the current batch, in which case no batch is started.
+	bool BeginBatch();
+
+	// Ends a batch of library writes, committing the writes if this is the outermost batch.
+	void EndBatch();
+
+	// Called after each library write, to commit the current batch if it is due (or if the write was made by a thread other than the batch owner).
+	void OnBatchWrite();
+
+	// Commits the writes in the current batch, and sends any pending media update notifications.
+	// 'beginNext' - whether to begin a new transaction for the next writes in the batch.
+	void CommitBatch( const bool beginNext );
+
+	// Notifies the main app that media information has been updated (or, on the batch owner thread, holds back the notification until the current batch is committed).
+	// 'previousInfo' - previous media information.
+	// 'updatedInfo' - updated media information.
+	void NotifyMediaUpdated( const MediaInfo& previousInfo, const MediaInfo& updatedInfo );
+
 	// Database.
 	Database& m_Database;
 
@@ -224,4 +360,28 @@ private:
 
 	// CD audio columns.
 	Columns m_CDDAColumns;
+
+	// Query which adds or updates a media library row (updating in place, so that the search index follows the row).
+	const std::string m_MediaReplaceQuery;
+
+	// Query which replaces a CD audio row.
+	const std::string m_CDDAReplaceQuery;
+
+	// Batch nesting depth.
+	int m_BatchDepth;
+
+	// Thread which owns the current batch.
+	std::thread::id m_BatchThread;
+
+	// Number of writes made since the current batch transaction began.
+	int m_BatchWrites;
+
+	// Time at which the current batch transaction began.
+	std::chrono::steady_clock::time_point m_BatchStartTime;
+
+	// Media update notifications held back until the current batch is committed.
+	MediaUpdates m_BatchNotifications;
+
+	// Batch state mutex.
+	std::mutex m_BatchMutex;
 };
@@ -0,0 +1,377 @@
+#include "LibraryBenchmark.h"
+
+#include "Library.h"
+#include "LibraryMaintainer.h"
+#include "Utility.h"
+
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <iomanip>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <vector>
+
+// The number of synthetic library entries written by each write benchmark.
+constexpr long s_WriteEntries = 5000;
+
+// The number of random library lookups made by each lookup benchmark.
+constexpr long s_Lookups = 20000;
+
+// Random lookup generator seed (fixed, so that each run looks up the same entries).
+constexpr unsigned int s_LookupSeed = 0x1974;
+
+// The number of synthetic library entries in each folder (and album).
+constexpr long s_EntriesPerFolder = 12;
+
+// Every nth album folder has a track modified before the final rescan.
+constexpr long s_TreeModifiedAlbumInterval = 10;
+
+// Number of channels in each generated track.
+constexpr long s_TreeChannels = 2;
+
+// The database access modes to benchmark.
+static const std::vector<Database::Mode> s_Modes = { Database::Mode::Disk, Database::Mode::Temp, Database::Mode::Memory };
+
+// Returns the number of milliseconds elapsed since 'start'.
+static double GetElapsedMilliseconds( const std::chrono::steady_clock::time_point& start )
+{
+	return std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - start ).count();
+}
+
+LibraryBenchmark::LibraryBenchmark( const HINSTANCE instance, const Handlers& handlers, const TreeSettings& treeSettings ) :
+	m_Instance( instance ),
+	m_Handlers( handlers ),
+	m_TreeSettings( treeSettings )
+{
+}
+
+LibraryBenchmark::~LibraryBenchmark()
+{
+}
+
+LibraryBenchmark::WriteResult LibraryBenchmark::RunWrites( const Database::Mode mode, const bool batched ) const
+{
+	WriteResult result;
+	result.Mode = mode;
+	result.Batched = batched;
+
+	const std::wstring databaseFilename = GetDatabaseFilename();
+	_wunlink( databaseFilename.c_str() );
+	{
+		auto database = std::make_unique<Database>( databaseFilename, mode );
+		auto library = std::make_unique<Library>( *database, m_Handlers );
+
+		const auto start = std::chrono::steady_clock::now();
+		{
+			std::unique_ptr<Library::Batch> batch = batched ? std::make_unique<Library::Batch>( *library ) : nullptr;
+			for ( long entry = 0; entry < s_WriteEntries; entry++ ) {
+				const MediaInfo mediaInfo = GetSyntheticEntry( entry );
+				const MediaInfo previousInfo( mediaInfo.GetFilename() );
+				if ( library->AddScannedMedia( previousInfo, mediaInfo, false /*sendNotification*/ ) ) {
+					++result.Entries;
+				}
+			}
+		}
+		result.WriteMilliseconds = GetElapsedMilliseconds( start );
+
+		const auto closeStart = std::chrono::steady_clock::now();
+		library.reset();
+		database.reset();
+		result.CloseMilliseconds = GetElapsedMilliseconds( closeStart );
+	}
+	_wunlink( databaseFilename.c_str() );
+	return result;
+}
+
+LibraryBenchmark::LookupResult LibraryBenchmark::RunLookups( const Database::Mode mode ) const
+{
+	LookupResult result;
+	result.Mode = mode;
+
+	const std::wstring databaseFilename = GetDatabaseFilename();
+	_wunlink( databaseFilename.c_str() );
+	{
+		Database database( databaseFilename, mode );
+		Library library( database, m_Handlers );
+		{
+			const Library::Batch batch( library );
+			for ( long entry = 0; entry < s_WriteEntries; entry++ ) {
+				const MediaInfo mediaInfo = GetSyntheticEntry( entry );
+				library.AddScannedMedia( MediaInfo( mediaInfo.GetFilename() ), mediaInfo, false /*sendNotification*/ );
+			}
+		}
+
+		std::mt19937 generator( s_LookupSeed );
+		std::uniform_int_distribution<long> distribution( 0, s_WriteEntries - 1 );
+		const Database::StatementStatistics initialStatistics = database.GetStatementStatistics();
+		const auto start = std::chrono::steady_clock::now();
+		for ( ; result.Lookups < s_Lookups; result.Lookups++ ) {
+			MediaInfo mediaInfo( GetSyntheticEntry( distribution( generator ) ).GetFilename() );
+			if ( library.GetMediaInfo( mediaInfo, false /*checkFileAttributes*/, false /*scanMedia*/, false /*sendNotification*/ ) ) {
+				++result.Found;
+			}
+		}
+		result.Milliseconds = GetElapsedMilliseconds( start );
+		const Database::StatementStatistics statistics = database.GetStatementStatistics();
+		result.Prepares = statistics.Prepares - initialStatistics.Prepares;
+		result.Reuses = statistics.Reuses - initialStatistics.Reuses;
+	}
+	_wunlink( databaseFilename.c_str() );
+	return result;
+}
+
+std::vector<LibraryBenchmark::ScanResult> LibraryBenchmark::RunScans( const Database::Mode mode, const std::filesystem::path& root ) const
+{
+	std::vector<ScanResult> results;
+	const std::wstring databaseFilename = GetDatabaseFilename();
+	_wunlink( databaseFilename.c_str() );
+	{
+		Database database( databaseFilename, mode );
+		Library library( database, m_Handlers );
+		LibraryMaintainer maintainer( m_Instance, library, m_Handlers );
+
+		// Scans the tree, and adds the results for the 'pass'.
+		auto scan = [ mode, &root, &library, &maintainer, &results ] ( const char* pass )
+		{
+			ScanResult result;
+			result.Mode = mode;
+			result.Pass = pass;
+			const auto start = std::chrono::steady_clock::now();
+			maintainer.Start( nullptr /*callback*/, { root.wstring() } );
+			while ( maintainer.IsActive() ) {
+				Sleep( 1 );
+			}
+			result.Milliseconds = GetElapsedMilliseconds( start );
+			result.Entries = static_cast<long>( library.GetAllMedia().size() );
+			results.push_back( result );
+		};
+
+		scan( "Initial" );
+		scan( "Unchanged" );
+		for ( long album = 0; album < ( m_TreeSettings.Artists * m_TreeSettings.AlbumsPerArtist ); album += s_TreeModifiedAlbumInterval ) {
+			WriteTrack( root, album, 1 /*track*/, 2 * m_TreeSettings.TrackFrames );
+		}
+		scan( "Modified" );
+		maintainer.Stop();
+	}
+	_wunlink( databaseFilename.c_str() );
+	return results;
+}
+
+std::vector<LibraryBenchmark::ProbeResult> LibraryBenchmark::RunProbes( const std::map<BenchmarkFile::Format, std::list<std::wstring>>& files ) const
+{
+	std::vector<ProbeResult> results;
+	for ( const auto& [ format, filenames ] : files ) {
+		ProbeResult result;
+		result.Format = format;
+		result.Files = static_cast<long>( filenames.size() );
+
+		// Read each file once before measuring, so that both methods read from the file cache.
+		std::map<std::wstring, Handler::StreamProperties> probedProperties;
+		for ( const auto& filename : filenames ) {
+			Handler::StreamProperties properties;
+			Tags tags;
+			bool tagsRead = false;
+			if ( m_Handlers.Probe( filename, properties, &tags, tagsRead ) ) {
+				probedProperties.insert( { filename, properties } );
+			}
+		}
+
+		auto start = std::chrono::steady_clock::now();
+		for ( const auto& filename : filenames ) {
+			Handler::StreamProperties properties;
+			Tags tags;
+			bool tagsRead = false;
+			m_Handlers.Probe( filename, properties, &tags, tagsRead );
+		}
+		result.ProbeMilliseconds = GetElapsedMilliseconds( start );
+
+		start = std::chrono::steady_clock::now();
+		for ( const auto& filename : filenames ) {
+			Tags tags;
+			const Decoder::Ptr decoder = m_Handlers.OpenDecoder( filename );
+			m_Handlers.GetTags( filename, tags );
+			const auto probed = probedProperties.find( filename );
+			if ( !decoder || ( probedProperties.end() == probed ) || ( decoder->GetSampleRate() != probed->second.SampleRate ) || ( decoder->GetChannels() != probed->second.Channels ) ) {
+				++result.Mismatches;
+			}
+		}
+		result.DecoderMilliseconds = GetElapsedMilliseconds( start );
+		results.push_back( result );
+	}
+	return results;
+}
+
+bool LibraryBenchmark::Run( const std::wstring& outputFilename ) const
+{
+	std::ofstream stream( outputFilename, std::ios::binary | std::ios::trunc );
+	bool success = stream.good();
+	if ( success ) {
+		stream << "Benchmark\tMode\tBatched\tEntries\tMilliseconds\tCloseMilliseconds\tEntriesPerSecond\tPrepares\tReuses\r\n";
+		for ( const auto mode : s_Modes ) {
+			for ( const bool batched : { false, true } ) {
+				const WriteResult result = RunWrites( mode, batched );
+				success = success && ( s_WriteEntries == result.Entries );
+
+				std::stringstream row;
+				row << std::fixed << std::setprecision( 3 );
+				row << "Write\t" << GetModeName( result.Mode ) << '\t' << ( result.Batched ? 1 : 0 ) << '\t' << result.Entries << '\t' <<
+					result.WriteMilliseconds << '\t' << result.CloseMilliseconds << '\t' <<
+					( ( result.WriteMilliseconds > 0 ) ? ( 1000 * result.Entries / result.WriteMilliseconds ) : 0.0 ) << "\r\n";
+				stream << row.str();
+			}
+		}
+
+		for ( const auto mode : s_Modes ) {
+			const LookupResult result = RunLookups( mode );
+			success = success && ( s_Lookups == result.Found );
+
+			std::stringstream row;
+			row << std::fixed << std::setprecision( 3 );
+			row << "Lookup\t" << GetModeName( result.Mode ) << "\t1\t" << result.Lookups << '\t' << result.Milliseconds << "\t\t" <<
+				( ( result.Milliseconds > 0 ) ? ( 1000 * result.Lookups / result.Milliseconds ) : 0.0 ) << '\t' << result.Prepares << '\t' << result.Reuses << "\r\n";
+			stream << row.str();
+		}
+
+		const std::filesystem::path root = GetTreeFolder();
+		std::map<BenchmarkFile::Format, std::list<std::wstring>> files;
+		for ( const auto mode : s_Modes ) {
+			success = CreateTree( root, files ) && success;
+			for ( const auto& result : RunScans( mode, root ) ) {
+				success = success && ( GetTreeTracks() == result.Entries );
+
+				std::stringstream row;
+				row << std::fixed << std::setprecision( 3 );
+				row << "Scan (" << result.Pass << ")\t" << GetModeName( result.Mode ) << "\t1\t" << result.Entries << '\t' << result.Milliseconds << "\t\t" <<
+					( ( result.Milliseconds > 0 ) ? ( 1000 * result.Entries / result.Milliseconds ) : 0.0 ) << "\r\n";
+				stream << row.str();
+			}
+			std::error_code error;
+			std::filesystem::remove_all( root, error );
+		}
+
+		success = CreateTree( root, files ) && success;
+		for ( const auto& result : RunProbes( files ) ) {
+			success = success && ( 0 == result.Mismatches );
+			for ( const bool probe : { true, false } ) {
+				const double milliseconds = probe ? result.ProbeMilliseconds : result.DecoderMilliseconds;
+				std::stringstream row;
+				row << std::fixed << std::setprecision( 3 );
+				row << ( probe ? "Probe (" : "Open decoder & read tags (" ) << WideStringToUTF8( BenchmarkFile::GetFormatName( result.Format ) ) << ")\t\t\t" << result.Files << '\t' << milliseconds << "\t\t" <<
+					( ( milliseconds > 0 ) ? ( 1000 * result.Files / milliseconds ) : 0.0 ) << "\r\n";
+				stream << row.str();
+			}
+		}
+		std::error_code error;
+		std::filesystem::remove_all( root, error );
+		success = success && stream.good();
+	}
+	return success;
+}
+
+const char* LibraryBenchmark::GetModeName( const Database::Mode mode )
+{
+	const char* name = "";
+	switch ( mode ) {
+		case Database::Mode::Disk : {
+			name = "Disk";
+			break;
+		}
+		case Database::Mode::Temp : {
+			name = "Temp";
+			break;
+		}
+		case Database::Mode::Memory : {
+			name = "Memory";
+			break;
+		}
+	}
+	return name;
+}
+
+MediaInfo LibraryBenchmark::GetSyntheticEntry( const long index )
+{
+	const long folder = index / s_EntriesPerFolder;
+	const long track = 1 + index % s_EntriesPerFolder;
+	MediaInfo mediaInfo( L"X:\\LibraryBenchmark\\Folder" + std::to_wstring( folder ) + L"\\Track" + std::to_wstring( track ) + L".flac" );
+	mediaInfo.SetFiletime( 132000000000000000ll + index );
+	mediaInfo.SetFilesize( 20000000ll + index );
+	mediaInfo.SetDuration( 180.0f + track );
+	mediaInfo.SetSampleRate( 44100 );
+	mediaInfo.SetBitsPerSample( 16 );
+	mediaInfo.SetChannels( 2 );
+	mediaInfo.SetArtist( L"Artist " + std::to_wstring( folder / 10 ) );
+	mediaInfo.SetAlbum( L"Album " + std::to_wstring( folder ) );
+	mediaInfo.SetTitle( L"Title " + std::to_wstring( index ) );
+	mediaInfo.SetGenre( L"Genre " + std::to_wstring( folder % 20 ) );
+	mediaInfo.SetYear( 1950 + folder % 70 );
+	mediaInfo.SetTrack( track );
+	return mediaInfo;
+}
+
+std::filesystem::path LibraryBenchmark::GetTreeFolder()
+{
+	std::filesystem::path folder;
+	WCHAR pathName[ MAX_PATH ];
+	if ( 0 != GetTempPath( MAX_PATH, pathName ) ) {
+		folder = std::filesystem::path( pathName ) / L"VUPlayerScanBenchmark";
+	}
+	return folder;
+}
+
+long LibraryBenchmark::GetTreeTracks() const
+{
+	return m_TreeSettings.Artists * m_TreeSettings.AlbumsPerArtist * m_TreeSettings.TracksPerAlbum;
+}
+
+bool LibraryBenchmark::CreateTree( const std::filesystem::path& root, std::map<BenchmarkFile::Format, std::list<std::wstring>>& files ) const
+{
+	files.clear();
+	bool success = !root.empty() && !m_TreeSettings.Formats.empty();
+	if ( success ) {
+		std::error_code error;
+		std::filesystem::remove_all( root, error );
+		for ( long album = 0; success && ( album < ( m_TreeSettings.Artists * m_TreeSettings.AlbumsPerArtist ) ); album++ ) {
+			for ( long track = 1; success && ( track <= m_TreeSettings.TracksPerAlbum ); track++ ) {
+				const auto [ filename, format ] = WriteTrack( root, album, track, m_TreeSettings.TrackFrames );
+				success = !filename.empty();
+				if ( success ) {
+					files[ format ].push_back( filename );
+				}
+			}
+		}
+	}
+	return success;
+}
+
+std::pair<std::wstring, BenchmarkFile::Format> LibraryBenchmark::WriteTrack( const std::filesystem::path& root, const long album, const long track, const long frames ) const
+{
+	const long artist = album / m_TreeSettings.AlbumsPerArtist;
+	const long artistAlbum = album % m_TreeSettings.AlbumsPerArtist;
+	const BenchmarkFile::Format format = *std::next( m_TreeSettings.Formats.begin(), album % m_TreeSettings.Formats.size() );
+	const std::filesystem::path folder = root / ( L"Artist" + std::to_wstring( artist ) ) / ( L"Album" + std::to_wstring( artistAlbum ) );
+	std::wstring filename;
+	std::error_code error;
+	if ( std::filesystem::create_directories( folder, error ) || std::filesystem::is_directory( folder, error ) ) {
+		const Tags tags = {
+			{ Tag::Artist, "Artist " + std::to_string( artist ) },
+			{ Tag::Album, "Album " + std::to_string( album ) },
+			{ Tag::Title, "Title " + std::to_string( track ) },
+			{ Tag::Track, std::to_string( track ) }
+		};
+		filename = BenchmarkFile::Write( folder / ( L"Track" + std::to_wstring( track ) ), format, m_TreeSettings.SampleRate, s_TreeChannels, frames, tags );
+	}
+	return { filename, format };
+}
+
+std::wstring LibraryBenchmark::GetDatabaseFilename()
+{
+	std::wstring filename;
+	WCHAR pathName[ MAX_PATH ];
+	if ( 0 != GetTempPath( MAX_PATH, pathName ) ) {
+		filename = std::wstring( pathName ) + L"VUPlayerLibraryBenchmark.db";
+	}
+	return filename;
+}
@@ -0,0 +1,181 @@
+#pragma once
+
+#include "BenchmarkFile.h"
+#include "Database.h"
+#include "Handlers.h"
+#include "MediaInfo.h"
+
+#include <filesystem>
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+// Measures media library update, lookup & scan performance for each database access mode, without creating the main window.
+// Each measurement uses its own temporary database (and the scans use a generated folder tree), so the user's media library is not read or modified.
+// The generated folder tree is also used to compare reading the stream properties & tags of each file format using Handlers::Probe, against opening a decoder and reading the tags separately.
+// Results are written as tab separated values (one header row, then one row per measurement), so that they can be compared between builds.
+class LibraryBenchmark
+{
+public:
+	// Generated folder tree settings.
+	struct TreeSettings {
+		// Number of artist folders.
+		long Artists = 20;
+
+		// Number of album folders in each artist folder.
+		long AlbumsPerArtist = 10;
+
+		// Number of tracks in each album folder.
+		long TracksPerAlbum = 12;
+
+		// Number of sample frames in each track (the scans only read the file headers & tags, so the tracks are kept short).
+		long TrackFrames = 2000;
+
+		// Sample rate of each track.
+		long SampleRate = 8000;
+
+		// Track file formats, used by each album folder in turn.
+		std::list<BenchmarkFile::Format> Formats = { BenchmarkFile::Format::WAV, BenchmarkFile::Format::FLAC, BenchmarkFile::Format::Opus, BenchmarkFile::Format::WavPack, BenchmarkFile::Format::APE };
+	};
+
+	// 'instance' - module instance handle.
+	// 'handlers' - audio format handlers.
+	// 'treeSettings' - generated folder tree settings.
+	LibraryBenchmark( const HINSTANCE instance, const Handlers& handlers, const TreeSettings& treeSettings );
+
+	virtual ~LibraryBenchmark();
+
+	// Library write benchmark results.
+	struct WriteResult {
+		// Database access mode.
+		Database::Mode Mode = Database::Mode::Disk;
+
+		// Whether the writes were grouped into a library batch.
+		bool Batched = false;
+
+		// Number of library entries written.
+		long Entries = 0;
+
+		// Time taken to write the library entries, in milliseconds.
+		double WriteMilliseconds = 0;
+
+		// Time taken to close the database (which includes flushing the database to disk, for the temporary & in-memory modes), in milliseconds.
+		double CloseMilliseconds = 0;
+	};
+
+	// Library scan benchmark results, for a single scan.
+	struct ScanResult {
+		// Database access mode.
+		Database::Mode Mode = Database::Mode::Disk;
+
+		// Scan description.
+		std::string Pass;
+
+		// Number of library entries after the scan.
+		long Entries = 0;
+
+		// Time taken by the scan, in milliseconds.
+		double Milliseconds = 0;
+	};
+
+	// Library lookup benchmark results.
+	struct LookupResult {
+		// Database access mode.
+		Database::Mode Mode = Database::Mode::Disk;
+
+		// Number of lookups made.
+		long Lookups = 0;
+
+		// Number of lookups which returned a library entry.
+		long Found = 0;
+
+		// Time taken by the lookups, in milliseconds.
+		double Milliseconds = 0;
+
+		// Number of statements prepared during the lookups.
+		uint64_t Prepares = 0;
+
+		// Number of cached statements reused during the lookups.
+		uint64_t Reuses = 0;
+	};
+
+	// File probe benchmark results, for the files of one format.
+	struct ProbeResult {
+		// File format.
+		BenchmarkFile::Format Format = BenchmarkFile::Format::WAV;
+
+		// Number of files.
+		long Files = 0;
+
+		// Time taken to read the stream properties & tags of the files using Handlers::Probe, in milliseconds.
+		double ProbeMilliseconds = 0;
+
+		// Time taken to read the stream properties & tags of the files by opening a decoder, then reading the tags separately, in milliseconds.
+		double DecoderMilliseconds = 0;
+
+		// Number of files for which either method failed, or the methods returned different stream properties.
+		long Mismatches = 0;
+	};
+
+	// Benchmarks writing a set of synthetic library entries, as a library scan would, using a database with the access 'mode'.
+	// 'batched' - whether to group the writes into a library batch.
+	// Returns the benchmark results.
+	WriteResult RunWrites( const Database::Mode mode, const bool batched ) const;
+
+	// Benchmarks looking up random entries from a set of synthetic library entries, as playlist loading would, using a database with the access 'mode'.
+	// Returns the benchmark results.
+	LookupResult RunLookups( const Database::Mode mode ) const;
+
+	// Benchmarks the library maintainer scanning a generated folder tree into an empty library, using a database with the access 'mode'.
+	// The tree is then rescanned unchanged (so that the directory journal applies), and rescanned again after some of the files have been modified.
+	// 'root' - root folder of the generated tree.
+	// Returns the benchmark results for each scan.
+	std::vector<ScanResult> RunScans( const Database::Mode mode, const std::filesystem::path& root ) const;
+
+	// Benchmarks reading the stream properties & tags of the generated 'files' of each format, using Handlers::Probe and by opening a decoder.
+	// Returns the benchmark results for each format.
+	std::vector<ProbeResult> RunProbes( const std::map<BenchmarkFile::Format, std::list<std::wstring>>& files ) const;
+
+	// Runs the benchmarks for each database access mode, writing the results to 'outputFilename'.
+	// Returns true if the results were written.
+	bool Run( const std::wstring& outputFilename ) const;
+
+private:
+	// Returns a name for the database access 'mode'.
+	static const char* GetModeName( const Database::Mode mode );
+
+	// Returns the synthetic library entry with the 'index'.
+	static MediaInfo GetSyntheticEntry( const long index );
+
+	// Returns the filename of the temporary database used by a benchmark (which is deleted before & after use).
+	static std::wstring GetDatabaseFilename();
+
+	// Returns the root folder of the generated folder tree used by the scan benchmarks.
+	static std::filesystem::path GetTreeFolder();
+
+	// Returns the number of tracks in the generated folder tree.
+	long GetTreeTracks() const;
+
+	// Generates a folder tree of short tracks under 'root'.
+	// 'files' - out, the generated files of each format.
+	// Returns whether the tree was generated.
+	bool CreateTree( const std::filesystem::path& root, std::map<BenchmarkFile::Format, std::list<std::wstring>>& files ) const;
+
+	// Writes a track in the generated folder tree.
+	// 'root' - root folder of the generated tree.
+	// 'album' - album index (across all artists).
+	// 'track' - track number.
+	// 'frames' - number of sample frames.
+	// Returns the track file name, along with its format, or an empty file name if the track could not be written.
+	std::pair<std::wstring, BenchmarkFile::Format> WriteTrack( const std::filesystem::path& root, const long album, const long track, const long frames ) const;
+
+	// Module instance handle.
+	const HINSTANCE m_Instance;
+
+	// Audio format handlers.
+	const Handlers& m_Handlers;
+
+	// Generated folder tree settings.
+	const TreeSettings m_TreeSettings;
+};
@@ -3,6 +3,42 @@
 #include "Utility.h"
 #include "VUPlayer.h"
 
+#include <winioctl.h>
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+// The maximum number of probed files waiting to be written to the library.
+constexpr size_t s_MaxProbedFiles = 256;
+
+// The maximum number of probe threads for a drive without a seek penalty.
+constexpr long s_MaxProbeThreadsPerDrive = 4;
+
+// The number of probe threads for a network drive.
+constexpr long s_RemoteProbeThreads = 2;
+
+// FNV-1a hash offset basis.
+constexpr uint64_t s_HashOffset = 0xcbf29ce484222325ull;
+
+// FNV-1a hash prime.
+constexpr uint64_t s_HashPrime = 0x100000001b3ull;
+
+// Adds the bytes of a 'value' to an FNV-1a 'hash'.
+template <typename T>
+static void AddToHash( uint64_t& hash, const T value )
+{
+	for ( size_t byte = 0; byte < sizeof( T ); byte++ ) {
+		hash = ( hash ^ static_cast<uint8_t>( static_cast<uint64_t>( value ) >> ( 8 * byte ) ) ) * s_HashPrime;
+	}
+}
+
+// Returns a FILETIME as a single value.
+static long long GetFiletime( const FILETIME& filetime )
+{
+	return ( static_cast<long long>( filetime.dwHighDateTime ) << 32 ) | filetime.dwLowDateTime;
+}
+
 DWORD WINAPI LibraryMaintainer::MaintainerThreadProc( LPVOID lpParam )
 {
 	LibraryMaintainer* maintainer = static_cast<LibraryMaintainer*>( lpParam );
@@ -14,7 +50,7 @@ DWORD WINAPI LibraryMaintainer::MaintainerThreadProc( LPVOID lpParam )
 	return 0;
 }
 
-LibraryMaintainer::LibraryMaintainer( const HINSTANCE instance, Library& library, Handlers& handlers ) :
+LibraryMaintainer::LibraryMaintainer( const HINSTANCE instance, Library& library, const Handlers& handlers ) :
 	m_Library( library ),
 	m_SupportedFileExtensions(),
 	m_StopEvent( CreateEvent( NULL /*attributes*/, TRUE /*manualReset*/, FALSE /*initialState*/, L"" /*name*/ ) ),
@@ -23,7 +59,14 @@ LibraryMaintainer::LibraryMaintainer( const HINSTANCE instance, Library& library
 	m_StatusMutex(),
 	m_StatusScanningComputer(),
 	m_StatusUpdatingLibrary(),
-	m_FileAddedCallback( nullptr )
+	m_FileAddedCallback( nullptr ),
+	m_Roots(),
+	m_FilesFound( 0 ),
+	m_DirectoryJournal(),
+	m_ProbedFiles(),
+	m_ActiveProbeThreads( 0 ),
+	m_ProbedFilesMutex(),
+	m_ProbedFilesChanged()
 {
 	const int bufSize = 64;
 	WCHAR buf[ bufSize ] = {};
@@ -44,10 +87,11 @@ LibraryMaintainer::~LibraryMaintainer()
 	CloseHandle( m_StopEvent );
 }
 
-void LibraryMaintainer::Start( FileAddedCallback callback )
+void LibraryMaintainer::Start( FileAddedCallback callback, const std::set<std::wstring>& roots )
 {
 	Stop();
 	m_FileAddedCallback = callback;
+	m_Roots = roots;
 	m_Thread = CreateThread( NULL /*attributes*/, 0 /*stackSize*/, MaintainerThreadProc, reinterpret_cast<LPVOID>( this ), 0 /*flags*/, NULL /*threadId*/ );
 	if ( nullptr != m_Thread ) {
 		SetThreadPriority( m_Thread, THREAD_PRIORITY_LOWEST );
@@ -86,52 +130,232 @@ void LibraryMaintainer::SetStatus( const std::wstring& status )
 
 void LibraryMaintainer::Handler()
 {
-	std::set<std::filesystem::path> allFiles;
-
-	// Scan all drives for supported file types.
+	// Scan all drives for supported file types, with a thread per drive.
 	std::wstring initialStatus = m_StatusScanningComputer;
 	WideStringReplace( initialStatus, L"%", std::to_wstring( 0 ) );
 	SetStatus( initialStatus );
-	const auto drives = GetRootDrives();
+	m_FilesFound = 0;
+	m_DirectoryJournal = m_Library.GetDirectoryJournal();
+	const auto drives = m_Roots.empty() ? GetRootDrives() : m_Roots;
+	std::set<std::wstring> scannedRoots;
 	for ( const auto& drive : drives ) {
-		ScanFolder( drive, allFiles );
+		scannedRoots.insert( WideStringToLower( drive ) );
+	}
+	std::map<std::wstring, DriveScan> driveScans;
+	{
+		std::vector<std::thread> scanThreads;
+		for ( const auto& drive : drives ) {
+			scanThreads.push_back( std::thread( [ this, &drive, &scan = driveScans[ drive ] ] () {
+				SetThreadPriority( GetCurrentThread(), THREAD_PRIORITY_LOWEST );
+				ScanFolder( drive, 0 /*modified*/, scan );
+			} ) );
+		}
+		for ( auto& thread : scanThreads ) {
+			thread.join();
+		}
+	}
+
+	std::map<std::wstring, std::set<std::filesystem::path>> filesByDrive;
+	std::set<std::wstring> unchangedFolders;
+	Library::DirectoryJournal scannedFolders;
+	for ( auto& [ drive, scan ] : driveScans ) {
+		// Group the files by the root of the drive, in case the scanned folders are not drive roots (so that each file is only probed once).
+		filesByDrive[ WideStringToUpper( std::filesystem::path( drive ).root_path().wstring() ) ].merge( scan.MediaFiles );
+		unchangedFolders.merge( scan.UnchangedFolders );
+		scannedFolders.merge( scan.Folders );
 	}
+	driveScans.clear();
 
-	if ( WAIT_OBJECT_0 != WaitForSingleObject( m_StopEvent, 0 ) ) {
-		// Make a note of existing library files (excluding streams), and merge in any that were not found in the folder scan.
+	if ( !IsStopping() ) {
+		// Make a note of existing library files (excluding streams), and merge in any that were not found in the folder scan (unless they are in an unchanged folder, or outside the scanned folders).
 		std::set<std::filesystem::path> existingFiles;
 		const auto allMedia = m_Library.GetAllMedia();
 		for ( const auto& mediaInfo : allMedia ) {
 			if ( const auto& filename = mediaInfo.GetFilename(); !IsURL( filename ) ) {
-				existingFiles.insert( mediaInfo.GetFilename() );
-				allFiles.insert( filename );
+				const std::filesystem::path path( filename );
+				existingFiles.insert( path );
+				if ( const std::wstring folder = WideStringToLower( path.parent_path().wstring() ); ( unchangedFolders.end() == unchangedFolders.find( folder ) ) &&
+						( m_Roots.empty() || IsWithinRoots( folder, scannedRoots ) ) ) {
+					filesByDrive[ WideStringToUpper( path.root_path().wstring() ) ].insert( path );
+				}
 			}
 		}
 
-		// Refresh library information for all the files.
-		if ( WAIT_OBJECT_0 != WaitForSingleObject( m_StopEvent, 0 ) ) {
-			size_t current = 0;
-			size_t total = allFiles.size();
-			for ( auto path = allFiles.begin(); ( WAIT_OBJECT_0 != WaitForSingleObject( m_StopEvent, 0 ) ) && ( allFiles.end() != path ); ++path ) {
-				std::wstring status = m_StatusUpdatingLibrary;
-				WideStringReplace( status, L"%1", std::to_wstring( ++current ) );
-				WideStringReplace( status, L"%2", std::to_wstring( total ) );
-				status += L" - " + TruncatePath( *path );
-				SetStatus( status );
-
-				MediaInfo mediaInfo( path->c_str() );
-				if ( m_Library.GetMediaInfo( mediaInfo, true /*checkFileAttributes*/, true /*scanMedia*/, true /*sendNotification*/, true /*removeMissing*/ ) ) {
-					if ( ( nullptr != m_FileAddedCallback ) && ( existingFiles.end() == existingFiles.find( *path ) ) ) {
-						m_FileAddedCallback( *path );						
+		// Refresh library information for all the files, probing the files on each drive concurrently, and writing to the library from this thread.
+		if ( !IsStopping() ) {
+			std::map<std::wstring, DriveFiles> probeDrives;
+			size_t total = 0;
+			for ( const auto& [ drive, files ] : filesByDrive ) {
+				if ( !files.empty() ) {
+					DriveFiles& probeDrive = probeDrives[ drive ];
+					probeDrive.Files.assign( files.begin(), files.end() );
+					total += files.size();
+				}
+			}
+			filesByDrive.clear();
+
+			std::vector<std::thread> probeThreads;
+			{
+				std::lock_guard<std::mutex> lock( m_ProbedFilesMutex );
+				m_ProbedFiles.clear();
+				m_ActiveProbeThreads = 0;
+				for ( auto& [ drive, probeDrive ] : probeDrives ) {
+					const long threadCount = std::min<long>( GetProbeThreadCount( drive ), static_cast<long>( probeDrive.Files.size() ) );
+					for ( long threadIndex = 0; threadIndex < threadCount; threadIndex++ ) {
+						probeThreads.push_back( std::thread( &LibraryMaintainer::ProbeFiles, this, std::ref( probeDrive ) ) );
+						++m_ActiveProbeThreads;
+					}
+				}
+			}
+
+			const std::set<std::wstring> incompleteFolders = WriteProbedFiles( existingFiles, total );
+
+			for ( auto& thread : probeThreads ) {
+				thread.join();
+			}
+
+			if ( !IsStopping() ) {
+				// Folders with files that are not in the library (or which have just been removed from it) are left out of the journal, so that they are probed again on the next scan.
+				for ( const auto& folder : incompleteFolders ) {
+					scannedFolders.erase( folder );
+				}
+
+				// The library is now up to date with the remaining scanned folders, so update the directory journal (removing any folders which no longer exist within the scanned folders, or which were left out above).
+				std::set<std::wstring> removedFolders;
+				for ( const auto& [ folder, entry ] : m_DirectoryJournal ) {
+					if ( ( scannedFolders.end() == scannedFolders.find( folder ) ) && IsWithinRoots( folder, scannedRoots ) ) {
+						removedFolders.insert( folder );
 					}
 				}
+				m_Library.UpdateDirectoryJournal( scannedFolders, removedFolders );
 			}
 		}
 	}
+	m_DirectoryJournal.clear();
 
 	SetStatus( {} );
 }
 
+void LibraryMaintainer::ProbeFiles( DriveFiles& drive )
+{
+	SetThreadPriority( GetCurrentThread(), THREAD_PRIORITY_LOWEST );
+	CoInitializeEx( NULL /*reserved*/, COINIT_APARTMENTTHREADED );
+
+	for ( size_t fileIndex = drive.NextFile++; !IsStopping() && ( fileIndex < drive.Files.size() ); fileIndex = drive.NextFile++ ) {
+		ProbedFile probedFile;
+		probedFile.Path = drive.Files[ fileIndex ];
+		probedFile.PreviousInfo = MediaInfo( probedFile.Path.c_str() );
+		MediaInfo mediaInfo( probedFile.PreviousInfo );
+		if ( m_Library.GetMediaInfo( mediaInfo, true /*checkFileAttributes*/, false /*scanMedia*/, false /*sendNotification*/ ) ) {
+			probedFile.Result = ProbeResult::Current;
+		} else {
+			probedFile.ScannedInfo = probedFile.PreviousInfo;
+			probedFile.Result = m_Library.ScanMedia( probedFile.ScannedInfo ) ? ProbeResult::Scanned : ProbeResult::Missing;
+		}
+
+		std::unique_lock<std::mutex> lock( m_ProbedFilesMutex );
+		m_ProbedFilesChanged.wait( lock, [ this ] () { return m_ProbedFiles.size() < s_MaxProbedFiles; } );
+		m_ProbedFiles.push_back( std::move( probedFile ) );
+		m_ProbedFilesChanged.notify_all();
+	}
+
+	CoUninitialize();
+
+	std::lock_guard<std::mutex> lock( m_ProbedFilesMutex );
+	--m_ActiveProbeThreads;
+	m_ProbedFilesChanged.notify_all();
+}
+
+std::set<std::wstring> LibraryMaintainer::WriteProbedFiles( const std::set<std::filesystem::path>& existingFiles, const size_t total )
+{
+	std::set<std::wstring> incompleteFolders;
+	// Group the library updates into transactions, rather than committing each file individually.
+	const Library::Batch batch( m_Library );
+
+	const auto startTime = std::chrono::steady_clock::now();
+	size_t current = 0;
+	std::unique_lock<std::mutex> lock( m_ProbedFilesMutex );
+	while ( true ) {
+		m_ProbedFilesChanged.wait( lock, [ this ] () { return !m_ProbedFiles.empty() || ( 0 == m_ActiveProbeThreads ); } );
+		if ( m_ProbedFiles.empty() ) {
+			break;
+		}
+		const ProbedFile probedFile = std::move( m_ProbedFiles.front() );
+		m_ProbedFiles.pop_front();
+		m_ProbedFilesChanged.notify_all();
+		lock.unlock();
+
+		// Once stopping, the remaining probed files are discarded (the probe threads will finish after their current file).
+		if ( !IsStopping() ) {
+			bool updated = ( ProbeResult::Current == probedFile.Result );
+			if ( ProbeResult::Scanned == probedFile.Result ) {
+				updated = m_Library.AddScannedMedia( probedFile.PreviousInfo, probedFile.ScannedInfo );
+			} else if ( ProbeResult::Missing == probedFile.Result ) {
+				m_Library.RemoveFromLibrary( probedFile.PreviousInfo );
+			}
+			if ( !updated ) {
+				incompleteFolders.insert( WideStringToLower( probedFile.Path.parent_path().wstring() ) );
+			}
+			if ( updated && ( nullptr != m_FileAddedCallback ) && ( existingFiles.end() == existingFiles.find( probedFile.Path ) ) ) {
+				m_FileAddedCallback( probedFile.Path );
+			}
+
+			const double seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - startTime ).count();
+			std::wstring statusText = m_StatusUpdatingLibrary;
+			WideStringReplace( statusText, L"%1", std::to_wstring( ++current ) );
+			WideStringReplace( statusText, L"%2", std::to_wstring( total ) );
+			if ( seconds > 0 ) {
+				statusText += L" (" + std::to_wstring( std::lround( current / seconds ) ) + L"/s)";
+			}
+			statusText += L" - " + TruncatePath( probedFile.Path );
+			SetStatus( statusText );
+		}
+
+		lock.lock();
+	}
+	return incompleteFolders;
+}
+
+long LibraryMaintainer::GetProbeThreadCount( const std::wstring& root )
+{
+	long threadCount = 1;
+	const UINT driveType = GetDriveType( root.c_str() );
+	if ( DRIVE_REMOTE == driveType ) {
+		threadCount = s_RemoteProbeThreads;
+	} else if ( ( root.size() >= 2 ) && ( ':' == root[ 1 ] ) ) {
+		// Only probe on multiple threads if the drive is known not to incur a seek penalty.
+		const std::wstring volume = L"\\\\.\\" + root.substr( 0, 2 );
+		const HANDLE handle = CreateFile( volume.c_str(), 0 /*desiredAccess*/, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL /*securityAttributes*/, OPEN_EXISTING, 0 /*flags*/, NULL /*template*/ );
+		if ( INVALID_HANDLE_VALUE != handle ) {
+			STORAGE_PROPERTY_QUERY query = {};
+			query.PropertyId = StorageDeviceSeekPenaltyProperty;
+			query.QueryType = PropertyStandardQuery;
+			DEVICE_SEEK_PENALTY_DESCRIPTOR descriptor = {};
+			DWORD bytesReturned = 0;
+			if ( DeviceIoControl( handle, IOCTL_STORAGE_QUERY_PROPERTY, &query, sizeof( query ), &descriptor, sizeof( descriptor ), &bytesReturned, NULL /*overlapped*/ ) &&
+					( bytesReturned >= sizeof( descriptor ) ) && !descriptor.IncursSeekPenalty ) {
+				threadCount = std::clamp( static_cast<long>( std::thread::hardware_concurrency() ), 1l, s_MaxProbeThreadsPerDrive );
+			}
+			CloseHandle( handle );
+		}
+	}
+	return threadCount;
+}
+
+bool LibraryMaintainer::IsStopping() const
+{
+	return ( WAIT_OBJECT_0 == WaitForSingleObject( m_StopEvent, 0 ) );
+}
+
+bool LibraryMaintainer::IsWithinRoots( const std::wstring& folder, const std::set<std::wstring>& roots )
+{
+	const auto match = std::find_if( roots.begin(), roots.end(), [ &folder ] ( const std::wstring& root ) {
+		const size_t length = ( !root.empty() && ( '\\' == root.back() ) ) ? ( root.size() - 1 ) : root.size();
+		return ( 0 == folder.compare( 0, length, root, 0, length ) ) && ( ( folder.size() == length ) || ( '\\' == folder[ length ] ) );
+	} );
+	return roots.end() != match;
+}
+
 std::set<std::wstring> LibraryMaintainer::GetRootDrives()
 {
 	std::set<std::wstring> drives;
@@ -154,37 +378,75 @@ std::set<std::wstring> LibraryMaintainer::GetRootDrives()
 	return drives;
 }
 
-void LibraryMaintainer::ScanFolder( const std::filesystem::path& folder, std::set<std::filesystem::path>& mediaFiles )
+void LibraryMaintainer::ScanFolder( const std::filesystem::path& folder, const long long modified, DriveScan& scan )
 {
 	const FINDEX_INFO_LEVELS levels = FindExInfoBasic;
 	const FINDEX_SEARCH_OPS searchOp = FindExSearchNameMatch;
 	const DWORD flags = FIND_FIRST_EX_LARGE_FETCH;
 	WIN32_FIND_DATA findData = {};
 	std::filesystem::path path = folder / L"*.*";
+	std::list<std::filesystem::path> files;
+	std::list<std::pair<std::filesystem::path, long long>> subfolders;
+	Library::DirectoryEntry entry;
+	entry.Modified = modified;
+	uint64_t hash = s_HashOffset;
 	const HANDLE handle = FindFirstFileEx( path.c_str(), levels, &findData, searchOp, nullptr /*filter*/, flags );
 	if ( INVALID_HANDLE_VALUE != handle ) {
 		BOOL found = TRUE;
-		while ( found && ( WAIT_OBJECT_0 != WaitForSingleObject( m_StopEvent, 0 ) ) ) {
+		while ( found && !IsStopping() ) {
 			if ( !( ( findData.dwFileAttributes & FILE_ATTRIBUTE_HIDDEN ) || ( findData.dwFileAttributes & FILE_ATTRIBUTE_SYSTEM ) ) ) {
 				if ( findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY ) {
 					if ( ( findData.cFileName[ 0 ] != '.' ) ) {
-						path = folder / findData.cFileName;
-						ScanFolder( path, mediaFiles );
+						subfolders.push_back( { folder / findData.cFileName, GetFiletime( findData.ftLastWriteTime ) } );
+						for ( const auto ch : WideStringToLower( findData.cFileName ) ) {
+							AddToHash( hash, ch );
+						}
+						AddToHash( hash, '\\' );
+						++entry.Entries;
 					}
 				} else if ( IsSupportedFileType( findData.cFileName ) ) {
-					path = folder / findData.cFileName;
-					mediaFiles.insert( path );
-
-					std::wstring status = m_StatusScanningComputer;
-					WideStringReplace( status, L"%", std::to_wstring( mediaFiles.size() ) );
-					status += L" - " + TruncatePath( path );
-					SetStatus( status );			
+					files.push_back( folder / findData.cFileName );
+					for ( const auto ch : WideStringToLower( findData.cFileName ) ) {
+						AddToHash( hash, ch );
+					}
+					AddToHash( hash, GetFiletime( findData.ftLastWriteTime ) );
+					AddToHash( hash, ( static_cast<uint64_t>( findData.nFileSizeHigh ) << 32 ) | findData.nFileSizeLow );
+					++entry.Entries;
 				}
 			}
 			found = FindNextFile( handle, &findData );
 		}
 		FindClose( handle );
 	}
+
+	if ( !IsStopping() ) {
+		entry.Hash = static_cast<long long>( hash );
+		const std::wstring folderKey = WideStringToLower( folder.wstring() );
+		const auto previous = m_DirectoryJournal.find( folderKey );
+		const bool unchanged = ( m_DirectoryJournal.end() != previous ) && ( previous->second.Modified == entry.Modified ) &&
+			( previous->second.Entries == entry.Entries ) && ( previous->second.Hash == entry.Hash );
+		if ( unchanged ) {
+			scan.UnchangedFolders.insert( folderKey );
+		}
+		scan.Folders.insert( { folderKey, entry } );
+
+		for ( const auto& file : files ) {
+			if ( !unchanged ) {
+				scan.MediaFiles.insert( file );
+			}
+			++m_FilesFound;
+		}
+		if ( !files.empty() ) {
+			std::wstring status = m_StatusScanningComputer;
+			WideStringReplace( status, L"%", std::to_wstring( m_FilesFound ) );
+			status += L" - " + TruncatePath( files.back() );
+			SetStatus( status );
+		}
+
+		for ( const auto& [ subfolder, subfolderModified ] : subfolders ) {
+			ScanFolder( subfolder, subfolderModified, scan );
+		}
+	}
 }
 
 bool LibraryMaintainer::IsSupportedFileType( const std::wstring& filename ) const
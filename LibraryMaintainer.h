@@ -1,7 +1,12 @@
 #pragma once
 
 #include <atomic>
+#include <condition_variable>
 #include <filesystem>
+#include <list>
+#include <map>
+#include <mutex>
+#include <set>
 
 #include "Library.h"
 
@@ -12,7 +17,7 @@ public:
 	// 'instance' - module instance handle.
 	// 'library' - media library.
 	// 'handlers' - available handlers.
-	LibraryMaintainer( const HINSTANCE instance, Library& library, Handlers& handlers );
+	LibraryMaintainer( const HINSTANCE instance, Library& library, const Handlers& handlers );
 
 	virtual ~LibraryMaintainer();
 
@@ -20,7 +25,8 @@ public:
 	using FileAddedCallback = std::function<void( const std::filesystem::path& file )>;
 
 	// Starts library maintenance, using the 'callback'.
-	void Start( FileAddedCallback callback );
+	// 'roots' - folders to scan, or an empty set to scan all fixed, removable & network drives.
+	void Start( FileAddedCallback callback, const std::set<std::wstring>& roots = {} );
 
 	// Stops library maintenance.
 	void Stop();
@@ -38,14 +44,81 @@ private:
 	// Truncates the 'path' for display purposes.
 	static std::wstring TruncatePath( const std::filesystem::path& path );
 
+	// The outcome of probing a file.
+	enum class ProbeResult {
+		Current,	// The library information is up to date.
+		Scanned,	// The file has been scanned, and the library information needs updating.
+		Missing		// The file could not be scanned, and should be removed from the library.
+	};
+
+	// A probed file.
+	struct ProbedFile {
+		// File path.
+		std::filesystem::path Path;
+
+		// Probe outcome.
+		ProbeResult Result = ProbeResult::Missing;
+
+		// Previous media information.
+		MediaInfo PreviousInfo;
+
+		// Scanned media information.
+		MediaInfo ScannedInfo;
+	};
+
+	// Files to probe on a drive.
+	struct DriveFiles {
+		// Files to probe.
+		std::vector<std::filesystem::path> Files;
+
+		// Index of the next file to probe.
+		std::atomic<size_t> NextFile = 0;
+	};
+
+	// The results of scanning a drive.
+	struct DriveScan {
+		// Supported files to probe.
+		std::set<std::filesystem::path> MediaFiles;
+
+		// Folders (as lowercase paths) which are unchanged since the last scan, and so whose files do not need probing.
+		std::set<std::wstring> UnchangedFolders;
+
+		// The current state of all the scanned folders.
+		Library::DirectoryJournal Folders;
+	};
+
 	// Maintenance thread handler.
 	void Handler();
 
 	// Returns the root drive names.
 	std::set<std::wstring> GetRootDrives();
 
-	// Recursively scans the 'folder' and adds any supported file types to 'mediaFiles'.
-	void ScanFolder( const std::filesystem::path& folder, std::set<std::filesystem::path>& mediaFiles );
+	// Returns whether the lowercase 'folder' is, or is within, one of the lowercase 'roots'.
+	static bool IsWithinRoots( const std::wstring& folder, const std::set<std::wstring>& roots );
+
+	// Recursively scans a folder, adding any supported files which need probing to the drive 'scan' results.
+	// Files are only probed if the folder has changed since it was last scanned (subfolders are always scanned).
+	// 'folder' - folder to scan.
+	// 'modified' - folder last write time.
+	// 'scan' - in/out, drive scan results.
+	void ScanFolder( const std::filesystem::path& folder, const long long modified, DriveScan& scan );
+
+	// Probes the files on a drive, passing the probed files to the database writer.
+	// 'drive' - files to probe.
+	void ProbeFiles( DriveFiles& drive );
+
+	// Updates the library with the probed files, until all the probe threads have finished.
+	// 'existingFiles' - files which were in the library before the scan.
+	// 'total' - total number of files to probe.
+	// Returns the (lowercase) folders containing files which could not be scanned or written to the library, or whose library entries were removed.
+	std::set<std::wstring> WriteProbedFiles( const std::set<std::filesystem::path>& existingFiles, const size_t total );
+
+	// Returns the number of threads with which to probe files on the drive with the 'root' path.
+	// Drives which incur a seek penalty (i.e. spinning disks) are probed on a single thread, so that the disk is not thrashed.
+	static long GetProbeThreadCount( const std::wstring& root );
+
+	// Returns whether the 'stop' event has been signalled.
+	bool IsStopping() const;
 
 	// Returns whether the 'filename' is a supported media file type.
 	bool IsSupportedFileType( const std::wstring& filename ) const;
@@ -79,5 +152,26 @@ private:
 
 	// A callback for when a new file is added to the library. 
 	FileAddedCallback m_FileAddedCallback;
+
+	// Folders to scan (or empty to scan all drives).
+	std::set<std::wstring> m_Roots;
+
+	// Number of supported files found so far by the folder scan.
+	std::atomic<size_t> m_FilesFound;
+
+	// Directory journal, as of the start of the current scan.
+	Library::DirectoryJournal m_DirectoryJournal;
+
+	// Probed files waiting to be written to the library.
+	std::list<ProbedFile> m_ProbedFiles;
+
+	// Number of probe threads which are still running.
+	long m_ActiveProbeThreads;
+
+	// Probed files mutex.
+	std::mutex m_ProbedFilesMutex;
+
+	// Signalled when a file has been probed, when a probed file has been taken for writing, or when a probe thread finishes.
+	std::condition_variable m_ProbedFilesChanged;
 };
 
@@ -24,11 +24,11 @@ bool MediaInfo::operator<( const MediaInfo& o ) const
 	const bool lessThan = 
 		std::tie( m_Filename, m_Filetime, m_Filesize, m_Duration, m_SampleRate, m_BitsPerSample, m_Channels, m_Bitrate, 
 			m_Artist,	m_Title, m_Album, m_Genre, m_Year, m_Comment, m_Track, m_Version, m_ArtworkID, 
-			m_Source, m_CDDB, m_GainTrack, m_GainAlbum ) <
+			m_Source, m_CDDB, m_GainTrack, m_GainAlbum, m_SamplePeak, m_LeadingSilence, m_TrailingSilence, m_CrossfadePosition ) <
 
 		std::tie( o.m_Filename, o.m_Filetime, o.m_Filesize, o.m_Duration, o.m_SampleRate, o.m_BitsPerSample, o.m_Channels, o.m_Bitrate,
 			o.m_Artist, o.m_Title, o.m_Album, o.m_Genre, o.m_Year, o.m_Comment, o.m_Track, o.m_Version, o.m_ArtworkID,
-			o.m_Source, o.m_CDDB, o.m_GainTrack, o.m_GainAlbum );
+			o.m_Source, o.m_CDDB, o.m_GainTrack, o.m_GainAlbum, o.m_SamplePeak, o.m_LeadingSilence, o.m_TrailingSilence, o.m_CrossfadePosition );
 
 	return lessThan;
 }
@@ -240,6 +240,54 @@ void MediaInfo::SetGainAlbum( const std::optional<float> gain )
 	m_GainAlbum = ( gain.has_value() && std::isfinite( gain.value() ) ) ? gain : std::nullopt;
 }
 
+std::optional<float> MediaInfo::GetSamplePeak() const
+{
+	return m_SamplePeak;
+}
+
+void MediaInfo::SetSamplePeak( const std::optional<float> peak )
+{
+	m_SamplePeak = ( peak.has_value() && std::isfinite( peak.value() ) ) ? peak : std::nullopt;
+}
+
+std::optional<float> MediaInfo::GetLeadingSilence() const
+{
+	return m_LeadingSilence;
+}
+
+void MediaInfo::SetLeadingSilence( const std::optional<float> position )
+{
+	m_LeadingSilence = ( position.has_value() && std::isfinite( position.value() ) ) ? position : std::nullopt;
+}
+
+std::optional<float> MediaInfo::GetTrailingSilence() const
+{
+	return m_TrailingSilence;
+}
+
+void MediaInfo::SetTrailingSilence( const std::optional<float> position )
+{
+	m_TrailingSilence = ( position.has_value() && std::isfinite( position.value() ) ) ? position : std::nullopt;
+}
+
+std::optional<float> MediaInfo::GetCrossfadePosition() const
+{
+	return m_CrossfadePosition;
+}
+
+void MediaInfo::SetCrossfadePosition( const std::optional<float> position )
+{
+	m_CrossfadePosition = ( position.has_value() && std::isfinite( position.value() ) ) ? position : std::nullopt;
+}
+
+void MediaInfo::ClearAnalysis()
+{
+	m_SamplePeak = std::nullopt;
+	m_LeadingSilence = std::nullopt;
+	m_TrailingSilence = std::nullopt;
+	m_CrossfadePosition = std::nullopt;
+}
+
 std::wstring MediaInfo::GetTitle( const bool filenameAsTitle ) const
 {
 	std::wstring title = m_Title;
@@ -139,6 +139,33 @@ public:
 	// Sets the album gain, in dB.
 	void SetGainAlbum( const std::optional<float> gain );
 
+	// Returns the track sample peak, as a linear value (or nullopt if the track has not been analysed).
+	std::optional<float> GetSamplePeak() const;
+
+	// Sets the track sample peak, as a linear value.
+	void SetSamplePeak( const std::optional<float> peak );
+
+	// Returns the position of the first non-silent sample, in seconds (or nullopt if the track has not been analysed).
+	std::optional<float> GetLeadingSilence() const;
+
+	// Sets the position of the first non-silent sample, in seconds.
+	void SetLeadingSilence( const std::optional<float> position );
+
+	// Returns the position at which trailing silence starts, in seconds (or nullopt if the track has not been analysed).
+	std::optional<float> GetTrailingSilence() const;
+
+	// Sets the position at which trailing silence starts, in seconds.
+	void SetTrailingSilence( const std::optional<float> position );
+
+	// Returns the crossfade position, in seconds from the start of the track (or nullopt if the track has not been analysed).
+	std::optional<float> GetCrossfadePosition() const;
+
+	// Sets the crossfade position, in seconds from the start of the track.
+	void SetCrossfadePosition( const std::optional<float> position );
+
+	// Clears any track analysis information (sample peak, silence & crossfade positions).
+	void ClearAnalysis();
+
 	// Returns the title
 	// 'filenameAsTitle' - whether to return the filename if there is no title.
 	std::wstring GetTitle( const bool filenameAsTitle = false ) const;
@@ -197,5 +224,9 @@ private:
 	std::optional<float> m_Bitrate = std::nullopt;
 	std::optional<float> m_GainTrack = std::nullopt;
 	std::optional<float> m_GainAlbum = std::nullopt;
+	std::optional<float> m_SamplePeak = std::nullopt;
+	std::optional<float> m_LeadingSilence = std::nullopt;
+	std::optional<float> m_TrailingSilence = std::nullopt;
+	std::optional<float> m_CrossfadePosition = std::nullopt;
 };
 
@@ -0,0 +1,160 @@
+#include "MediaSearch.h"
+
+#include <algorithm>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+// Query which creates the search index, with the artist, title, album, genre, comment & filename columns read from the media table.
+// Prefix indexes are kept for one to six character prefixes, so that a prefix query for a common word (such as a folder name in every filename) reads a single list of matches, rather than merging the lists for every word with the prefix.
+static const std::string s_CreateTableQuery = "CREATE VIRTUAL TABLE IF NOT EXISTS MediaSearch USING fts5(Artist,Title,Album,Genre,Comment,Filename, content='Media', tokenize='unicode61 remove_diacritics 2', prefix='1 2 3 4 5 6');";
+
+// Query which rebuilds the search index from the media table.
+static const std::string s_RebuildQuery = "INSERT INTO MediaSearch(MediaSearch) VALUES('rebuild');";
+
+// Name of the rank function used by the search queries.
+constexpr char s_RankFunction[] = "MediaRank";
+
+// Rank function weights for each search index column (artist & title matches rank above album matches, which rank above genre, comment & filename matches).
+static const std::vector<double> s_ColumnWeights = { 10.0, 10.0, 5.0, 2.0, 1.0, 1.0 };
+
+// The maximum number of matches which are ranked by relevance.
+// Every match needs to be scored to rank the results (at around a microsecond per match), so broad queries (such as a single letter) are left unranked to keep the search time bounded.
+constexpr long s_MaxRankedMatches = 5000;
+
+// Query which counts the matches for a full text query, up to one more than the maximum number which are ranked.
+static const std::string s_CountQuery = "SELECT COUNT(*) FROM (SELECT 1 FROM MediaSearch WHERE MediaSearch MATCH ?1 LIMIT " + std::to_string( 1 + s_MaxRankedMatches ) + ");";
+
+// Query which selects the media table rows matching a full text query, ordered by rank.
+static const std::string s_RankedSelectQuery = "SELECT Media.* FROM MediaSearch JOIN Media ON Media.rowid=MediaSearch.rowid WHERE MediaSearch MATCH ?1 ORDER BY " + std::string( s_RankFunction ) + "(MediaSearch) LIMIT ?2;";
+
+// Query which selects the media table rows matching a full text query, in media table order.
+static const std::string s_UnrankedSelectQuery = "SELECT Media.* FROM MediaSearch JOIN Media ON Media.rowid=MediaSearch.rowid WHERE MediaSearch MATCH ?1 LIMIT ?2;";
+
+// The names & queries of the triggers which keep the search index in step with the media table.
+// Updates which do not change any of the indexed columns (such as gain & track analysis updates) leave the index alone.
+static const std::vector<std::pair<std::string, std::string>> s_Triggers = {
+	{ "MediaSearchInsert", "CREATE TRIGGER IF NOT EXISTS MediaSearchInsert AFTER INSERT ON Media BEGIN "
+		"INSERT INTO MediaSearch(rowid,Artist,Title,Album,Genre,Comment,Filename) VALUES(new.rowid,new.Artist,new.Title,new.Album,new.Genre,new.Comment,new.Filename); "
+		"END;" },
+	{ "MediaSearchDelete", "CREATE TRIGGER IF NOT EXISTS MediaSearchDelete AFTER DELETE ON Media BEGIN "
+		"INSERT INTO MediaSearch(MediaSearch,rowid,Artist,Title,Album,Genre,Comment,Filename) VALUES('delete',old.rowid,old.Artist,old.Title,old.Album,old.Genre,old.Comment,old.Filename); "
+		"END;" },
+	{ "MediaSearchUpdate", "CREATE TRIGGER IF NOT EXISTS MediaSearchUpdate AFTER UPDATE OF Artist,Title,Album,Genre,Comment,Filename ON Media "
+		"WHEN old.Artist IS NOT new.Artist OR old.Title IS NOT new.Title OR old.Album IS NOT new.Album OR old.Genre IS NOT new.Genre OR old.Comment IS NOT new.Comment OR old.Filename IS NOT new.Filename BEGIN "
+		"INSERT INTO MediaSearch(MediaSearch,rowid,Artist,Title,Album,Genre,Comment,Filename) VALUES('delete',old.rowid,old.Artist,old.Title,old.Album,old.Genre,old.Comment,old.Filename); "
+		"INSERT INTO MediaSearch(rowid,Artist,Title,Album,Genre,Comment,Filename) VALUES(new.rowid,new.Artist,new.Title,new.Album,new.Genre,new.Comment,new.Filename); "
+		"END;" }
+};
+
+// Rank function, which scores each phrase found in a column by the column weight, divided by the number of words in the column (so that a phrase which makes up all of a column ranks above one which makes up only a part of it).
+// Unlike bm25, the score does not depend on how common each phrase is across the whole index, so ranking does not need to read through every row containing a common word.
+// Lower values rank first.
+static void RankFunction( const Fts5ExtensionApi* api, Fts5Context* context, sqlite3_context* result, int /*valueCount*/, sqlite3_value** /*values*/ )
+{
+	double score = 0;
+	int instanceCount = 0;
+	if ( SQLITE_OK == api->xInstCount( context, &instanceCount ) ) {
+		for ( int instance = 0; instance < instanceCount; instance++ ) {
+			int phrase = 0;
+			int column = 0;
+			int offset = 0;
+			int columnSize = 0;
+			if ( ( SQLITE_OK == api->xInst( context, instance, &phrase, &column, &offset ) ) && ( column >= 0 ) && ( column < static_cast<int>( s_ColumnWeights.size() ) ) &&
+					( SQLITE_OK == api->xColumnSize( context, column, &columnSize ) ) && ( columnSize > 0 ) ) {
+				score += s_ColumnWeights[ column ] / columnSize;
+			}
+		}
+	}
+	sqlite3_result_double( result, -score );
+}
+
+// Registers the rank function with the 'database' connection.
+// Returns whether the function was registered.
+static bool RegisterRankFunction( sqlite3* database )
+{
+	bool registered = false;
+	fts5_api* api = nullptr;
+	sqlite3_stmt* stmt = nullptr;
+	if ( SQLITE_OK == sqlite3_prepare_v2( database, "SELECT fts5(?1);", -1 /*nByte*/, &stmt, nullptr /*tail*/ ) ) {
+		sqlite3_bind_pointer( stmt, 1 /*param*/, &api, "fts5_api_ptr", nullptr /*destructor*/ );
+		sqlite3_step( stmt );
+		sqlite3_finalize( stmt );
+	}
+	if ( ( nullptr != api ) && ( api->iVersion >= 2 ) ) {
+		registered = ( SQLITE_OK == api->xCreateFunction( api, s_RankFunction, nullptr /*userData*/, RankFunction, nullptr /*destroy*/ ) );
+	}
+	return registered;
+}
+
+bool MediaSearch::CreateIndex( sqlite3* database )
+{
+	bool available = false;
+	if ( ( nullptr != database ) && RegisterRankFunction( database ) ) {
+		// Count the index objects which already exist, so that the index can be rebuilt if any of them are missing.
+		std::string countQuery = "SELECT COUNT(*) FROM sqlite_master WHERE name IN ('MediaSearch'";
+		for ( const auto& [ name, query ] : s_Triggers ) {
+			countQuery += ",'" + name + "'";
+		}
+		countQuery += ");";
+		size_t existingObjects = 0;
+		sqlite3_stmt* stmt = nullptr;
+		if ( SQLITE_OK == sqlite3_prepare_v2( database, countQuery.c_str(), -1 /*nByte*/, &stmt, nullptr /*tail*/ ) ) {
+			if ( SQLITE_ROW == sqlite3_step( stmt ) ) {
+				existingObjects = static_cast<size_t>( sqlite3_column_int64( stmt, 0 /*columnIndex*/ ) );
+			}
+			sqlite3_finalize( stmt );
+		}
+
+		// Use a savepoint, rather than a transaction, in case a library batch is already open.
+		std::string createQuery = "SAVEPOINT MediaSearch;" + s_CreateTableQuery;
+		for ( const auto& [ name, query ] : s_Triggers ) {
+			createQuery += query;
+		}
+		if ( ( 1 + s_Triggers.size() ) != existingObjects ) {
+			createQuery += s_RebuildQuery;
+		}
+		createQuery += "RELEASE MediaSearch;";
+		available = ( SQLITE_OK == sqlite3_exec( database, createQuery.c_str(), NULL /*callback*/, NULL /*arg*/, NULL /*errMsg*/ ) );
+		if ( !available ) {
+			sqlite3_exec( database, "ROLLBACK TO MediaSearch; RELEASE MediaSearch;", NULL /*callback*/, NULL /*arg*/, NULL /*errMsg*/ );
+		}
+	}
+	return available;
+}
+
+bool MediaSearch::CanRank( sqlite3* database, const std::string& matchQuery )
+{
+	bool canRank = false;
+	sqlite3_stmt* stmt = nullptr;
+	if ( ( nullptr != database ) && ( SQLITE_OK == sqlite3_prepare_v2( database, s_CountQuery.c_str(), -1 /*nByte*/, &stmt, nullptr /*tail*/ ) ) ) {
+		if ( ( SQLITE_OK == sqlite3_bind_text( stmt, 1 /*param*/, matchQuery.c_str(), -1 /*strLen*/, SQLITE_TRANSIENT ) ) && ( SQLITE_ROW == sqlite3_step( stmt ) ) ) {
+			canRank = ( sqlite3_column_int64( stmt, 0 /*columnIndex*/ ) <= s_MaxRankedMatches );
+		}
+		sqlite3_finalize( stmt );
+	}
+	return canRank;
+}
+
+const std::string& MediaSearch::GetSelectQuery( const bool ranked )
+{
+	return ranked ? s_RankedSelectQuery : s_UnrankedSelectQuery;
+}
+
+std::string MediaSearch::GetMatchQuery( const std::string& text )
+{
+	// Quote each word (so that punctuation is not treated as query syntax), and match it as a prefix.
+	std::string query;
+	std::stringstream stream( text );
+	std::string word;
+	while ( stream >> word ) {
+		word.erase( std::remove( word.begin(), word.end(), '"' ), word.end() );
+		if ( !word.empty() ) {
+			if ( !query.empty() ) {
+				query += " ";
+			}
+			query += "\"" + word + "\"*";
+		}
+	}
+	return query;
+}
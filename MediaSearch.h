@@ -0,0 +1,28 @@
+#pragma once
+
+#include <sqlite3.h>
+
+#include <string>
+
+// Full text search index over the media library table.
+// The index is an external content table, which reads column values from the media table rather than storing a copy of them, and triggers on the media table keep the index in step.
+class MediaSearch
+{
+public:
+	// Creates the search index and its triggers if necessary, and registers the rank function used by the search queries with the 'database' connection.
+	// The index is rebuilt from the media table if the index, or any of its triggers, were missing (the triggers are dropped along with the media table, should the table be recreated).
+	// 'database' - database containing the media table.
+	// Returns whether the search index is available.
+	static bool CreateIndex( sqlite3* database );
+
+	// Returns whether the full text 'matchQuery' has few enough matches to be ranked by relevance, within a bounded time.
+	// 'database' - database containing the search index.
+	static bool CanRank( sqlite3* database, const std::string& matchQuery );
+
+	// Returns the query which selects the media table rows matching a full text query (parameter 1), up to a maximum number of rows (parameter 2).
+	// 'ranked' - whether the rows are ordered by relevance, rather than in media table order.
+	static const std::string& GetSelectQuery( const bool ranked );
+
+	// Returns the UTF-8 search 'text' as a full text query, with each word quoted and matched as a prefix, or an empty string if there are no words to match.
+	static std::string GetMatchQuery( const std::string& text );
+};
@@ -1,6 +1,10 @@
 #include "Output.h"
 
+#include "AllocationCounter.h"
+#include "DSPKernels.h"
+#include "EncoderPCM.h"
 #include "GainCalculator.h"
+#include "TrackAnalyser.h"
 #include "Utility.h"
 #include "VUPlayer.h"
 
@@ -10,7 +14,12 @@
 #include "bassmix.h"
 #include "basswasapi.h"
 
+#include <crtdbg.h>
+
 #include <cmath>
+#include <filesystem>
+#include <set>
+#include <thread>
 
 // Output buffer length, in seconds.
 constexpr float s_BufferLength = 1.5f;
@@ -30,9 +39,6 @@ constexpr float s_GainMax = 20.0f;
 // Fade out duration, in seconds.
 constexpr float s_FadeOutDuration = 5.0f;
 
-// The relative volume at which to set the crossfade position on a track.
-constexpr float s_CrossfadeVolume = 0.3f;
-
 // The fade to next duration, in seconds.
 constexpr float s_FadeToNextDuration = 3.0f;
 
@@ -45,19 +51,34 @@ constexpr DWORD s_StopFadeDuration = 20;
 // Maximum number of playlist items to skip when trying to switch decoder streams.
 constexpr size_t s_MaxSkipItems = 20;
 
-// Define to output debug timing for slow StreamProc calls.
-#undef STREAMPROC_TIMING
+// Maximum number of loudness precalculation threads.
+constexpr size_t s_LoudnessPrecalcMaxThreads = 8;
+
+// Pre-buffer level below which playback decoding is considered to be under pressure, and loudness precalculation is throttled.
+constexpr float s_LoudnessPrecalcThrottleLevel = 0.5f;
+
+// Decode load (the time taken to read sample data from the decoder, as a proportion of its duration) above which playback decoding is considered to be under pressure, and loudness precalculation is throttled.
+constexpr float s_LoudnessPrecalcThrottleLoad = 0.25f;
+
+// Smoothing factor applied to each decode load measurement.
+constexpr float s_DecodeLoadSmoothing = 0.1f;
+
+// Interval at which throttled loudness precalculation threads check whether they can resume, in milliseconds.
+constexpr DWORD s_LoudnessPrecalcThrottleInterval = 250;
+
+// Length of each output stream callback when rendering offline, in seconds.
+constexpr float s_RenderCallbackLength = 0.01f;
+
+// Bits per sample of the WAV file written when rendering offline.
+constexpr long s_RenderBitsPerSample = 24;
 
 DWORD CALLBACK Output::StreamProc( HSTREAM handle, void *buf, DWORD length, void *user )
 {
 	DWORD bytesRead = 0;
 	Output* output = static_cast<Output*>( user );
 	if ( nullptr != output ) {
-#ifdef STREAMPROC_TIMING
-		LARGE_INTEGER perfFreq, perfCount1, perfCount2;
-		QueryPerformanceFrequency( &perfFreq );
-		QueryPerformanceCounter( &perfCount1 );
-#endif
+		const AllocationCounter::Scope allocationCounter;
+		const OutputDiagnostics::Timer timer( output->m_Diagnostics, OutputDiagnostics::Stage::StreamCallback );
 
 		float* sampleBuffer = static_cast<float*>( buf );
 		bytesRead = output->ApplyLeadIn( sampleBuffer, length, handle );
@@ -70,15 +91,11 @@ DWORD CALLBACK Output::StreamProc( HSTREAM handle, void *buf, DWORD length, void
 				output->SetOutputStreamFinished( true );
 			}
 		}
-
-#ifdef STREAMPROC_TIMING
-		QueryPerformanceCounter( &perfCount2 );
-		const float msec = 1000 * static_cast<float>( perfCount2.QuadPart - perfCount1.QuadPart ) / perfFreq.QuadPart;
-		if ( msec >= 1.0f ) {
-			const std::wstring debugStr = L"VUPlayer::Output::StreamProc: " + std::to_wstring( msec ) + L"ms\r\n";
-			OutputDebugString( debugStr.c_str() );
+		if ( allocationCounter.IsOutermost() ) {
+			// The output callbacks must not allocate (this is only checked in debug builds, whether or not diagnostics are enabled).
+			_ASSERTE( 0 == allocationCounter.GetCount() );
+			output->m_Diagnostics.RecordRealtimeAllocations( allocationCounter.GetCount() );
 		}
-#endif
 	}
 	return bytesRead;
 }
@@ -88,6 +105,8 @@ DWORD CALLBACK Output::WasapiProc( void *buffer, DWORD length, void *user )
 	DWORD bytesRead = 0;
 	Output* output = static_cast<Output*>( user );
 	if ( nullptr != output ) {
+		const AllocationCounter::Scope allocationCounter;
+		const OutputDiagnostics::Timer timer( output->m_Diagnostics, OutputDiagnostics::Stage::DeviceCallback );
 		if ( output->m_WASAPIPaused ) {
 			float* sampleBuffer = static_cast<float*>( buffer );
 			if ( nullptr != sampleBuffer ) {
@@ -103,6 +122,11 @@ DWORD CALLBACK Output::WasapiProc( void *buffer, DWORD length, void *user )
 				}
 			}
 		}
+		if ( allocationCounter.IsOutermost() ) {
+			// The output callbacks must not allocate (this is only checked in debug builds, whether or not diagnostics are enabled).
+			_ASSERTE( 0 == allocationCounter.GetCount() );
+			output->m_Diagnostics.RecordRealtimeAllocations( allocationCounter.GetCount() );
+		}
 	}
 	return bytesRead;
 }
@@ -187,6 +211,7 @@ Output::Output( const HINSTANCE instance, const HWND hwnd, const Handlers& handl
 	m_SoftClipStateDecoding(),
 	m_DecoderStream(),
 	m_DecoderSampleRate( 0 ),
+	m_DecoderChannels( 0 ),
 	m_OutputStream( 0 ),
 	m_MixerStream( 0 ),
 	m_PlaylistMutex(),
@@ -206,6 +231,7 @@ Output::Output( const HINSTANCE instance, const HWND hwnd, const Handlers& handl
 	m_GainPreamp( 0 ),
 	m_RetainStopAtTrackEnd( m_Settings.GetRetainStopAtTrackEnd() ),
 	m_StopAtTrackEnd( m_RetainStopAtTrackEnd ? m_Settings.GetStopAtTrackEnd() : false ),
+	m_SilenceThreshold( powf( 10.0f, m_Settings.GetSilenceThreshold() / 20.0f ) ),
 	m_Muted( false ),
 	m_FadeOut( false ),
 	m_FadeToNext( false ),
@@ -218,6 +244,8 @@ Output::Output( const HINSTANCE instance, const HWND hwnd, const Handlers& handl
 	m_CrossfadeStopEvent( CreateEvent( NULL /*attributes*/, TRUE /*manualReset*/, FALSE /*initialState*/, L"" /*name*/ ) ),
 	m_LoudnessPrecalcThread( nullptr ),
 	m_LoudnessPrecalcStopEvent( CreateEvent( NULL /*attributes*/, TRUE /*manualReset*/, FALSE /*initialState*/, L"" /*name*/ ) ),
+	m_DecodeUnderPressure( false ),
+	m_DecodeLoad( 0 ),
 	m_PreloadDecoderThread( nullptr ),
 	m_PreloadDecoderStopEvent( CreateEvent( NULL /*attributes*/, TRUE /*manualReset*/, FALSE /*initialState*/, L"" /*name*/ ) ),
 	m_PreloadDecoderWakeEvent( CreateEvent( NULL /*attributes*/, TRUE /*manualReset*/, FALSE /*initialState*/, L"" /*name*/ ) ),
@@ -228,6 +256,12 @@ Output::Output( const HINSTANCE instance, const HWND hwnd, const Handlers& handl
 	m_SoftClipStateCrossfading(),
 	m_CrossfadeSeekOffset( 0 ),
 	m_GainEstimateMap(),
+	m_GainEstimateMutex(),
+	m_GainEstimatePending( false ),
+	m_GainScales( { std::make_pair( 0.0f, 1.0f ), std::make_pair( 0.0f, 1.0f ) } ),
+	m_GainScaleIndex( 0 ),
+	m_CrossfadingBuffer(),
+	m_Diagnostics(),
 	m_CurrentEQ( m_Settings.GetEQSettings() ),
 	m_FX(),
 	m_EQEnabled( m_CurrentEQ.Enabled ),
@@ -239,6 +273,7 @@ Output::Output( const HINSTANCE instance, const HWND hwnd, const Handlers& handl
 	m_ResetASIO( false ),
 	m_OutputStreamFinished( false ),
 	m_MixerStreamHasEndSync( false ),
+	m_Rendering( false ),
 	m_LeadInSeconds( 0 ),
 	m_PreloadedDecoder( {} ),
 	m_PreloadedDecoderMutex(),
@@ -306,6 +341,7 @@ bool Output::Play( const long playlistID, const float seek )
 	}
 
 	if ( m_Playlist && m_Playlist->GetItem( item ) ) {
+		RefreshTrackAnalysis( item );
 		m_DecoderStream = OpenOutputDecoder( item );
 		if ( m_DecoderStream ) {
 
@@ -318,6 +354,7 @@ bool Output::Play( const long playlistID, const float seek )
 			EstimateGain( item );
 
 			m_DecoderSampleRate = m_DecoderStream->GetSampleRate();
+			m_DecoderChannels = m_DecoderStream->GetChannels();
 			const DWORD freq = static_cast<DWORD>( m_DecoderSampleRate );
 			float seekPosition = seek;
 			if ( 0.0f != seekPosition ) {
@@ -329,13 +366,15 @@ bool Output::Play( const long playlistID, const float seek )
 				}
 				seekPosition = m_DecoderStream->Seek( seekPosition );
 			} else if ( GetCrossfade() ) {
-				m_DecoderStream->SkipSilence();
+				m_DecoderStream->SkipSilence( m_SilenceThreshold, GetLeadingSilence( item ) );
 			}
 
-			if ( ( Settings::OutputMode::Standard != m_OutputMode ) && !IsURL( item.Info.GetFilename() ) ) {
+			if ( ( Settings::OutputMode::Standard != m_OutputMode ) && !m_Rendering && !IsURL( item.Info.GetFilename() ) ) {
 				m_DecoderStream->PreBuffer( m_OnPreBufferFinishedCallback );
 			}
 
+			ResizeScratchBuffers( m_DecoderSampleRate, m_DecoderChannels, outputBufferSize / 1000.0f );
+
 			if ( CreateOutputStream( item.Info ) ) {
 				m_CurrentItemDecoding = item;
 				UpdateOutputVolume();
@@ -370,7 +409,7 @@ bool Output::Play( const long playlistID, const float seek )
 void Output::Stop()
 {
 	if ( 0 != m_OutputStream ) {
-		if ( Settings::OutputMode::Standard == m_OutputMode ) {
+		if ( ( Settings::OutputMode::Standard == m_OutputMode ) && !m_Rendering ) {
 			if ( BASS_ACTIVE_PLAYING == BASS_ChannelIsActive( m_OutputStream ) ) {
 				const HANDLE slideFinishedEvent = CreateEvent( nullptr /*attributes*/, FALSE /*manualReset*/, FALSE /*initial*/, L"" /*name*/ );
 				if ( nullptr != slideFinishedEvent ) {
@@ -416,6 +455,7 @@ void Output::Stop()
 
 	m_FX.clear();
 	m_DecoderSampleRate = 0;
+	m_DecoderChannels = 0;
 	m_DecoderStream.reset();
 	m_CrossfadingStream.reset();
 	m_CurrentItemDecoding = {};
@@ -436,6 +476,11 @@ void Output::Stop()
 	m_MixerStreamHasEndSync = false;
 	StopCrossfadeThread();
 	StopLoudnessPrecalcThread();
+	m_GainEstimatePending = false;
+	{
+		std::lock_guard<std::mutex> lock( m_GainEstimateMutex );
+		m_GainEstimateMap.clear();
+	}
 	std::lock_guard<std::mutex> lock( m_PreloadedDecoderMutex );
 	m_PreloadedDecoder = {};
 	SetStreamTitleQueue( {} );
@@ -538,6 +583,94 @@ void Output::Play( const Playlist::Ptr playlist, const long startID, const float
 	Play( startID, seek );
 }
 
+bool Output::Render( const Playlist::Ptr playlist, const std::wstring& filename, RenderStatistics& statistics )
+{
+	statistics = {};
+	Stop();
+	m_Rendering = true;
+	m_Playlist = playlist;
+
+	const bool diagnosticsEnabled = m_Diagnostics.IsEnabled();
+	m_Diagnostics.Reset();
+	m_Diagnostics.SetEnabled( true );
+
+	bool success = Play();
+	std::unique_ptr<Encoder> encoder;
+	if ( success ) {
+		statistics.SampleRate = m_DecoderSampleRate;
+		statistics.Channels = m_DecoderChannels;
+		if ( !filename.empty() ) {
+			// The encoder adds the file extension.
+			std::wstring encoderFilename = std::filesystem::path( filename ).replace_extension().wstring();
+			encoder = std::make_unique<EncoderPCM>();
+			success = encoder->Open( encoderFilename, statistics.SampleRate, statistics.Channels, s_RenderBitsPerSample, 0 /*totalSamples*/, {} /*settings*/, {} /*tags*/ );
+		}
+	}
+
+	if ( success ) {
+		const long callbackFrames = std::max( 1l, static_cast<long>( statistics.SampleRate * s_RenderCallbackLength ) );
+		std::vector<float> buffer( static_cast<size_t>( callbackFrames ) * statistics.Channels );
+		const DWORD callbackBytes = static_cast<DWORD>( buffer.size() * sizeof( float ) );
+
+		// The first output queue entry is the initial track, each subsequent entry is a transition.
+		size_t queueEntriesChecked = 1;
+		float crossfadePosition = 0;
+
+		const LONGLONG renderStart = GetTick();
+		while ( success && ( 0 != m_OutputStream ) ) {
+			if ( const float position = GetCrossfadePosition(); position > 0 ) {
+				crossfadePosition = position;
+			}
+
+			const LONGLONG callbackStart = GetTick();
+			const DWORD bytesRead = BASS_ChannelGetData( m_OutputStream, buffer.data(), callbackBytes );
+			statistics.CallbackTimes.push_back( GetInterval( callbackStart, GetTick() ) );
+
+			if ( ( static_cast<DWORD>( -1 ) == bytesRead ) || ( 0 == bytesRead ) ) {
+				if ( m_RestartItemID > 0 ) {
+					// The next track could not be chained to the current stream, so restart from the next track (as the main window does during playback).
+					const long restartItemID = m_RestartItemID;
+					++statistics.Restarts;
+					success = Play( restartItemID ) && ( statistics.SampleRate == m_DecoderSampleRate ) && ( statistics.Channels == m_DecoderChannels );
+					queueEntriesChecked = 1;
+					crossfadePosition = 0;
+				} else {
+					break;
+				}
+			} else {
+				const long framesRead = static_cast<long>( bytesRead / ( statistics.Channels * sizeof( float ) ) );
+				statistics.SampleFrames += framesRead;
+				if ( encoder ) {
+					success = encoder->Write( buffer.data(), framesRead );
+				}
+
+				// Compare the length of each track which has just finished with its expected length (up to the crossfade position, if there was one).
+				const Queue queue = GetOutputQueue();
+				for ( ; queueEntriesChecked < queue.size(); queueEntriesChecked++ ) {
+					const Item& previous = queue[ queueEntriesChecked - 1 ];
+					const Item& next = queue[ queueEntriesChecked ];
+					const float actualLength = next.Position - previous.Position;
+					const float expectedLength = ( crossfadePosition > 0 ) ? crossfadePosition : ( previous.PlaylistItem.Info.GetDuration() - previous.InitialSeek );
+					statistics.TransitionErrors.push_back( actualLength - expectedLength );
+					crossfadePosition = 0;
+				}
+			}
+		}
+		statistics.ElapsedSeconds = GetInterval( renderStart, GetTick() );
+	}
+
+	if ( encoder ) {
+		encoder->Close();
+	}
+
+	Stop();
+	m_Rendering = false;
+
+	statistics.Diagnostics = m_Diagnostics.GetReport();
+	m_Diagnostics.SetEnabled( diagnosticsEnabled );
+	return success;
+}
+
 Playlist::Ptr Output::GetPlaylist()
 {
 	return m_Playlist;
@@ -545,6 +678,10 @@ Playlist::Ptr Output::GetPlaylist()
 
 Output::State Output::GetState()
 {
+	if ( m_Rendering ) {
+		return ( 0 != m_OutputStream ) ? State::Playing : State::Stopped;
+	}
+
 	State state = State::Stopped;
 	switch ( m_OutputMode ) {
 		case Settings::OutputMode::Standard : {
@@ -641,8 +778,7 @@ DWORD Output::ReadSampleData( float* buffer, const DWORD byteCount, HSTREAM hand
 					bool checkCrossFade = ( GetRandomPlay() || GetRepeatTrack() );
 					if ( !checkCrossFade ) {
 						std::lock_guard<std::mutex> lock( m_PlaylistMutex );
-						Playlist::Item nextItem = {};
-						checkCrossFade = m_Playlist->GetNextItem( m_CurrentItemDecoding, nextItem, GetRepeatPlaylist() /*wrap*/ );
+						checkCrossFade = m_Playlist->HasNextItem( m_CurrentItemDecoding, GetRepeatPlaylist() /*wrap*/ );
 					}
 					if ( checkCrossFade ) {
 						// Ensure we don't read past the crossfade point.
@@ -655,7 +791,8 @@ DWORD Output::ReadSampleData( float* buffer, const DWORD byteCount, HSTREAM hand
 								samplesToRead = samplesTillCrossfade;
 								if ( samplesToRead <= 0 ) {
 									samplesToRead = 0;
-									// Hold on the the decoder, and indicate its fade out position.
+									// Hold on the the decoder, and indicate its fade out position (this is a track transition, so allocations are allowed).
+									const AllocationCounter::Suspend suspendAllocationCounter;
 									std::lock_guard<std::mutex> crossfadingStreamLock( m_CrossfadingStreamMutex );
 									m_CrossfadingStream = m_DecoderStream;
 									m_CurrentItemCrossfading = m_CurrentItemDecoding;
@@ -669,6 +806,7 @@ DWORD Output::ReadSampleData( float* buffer, const DWORD byteCount, HSTREAM hand
 			} else if ( GetFadeToNext() && m_SwitchToNext ) {
 				ToggleFadeToNext();
 				samplesToRead = 0;
+				const AllocationCounter::Suspend suspendAllocationCounter;
 				std::lock_guard<std::mutex> crossfadingStreamLock( m_CrossfadingStreamMutex );
 				m_CrossfadingStream = m_DecoderStream;
 				m_CurrentItemCrossfading = m_CurrentItemDecoding;
@@ -677,10 +815,11 @@ DWORD Output::ReadSampleData( float* buffer, const DWORD byteCount, HSTREAM hand
 				m_SoftClipStateCrossfading = m_SoftClipStateDecoding;
 			}
 
-			bytesRead = static_cast<DWORD>( m_DecoderStream->Read( buffer, samplesToRead ) * channels * 4 );
+			bytesRead = static_cast<DWORD>( ReadDecoder( *m_DecoderStream, buffer, samplesToRead ) * channels * 4 );
 		}
 
 		if ( m_DecoderStream->SupportsStreamTitles() ) {
+			const AllocationCounter::Suspend suspendAllocationCounter;
 			auto streamTitleQueue = GetStreamTitleQueue();
 			const auto [ seconds, displayTitle ] = m_DecoderStream->GetStreamTitle();
 			if ( m_StreamTitleQueue.empty() || ( seconds != m_StreamTitleQueue.back().first ) ) {
@@ -690,8 +829,10 @@ DWORD Output::ReadSampleData( float* buffer, const DWORD byteCount, HSTREAM hand
 		}
 	}
 
-	// Check if we need to switch to the next decoder stream.
+	// Check if we need to switch to the next decoder stream (this is a track transition, so allocations are allowed).
 	if ( 0 == bytesRead ) {
+		const AllocationCounter::Suspend suspendAllocationCounter;
+		const OutputDiagnostics::Timer timer( m_Diagnostics, OutputDiagnostics::Stage::Transition );
 		SetCrossfadePosition( 0 );
 		m_LastTransitionPosition = 0;
 
@@ -704,16 +845,21 @@ DWORD Output::ReadSampleData( float* buffer, const DWORD byteCount, HSTREAM hand
 			Playlist::Item nextItem = m_CurrentItemDecoding;
 			auto nextDecoder = GetNextDecoder( nextItem );
 			if ( nextDecoder && !IsURL( nextItem.Info.GetFilename() ) ) {
-				EstimateGain( nextItem );
+				m_GainEstimatePending = !ApplyGainEstimate( nextItem, *nextDecoder );
+				if ( m_GainEstimatePending ) {
+					m_Diagnostics.RecordGainEstimateFallback();
+				}
 				const long channels = m_DecoderStream->GetChannels();
 				const long sampleRate = m_DecoderStream->GetSampleRate();
+				// The next decoder is converted to the current stream format, so playback only needs restarting if the conversion could not be set up.
 				if ( ( nextDecoder->GetChannels() == channels ) && ( nextDecoder->GetSampleRate() == sampleRate ) ) {
-					if ( GetCrossfade() || GetFadeToNext() ) {
-						nextDecoder->SkipSilence();
+					// Leading silence is skipped on the preload thread for a pre-buffered decoder, as skipping it here would wait for the pre-buffer to be primed again.
+					if ( ( GetCrossfade() || GetFadeToNext() ) && !nextDecoder->IsSilenceSkipped() && !nextDecoder->IsPreBuffering() ) {
+						nextDecoder->SkipSilence( m_SilenceThreshold, GetLeadingSilence( nextItem ) );
 					}
 
 					const long sampleCount = static_cast<long>( byteCount ) / ( channels * 4 );
-					bytesRead = static_cast<DWORD>( nextDecoder->Read( buffer, sampleCount ) * channels * 4 );
+					bytesRead = static_cast<DWORD>( ReadDecoder( *nextDecoder, buffer, sampleCount ) * channels * 4 );
 					if ( bytesRead > 0 ) {
 						m_LastTransitionPosition = GetDecodePosition() - m_LeadInSeconds;
 						Queue queue = GetOutputQueue();
@@ -750,21 +896,31 @@ DWORD Output::ReadSampleData( float* buffer, const DWORD byteCount, HSTREAM hand
 	}
 
 	if ( 0 != bytesRead ) {
-		const long currentDecodingChannels = OutputDecoder::GetOutputChannels( m_CurrentItemDecoding.Info );
-		if ( currentDecodingChannels > 0 ) {
-			ApplyGain( buffer, static_cast<long>( bytesRead / ( currentDecodingChannels * 4 ) ), m_CurrentItemDecoding, m_SoftClipStateDecoding );
+		// All decoders are converted to the output stream format, so the stream format applies to both the decoding and crossfading streams.
+		const long channels = m_DecoderChannels;
+		const long samplerate = m_DecoderSampleRate;
+		if ( channels > 0 ) {
+			const OutputDiagnostics::Timer timer( m_Diagnostics, OutputDiagnostics::Stage::Gain );
+			if ( m_GainEstimatePending && m_DecoderStream ) {
+				// Pick up a gain estimate which was not ready at the track transition.
+				m_GainEstimatePending = !ApplyGainEstimate( m_CurrentItemDecoding, *m_DecoderStream );
+			}
+			ApplyGain( buffer, static_cast<long>( bytesRead / ( channels * 4 ) ), channels, m_CurrentItemDecoding, m_SoftClipStateDecoding );
 		}
 
 		std::lock_guard<std::mutex> crossfadingStreamLock( m_CrossfadingStreamMutex );
 		if ( m_CrossfadingStream ) {
+			const OutputDiagnostics::Timer timer( m_Diagnostics, OutputDiagnostics::Stage::Crossfade );
 			// Decode and fade out the crossfading stream and mix with the final output buffer.
-			const long channels = OutputDecoder::GetOutputChannels( m_CurrentItemCrossfading.Info );
-			const long samplerate = m_CurrentItemCrossfading.Info.GetSampleRate();
 			if ( ( channels > 0 ) && ( samplerate > 0 ) ) {
 				const long samplesToRead = static_cast<long>( bytesRead ) / ( channels * 4 );
-				std::vector<float> crossfadingBuffer( bytesRead / 4 );
-				const long crossfadingBytesRead = m_CrossfadingStream->Read( crossfadingBuffer.data(), samplesToRead ) * channels * 4;
-				ApplyGain( crossfadingBuffer.data(), crossfadingBytesRead / ( channels * 4 ), m_CurrentItemCrossfading, m_SoftClipStateCrossfading );
+				if ( m_CrossfadingBuffer.size() < ( bytesRead / 4 ) ) {
+					// Should not happen, as the scratch buffer is sized to hold the whole output buffer.
+					m_CrossfadingBuffer.resize( bytesRead / 4 );
+				}
+				float* crossfadingBuffer = m_CrossfadingBuffer.data();
+				const long crossfadingBytesRead = m_CrossfadingStream->Read( crossfadingBuffer, samplesToRead ) * channels * 4;
+				ApplyGain( crossfadingBuffer, crossfadingBytesRead / ( channels * 4 ), channels, m_CurrentItemCrossfading, m_SoftClipStateCrossfading );
 				if ( crossfadingBytesRead <= static_cast<long>( bytesRead ) ) {
 					long crossfadingSamplesRead = crossfadingBytesRead / ( channels * 4 );
 
@@ -776,32 +932,18 @@ DWORD Output::ReadSampleData( float* buffer, const DWORD byteCount, HSTREAM hand
 								crossfadingSamplesRead = 0;
 							} else {
 								const float fadeOutEndPosition = m_FadeOutStartPosition + GetFadeOutDuration();
-								for ( long sampleIndex = 0; sampleIndex < crossfadingSamplesRead; sampleIndex++ ) {
-									const float pos = static_cast<float>( sampleIndex ) / samplerate;			
-									float scale = static_cast<float>( fadeOutEndPosition - currentPos - pos ) / GetFadeOutDuration();
-									if ( ( scale < 0 ) || ( scale > 1.0f ) ) {
-										scale = 0;
-									}
-									for ( long channel = 0; channel < channels; channel++ ) {
-										crossfadingBuffer[ sampleIndex * channels + channel ] *= scale;
-									}
-								}
+								const float fadeStart = ( fadeOutEndPosition - currentPos ) / GetFadeOutDuration();
+								const float fadeStep = -1.0f / ( samplerate * GetFadeOutDuration() );
+								DSPKernels::Fade( crossfadingBuffer, crossfadingSamplesRead, channels, fadeStart, fadeStep, DSPKernels::FadeCurve::Linear );
 							}
 						}
 					} else {
 						// Crossfade.
 						const float trackPos = GetDecodePosition() - m_LastTransitionPosition - m_LeadInSeconds;
 						if ( ( crossfadingBytesRead > 0 ) && ( trackPos < GetFadeOutDuration() ) ) {				
-							for ( long sampleIndex = 0; sampleIndex < crossfadingSamplesRead; sampleIndex++ ) {
-								const float pos = static_cast<float>( sampleIndex ) / samplerate;			
-								float scale = static_cast<float>( GetFadeOutDuration() - trackPos - pos ) / GetFadeOutDuration();
-								if ( ( scale < 0 ) || ( scale > 1.0f ) ) {
-									scale = 0;
-								}
-								for ( long channel = 0; channel < channels; channel++ ) {
-									crossfadingBuffer[ sampleIndex * channels + channel ] *= scale;
-								}
-							}
+							const float fadeStart = ( GetFadeOutDuration() - trackPos ) / GetFadeOutDuration();
+							const float fadeStep = -1.0f / ( samplerate * GetFadeOutDuration() );
+							DSPKernels::Fade( crossfadingBuffer, crossfadingSamplesRead, channels, fadeStart, fadeStep, DSPKernels::FadeCurve::Linear );
 						} else {
 							crossfadingSamplesRead = 0;
 						}
@@ -813,9 +955,7 @@ DWORD Output::ReadSampleData( float* buffer, const DWORD byteCount, HSTREAM hand
 						m_CrossfadingItemID = m_CurrentItemCrossfading.ID;
 						m_SoftClipStateCrossfading.clear();
 					} else {
-						for ( long sample = 0; sample < crossfadingSamplesRead * channels; sample++ ) {
-							buffer[ sample ] += crossfadingBuffer[ sample ];
-						}
+						DSPKernels::MixAdd( buffer, crossfadingBuffer, static_cast<size_t>( crossfadingSamplesRead ) * channels );
 					}
 				}
 			}
@@ -836,16 +976,9 @@ DWORD Output::ReadSampleData( float* buffer, const DWORD byteCount, HSTREAM hand
 			} else {
 				const long sampleCount = static_cast<long>( bytesRead ) / ( channels * 4 );
 				const float fadeOutEndPosition = m_FadeOutStartPosition + GetFadeOutDuration();
-				for ( long sampleIndex = 0; sampleIndex < sampleCount; sampleIndex++ ) {
-					const float pos = static_cast<float>( sampleIndex ) / samplerate;			
-					float scale = static_cast<float>( fadeOutEndPosition - currentPos - pos ) / GetFadeOutDuration();
-					if ( ( scale < 0 ) || ( scale > 1.0f ) ) {
-						scale = 0;
-					}
-					for ( long channel = 0; channel < channels; channel++ ) {
-						buffer[ sampleIndex * channels + channel ] *= scale;
-					}
-				}
+				const float fadeStart = ( fadeOutEndPosition - currentPos ) / GetFadeOutDuration();
+				const float fadeStep = -1.0f / ( samplerate * GetFadeOutDuration() );
+				DSPKernels::Fade( buffer, sampleCount, channels, fadeStart, fadeStep, DSPKernels::FadeCurve::Linear );
 
 				if ( GetFadeToNext() && ( currentPos > ( m_FadeOutStartPosition + GetFadeToNextDuration() ) ) ) {
 					m_SwitchToNext = true;
@@ -1017,7 +1150,10 @@ void Output::GetFFTData( std::vector<float>& fft )
 void Output::OnSyncEnd()
 {
 	if ( m_RestartItemID > 0 ) {
-		PostMessage( m_Parent, MSG_RESTARTPLAYBACK, m_RestartItemID, NULL /*lParam*/ );
+		// When rendering offline, the render loop restarts playback itself.
+		if ( !m_Rendering ) {
+			PostMessage( m_Parent, MSG_RESTARTPLAYBACK, m_RestartItemID, NULL /*lParam*/ );
+		}
 	} else if ( GetStopAtTrackEnd() || GetFadeOut() ) {
 		if ( GetStopAtTrackEnd() && !m_RetainStopAtTrackEnd ) {
 			ToggleStopAtTrackEnd();
@@ -1089,6 +1225,8 @@ void Output::SetCrossfade( const bool enabled )
 				const Item item = *iter;
 				CalculateCrossfadePoint( item.PlaylistItem, item.InitialSeek );
 			}
+			SkipPreloadedSilence();
+			StartLoudnessPrecalcThread();
 		}
 	} else {
 		StopCrossfadeThread();
@@ -1213,6 +1351,7 @@ void Output::SettingsChanged()
 	}
 
 	m_RetainStopAtTrackEnd = m_Settings.GetRetainStopAtTrackEnd();
+	m_SilenceThreshold = powf( 10.0f, m_Settings.GetSilenceThreshold() / 20.0f );
 
 	m_Handlers.SettingsChanged( m_Settings );
 }
@@ -1268,8 +1407,9 @@ void Output::InitialiseBass()
 	}
 }
 
-void Output::EstimateGain( Playlist::Item& item )
+bool Output::IsGainEstimateRequired( const Playlist::Item& item ) const
 {
+	bool required = false;
 	if ( ( Settings::GainMode::Disabled != m_GainMode ) && !IsURL( item.Info.GetFilename() ) ) {
 		auto gain = item.Info.GetGainAlbum();
 		if ( !gain.has_value() || ( Settings::GainMode::Track == m_GainMode ) ) {
@@ -1277,103 +1417,173 @@ void Output::EstimateGain( Playlist::Item& item )
 				gain = trackGain;
 			}
 		}
-		if ( !gain.has_value() ) {
-			const auto estimateIter = m_GainEstimateMap.find( item.ID );
-			if ( m_GainEstimateMap.end() != estimateIter ) {
-				item.Info.SetGainTrack( estimateIter->second );
-			} else {
-				const auto tempDecoder = OpenDecoder( item );
-				if ( tempDecoder ) {
-					const auto trackGain = tempDecoder->CalculateTrackGain( [] () { return true; }, s_GainPrecalcTime );
-					item.Info.SetGainTrack( trackGain );
-					m_GainEstimateMap.insert( GainEstimateMap::value_type( item.ID, trackGain ) );
-				}
+		required = !gain.has_value();
+	}
+	return required;
+}
+
+void Output::EstimateGain( Playlist::Item& item )
+{
+	if ( IsGainEstimateRequired( item ) ) {
+		std::unique_lock<std::mutex> lock( m_GainEstimateMutex );
+		const auto estimateIter = m_GainEstimateMap.find( item.ID );
+		if ( m_GainEstimateMap.end() != estimateIter ) {
+			item.Info.SetGainTrack( estimateIter->second );
+		} else {
+			lock.unlock();
+			const auto tempDecoder = OpenDecoder( item );
+			if ( tempDecoder ) {
+				const auto trackGain = tempDecoder->CalculateTrackGain( [] () { return true; }, s_GainPrecalcTime );
+				item.Info.SetGainTrack( trackGain );
+				lock.lock();
+				m_GainEstimateMap.insert( GainEstimateMap::value_type( item.ID, trackGain ) );
 			}
 		}
 	}
 }
 
+bool Output::ApplyGainEstimate( Playlist::Item& item, const OutputDecoder& decoder ) const
+{
+	bool applied = true;
+	if ( IsGainEstimateRequired( item ) ) {
+		const auto estimate = decoder.GetGainEstimate();
+		if ( estimate.has_value() ) {
+			item.Info.SetGainTrack( estimate );
+		} else {
+			applied = false;
+		}
+	}
+	return applied;
+}
+
+OutputDiagnostics& Output::GetDiagnostics()
+{
+	return m_Diagnostics;
+}
+
+long Output::ReadDecoder( OutputDecoder& decoder, float* buffer, const long sampleCount )
+{
+	const auto level = decoder.GetPreBufferLevel();
+	const auto readStart = std::chrono::steady_clock::now();
+	long samplesRead = 0;
+	if ( m_Diagnostics.IsEnabled() ) {
+		const OutputDiagnostics::Timer timer( m_Diagnostics, OutputDiagnostics::Stage::Decode );
+		if ( level.has_value() ) {
+			m_Diagnostics.RecordPreBufferLevel( *level );
+		}
+		const long underruns = decoder.GetUnderrunCount();
+		samplesRead = decoder.Read( buffer, sampleCount );
+		m_Diagnostics.RecordUnderruns( decoder.GetUnderrunCount() - underruns );
+		if ( ( samplesRead > 0 ) && ( samplesRead < sampleCount ) ) {
+			m_Diagnostics.RecordShortRead();
+		}
+	} else {
+		samplesRead = decoder.Read( buffer, sampleCount );
+	}
+	UpdateDecodePressure( level, std::chrono::steady_clock::now() - readStart, samplesRead, decoder.GetSampleRate() );
+	return samplesRead;
+}
+
+void Output::UpdateDecodePressure( const std::optional<float>& preBufferLevel, const std::chrono::steady_clock::duration readTime, const long samplesRead, const long sampleRate )
+{
+	// The read time covers decoding in Standard mode, and any wait for the pre-buffer to refill in the other modes.
+	if ( ( samplesRead > 0 ) && ( sampleRate > 0 ) ) {
+		const float load = std::chrono::duration<float>( readTime ).count() * sampleRate / samplesRead;
+		m_DecodeLoad += s_DecodeLoadSmoothing * ( load - m_DecodeLoad );
+	}
+	const bool preBufferLow = preBufferLevel.has_value() && ( *preBufferLevel < s_LoudnessPrecalcThrottleLevel );
+	m_DecodeUnderPressure.store( preBufferLow || ( m_DecodeLoad > s_LoudnessPrecalcThrottleLoad ), std::memory_order_relaxed );
+}
+
+void Output::ResizeScratchBuffers( const long sampleRate, const long channels, const float bufferSeconds )
+{
+	// Output callbacks can request up to the whole output buffer at a time.
+	const size_t sampleCount = static_cast<size_t>( std::ceil( sampleRate * bufferSeconds ) ) * channels;
+	if ( m_CrossfadingBuffer.size() != sampleCount ) {
+		m_CrossfadingBuffer.resize( sampleCount );
+		m_CrossfadingBuffer.shrink_to_fit();
+	}
+	m_SoftClipStateDecoding.reserve( channels );
+	m_SoftClipStateCrossfading.reserve( channels );
+}
+
 void Output::CalculateCrossfadePoint( const Playlist::Item& item, const float seekOffset )
 {
 	StopCrossfadeThread();
 	ResetEvent( m_CrossfadeStopEvent );
-	m_CrossfadeItem = item;
-	m_CrossfadeSeekOffset = seekOffset;
-	m_CrossfadeThread = CreateThread( NULL /*attributes*/, 0 /*stackSize*/, CrossfadeThreadProc, reinterpret_cast<LPVOID>( this ), 0 /*flags*/, NULL /*threadId*/ );
+
+	// Any stored track analysis for the item has already been checked against the file (by RefreshTrackAnalysis), so it can be used without accessing the library.
+	if ( const auto crossfadeInfo = TrackAnalyser::GetCrossfadeInfo( item.Info ); crossfadeInfo.has_value() ) {
+		const auto [ crossfadePosition, leadingSilence ] = *crossfadeInfo;
+		SetCrossfadePosition( GetRelativeCrossfadePosition( crossfadePosition, leadingSilence, seekOffset ) );
+	} else {
+		m_CrossfadeItem = item;
+		m_CrossfadeSeekOffset = seekOffset;
+		m_CrossfadeThread = CreateThread( NULL /*attributes*/, 0 /*stackSize*/, CrossfadeThreadProc, reinterpret_cast<LPVOID>( this ), 0 /*flags*/, NULL /*threadId*/ );
+	}
 }
 
 void Output::CalculateCrossfadeHandler()
 {
-	const auto decoder = IsURL( m_CrossfadeItem.Info.GetFilename() ) ? nullptr : OpenDecoder( m_CrossfadeItem );
-	if ( decoder ) {
-		const float duration = decoder->GetDuration();
-		const long channels = decoder->GetChannels();
-		const long samplerate = decoder->GetSampleRate();
-		if ( ( duration > 0 ) && ( channels > 0 ) && ( samplerate > 0 ) ) {
-			if ( 0.0f == m_CrossfadeSeekOffset ) {
-				decoder->SkipSilence();
-			}
-
-			float position = 0;
-			if ( m_CrossfadeSeekOffset > 0 ) {
-				position = decoder->Seek( m_CrossfadeSeekOffset );
-			}
-			float crossfadePosition = 0;
-
-			int64_t cumulativeCount = 0;
-			double cumulativeTotal = 0;
-			double cumulativeRMS = 0;
-
-			const double crossfadeRMSRatio = s_CrossfadeVolume;
-			const long windowSize = samplerate / 10;
-			std::vector<float> buffer( windowSize * channels );
-
-			while ( WAIT_OBJECT_0 != WaitForSingleObject( m_CrossfadeStopEvent, 0 ) ) {
-				long sampleCount = decoder->Read( buffer.data(), windowSize );
-				if ( sampleCount > 0 ) {
-					auto sampleIter = buffer.begin();
-					double windowTotal = 0;
-					for ( long sampleIndex = 0; sampleIndex < sampleCount; sampleIndex++ ) {
-						for ( long channel = 0; channel < channels; channel++, sampleIter++, cumulativeCount++ ) {
-							const double value = *sampleIter * *sampleIter;
-							windowTotal += value;
-							cumulativeTotal += value;
-						}
-					}
-
-					const double windowRMS = sqrt( windowTotal / ( sampleCount * channels ) );
-					cumulativeRMS = sqrt( cumulativeTotal / cumulativeCount );
-					position += static_cast<float>( sampleCount ) / samplerate;
+	Decoder::CanContinue canContinue( [ stopEvent = m_CrossfadeStopEvent ] ()
+	{
+		return ( WAIT_OBJECT_0 != WaitForSingleObject( stopEvent, 0 ) );
+	} );
 
-					if ( windowRMS > cumulativeRMS ) {
-						crossfadePosition = position;
-					} else if ( ( cumulativeRMS > 0 ) && ( ( windowRMS / cumulativeRMS ) > crossfadeRMSRatio ) ) {
-						crossfadePosition = position;
+	Playlist::Ptr playlist;
+	{
+		std::lock_guard<std::mutex> lock( m_PlaylistMutex );
+		playlist = m_Playlist;
+	}
+
+	// Use any stored crossfade information for the file, so that the track only needs to be decoded if it has not been analysed since it last changed.
+	const MediaInfo& mediaInfo = m_CrossfadeItem.Info;
+	const bool isFile = ( MediaInfo::Source::File == mediaInfo.GetSource() ) && !IsURL( mediaInfo.GetFilename() );
+	float crossfadePosition = 0;
+	float leadingSilence = 0;
+	bool hasCrossfadeInfo = isFile && playlist && playlist->GetLibrary().GetCrossfadeInfo( mediaInfo.GetFilename(), crossfadePosition, leadingSilence );
+	if ( !hasCrossfadeInfo ) {
+		const auto decoder = IsURL( mediaInfo.GetFilename() ) ? nullptr : OpenDecoder( m_CrossfadeItem );
+		if ( decoder && ( decoder->GetDuration() > 0 ) ) {
+			if ( const auto result = TrackAnalyser::Analyse( *decoder, m_SilenceThreshold, canContinue ); result.has_value() ) {
+				crossfadePosition = result->CrossfadePosition;
+				leadingSilence = result->LeadingSilence;
+				hasCrossfadeInfo = true;
+
+				// Only store the analysis if the library entry matches the current state of the file.
+				if ( MediaInfo libraryInfo( mediaInfo.GetFilename() ); isFile && playlist &&
+						playlist->GetLibrary().GetMediaInfo( libraryInfo, true /*checkFileAttributes*/, false /*scanMedia*/, false /*sendNotification*/ ) ) {
+					const MediaInfo previousMediaInfo( libraryInfo );
+					TrackAnalyser::UpdateMediaInfo( *result, libraryInfo );
+					playlist->GetLibrary().UpdateTrackAnalysis( previousMediaInfo, libraryInfo );
+					if ( result->Index ) {
+						playlist->GetLibrary().SetSeekIndex( mediaInfo.GetFilename(), *result->Index );
 					}
-				} else {
-					break;
 				}
 			}
-			if ( WAIT_OBJECT_0 != WaitForSingleObject( m_CrossfadeStopEvent, 0 ) ) {
-				SetCrossfadePosition( crossfadePosition - m_CrossfadeSeekOffset );
+		}
+	}
 
-				Playlist::Item nextItem = {};
-				{
-					std::lock_guard<std::mutex> lock( m_PreloadedDecoderMutex );
-					nextItem = m_PreloadedDecoder.item;
-				}
-				if ( MediaInfo::Source::CDDA == nextItem.Info.GetSource() ) {
-					// Pre-cache some CD audio data for the next track, to prevent glitches when crossfading.
-					if ( const auto nextDecoder = OpenDecoder( nextItem ); nextDecoder ) {
-						const long kSamplesToRead = 10 * nextDecoder->GetSampleRate();
-						long totalSamplesRead = 0;
-						while ( WAIT_OBJECT_0 != WaitForSingleObject( m_CrossfadeStopEvent, 0 ) ) {
-							const long samplesRead = nextDecoder->Read( buffer.data(), windowSize );
-							totalSamplesRead += samplesRead;
-							if ( ( totalSamplesRead >= kSamplesToRead ) || ( samplesRead <= 0 ) ) {
-								break;
-							}
-						}
+	if ( hasCrossfadeInfo && canContinue() ) {
+		SetCrossfadePosition( GetRelativeCrossfadePosition( crossfadePosition, leadingSilence, m_CrossfadeSeekOffset ) );
+
+		Playlist::Item nextItem = {};
+		{
+			std::lock_guard<std::mutex> lock( m_PreloadedDecoderMutex );
+			nextItem = m_PreloadedDecoder.item;
+		}
+		if ( MediaInfo::Source::CDDA == nextItem.Info.GetSource() ) {
+			// Pre-cache some CD audio data for the next track, to prevent glitches when crossfading.
+			if ( const auto nextDecoder = OpenDecoder( nextItem ); nextDecoder ) {
+				const long kSamplesToRead = 10 * nextDecoder->GetSampleRate();
+				const long windowSize = nextDecoder->GetSampleRate() / 10;
+				std::vector<float> buffer( windowSize * nextDecoder->GetChannels() );
+				long totalSamplesRead = 0;
+				while ( canContinue() ) {
+					const long samplesRead = nextDecoder->Read( buffer.data(), windowSize );
+					totalSamplesRead += samplesRead;
+					if ( ( totalSamplesRead >= kSamplesToRead ) || ( samplesRead <= 0 ) ) {
+						break;
 					}
 				}
 			}
@@ -1381,6 +1591,39 @@ void Output::CalculateCrossfadeHandler()
 	}
 }
 
+void Output::RefreshTrackAnalysis( Playlist::Item& item )
+{
+	bool isCurrent = false;
+	if ( ( MediaInfo::Source::File == item.Info.GetSource() ) && !IsURL( item.Info.GetFilename() ) ) {
+		Playlist::Ptr playlist;
+		{
+			std::lock_guard<std::mutex> lock( m_PlaylistMutex );
+			playlist = m_Playlist;
+		}
+		// The library entry only matches if the file has not been modified since it was stored, in which case the analysis is current.
+		if ( MediaInfo libraryInfo( item.Info.GetFilename() ); playlist &&
+				playlist->GetLibrary().GetMediaInfo( libraryInfo, true /*checkFileAttributes*/, false /*scanMedia*/, false /*sendNotification*/ ) ) {
+			TrackAnalyser::CopyAnalysis( libraryInfo, item.Info );
+			isCurrent = true;
+		}
+	}
+	if ( !isCurrent ) {
+		item.Info.ClearAnalysis();
+	}
+}
+
+std::optional<float> Output::GetLeadingSilence( const Playlist::Item& item ) const
+{
+	return item.Info.GetLeadingSilence();
+}
+
+float Output::GetRelativeCrossfadePosition( const float crossfadePosition, const float leadingSilence, const float seekOffset )
+{
+	const float playbackStart = ( seekOffset > 0 ) ? seekOffset : leadingSilence;
+	const float relativePosition = ( crossfadePosition > playbackStart ) ? ( crossfadePosition - playbackStart ) : 0;
+	return relativePosition;
+}
+
 void Output::StopCrossfadeThread()
 {
 	if ( nullptr != m_CrossfadeThread ) {
@@ -1445,6 +1688,7 @@ void Output::ToggleFadeToNext()
 	m_FadeToNext = !m_FadeToNext;
 	if ( m_FadeToNext && ( 0 != m_OutputStream ) ) {
 		m_FadeOutStartPosition = GetDecodePosition();
+		SkipPreloadedSilence();
 	} else {
 		m_SwitchToNext = false;
 		std::lock_guard<std::mutex> crossfadingStreamLock( m_CrossfadingStreamMutex );
@@ -1462,10 +1706,9 @@ bool Output::GetFadeToNext() const
 	return m_FadeToNext;
 }
 
-void Output::ApplyGain( float* buffer, const long sampleCount, const Playlist::Item& item, std::vector<float>& softClipState )
+void Output::ApplyGain( float* buffer, const long sampleCount, const long channels, const Playlist::Item& item, std::vector<float>& softClipState )
 {
 	const bool eqEnabled = m_EQEnabled;
-	const long channels = OutputDecoder::GetOutputChannels( item.Info );
 	if ( ( 0 != sampleCount ) && ( channels > 0 ) && ( ( Settings::GainMode::Disabled != m_GainMode ) || eqEnabled ) ) {
 		float preamp = eqEnabled ? m_EQPreamp : 0;
 
@@ -1488,23 +1731,15 @@ void Output::ApplyGain( float* buffer, const long sampleCount, const Playlist::I
 		}
 
 		if ( 0 != preamp ) {
-			const float scale = powf( 10.0f, preamp / 20.0f );
-			const long totalSamples = sampleCount * channels;
-			for ( long sampleIndex = 0; sampleIndex < totalSamples; sampleIndex++ ) {
-				buffer[ sampleIndex ] *= scale;
-			}
+			const float scale = GetGainScale( preamp );
+			const size_t totalSamples = static_cast<size_t>( sampleCount ) * channels;
 			switch ( m_LimitMode ) {
 				case Settings::LimitMode::Hard : {
-					for ( long sampleIndex = 0; sampleIndex < totalSamples; sampleIndex++ ) {
-						if ( buffer[ sampleIndex ] < -1.0f ) {
-							buffer[ sampleIndex ] = -1.0f;
-						} else if ( buffer[ sampleIndex ] > 1.0f ) {
-							buffer[ sampleIndex ] = 1.0f;
-						}
-					}
+					DSPKernels::GainClip( buffer, totalSamples, scale );
 					break;
 				}
 				case Settings::LimitMode::Soft : {
+					DSPKernels::Gain( buffer, totalSamples, scale );
 					if ( softClipState.size() != static_cast<size_t>( channels ) ) {
 						softClipState.resize( channels, 0 );
 					}
@@ -1512,6 +1747,7 @@ void Output::ApplyGain( float* buffer, const long sampleCount, const Playlist::I
 					break;
 				}
 				default : {
+					DSPKernels::Gain( buffer, totalSamples, scale );
 					break;
 				}
 			}
@@ -1519,6 +1755,23 @@ void Output::ApplyGain( float* buffer, const long sampleCount, const Playlist::I
 	}
 }
 
+float Output::GetGainScale( const float preamp )
+{
+	const auto cachedScale = std::find_if( m_GainScales.begin(), m_GainScales.end(), [ preamp ] ( const std::pair<float, float>& gainScale )
+	{
+		return gainScale.first == preamp;
+	} );
+	float scale = 1.0f;
+	if ( m_GainScales.end() != cachedScale ) {
+		scale = cachedScale->second;
+	} else {
+		scale = powf( 10.0f, preamp / 20.0f );
+		m_GainScales[ m_GainScaleIndex ] = { preamp, scale };
+		m_GainScaleIndex = ( m_GainScaleIndex + 1 ) % m_GainScales.size();
+	}
+	return scale;
+}
+
 Output::Queue Output::GetOutputQueue()
 {
 	std::lock_guard<std::mutex> lock( m_QueueMutex );
@@ -1593,18 +1846,23 @@ void Output::UpdateEQ( const Settings::EQ& eq )
 	}
 }
 
-Decoder::Ptr Output::OpenDecoder( Playlist::Item& item )
+Decoder::Ptr Output::OpenDecoder( Playlist::Item& item, const bool loadSeekIndex )
 {
-	Decoder::Ptr decoder = m_Handlers.OpenDecoder( item.Info.GetFilename() );
+	std::wstring filename = item.Info.GetFilename();
+	Decoder::Ptr decoder = m_Handlers.OpenDecoder( filename );
 	if ( !decoder ) {
 		auto duplicate = item.Duplicates.begin();
 		while ( !decoder && ( item.Duplicates.end() != duplicate ) ) {
-			decoder = m_Handlers.OpenDecoder( *duplicate );
+			filename = *duplicate;
+			decoder = m_Handlers.OpenDecoder( filename );
 			++duplicate;
 		}
 	}
 	if ( decoder ) {
 		m_Playlist->GetLibrary().UpdateMediaInfoFromDecoder( item.Info, *decoder );
+		if ( loadSeekIndex && decoder->SupportsSeekIndex() && !IsURL( filename ) ) {
+			decoder->SetSeekIndex( m_Playlist->GetLibrary().GetSeekIndex( filename ) );
+		}
 	}
 	return decoder;
 }
@@ -1615,18 +1873,28 @@ Output::OutputDecoderPtr Output::OpenOutputDecoder( Playlist::Item& item, const
 	if ( usePreloadedDecoder ) {
 		std::lock_guard<std::mutex> lock( m_PreloadedDecoderMutex );
 		if ( m_PreloadedDecoder.decoder && ( m_PreloadedDecoder.item.Info.GetFilename() == item.Info.GetFilename() ) && ( m_PreloadedDecoder.item.Info.GetFiletime() == item.Info.GetFiletime() ) ) {
-			outputDecoder = m_PreloadedDecoder.decoder;
+			// The preloaded decoder can only be used if it can produce the current output format (it might already have started pre-buffering at a previous format).
+			if ( m_PreloadedDecoder.decoder->SetOutputFormat( m_DecoderSampleRate, m_DecoderChannels ) ) {
+				outputDecoder = m_PreloadedDecoder.decoder;
+				// Use the preloaded item's track analysis, which has been checked against the file on the preload thread (or cleared, if the check has not yet been made).
+				TrackAnalyser::CopyAnalysis( m_PreloadedDecoder.item.Info, item.Info );
+			}
 			m_PreloadedDecoder.decoder.reset();
 			m_PreloadedDecoder.item = {};
-			if ( ( Settings::OutputMode::Standard != m_OutputMode ) && !IsURL( item.Info.GetFilename() ) ) {
-				// Ensure pre-buffering has started (in case the pre-buffer finished callback was not received for the previous decoder).
-				outputDecoder->PreBuffer( m_OnPreBufferFinishedCallback );
-			}
 		}
 	}
 	if ( !outputDecoder ) {
+		if ( usePreloadedDecoder ) {
+			// The item's track analysis cannot be checked against the file from the output thread, so do not rely on it.
+			item.Info.ClearAnalysis();
+		}
 		try {
-			outputDecoder = std::make_shared<OutputDecoder>( OpenDecoder( item ), item.ID );
+			// Only load a seek index when not opening the decoder on the output thread.
+			outputDecoder = std::make_shared<OutputDecoder>( OpenDecoder( item, !usePreloadedDecoder /*loadSeekIndex*/ ), item.ID );
+			if ( !outputDecoder->SetOutputFormat( m_DecoderSampleRate, m_DecoderChannels ) ) {
+				// The decoder cannot be converted to the format of the decoding stream.
+				outputDecoder.reset();
+			}
 		} catch ( const std::runtime_error& ) {
 		}
 	}
@@ -1635,6 +1903,11 @@ Output::OutputDecoderPtr Output::OpenOutputDecoder( Playlist::Item& item, const
 
 Output::State Output::StartOutput()
 {
+	if ( m_Rendering ) {
+		// Sample data is pulled from the decoding stream by the render loop.
+		return State::Playing;
+	}
+
 	State state = State::Stopped;
 	switch ( m_OutputMode ) {
 		case Settings::OutputMode::Standard : {
@@ -1722,6 +1995,12 @@ bool Output::CreateOutputStream( const MediaInfo& mediaInfo )
 	if ( ( mediaInfo.GetSampleRate() > 0 ) && ( mediaInfo.GetChannels() > 0 ) ) {
 		const DWORD samplerate = static_cast<DWORD>( mediaInfo.GetSampleRate() );
 		const DWORD channels = static_cast<DWORD>( OutputDecoder::GetOutputChannels( mediaInfo ) );
+		if ( m_Rendering ) {
+			// Create a decoding stream, so that sample data can be pulled as fast as possible.
+			m_LeadInSeconds = 0;
+			m_OutputStream = BASS_StreamCreate( samplerate, channels, BASS_SAMPLE_FLOAT | BASS_STREAM_DECODE, StreamProc, this );
+			return ( 0 != m_OutputStream );
+		}
 		switch ( m_OutputMode ) {
 			case Settings::OutputMode::Standard : {
 				m_LeadInSeconds = 0;
@@ -1981,34 +2260,148 @@ void Output::LoudnessPrecalcHandler()
 		return ( WAIT_OBJECT_0 != WaitForSingleObject( stopEvent, 0 ) );
 	} );
 
+	// Leave a core free for playback decoding.
+	const size_t threadCount = std::clamp<size_t>( std::thread::hardware_concurrency(), 2, s_LoudnessPrecalcMaxThreads + 1 ) - 1;
+
+	// Playlist item IDs which have already been processed, so that they are not checked again on subsequent passes.
+	std::set<long> processedItems;
+
 	do {
 		Playlist::ItemList items;
 		{
 			std::lock_guard<std::mutex> lock( m_PlaylistMutex );
 			items = m_Playlist->GetItems();
 		}
-		auto item = items.begin();
-		while ( ( items.end() != item ) && canContinue() ) {
-			auto gain = item->Info.GetGainTrack();
-			if ( !gain.has_value() ) {
-				m_Playlist->GetLibrary().GetMediaInfo( item->Info, false /*checkFileAttributes*/, false /*scanMedia*/, false /*sendNotification*/ );
-				gain = item->Info.GetGainTrack();
-				if ( !gain.has_value() ) {
-					gain = GainCalculator::CalculateTrackGain( item->Info.GetFilename(), m_Handlers, canContinue );
-					if ( gain.has_value() ) {
-						const MediaInfo previousMediaInfo( item->Info );
-						item->Info.SetGainTrack( gain );
-						std::lock_guard<std::mutex> lock( m_PlaylistMutex );
-						m_Playlist->UpdateItem( *item );
-						m_Playlist->GetLibrary().UpdateTrackGain( previousMediaInfo, item->Info );
-					}
+
+		std::map<long, size_t> positions;
+		std::vector<Playlist::Item> pending;
+		for ( const auto& item : items ) {
+			positions.insert( { item.ID, positions.size() } );
+			if ( ( MediaInfo::Source::File == item.Info.GetSource() ) && !IsURL( item.Info.GetFilename() ) && !processedItems.contains( item.ID ) ) {
+				pending.push_back( item );
+			}
+		}
+		if ( pending.empty() ) {
+			continue;
+		}
+
+		std::mutex pendingMutex;
+		std::pair<long, long> prioritisedFrom = { -1, -1 };
+
+		// Returns the next item to process, reprioritising the pending items whenever the current (or preloaded) item changes.
+		auto takeNextItem = [ this, &pending, &pendingMutex, &positions, &prioritisedFrom ] () -> Playlist::Item
+		{
+			const Queue queue = GetOutputQueue();
+			const long currentID = queue.empty() ? 0 : queue.back().PlaylistItem.ID;
+			long preloadedID = 0;
+			if ( GetRandomPlay() ) {
+				std::lock_guard<std::mutex> preloadLock( m_PreloadedDecoderMutex );
+				preloadedID = m_PreloadedDecoder.item.ID;
+			}
+
+			Playlist::Item item = {};
+			std::lock_guard<std::mutex> lock( pendingMutex );
+			if ( prioritisedFrom != std::make_pair( currentID, preloadedID ) ) {
+				prioritisedFrom = { currentID, preloadedID };
+				PrioritiseLoudnessPrecalc( pending, positions, currentID, preloadedID );
+			}
+			if ( !pending.empty() ) {
+				item = pending.back();
+				pending.pop_back();
+			}
+			return item;
+		};
+
+		// Worker threads other than the first are paused while playback decoding is under pressure.
+		auto worker = [ this, &takeNextItem, &pendingMutex, &processedItems, canContinue ] ( const bool throttle )
+		{
+			while ( canContinue() ) {
+				if ( throttle && m_DecodeUnderPressure.load( std::memory_order_relaxed ) ) {
+					WaitForSingleObject( m_LoudnessPrecalcStopEvent, s_LoudnessPrecalcThrottleInterval );
+					continue;
+				}
+				Playlist::Item item = takeNextItem();
+				if ( 0 == item.ID ) {
+					break;
+				}
+				PrecalculateLoudness( item, canContinue );
+				if ( canContinue() ) {
+					std::lock_guard<std::mutex> lock( pendingMutex );
+					processedItems.insert( item.ID );
 				}
 			}
-			++item;
+		};
+
+		std::list<std::thread> threads;
+		for ( size_t threadIndex = 1; threadIndex < std::min( threadCount, pending.size() ); threadIndex++ ) {
+			threads.push_back( std::thread( [ &worker ] ()
+			{
+				SetThreadPriority( GetCurrentThread(), THREAD_PRIORITY_BELOW_NORMAL );
+				worker( true /*throttle*/ );
+			} ) );
+		}
+		worker( false /*throttle*/ );
+		for ( auto& thread : threads ) {
+			thread.join();
 		}
 	} while ( WAIT_OBJECT_0 != WaitForSingleObject( m_LoudnessPrecalcStopEvent, interval ) );
 }
 
+void Output::PrecalculateLoudness( Playlist::Item& item, Decoder::CanContinue canContinue )
+{
+	if ( !item.Info.GetGainTrack().has_value() || !TrackAnalyser::HasAnalysis( item.Info ) ) {
+		m_Playlist->GetLibrary().GetMediaInfo( item.Info, false /*checkFileAttributes*/, false /*scanMedia*/, false /*sendNotification*/ );
+		if ( !item.Info.GetGainTrack().has_value() || !TrackAnalyser::HasAnalysis( item.Info ) ) {
+			// A single decode provides the track gain, along with the silence & crossfade positions used during playback.
+			if ( const auto result = TrackAnalyser::Analyse( item.Info.GetFilename(), m_Handlers, m_SilenceThreshold, canContinue ); result.has_value() ) {
+				const MediaInfo previousMediaInfo( item.Info );
+				TrackAnalyser::UpdateMediaInfo( *result, item.Info );
+				Playlist::Ptr playlist;
+				{
+					std::lock_guard<std::mutex> lock( m_PlaylistMutex );
+					m_Playlist->UpdateItem( item );
+					playlist = m_Playlist;
+				}
+				// The library writes are made without holding the playlist mutex, which the output thread also takes.
+				playlist->GetLibrary().UpdateTrackAnalysis( previousMediaInfo, item.Info );
+				if ( result->Index ) {
+					playlist->GetLibrary().SetSeekIndex( item.Info.GetFilename(), *result->Index );
+				}
+			}
+		}
+	}
+}
+
+void Output::PrioritiseLoudnessPrecalc( std::vector<Playlist::Item>& pending, const std::map<long, size_t>& positions, const long currentID, const long preloadedID ) const
+{
+	// Items are ordered by how soon they would be played in playlist order from the current item, with any preloaded item first.
+	const size_t playlistSize = positions.size();
+	const auto currentPosition = positions.find( currentID );
+	const size_t startPosition = ( positions.end() != currentPosition ) ? ( currentPosition->second + 1 ) : 0;
+	auto distance = [ &positions, playlistSize, startPosition, preloadedID ] ( const Playlist::Item& item ) -> size_t
+	{
+		if ( item.ID == preloadedID ) {
+			return 0;
+		}
+		const auto position = positions.find( item.ID );
+		return ( positions.end() != position ) ? ( 1 + ( position->second + playlistSize - startPosition ) % playlistSize ) : playlistSize;
+	};
+
+	// Calculate each sort key once, rather than looking up the playlist positions on every comparison.
+	std::vector<std::pair<size_t, Playlist::Item>> sortedItems;
+	sortedItems.reserve( pending.size() );
+	for ( auto& item : pending ) {
+		sortedItems.emplace_back( distance( item ), std::move( item ) );
+	}
+	std::stable_sort( sortedItems.begin(), sortedItems.end(), [] ( const std::pair<size_t, Playlist::Item>& first, const std::pair<size_t, Playlist::Item>& second )
+	{
+		return first.first > second.first;
+	} );
+	for ( size_t index = 0; index < sortedItems.size(); index++ ) {
+		pending[ index ] = std::move( sortedItems[ index ].second );
+	}
+}
+
 void Output::StartLoudnessPrecalcThread()
 {
 	StopLoudnessPrecalcThread();
@@ -2019,7 +2412,8 @@ void Output::StartLoudnessPrecalcThread()
 			Settings::LimitMode limitMode = Settings::LimitMode::None;
 			float preamp = 0;
 			m_Settings.GetGainSettings( gainMode, limitMode, preamp );
-			if ( Settings::GainMode::Disabled != gainMode ) {
+			// The track analysis also provides the silence offsets & crossfade positions, so precalculation runs when crossfade is enabled, even if gain is disabled.
+			if ( ( Settings::GainMode::Disabled != gainMode ) || GetCrossfade() ) {
 				m_LoudnessPrecalcThread = CreateThread( NULL /*attributes*/, 0 /*stackSize*/, LoudnessPrecalcThreadProc, reinterpret_cast<LPVOID>( this ), 0 /*flags*/, NULL /*threadId*/ );
 				if ( nullptr != m_LoudnessPrecalcThread ) {
 					SetThreadPriority( m_LoudnessPrecalcThread, THREAD_PRIORITY_BELOW_NORMAL );
@@ -2108,16 +2502,39 @@ void Output::PreloadDecoderHandler()
 {
 	const HANDLE handles[ 2 ] = { m_PreloadDecoderStopEvent, m_PreloadDecoderWakeEvent };
 	while ( WaitForMultipleObjects( 2, handles, FALSE /*waitAll*/, INFINITE ) != WAIT_OBJECT_0 ) {
-		std::lock_guard<std::mutex> lock( m_PreloadedDecoderMutex );
-		const std::wstring& filename = m_PreloadedDecoder.itemToPreload.Info.GetFilename();
-		m_PreloadedDecoder.decoder = IsURL( filename ) ? nullptr : OpenOutputDecoder( m_PreloadedDecoder.itemToPreload );
-		if ( m_PreloadedDecoder.decoder ) {
-			m_PreloadedDecoder.item = m_PreloadedDecoder.itemToPreload;
-		} else {
-			m_PreloadedDecoder.item = {};
+		Playlist::Item preloadedItem = {};
+		OutputDecoderPtr preloadedDecoder;
+		{
+			std::lock_guard<std::mutex> lock( m_PreloadedDecoderMutex );
+			const std::wstring& filename = m_PreloadedDecoder.itemToPreload.Info.GetFilename();
+			m_PreloadedDecoder.decoder = IsURL( filename ) ? nullptr : OpenOutputDecoder( m_PreloadedDecoder.itemToPreload );
+			if ( m_PreloadedDecoder.decoder ) {
+				// The track analysis is only made available once it has been checked against the file.
+				m_PreloadedDecoder.item = m_PreloadedDecoder.itemToPreload;
+				m_PreloadedDecoder.item.Info.ClearAnalysis();
+				PrepareTransition( *m_PreloadedDecoder.decoder, m_PreloadedDecoder.item );
+			} else {
+				m_PreloadedDecoder.item = {};
+			}
+			m_PreloadedDecoder.itemToPreload = {};
+			preloadedItem = m_PreloadedDecoder.item;
+			preloadedDecoder = m_PreloadedDecoder.decoder;
+			ResetEvent( m_PreloadDecoderWakeEvent );
+		}
+
+		// Estimate the gain and check the track analysis for the preloaded item now, so that the output thread can pick them up without decoding or accessing the library.
+		// The gain estimate is handed over with the decoder, so it still reaches the output thread if the decoder has already been taken.
+		if ( preloadedItem.ID > 0 ) {
+			if ( IsGainEstimateRequired( preloadedItem ) ) {
+				EstimateGain( preloadedItem );
+				preloadedDecoder->SetGainEstimate( preloadedItem.Info.GetGainTrack() );
+			}
+			RefreshTrackAnalysis( preloadedItem );
+			std::lock_guard<std::mutex> lock( m_PreloadedDecoderMutex );
+			if ( m_PreloadedDecoder.decoder == preloadedDecoder ) {
+				TrackAnalyser::CopyAnalysis( preloadedItem.Info, m_PreloadedDecoder.item.Info );
+			}
 		}
-		m_PreloadedDecoder.itemToPreload = {};
-		ResetEvent( m_PreloadDecoderWakeEvent );
 	}
 }
 
@@ -2139,6 +2556,25 @@ void Output::PreloadNextDecoder( const Playlist::Item& item )
 	}
 }
 
+void Output::PrepareTransition( OutputDecoder& decoder, const Playlist::Item& item )
+{
+	// The track analysis has not yet been checked against the file, so any leading silence is found by scanning the decoder.
+	if ( GetCrossfade() || GetFadeToNext() ) {
+		decoder.SkipSilence( m_SilenceThreshold, GetLeadingSilence( item ) );
+	}
+	if ( ( Settings::OutputMode::Standard != m_OutputMode ) && !m_Rendering && !IsURL( item.Info.GetFilename() ) ) {
+		decoder.PreBuffer( m_OnPreBufferFinishedCallback );
+	}
+}
+
+void Output::SkipPreloadedSilence()
+{
+	std::lock_guard<std::mutex> lock( m_PreloadedDecoderMutex );
+	if ( m_PreloadedDecoder.decoder && !m_PreloadedDecoder.decoder->IsSilenceSkipped() ) {
+		m_PreloadedDecoder.decoder->SkipSilence( m_SilenceThreshold, GetLeadingSilence( m_PreloadedDecoder.item ) );
+	}
+}
+
 std::vector<std::pair<float /*seconds*/,std::wstring /*title*/>> Output::GetStreamTitleQueue()
 {
 	std::lock_guard<std::mutex> lock( m_StreamTitleMutex );
@@ -5,10 +5,13 @@
 #include "bass.h"
 #include "Handlers.h"
 #include "OutputDecoder.h"
+#include "OutputDiagnostics.h"
 #include "Playlist.h"
 #include "Settings.h"
 
+#include <array>
 #include <atomic>
+#include <chrono>
 #include <functional>
 
 // Message ID for signalling that playback needs to be restarted from a playlist item ID (wParam).
@@ -41,6 +44,18 @@ public:
 		std::wstring StreamTitle;			// Current stream title.
 	};
 
+	// Offline render statistics.
+	struct RenderStatistics {
+		long SampleRate = 0;									// Output sample rate.
+		long Channels = 0;										// Output channel count.
+		long long SampleFrames = 0;						// Number of sample frames rendered.
+		float ElapsedSeconds = 0;							// Time taken to render, in seconds.
+		long Restarts = 0;										// Number of track transitions which needed the output stream to be restarted.
+		std::vector<float> TransitionErrors;	// Actual minus expected track length at each gapless or crossfade transition, in seconds.
+		std::vector<float> CallbackTimes;			// Time taken by each output stream callback, in seconds.
+		std::wstring Diagnostics;							// Output diagnostics report.
+	};
+
 	// Maps a device ID to its description.
 	using Devices = std::map<int,std::wstring>;
 
@@ -72,6 +87,12 @@ public:
 	// 'seek' - Initial start position in seconds (negative value to seek relative to the end of the track).
 	void Play( const Playlist::Ptr playlist, const long startID = 0, const float seek = 0.0f );
 
+	// Renders a 'playlist' offline, as fast as possible, without using an output device (any current playback is stopped).
+	// 'filename' - WAV file to write, or an empty string to discard the rendered sample data.
+	// 'statistics' - out, render statistics.
+	// Returns true if the whole playlist was rendered.
+	bool Render( const Playlist::Ptr playlist, const std::wstring& filename, RenderStatistics& statistics );
+
 	// Gets the current playlist.
 	Playlist::Ptr GetPlaylist();
 
@@ -195,6 +216,9 @@ public:
 	// Sets the 'callback' function for when the output playlist changes.
 	void SetPlaylistChangeCallback( PlaylistChangeCallback callback );
 
+	// Returns the output path diagnostics (which are disabled by default).
+	OutputDiagnostics& GetDiagnostics();
+
 private:
 	// Output queue.
 	using Queue = std::vector<Item>;
@@ -261,22 +285,54 @@ private:
 	// Background thread handler for calculating the crossfade point for the current track.
 	void CalculateCrossfadeHandler();
 
-	// Background thread handler for precalculating loudness values for tracks in the current playlist.
+	// Background thread handler for precalculating loudness values (along with the silence & crossfade positions) for tracks in the current playlist.
+	// Upcoming tracks are processed first, using a pool of worker threads which is throttled while playback decoding is under pressure.
 	void LoudnessPrecalcHandler();
 
+	// Precalculates the loudness value (along with the silence & crossfade positions) for a playlist 'item', if they are not already known.
+	// 'canContinue' - callback which returns whether processing should continue.
+	void PrecalculateLoudness( Playlist::Item& item, Decoder::CanContinue canContinue );
+
+	// Sorts the 'pending' loudness precalculation items so that the item to process next is at the back.
+	// 'positions' - maps a playlist item ID to its playlist position.
+	// 'currentID' - the playlist item ID currently being decoded (or zero if none).
+	// 'preloadedID' - the playlist item ID which has been preloaded to play next (or zero if none).
+	void PrioritiseLoudnessPrecalc( std::vector<Playlist::Item>& pending, const std::map<long, size_t>& positions, const long currentID, const long preloadedID ) const;
+
 	// Background thread handler for preloading the next decoder.
 	void PreloadDecoderHandler();
 
 	// Initialises the BASS system;
 	void InitialiseBass();
 
-	// Estimates the gain for a playlist 'item' if necessary.
+	// Returns whether a gain estimate is required for the playlist 'item' (i.e. gain is enabled and the item has no gain value).
+	bool IsGainEstimateRequired( const Playlist::Item& item ) const;
+
+	// Estimates the gain for a playlist 'item' if necessary (this can involve decoding, so must not be called from the output thread).
 	void EstimateGain( Playlist::Item& item );
 
+	// Applies the gain estimate handed over with the 'decoder' to a playlist 'item' if necessary, without decoding or locking (so it is safe to call from the output thread).
+	// Returns false if an estimate is required but is not yet ready (in which case the item is left without a gain value, i.e. unity gain is applied).
+	bool ApplyGainEstimate( Playlist::Item& item, const OutputDecoder& decoder ) const;
+
 	// Calculates the crossfade point for the 'item'.
+	// If the 'item' has a stored track analysis, the crossfade point is set immediately, otherwise it is calculated on a background thread.
 	// 'seekOffset' - indicates the initial seek position of 'item', in seconds.
 	void CalculateCrossfadePoint( const Playlist::Item& item, const float seekOffset = 0.0f );
 
+	// Updates the track analysis for a playlist 'item' from the library, clearing it if the file has been modified since the analysis was stored.
+	// This accesses the library, so must not be called from the output thread.
+	void RefreshTrackAnalysis( Playlist::Item& item );
+
+	// Returns the position of the first non-silent sample for a playlist 'item', in seconds, if known from a stored track analysis.
+	std::optional<float> GetLeadingSilence( const Playlist::Item& item ) const;
+
+	// Returns the crossfade position relative to the start of playback, in seconds (or zero if there is no crossfade position).
+	// 'crossfadePosition' - crossfade position, in seconds from the start of the track.
+	// 'leadingSilence' - position of the first non-silent sample, in seconds.
+	// 'seekOffset' - initial seek position, in seconds (or zero if playback starts after any leading silence).
+	static float GetRelativeCrossfadePosition( const float crossfadePosition, const float leadingSilence, const float seekOffset );
+
 	// Terminates the crossfade calculation thread.
 	void StopCrossfadeThread();
 
@@ -286,8 +342,30 @@ private:
 	// Sets the crossfade 'position' for the current track, in seconds.
 	void SetCrossfadePosition( const float position );
 
-	// Applies gain (and EQ preamp) to an output 'buffer' containing 'sampleCount' samples, using 'item' information and 'softClipState'.
-	void ApplyGain( float* buffer, const long sampleCount, const Playlist::Item& item, std::vector<float>& softClipState );
+	// Applies gain (and EQ preamp) to an output 'buffer' containing 'sampleCount' samples of 'channels', using 'item' information and 'softClipState'.
+	void ApplyGain( float* buffer, const long sampleCount, const long channels, const Playlist::Item& item, std::vector<float>& softClipState );
+
+	// Reads sample data from a 'decoder', recording decode time, pre-buffer level, underruns and short reads in the output diagnostics.
+	// 'buffer' - output buffer (floating point format scaled to +/-1.0f).
+	// 'sampleCount' - number of samples to read.
+	// Returns the number of samples read, or zero if the stream has ended.
+	long ReadDecoder( OutputDecoder& decoder, float* buffer, const long sampleCount );
+
+	// Updates whether playback decoding is under pressure, following a decoder read.
+	// 'preBufferLevel' - decoder pre-buffer level before the read, or nullopt if the decoder is not pre-buffered.
+	// 'readTime' - the time taken by the read.
+	// 'samplesRead' - number of samples read.
+	// 'sampleRate' - decoder sample rate.
+	void UpdateDecodePressure( const std::optional<float>& preBufferLevel, const std::chrono::steady_clock::duration readTime, const long samplesRead, const long sampleRate );
+
+	// Resizes the scratch buffers used by the output thread (must not be called while the output thread is active).
+	// 'sampleRate' - output sample rate.
+	// 'channels' - output channel count.
+	// 'bufferSeconds' - output buffer length, in seconds.
+	void ResizeScratchBuffers( const long sampleRate, const long channels, const float bufferSeconds );
+
+	// Returns the linear scale for a 'preamp' value in dB, reusing recent conversions where possible (only to be called from the output thread).
+	float GetGainScale( const float preamp );
 
 	// Gets the output queue.
 	Queue GetOutputQueue();
@@ -296,9 +374,10 @@ private:
 	void SetOutputQueue( const Queue& queue );
 
 	// Returns a decoder for the 'item' (and updates the item if necessary), or nullptr if a decoder could not be opened.
-	Decoder::Ptr OpenDecoder( Playlist::Item& item );
+	// 'loadSeekIndex' - whether to load any stored seek index for the decoder from the library (which should not be done on the output thread).
+	Decoder::Ptr OpenDecoder( Playlist::Item& item, const bool loadSeekIndex = false );
 
-	// Returns an output decoder for the 'item'.
+	// Returns an output decoder for the 'item', converted to the format of the current output stream (if there is one).
 	// 'usePreloadedDecoder' - whether to use the preloaded decoder (when available).
 	OutputDecoderPtr OpenOutputDecoder( Playlist::Item& item, const bool usePreloadedDecoder = false );
 
@@ -356,6 +435,14 @@ private:
 	// Preloads the next decoder on from the current 'item'.
 	void PreloadNextDecoder( const Playlist::Item& item );
 
+	// Prepares a preloaded 'decoder' for the transition to the playlist 'item', by skipping any leading silence (when crossfading) and priming the pre-buffer.
+	// This waits for the pre-buffer to be primed, so must not be called from the output thread.
+	void PrepareTransition( OutputDecoder& decoder, const Playlist::Item& item );
+
+	// Skips any leading silence on the preloaded decoder, if it has not already been skipped (for when crossfading or fading to the next track is switched on after the decoder was preloaded).
+	// This waits for the pre-buffer to be primed, so must not be called from the output thread.
+	void SkipPreloadedSilence();
+
 	// Gets the stream title queue.
 	std::vector<std::pair<float /*seconds*/,std::wstring /*title*/>> GetStreamTitleQueue();
 
@@ -389,8 +476,11 @@ private:
 	// The currently decoding stream.
 	OutputDecoderPtr m_DecoderStream;
 
-	// The sample rate of the currently decoding stream.
-	long m_DecoderSampleRate;
+	// The sample rate of the currently decoding stream (subsequent decoders are converted to this sample rate).
+	std::atomic<long> m_DecoderSampleRate;
+
+	// The channel count of the currently decoding stream (subsequent decoders are converted to this channel count).
+	std::atomic<long> m_DecoderChannels;
 
 	// The current BASS output stream (or source stream when using the mixer).
 	HSTREAM m_OutputStream;
@@ -449,6 +539,9 @@ private:
 	// Indicates whether to stop playback at the end of the current track.
 	bool m_StopAtTrackEnd;
 
+	// Linear sample value at or below which a sample is considered silent.
+	std::atomic<float> m_SilenceThreshold;
+
 	// Indicates whether the output is muted.
 	bool m_Muted;
 
@@ -485,6 +578,12 @@ private:
 	// Event handle for terminating the loudness precalculation thread.
 	HANDLE m_LoudnessPrecalcStopEvent;
 
+	// Indicates whether playback decoding is under pressure (i.e. the pre-buffer is running low, or decoder reads are taking too long), so that loudness precalculation should be throttled.
+	std::atomic<bool> m_DecodeUnderPressure;
+
+	// Smoothed decode load, the time taken to read sample data from the decoder as a proportion of its duration (only accessed from the output thread).
+	float m_DecodeLoad;
+
 	// The thread for preloading the next decoder.
 	HANDLE m_PreloadDecoderThread;
 
@@ -515,6 +614,24 @@ private:
 	// Gain estimates.
 	GainEstimateMap m_GainEstimateMap;
 
+	// Gain estimates mutex.
+	std::mutex m_GainEstimateMutex;
+
+	// Indicates whether the currently decoding item is waiting for its gain estimate (only accessed from the output thread, and when stopped).
+	bool m_GainEstimatePending;
+
+	// Recent preamp (in dB) to linear scale conversions, so that the decoding & crossfading streams do not each need a conversion per output callback (initially 0dB, unity scale).
+	std::array<std::pair<float, float>, 2> m_GainScales;
+
+	// Index of the next gain scale conversion to replace.
+	size_t m_GainScaleIndex;
+
+	// Scratch buffer for the crossfading stream, sized to hold a whole output buffer.
+	std::vector<float> m_CrossfadingBuffer;
+
+	// Output path timing & buffer statistics.
+	OutputDiagnostics m_Diagnostics;
+
 	// Current EQ settings.
 	Settings::EQ m_CurrentEQ;
 
@@ -548,6 +665,9 @@ private:
 	// Indicates whether an end synchronizer has been set on a mixer stream.
 	std::atomic<bool> m_MixerStreamHasEndSync;
 
+	// Indicates whether the output is being rendered offline (i.e. pulled from a decoding stream rather than played on an output device).
+	bool m_Rendering;
+
 	// When starting playback in non-standard output mode, the lead-in length before passing through actual sample data.
 	float m_LeadInSeconds;
 
@@ -1,15 +1,27 @@
 #include "OutputDecoder.h"
 
-// Pre-buffer read queue size.
-constexpr size_t kQueueSize = 5;
+#include "AllocationCounter.h"
 
-// The (maximum) number of seconds stored in each pre-buffer slot.
-constexpr float kSecondsPerSlot = 0.5f;
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <typeinfo>
+
+// The number of seconds of sample data held in the pre-buffer.
+constexpr float kPreBufferSeconds = 2.5f;
+
+// The number of seconds of sample data decoded at a time by the pre-buffering thread (the pre-buffer is primed once the first block has been written).
+constexpr float kDecodeBlockSeconds = 0.5f;
+
+// The interval at which the pre-buffering thread checks for free space, when the pre-buffer is full.
+constexpr std::chrono::milliseconds kPreBufferFullInterval( 10 );
 
 OutputDecoder::OutputDecoder( Decoder::Ptr decoder, const long id ) :
 	m_Decoder( decoder ),
 	m_ID( id ),
-	m_Channels( GetOutputChannels( decoder ) )
+	m_Channels( GetOutputChannels( decoder ) ),
+	m_OutputSampleRate( decoder ? decoder->GetSampleRate() : 0 ),
+	m_OutputChannels( m_Channels )
 {
   if ( m_Channels <= 0 ) {
 		throw std::runtime_error( "Unable to create output decoder" );
@@ -19,11 +31,13 @@ OutputDecoder::OutputDecoder( Decoder::Ptr decoder, const long id ) :
 OutputDecoder::~OutputDecoder()
 {
 	StopPreBufferThread();
-	if ( nullptr != m_SemaphoreInput ) {
-		CloseHandle( m_SemaphoreInput );
-	}
-	if ( nullptr != m_SemaphoreOutput ) {
-		CloseHandle( m_SemaphoreOutput );
+	if ( AllocationCounter::IsAvailable() && ( m_SteadyStateReadCount > 0 ) ) {
+		// Record the allocation counts against the decoder type (removing any 'class ' prefix from the type name).
+		std::string decoderType = typeid( *m_Decoder ).name();
+		if ( const size_t pos = decoderType.find( ' ' ); std::string::npos != pos ) {
+			decoderType = decoderType.substr( pos + 1 );
+		}
+		AllocationCounter::AddCategoryCount( std::wstring( decoderType.begin(), decoderType.end() ), m_SteadyStateReadCount, m_SteadyStateReadAllocations );
 	}
 }
 
@@ -31,30 +45,22 @@ long OutputDecoder::Read( float* buffer, const long sampleCount )
 {
 	long samplesRead = 0;
 	if ( m_UsePreBuffer ) {
-		while ( ( samplesRead < sampleCount ) && !m_DecoderFinished ) {
-			const long readBufferSize = ( nullptr != m_ReadBuffer ) ? static_cast<long>( m_ReadBuffer->size() ) : 0;
-			if ( m_ReadBufferOffset < readBufferSize ) {
-				const long samplesToRead = std::min<long>( sampleCount - samplesRead, ( readBufferSize - m_ReadBufferOffset ) / m_Channels );
-        const auto first = m_ReadBuffer->begin() + m_ReadBufferOffset;
-        const auto last = first + samplesToRead * m_Channels;
-        const auto dest = buffer + samplesRead * m_Channels;
-				std::copy( first, last, dest );
-				m_ReadBufferOffset += samplesToRead * m_Channels;
-				samplesRead += samplesToRead;
-			} else {
-				WaitForSingleObject( m_SemaphoreOutput, INFINITE );
-				std::lock_guard<std::mutex> lock( m_BufferMutex );
-				if ( m_ReadQueue.empty() ) {
-					m_DecoderFinished = true;
-				} else {
-					m_ReadBuffer = m_ReadQueue.front();
-					m_ReadBufferOffset = 0;
-					m_ReadQueue.pop();
-				}
-				ReleaseSemaphore( m_SemaphoreInput, 1, nullptr );
-			}
+		// Check whether decoding has finished before reading, so that sample data written just before finishing is not missed.
+		const bool decoderFinished = m_DecoderFinished;
+		samplesRead = static_cast<long>( m_RingBuffer->Read( buffer, static_cast<size_t>( sampleCount * m_OutputChannels ) ) ) / m_OutputChannels;
+		if ( ( samplesRead < sampleCount ) && !decoderFinished ) {
+			// Never wait on the pre-buffering thread, pad with silence instead.
+			// The pre-buffer is primed before a seek or transition reaches the output thread, so this only happens if decoding cannot keep up.
+			std::fill( buffer + samplesRead * m_OutputChannels, buffer + sampleCount * m_OutputChannels, 0.0f );
+			samplesRead = sampleCount;
+			++m_UnderrunCount;
 		}
+	} else if ( m_FirstReadComplete ) {
+		// Decoding directly on the output thread, so any allocations made by the decoder are counted against the output callback.
+		samplesRead = Decode( buffer, sampleCount );
 	} else {
+		// The first read is allowed to allocate (e.g. to size decoder scratch buffers).
+		const AllocationCounter::Suspend suspendAllocationCounter;
 		samplesRead = Decode( buffer, sampleCount );
 	}
 	return samplesRead;
@@ -65,7 +71,13 @@ float OutputDecoder::Seek( const float position )
 	if ( m_UsePreBuffer ) {
 		StopPreBufferThread();
 	}
+	m_PendingSamples.clear();
+	m_PendingOffset = 0;
+	m_SilenceSkipped = false;
 	const float result = m_Decoder->Seek( position );
+	if ( m_Resampler ) {
+		m_Resampler->Reset();
+	}
 	if ( m_UsePreBuffer ) {
 		StartPreBufferThread();
 	}
@@ -74,12 +86,12 @@ float OutputDecoder::Seek( const float position )
 
 long OutputDecoder::GetSampleRate() const
 {
-	return m_Decoder->GetSampleRate();
+	return m_OutputSampleRate;
 }
 
 long OutputDecoder::GetChannels() const
 {
-	return m_Channels;
+	return m_OutputChannels;
 }
 
 std::optional<long> OutputDecoder::GetBPS() const
@@ -92,18 +104,39 @@ std::optional<float> OutputDecoder::GetBitrate() const
 	return m_Decoder->GetBitrate();
 }
 
-void OutputDecoder::SkipSilence()
+void OutputDecoder::SkipSilence( const float threshold, const std::optional<float> leadingSilence )
 {
 	if ( m_UsePreBuffer ) {
 		StopPreBufferThread();
-		m_Decoder->Seek( 0 );
 	}
-	m_Decoder->SkipSilence();
+	m_PendingSamples.clear();
+	m_PendingOffset = 0;
+	if ( leadingSilence.has_value() && m_Decoder->SupportsSampleAccurateSeek() ) {
+		// Seek directly to the first non-silent sample, rather than decoding up to it.
+		if ( m_UsePreBuffer || ( *leadingSilence > 0 ) ) {
+			m_Decoder->Seek( *leadingSilence );
+		}
+	} else {
+		// Scan for the first non-silent sample (a seek could land before or after it, if the decoder cannot seek to an exact sample).
+		if ( m_UsePreBuffer ) {
+			m_Decoder->Seek( 0 );
+		}
+		m_Decoder->SkipSilence( threshold, m_PendingSamples );
+	}
+	if ( m_Resampler ) {
+		m_Resampler->Reset();
+	}
+	m_SilenceSkipped = true;
 	if ( m_UsePreBuffer ) {
 		StartPreBufferThread();
 	}
 }
 
+bool OutputDecoder::IsSilenceSkipped() const
+{
+	return m_SilenceSkipped;
+}
+
 bool OutputDecoder::SupportsStreamTitles() const
 {
 	return m_Decoder->SupportsStreamTitles();
@@ -117,73 +150,134 @@ std::pair<float /*seconds*/, std::wstring /*title*/> OutputDecoder::GetStreamTit
 void OutputDecoder::PreBuffer( PreBufferFinishedCallback callback )
 {
 	if ( !m_UsePreBuffer ) {
-		m_SemaphoreOutput = CreateSemaphore( nullptr /*attributes*/, 0 /*initial*/, kQueueSize /*maximum*/, L"" );
-		m_SemaphoreInput = CreateSemaphore( nullptr /*attributes*/, kQueueSize /*initial*/, kQueueSize /*maximum*/, L"" );
-		m_UsePreBuffer = ( nullptr != m_SemaphoreOutput ) && ( nullptr != m_SemaphoreInput );
-		if ( m_UsePreBuffer ) {
+		const size_t capacity = static_cast<size_t>( m_OutputSampleRate * kPreBufferSeconds ) * m_OutputChannels;
+		if ( capacity > 0 ) {
+			m_RingBuffer = std::make_unique<RingBuffer>( capacity );
+			m_UsePreBuffer = true;
 			m_PreBufferFinishedCallback = callback;
 			StartPreBufferThread();
 		}
 	}
 }
 
+bool OutputDecoder::IsPreBuffering() const
+{
+	return m_UsePreBuffer;
+}
+
+long OutputDecoder::GetUnderrunCount() const
+{
+	return m_UnderrunCount;
+}
+
+std::optional<float> OutputDecoder::GetPreBufferLevel() const
+{
+	std::optional<float> level;
+	if ( m_UsePreBuffer && !m_DecoderFinished && ( m_RingBuffer->GetCapacity() > 0 ) ) {
+		level = static_cast<float>( m_RingBuffer->GetReadAvailable() ) / m_RingBuffer->GetCapacity();
+	}
+	return level;
+}
+
+void OutputDecoder::SetGainEstimate( const std::optional<float> estimate )
+{
+	m_GainEstimate = estimate.value_or( std::numeric_limits<float>::quiet_NaN() );
+}
+
+std::optional<float> OutputDecoder::GetGainEstimate() const
+{
+	std::optional<float> estimate;
+	if ( const float gain = m_GainEstimate; !std::isnan( gain ) ) {
+		estimate = gain;
+	}
+	return estimate;
+}
+
+bool OutputDecoder::SetOutputFormat( const long sampleRate, const long channels )
+{
+	const long decoderSampleRate = m_Decoder->GetSampleRate();
+	const long outputSampleRate = ( sampleRate > 0 ) ? sampleRate : decoderSampleRate;
+	const long outputChannels = ( channels > 0 ) ? channels : m_Channels;
+	if ( m_UsePreBuffer ) {
+		// The format cannot be changed once pre-buffering has started, but it might already be the one requested.
+		return ( outputSampleRate == m_OutputSampleRate ) && ( outputChannels == m_OutputChannels );
+	}
+
+	if ( ( outputSampleRate == decoderSampleRate ) && ( outputChannels == m_Channels ) ) {
+		m_Resampler.reset();
+	} else if ( !m_Resampler || ( m_Resampler->GetOutputRate() != outputSampleRate ) || ( m_Resampler->GetOutputChannels() != outputChannels ) ) {
+		try {
+			m_Resampler = std::make_unique<Resampler>( decoderSampleRate, m_Channels, outputSampleRate, outputChannels,
+				[ this ] ( float* buffer, const long frames )
+				{
+					return DecodeNative( buffer, frames );
+				} );
+		} catch ( const std::runtime_error& ) {
+			return false;
+		}
+	}
+	m_OutputSampleRate = outputSampleRate;
+	m_OutputChannels = outputChannels;
+	return true;
+}
+
 void OutputDecoder::StartPreBufferThread()
 {
 	m_StopPreBuffering = false;
+	m_PreBufferPrimed = false;
 	m_DecoderFinished = false;
-	m_ReadQueue = {};
-	m_ReadBuffer = nullptr;
-	m_ReadBufferOffset = 0;
+	m_RingBuffer->Reset();
 
 	m_BufferThread = std::thread( [ this ] ()
 		{
-			// Create a 'circular' buffer containing a fixed number of write slots, which the read queue will point to.
-			// This buffer needs to be two slots wider than the read queue because:
-			// 1. When the writer wraps around, it will (re)acquire the initial read slot, before being held.
-			// 2. When the writer is then released, it will immediately acquire the next read slot, before being held.
-			constexpr size_t kSlotCount = 2 + kQueueSize;
-			m_BufferSlots.resize( kSlotCount );
-			size_t slotIndex = 0;
-
-			const long bufferSamples = static_cast<long>( m_Decoder->GetSampleRate() * kSecondsPerSlot );
-			bool finished = false;
-			while ( !finished ) {
-				auto& buffer = m_BufferSlots[ slotIndex ];
-				slotIndex = ( 1 + slotIndex ) % kSlotCount;
-
-				buffer.resize( bufferSamples * m_Channels );
-				const long samplesRead = Decode( buffer.data(), bufferSamples );
-				buffer.resize( samplesRead * m_Channels );
-
-				WaitForSingleObject( m_SemaphoreInput, INFINITE );
-				std::lock_guard<std::mutex> lock( m_BufferMutex );
-				if ( m_StopPreBuffering ) {
-					finished = true;
-					m_ReadQueue = {};
-				} else if ( buffer.empty() ) {
-					finished = true;
-					if ( m_PreBufferFinishedCallback ) {
-						m_PreBufferFinishedCallback( m_ID );
+			const long bufferSamples = static_cast<long>( m_OutputSampleRate * kDecodeBlockSeconds );
+			std::vector<float> buffer( bufferSamples * m_OutputChannels );
+			long samplesRead = Decode( buffer.data(), bufferSamples );
+			while ( ( samplesRead > 0 ) && !m_StopPreBuffering ) {
+				// Only write whole sample frames, so that the reader never sees a partial frame.
+				const size_t bufferSize = static_cast<size_t>( samplesRead * m_OutputChannels );
+				size_t bufferOffset = 0;
+				while ( ( bufferOffset < bufferSize ) && !m_StopPreBuffering ) {
+					const size_t writeAvailable = ( m_RingBuffer->GetWriteAvailable() / m_OutputChannels ) * m_OutputChannels;
+					if ( writeAvailable > 0 ) {
+						bufferOffset += m_RingBuffer->Write( buffer.data() + bufferOffset, std::min( writeAvailable, bufferSize - bufferOffset ) );
+						if ( !m_PreBufferPrimed ) {
+							m_PreBufferPrimed = true;
+							m_PreBufferPrimed.notify_all();
+						}
+					} else {
+						std::this_thread::sleep_for( kPreBufferFullInterval );
 					}
-				} else {
-					m_ReadQueue.push( &buffer );
 				}
-				ReleaseSemaphore( m_SemaphoreOutput, 1, nullptr );
+				if ( !m_StopPreBuffering ) {
+					samplesRead = Decode( buffer.data(), bufferSamples );
+				}
+			}
+
+			const bool decoderFinished = !m_StopPreBuffering;
+			if ( decoderFinished ) {
+				m_DecoderFinished = true;
+			}
+
+			// Release any waiting thread before calling back, as the callback might take a lock held by the waiting thread.
+			m_PreBufferPrimed = true;
+			m_PreBufferPrimed.notify_all();
+
+			if ( decoderFinished && m_PreBufferFinishedCallback ) {
+				m_PreBufferFinishedCallback( m_ID );
 			}
 		}
 	);
+
+	m_PreBufferPrimed.wait( false );
 }
 
 void OutputDecoder::StopPreBufferThread()
 {
 	if ( m_BufferThread.joinable() ) {
 		m_StopPreBuffering = true;
-		ReleaseSemaphore( m_SemaphoreInput, 1, nullptr );
 		m_BufferThread.join();
-
-		while ( WAIT_OBJECT_0 == WaitForSingleObject( m_SemaphoreOutput, 0 ) ) {}
-		while ( WAIT_OBJECT_0 == WaitForSingleObject( m_SemaphoreInput, 0 ) ) {}
-		ReleaseSemaphore( m_SemaphoreInput, kQueueSize, nullptr );
+		m_RingBuffer->Reset();
 	}
 }
 
@@ -203,7 +297,29 @@ long OutputDecoder::GetOutputChannels( const MediaInfo& mediaInfo )
 
 long OutputDecoder::Decode( float* buffer, const long sampleCount )
 {
-  const long samplesRead = m_Decoder->Read( buffer, sampleCount );
+	return m_Resampler ? m_Resampler->Read( buffer, sampleCount ) : DecodeNative( buffer, sampleCount );
+}
+
+long OutputDecoder::DecodeNative( float* buffer, const long sampleCount )
+{
+	const AllocationCounter::Scope allocationCounter;
+	long samplesRead = 0;
+	const long decoderChannels = m_Decoder->GetChannels();
+	if ( m_PendingOffset < m_PendingSamples.size() ) {
+		samplesRead = std::min( sampleCount, static_cast<long>( ( m_PendingSamples.size() - m_PendingOffset ) / decoderChannels ) );
+		std::copy_n( m_PendingSamples.data() + m_PendingOffset, static_cast<size_t>( samplesRead ) * decoderChannels, buffer );
+		m_PendingOffset += static_cast<size_t>( samplesRead ) * decoderChannels;
+	}
+	if ( samplesRead < sampleCount ) {
+		samplesRead += m_Decoder->Read( buffer + static_cast<size_t>( samplesRead ) * decoderChannels, sampleCount - samplesRead );
+	}
+	// Reads are counted whether they are made by the pre-buffering thread, or directly on the output thread (in Standard mode).
+	if ( !m_FirstReadComplete ) {
+		m_FirstReadComplete = true;
+	} else {
+		++m_SteadyStateReadCount;
+		m_SteadyStateReadAllocations += allocationCounter.GetCount();
+	}
   if ( ( 7 == m_Decoder->GetChannels() ) && ( 8 == m_Channels ) ) {
     // Copy the back centre channel to the back left & back right channels.
     for ( long sample = sampleCount - 1; sample >= 0; sample-- ) {
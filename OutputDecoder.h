@@ -4,12 +4,15 @@
 
 #include "Decoder.h"
 #include "Playlist.h"
+#include "Resampler.h"
+#include "RingBuffer.h"
 
-#include <array>
+#include <atomic>
 #include <functional>
-#include <mutex>
-#include <queue>
+#include <limits>
+#include <memory>
 #include <thread>
+#include <vector>
 
 // Buffered output decoder wrapper.
 class OutputDecoder
@@ -50,7 +53,12 @@ public:
 	std::optional<float> GetBitrate() const;
 
 	// Skips any leading silence.
-	void SkipSilence();
+	// 'threshold' - linear sample value at or below which a sample is considered silent.
+	// 'leadingSilence' - position of the first non-silent sample, in seconds, if already known from a track analysis.
+	void SkipSilence( const float threshold, const std::optional<float> leadingSilence );
+
+	// Returns whether leading silence has been skipped (since the last seek).
+	bool IsSilenceSkipped() const;
 
 	// Returns whether stream titles are supported.
 	bool SupportsStreamTitles() const;
@@ -58,23 +66,52 @@ public:
 	// Returns the current stream title, and the position (in seconds) at which the title last changed.
 	std::pair<float /*seconds*/, std::wstring /*title*/> GetStreamTitle();
 
-	// Starts pre-buffering sample data - all subsequent reads will be pre-buffered.
+	// Starts pre-buffering sample data - all subsequent reads will be pre-buffered, and will not wait for the decoder.
+	// This waits until the pre-buffer has been primed (as do any subsequent seeks), so should not be called from the output thread.
 	// 'callback' - called when the output decoder has finished pre-buffering.
 	void PreBuffer( PreBufferFinishedCallback callback );
 
+	// Returns whether pre-buffering has started.
+	bool IsPreBuffering() const;
+
+	// Returns the number of pre-buffered reads which could not be fully satisfied, and were padded with silence.
+	long GetUnderrunCount() const;
+
+	// Returns the fill level of the pre-buffer, in the range 0.0 (empty) to 1.0 (full).
+	// Returns nullopt if not pre-buffering, or if decoding has finished (when the pre-buffer is expected to drain).
+	std::optional<float> GetPreBufferLevel() const;
+
+	// Sets the gain 'estimate' for the playlist item, in dB (this can be called from any thread, at any time).
+	void SetGainEstimate( const std::optional<float> estimate );
+
+	// Returns the gain estimate for the playlist item, in dB, or nullopt if no estimate is available (yet).
+	std::optional<float> GetGainEstimate() const;
+
+	// Sets the output format, converting the sample data from the decoder format if necessary.
+	// 'sampleRate' - output sample rate, or zero to use the decoder sample rate.
+	// 'channels' - output channel count, or zero to use the decoder channel count.
+	// Returns whether the output format was set (the format cannot be changed once pre-buffering has started, so this fails unless it already matches).
+	bool SetOutputFormat( const long sampleRate, const long channels );
+
 private:
-	// Starts the pre-buffering thread.
+	// Starts the pre-buffering thread, and waits until the first block of sample data is available (so this should not be called from the output thread).
 	void StartPreBufferThread();
 
 	// Stops the pre-buffering thread.
 	void StopPreBufferThread();
 
-	// Decodes sample data.
+	// Decodes sample data in the output format.
 	// 'buffer' - output buffer (floating point format scaled to +/-1.0f).
 	// 'sampleCount' - number of samples to read.
 	// Returns the number of samples read, or zero if the stream has ended.
 	long Decode( float* buffer, const long sampleCount );
 
+	// Decodes sample data in the decoder format.
+	// 'buffer' - output buffer (floating point format scaled to +/-1.0f).
+	// 'sampleCount' - number of samples to read.
+	// Returns the number of samples read, or zero if the stream has ended.
+	long DecodeNative( float* buffer, const long sampleCount );
+
   // Returns the number of channels to output for the 'decoder'.
   static long GetOutputChannels( const Decoder::Ptr& decoder );
 
@@ -84,42 +121,60 @@ private:
 	// Decoder channels.
 	const long m_Channels;
 
+	// Output sample rate.
+	long m_OutputSampleRate;
+
+	// Output channels.
+	long m_OutputChannels;
+
+	// Converts from the decoder format to the output format (or null if no conversion is necessary).
+	std::unique_ptr<Resampler> m_Resampler;
+
+	// Sample data (in the decoder format) which was read when skipping leading silence, and which is output before reading any more from the decoder.
+	std::vector<float> m_PendingSamples;
+
+	// Offset of the next sample to output from the pending sample data.
+	size_t m_PendingOffset = 0;
+
+	// Indicates whether leading silence has been skipped (since the last seek).
+	bool m_SilenceSkipped = false;
+
 	// Playlist item ID.
 	const long m_ID;
 
 	// Indicates whether to use pre-buffering.
 	bool m_UsePreBuffer = false;
 
-	// Pre-buffer output semaphore.
-	HANDLE m_SemaphoreOutput = nullptr;
-
-	// Pre-buffer input semaphore.
-	HANDLE m_SemaphoreInput = nullptr;
+	// Pre-buffered sample data, written by the pre-buffering thread and read without blocking by the output thread.
+	std::unique_ptr<RingBuffer> m_RingBuffer;
 
 	// Pre-buffer thread.
 	std::thread m_BufferThread;
 
-	// Pre-buffer mutex.
-	std::mutex m_BufferMutex;
-
 	// Indicates whether the pre-buffering thread should stop.
 	std::atomic_bool m_StopPreBuffering = false;
 
+	// Indicates whether the pre-buffering thread has written its first block of sample data (or has finished).
+	std::atomic_bool m_PreBufferPrimed = false;
+
 	// Indicates whether decoding has finished.
-	bool m_DecoderFinished = false;
+	std::atomic_bool m_DecoderFinished = false;
+
+	// Number of pre-buffered reads which were padded with silence.
+	std::atomic<long> m_UnderrunCount = 0;
 
 	// Callback function for when the output decoder has finished pre-buffering.
 	PreBufferFinishedCallback m_PreBufferFinishedCallback = nullptr;
 
-	// Pre-buffered sample data.
-	std::vector<std::vector<float>> m_BufferSlots;
+	// Gain estimate for the playlist item, in dB, or NaN if no estimate is available.
+	std::atomic<float> m_GainEstimate = std::numeric_limits<float>::quiet_NaN();
 
-	// Read buffer queue.
-	std::queue<std::vector<float>*> m_ReadQueue;
+	// Indicates whether the first decoder read has been made.
+	bool m_FirstReadComplete = false;
 
-	// Current read buffer.
-	std::vector<float>* m_ReadBuffer = nullptr;
+	// Number of decoder reads made after the first (by which time any decoder scratch buffers should have been sized).
+	long long m_SteadyStateReadCount = 0;
 
-	// Current read buffer offset.
-	long m_ReadBufferOffset = 0;
+	// Number of heap allocations made during steady state decoder reads (only counted in debug builds).
+	long long m_SteadyStateReadAllocations = 0;
 };
@@ -0,0 +1,214 @@
+#include "OutputDiagnostics.h"
+
+#include "AllocationCounter.h"
+
+#include <algorithm>
+#include <sstream>
+
+// Initial minimum pre-buffer level, indicating that no level has been recorded.
+constexpr uint64_t s_NoPreBufferLevel = 101;
+
+OutputDiagnostics::Timer::Timer( OutputDiagnostics& diagnostics, const Stage stage ) :
+	m_Diagnostics( diagnostics ),
+	m_Stage( stage ),
+	m_StartTick( diagnostics.GetStartTick() )
+{
+}
+
+OutputDiagnostics::Timer::~Timer()
+{
+	if ( 0 != m_StartTick ) {
+		m_Diagnostics.RecordTiming( m_Stage, m_StartTick );
+	}
+}
+
+OutputDiagnostics::OutputDiagnostics() :
+	m_Enabled( false ),
+	m_TickFrequency( 0 ),
+	m_StageTimings(),
+	m_PreBufferLevels(),
+	m_MinPreBufferPercent( s_NoPreBufferLevel ),
+	m_Underruns( 0 ),
+	m_ShortReads( 0 ),
+	m_GainEstimateFallbacks( 0 ),
+	m_RealtimeAllocations( 0 )
+{
+	LARGE_INTEGER frequency = {};
+	QueryPerformanceFrequency( &frequency );
+	m_TickFrequency = frequency.QuadPart;
+	Reset();
+}
+
+OutputDiagnostics::~OutputDiagnostics()
+{
+}
+
+bool OutputDiagnostics::IsEnabled() const
+{
+	return m_Enabled.load( std::memory_order_relaxed );
+}
+
+void OutputDiagnostics::SetEnabled( const bool enabled )
+{
+	m_Enabled.store( enabled, std::memory_order_relaxed );
+}
+
+void OutputDiagnostics::Reset()
+{
+	for ( auto& timing : m_StageTimings ) {
+		for ( auto& bucket : timing.Histogram ) {
+			bucket.store( 0, std::memory_order_relaxed );
+		}
+		timing.Count.store( 0, std::memory_order_relaxed );
+		timing.TotalMicroseconds.store( 0, std::memory_order_relaxed );
+		timing.MaxMicroseconds.store( 0, std::memory_order_relaxed );
+	}
+	for ( auto& bucket : m_PreBufferLevels ) {
+		bucket.store( 0, std::memory_order_relaxed );
+	}
+	m_MinPreBufferPercent.store( s_NoPreBufferLevel, std::memory_order_relaxed );
+	m_Underruns.store( 0, std::memory_order_relaxed );
+	m_ShortReads.store( 0, std::memory_order_relaxed );
+	m_GainEstimateFallbacks.store( 0, std::memory_order_relaxed );
+	m_RealtimeAllocations.store( 0, std::memory_order_relaxed );
+}
+
+void OutputDiagnostics::RecordPreBufferLevel( const float level )
+{
+	if ( IsEnabled() ) {
+		const uint64_t percent = static_cast<uint64_t>( 100 * std::clamp( level, 0.0f, 1.0f ) );
+		const size_t bucket = std::min<size_t>( static_cast<size_t>( percent * s_LevelBuckets / 100 ), s_LevelBuckets - 1 );
+		m_PreBufferLevels[ bucket ].fetch_add( 1, std::memory_order_relaxed );
+
+		uint64_t minPercent = m_MinPreBufferPercent.load( std::memory_order_relaxed );
+		while ( ( percent < minPercent ) && !m_MinPreBufferPercent.compare_exchange_weak( minPercent, percent, std::memory_order_relaxed ) );
+	}
+}
+
+void OutputDiagnostics::RecordUnderruns( const long underruns )
+{
+	if ( IsEnabled() && ( underruns > 0 ) ) {
+		m_Underruns.fetch_add( static_cast<uint64_t>( underruns ), std::memory_order_relaxed );
+	}
+}
+
+void OutputDiagnostics::RecordShortRead()
+{
+	if ( IsEnabled() ) {
+		m_ShortReads.fetch_add( 1, std::memory_order_relaxed );
+	}
+}
+
+void OutputDiagnostics::RecordGainEstimateFallback()
+{
+	if ( IsEnabled() ) {
+		m_GainEstimateFallbacks.fetch_add( 1, std::memory_order_relaxed );
+	}
+}
+
+void OutputDiagnostics::RecordRealtimeAllocations( const long long allocations )
+{
+	if ( IsEnabled() && ( allocations > 0 ) ) {
+		m_RealtimeAllocations.fetch_add( static_cast<uint64_t>( allocations ), std::memory_order_relaxed );
+	}
+}
+
+LONGLONG OutputDiagnostics::GetStartTick() const
+{
+	LARGE_INTEGER count = {};
+	if ( IsEnabled() ) {
+		QueryPerformanceCounter( &count );
+	}
+	return count.QuadPart;
+}
+
+void OutputDiagnostics::RecordTiming( const Stage stage, const LONGLONG startTick )
+{
+	LARGE_INTEGER endTick = {};
+	QueryPerformanceCounter( &endTick );
+	const uint64_t microseconds = ( m_TickFrequency > 0 ) ? static_cast<uint64_t>( ( endTick.QuadPart - startTick ) * 1000000 / m_TickFrequency ) : 0;
+
+	size_t bucket = 0;
+	while ( ( bucket < ( s_TimingBuckets - 1 ) ) && ( microseconds >= ( 1ull << bucket ) ) ) {
+		++bucket;
+	}
+
+	StageTiming& timing = m_StageTimings[ static_cast<size_t>( stage ) ];
+	timing.Histogram[ bucket ].fetch_add( 1, std::memory_order_relaxed );
+	timing.Count.fetch_add( 1, std::memory_order_relaxed );
+	timing.TotalMicroseconds.fetch_add( microseconds, std::memory_order_relaxed );
+	uint64_t maxMicroseconds = timing.MaxMicroseconds.load( std::memory_order_relaxed );
+	while ( ( microseconds > maxMicroseconds ) && !timing.MaxMicroseconds.compare_exchange_weak( maxMicroseconds, microseconds, std::memory_order_relaxed ) );
+}
+
+const wchar_t* OutputDiagnostics::GetStageName( const Stage stage )
+{
+	switch ( stage ) {
+		case Stage::DeviceCallback : {
+			return L"Device callback";
+		}
+		case Stage::StreamCallback : {
+			return L"Stream callback";
+		}
+		case Stage::Decode : {
+			return L"Decode";
+		}
+		case Stage::Gain : {
+			return L"Gain";
+		}
+		case Stage::Crossfade : {
+			return L"Crossfade";
+		}
+		case Stage::Transition : {
+			return L"Transition";
+		}
+		default : {
+			return L"";
+		}
+	}
+}
+
+std::wstring OutputDiagnostics::GetReport() const
+{
+	std::wstringstream report;
+	for ( size_t stage = 0; stage < m_StageTimings.size(); stage++ ) {
+		const StageTiming& timing = m_StageTimings[ stage ];
+		const uint64_t count = timing.Count.load( std::memory_order_relaxed );
+		if ( count > 0 ) {
+			report << GetStageName( static_cast<Stage>( stage ) ) << L": " << count << L" calls, mean " << ( timing.TotalMicroseconds.load( std::memory_order_relaxed ) / count ) <<
+				L"us, max " << timing.MaxMicroseconds.load( std::memory_order_relaxed ) << L"us\r\n";
+			for ( size_t bucket = 0; bucket < s_TimingBuckets; bucket++ ) {
+				if ( const uint64_t bucketCount = timing.Histogram[ bucket ].load( std::memory_order_relaxed ); bucketCount > 0 ) {
+					if ( bucket < ( s_TimingBuckets - 1 ) ) {
+						report << L"\t< " << ( 1ull << bucket ) << L"us: " << bucketCount << L"\r\n";
+					} else {
+						report << L"\t>= " << ( 1ull << ( s_TimingBuckets - 2 ) ) << L"us: " << bucketCount << L"\r\n";
+					}
+				}
+			}
+		}
+	}
+
+	const uint64_t minPreBufferPercent = m_MinPreBufferPercent.load( std::memory_order_relaxed );
+	if ( minPreBufferPercent < s_NoPreBufferLevel ) {
+		report << L"Pre-buffer level: minimum " << minPreBufferPercent << L"%\r\n";
+		for ( size_t bucket = 0; bucket < s_LevelBuckets; bucket++ ) {
+			if ( const uint64_t bucketCount = m_PreBufferLevels[ bucket ].load( std::memory_order_relaxed ); bucketCount > 0 ) {
+				report << L"\t" << ( bucket * 100 / s_LevelBuckets ) << L"-" << ( ( bucket + 1 ) * 100 / s_LevelBuckets ) << L"%: " << bucketCount << L"\r\n";
+			}
+		}
+	}
+
+	report << L"Pre-buffer underruns: " << m_Underruns.load( std::memory_order_relaxed ) << L"\r\n";
+	report << L"Short decoder reads: " << m_ShortReads.load( std::memory_order_relaxed ) << L"\r\n";
+	report << L"Gain estimate fallbacks: " << m_GainEstimateFallbacks.load( std::memory_order_relaxed ) << L"\r\n";
+
+	if ( AllocationCounter::IsAvailable() ) {
+		// Output callbacks and steady state decoder reads are expected to be allocation free.
+		report << L"Output thread allocations: " << m_RealtimeAllocations.load( std::memory_order_relaxed ) << L"\r\n";
+		for ( const auto& [ decoderType, count ] : AllocationCounter::GetCategoryCounts() ) {
+			report << L"Decoder allocations (" << decoderType << L"): " << count.Allocations << L" in " << count.Calls << L" reads\r\n";
+		}
+	}
+	return report.str();
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include "stdafx.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// Timing & buffer statistics for the output path.
+// Measurements are recorded on the output thread using lock-free counters, and can be read (or reset) from any thread.
+// When diagnostics are disabled, each measurement point costs a single relaxed atomic load.
+class OutputDiagnostics
+{
+public:
+	// Timed stages of the output path.
+	enum class Stage {
+		DeviceCallback,		// WASAPI device callback.
+		StreamCallback,		// Output stream callback.
+		Decode,						// Reading sample data from the decoder.
+		Gain,							// Applying gain to the decoded sample data.
+		Crossfade,				// Decoding, fading and mixing the crossfading stream.
+		Transition,				// Switching to the next decoder.
+
+		_Count
+	};
+
+	// Measures the time taken by a stage, from construction to destruction.
+	class Timer
+	{
+	public:
+		// 'diagnostics' - diagnostics to record the measurement in.
+		// 'stage' - the stage being timed.
+		Timer( OutputDiagnostics& diagnostics, const Stage stage );
+
+		virtual ~Timer();
+
+	private:
+		// Diagnostics to record the measurement in.
+		OutputDiagnostics& m_Diagnostics;
+
+		// The stage being timed.
+		const Stage m_Stage;
+
+		// Start tick count, or zero if diagnostics are disabled.
+		const LONGLONG m_StartTick;
+	};
+
+	OutputDiagnostics();
+
+	virtual ~OutputDiagnostics();
+
+	// Returns whether diagnostics are enabled.
+	bool IsEnabled() const;
+
+	// Sets whether diagnostics are 'enabled'.
+	void SetEnabled( const bool enabled );
+
+	// Clears all measurements.
+	void Reset();
+
+	// Records the fill 'level' of a decoder pre-buffer, in the range 0.0 (empty) to 1.0 (full).
+	void RecordPreBufferLevel( const float level );
+
+	// Records a number of pre-buffer 'underruns' (reads which were padded with silence).
+	void RecordUnderruns( const long underruns );
+
+	// Records a decoder read which returned fewer samples than requested.
+	void RecordShortRead();
+
+	// Records a track transition at which no gain estimate was ready (so that unity gain was applied until the estimate arrived).
+	void RecordGainEstimateFallback();
+
+	// Records the number of heap 'allocations' made during an output callback, outside of track transitions (only counted in debug builds).
+	void RecordRealtimeAllocations( const long long allocations );
+
+	// Returns a text report of the measurements.
+	std::wstring GetReport() const;
+
+private:
+	// Number of timing histogram buckets (bucket N counts durations of less than 2^N microseconds, with the last bucket counting everything else).
+	static constexpr size_t s_TimingBuckets = 20;
+
+	// Number of pre-buffer level histogram buckets.
+	static constexpr size_t s_LevelBuckets = 10;
+
+	// Timing statistics for a stage.
+	struct StageTiming {
+		std::array<std::atomic<uint64_t>, s_TimingBuckets> Histogram;		// Duration histogram.
+		std::atomic<uint64_t> Count;																		// Number of measurements.
+		std::atomic<uint64_t> TotalMicroseconds;												// Total duration, in microseconds.
+		std::atomic<uint64_t> MaxMicroseconds;													// Maximum duration, in microseconds.
+	};
+
+	// Returns the name of a 'stage'.
+	static const wchar_t* GetStageName( const Stage stage );
+
+	// Returns the current tick count, or zero if diagnostics are disabled.
+	LONGLONG GetStartTick() const;
+
+	// Records the time taken by a 'stage', from the 'startTick'.
+	void RecordTiming( const Stage stage, const LONGLONG startTick );
+
+	// Indicates whether diagnostics are enabled.
+	std::atomic<bool> m_Enabled;
+
+	// Performance counter frequency.
+	LONGLONG m_TickFrequency;
+
+	// Timing statistics, indexed by stage.
+	std::array<StageTiming, static_cast<size_t>( Stage::_Count )> m_StageTimings;
+
+	// Pre-buffer level histogram.
+	std::array<std::atomic<uint64_t>, s_LevelBuckets> m_PreBufferLevels;
+
+	// Minimum pre-buffer level, in percent.
+	std::atomic<uint64_t> m_MinPreBufferPercent;
+
+	// Number of pre-buffer underruns.
+	std::atomic<uint64_t> m_Underruns;
+
+	// Number of short decoder reads.
+	std::atomic<uint64_t> m_ShortReads;
+
+	// Number of track transitions at which no gain estimate was ready.
+	std::atomic<uint64_t> m_GainEstimateFallbacks;
+
+	// Number of heap allocations made during output callbacks, outside of track transitions.
+	std::atomic<uint64_t> m_RealtimeAllocations;
+};
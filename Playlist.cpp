@@ -147,6 +147,24 @@ bool Playlist::GetNextItem( const Item& currentItem, Item& nextItem, const bool
 	return success;
 }
 
+bool Playlist::HasNextItem( const Item& currentItem, const bool wrap )
+{
+	std::lock_guard<std::mutex> lock( m_MutexPlaylist );
+
+	bool hasNext = false;
+	const long currentID = currentItem.ID;
+	auto iter = m_Playlist.begin();
+	while ( iter != m_Playlist.end() ) {
+		const long id = iter->ID;
+		++iter;
+		if ( id == currentID ) {
+			hasNext = ( iter != m_Playlist.end() ) || wrap;
+			break;
+		}
+	}
+	return hasNext;
+}
+
 bool Playlist::GetPreviousItem( const Item& currentItem, Item& previousItem, const bool wrap )
 {
 	std::lock_guard<std::mutex> lock( m_MutexPlaylist );
@@ -127,6 +127,11 @@ public:
 	// Returns true if a 'nextItem' was returned.
 	bool GetNextItem( const Item& currentItem, Item& nextItem, const bool wrap = true );
 
+	// Returns whether there is a next playlist item, without copying the item.
+	// 'currentItem' - the current item.
+	// 'wrap' - whether to wrap round to the first playlist item.
+	bool HasNextItem( const Item& currentItem, const bool wrap = true );
+
 	// Gets the previous playlist item.
 	// 'currentItem' - the current item.
 	// 'previousItem' - out, the previous item.
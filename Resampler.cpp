@@ -0,0 +1,411 @@
+#include "Resampler.h"
+
+#include "DSPKernels.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+
+// Number of filter taps on each side of the interpolation point, when upsampling (this is scaled up when downsampling).
+constexpr long s_HalfTaps = 32;
+
+// Kaiser window shape parameter (giving a stopband attenuation of around 90dB).
+constexpr double s_KaiserBeta = 9.0;
+
+// The maximum number of filter phases to hold in the coefficient table.
+// Sample rate ratios which need more phases than this use the nearest phase in the table (which holds an extra phase at the end, so that rounding up to the next input frame is covered).
+constexpr int64_t s_MaxPhases = 1024;
+
+// Number of input sample frames to read at a time.
+constexpr long s_BlockFrames = 1024;
+
+// Gain used when folding a speaker into a pair of speakers (-3dB).
+constexpr float s_FoldGain = 0.70710678f;
+
+// Speaker positions.
+enum class Speaker {
+	FrontLeft,
+	FrontRight,
+	FrontCentre,
+	LowFrequency,
+	BackLeft,
+	BackRight,
+	BackCentre,
+	SideLeft,
+	SideRight
+};
+
+// Maximum number of channels that have a default speaker layout.
+constexpr long s_MaxLayoutChannels = 8;
+
+// Default speaker layouts, indexed by channel count (matching the default WAVEFORMATEXTENSIBLE channel masks).
+static const std::array<std::vector<Speaker>, s_MaxLayoutChannels + 1> s_SpeakerLayouts = {
+	std::vector<Speaker>{},
+	{ Speaker::FrontCentre },
+	{ Speaker::FrontLeft, Speaker::FrontRight },
+	{ Speaker::FrontLeft, Speaker::FrontRight, Speaker::FrontCentre },
+	{ Speaker::FrontLeft, Speaker::FrontRight, Speaker::BackLeft, Speaker::BackRight },
+	{ Speaker::FrontLeft, Speaker::FrontRight, Speaker::FrontCentre, Speaker::BackLeft, Speaker::BackRight },
+	{ Speaker::FrontLeft, Speaker::FrontRight, Speaker::FrontCentre, Speaker::LowFrequency, Speaker::BackLeft, Speaker::BackRight },
+	{ Speaker::FrontLeft, Speaker::FrontRight, Speaker::FrontCentre, Speaker::LowFrequency, Speaker::BackCentre, Speaker::SideLeft, Speaker::SideRight },
+	{ Speaker::FrontLeft, Speaker::FrontRight, Speaker::FrontCentre, Speaker::LowFrequency, Speaker::BackLeft, Speaker::BackRight, Speaker::SideLeft, Speaker::SideRight }
+};
+
+// Returns the zeroth order modified Bessel function of the first kind, for 'x'.
+static double BesselI0( const double x )
+{
+	double result = 1.0;
+	double term = 1.0;
+	const double halfX = x / 2;
+	for ( int k = 1; term > ( result * 1e-12 ); k++ ) {
+		term *= ( halfX / k ) * ( halfX / k );
+		result += term;
+	}
+	return result;
+}
+
+Resampler::Resampler( const long inputRate, const long inputChannels, const long outputRate, const long outputChannels, ReadCallback readCallback ) :
+	m_InputRate( inputRate ),
+	m_InputChannels( inputChannels ),
+	m_OutputRate( outputRate ),
+	m_OutputChannels( outputChannels ),
+	m_ReadCallback( readCallback ),
+	m_FilterChannels( std::min( inputChannels, outputChannels ) ),
+	m_RemixMatrix(),
+	m_Interpolation( 1 ),
+	m_Decimation( 1 ),
+	m_PhaseCount( 1 ),
+	m_Taps( 0 ),
+	m_Coefficients(),
+	m_History(),
+	m_HistoryCapacity( 0 ),
+	m_HistoryFrames( 0 ),
+	m_HistoryPosition( 0 ),
+	m_Phase( 0 ),
+	m_InputBuffer(),
+	m_RemixBuffer(),
+	m_FilteredFrame(),
+	m_InputFrames( 0 ),
+	m_OutputFrames( 0 ),
+	m_InputFinished( false )
+{
+	if ( ( m_InputRate <= 0 ) || ( m_InputChannels <= 0 ) || ( m_OutputRate <= 0 ) || ( m_OutputChannels <= 0 ) || !m_ReadCallback ) {
+		throw std::runtime_error( "Unsupported resampler format" );
+	}
+
+	m_InputBuffer.resize( static_cast<size_t>( s_BlockFrames ) * m_InputChannels );
+	if ( m_InputChannels != m_OutputChannels ) {
+		CreateRemixMatrix();
+		if ( m_OutputChannels < m_InputChannels ) {
+			m_RemixBuffer.resize( static_cast<size_t>( s_BlockFrames ) * m_OutputChannels );
+		}
+	}
+
+	if ( m_InputRate != m_OutputRate ) {
+		const int64_t divisor = std::gcd( static_cast<int64_t>( m_InputRate ), static_cast<int64_t>( m_OutputRate ) );
+		m_Interpolation = m_OutputRate / divisor;
+		m_Decimation = m_InputRate / divisor;
+		CreateFilter();
+		m_HistoryCapacity = m_Taps + s_BlockFrames;
+		m_History.resize( static_cast<size_t>( m_HistoryCapacity ) * m_FilterChannels );
+		m_FilteredFrame.resize( m_FilterChannels );
+	}
+
+	Reset();
+}
+
+Resampler::~Resampler()
+{
+}
+
+long Resampler::Read( float* buffer, const long frames )
+{
+	long framesRead = 0;
+	if ( ( nullptr != buffer ) && ( frames > 0 ) ) {
+		if ( m_InputRate != m_OutputRate ) {
+			framesRead = Resample( buffer, frames );
+		} else if ( m_InputChannels != m_OutputChannels ) {
+			while ( framesRead < frames ) {
+				const long framesToRead = std::min( s_BlockFrames, frames - framesRead );
+				const long blockFramesRead = m_ReadCallback( m_InputBuffer.data(), framesToRead );
+				if ( blockFramesRead <= 0 ) {
+					break;
+				}
+				Remix( m_InputBuffer.data(), buffer + static_cast<size_t>( framesRead ) * m_OutputChannels, blockFramesRead );
+				framesRead += blockFramesRead;
+			}
+		} else {
+			framesRead = m_ReadCallback( buffer, frames );
+		}
+	}
+	return framesRead;
+}
+
+void Resampler::Reset()
+{
+	// Prime the filter history with silence, so that the first output frame is aligned with the first input frame.
+	m_HistoryFrames = ( m_Taps > 0 ) ? ( m_Taps / 2 - 1 ) : 0;
+	std::fill( m_History.begin(), m_History.end(), 0.0f );
+	m_HistoryPosition = 0;
+	m_Phase = 0;
+	m_InputFrames = 0;
+	m_OutputFrames = 0;
+	m_InputFinished = false;
+}
+
+long Resampler::GetInputRate() const
+{
+	return m_InputRate;
+}
+
+long Resampler::GetInputChannels() const
+{
+	return m_InputChannels;
+}
+
+long Resampler::GetOutputRate() const
+{
+	return m_OutputRate;
+}
+
+long Resampler::GetOutputChannels() const
+{
+	return m_OutputChannels;
+}
+
+void Resampler::CreateRemixMatrix()
+{
+	m_RemixMatrix.assign( static_cast<size_t>( m_OutputChannels ) * m_InputChannels, 0.0f );
+
+	if ( ( m_InputChannels > s_MaxLayoutChannels ) || ( m_OutputChannels > s_MaxLayoutChannels ) ) {
+		// No speaker layout, so map channels directly.
+		for ( long channel = 0; channel < std::min( m_InputChannels, m_OutputChannels ); channel++ ) {
+			m_RemixMatrix[ channel * m_InputChannels + channel ] = 1.0f;
+		}
+		return;
+	}
+
+	const std::vector<Speaker>& inputLayout = s_SpeakerLayouts[ m_InputChannels ];
+	const std::vector<Speaker>& outputLayout = s_SpeakerLayouts[ m_OutputChannels ];
+	auto findSpeaker = [ &outputLayout ] ( const Speaker speaker ) -> long
+	{
+		const auto it = std::find( outputLayout.begin(), outputLayout.end(), speaker );
+		return ( outputLayout.end() != it ) ? static_cast<long>( std::distance( outputLayout.begin(), it ) ) : -1;
+	};
+
+	// Folds an input channel into the nearest output speakers, using the ITU-R BS.775 downmix coefficients (without normalisation, as with the BASS mixer downmix).
+	std::function<void( const long, const Speaker, const float )> addSpeaker = [ this, &findSpeaker, &addSpeaker ] ( const long inputChannel, const Speaker speaker, const float gain )
+	{
+		if ( const long outputChannel = findSpeaker( speaker ); outputChannel >= 0 ) {
+			m_RemixMatrix[ outputChannel * m_InputChannels + inputChannel ] += gain;
+			return;
+		}
+		switch ( speaker ) {
+			case Speaker::FrontLeft :
+			case Speaker::FrontRight : {
+				addSpeaker( inputChannel, Speaker::FrontCentre, gain * s_FoldGain );
+				break;
+			}
+			case Speaker::FrontCentre : {
+				addSpeaker( inputChannel, Speaker::FrontLeft, gain * s_FoldGain );
+				addSpeaker( inputChannel, Speaker::FrontRight, gain * s_FoldGain );
+				break;
+			}
+			case Speaker::BackLeft : {
+				if ( findSpeaker( Speaker::SideLeft ) >= 0 ) {
+					addSpeaker( inputChannel, Speaker::SideLeft, gain );
+				} else {
+					addSpeaker( inputChannel, Speaker::FrontLeft, gain * s_FoldGain );
+				}
+				break;
+			}
+			case Speaker::BackRight : {
+				if ( findSpeaker( Speaker::SideRight ) >= 0 ) {
+					addSpeaker( inputChannel, Speaker::SideRight, gain );
+				} else {
+					addSpeaker( inputChannel, Speaker::FrontRight, gain * s_FoldGain );
+				}
+				break;
+			}
+			case Speaker::SideLeft : {
+				if ( findSpeaker( Speaker::BackLeft ) >= 0 ) {
+					addSpeaker( inputChannel, Speaker::BackLeft, gain );
+				} else {
+					addSpeaker( inputChannel, Speaker::FrontLeft, gain * s_FoldGain );
+				}
+				break;
+			}
+			case Speaker::SideRight : {
+				if ( findSpeaker( Speaker::BackRight ) >= 0 ) {
+					addSpeaker( inputChannel, Speaker::BackRight, gain );
+				} else {
+					addSpeaker( inputChannel, Speaker::FrontRight, gain * s_FoldGain );
+				}
+				break;
+			}
+			case Speaker::BackCentre : {
+				if ( findSpeaker( Speaker::BackLeft ) >= 0 ) {
+					addSpeaker( inputChannel, Speaker::BackLeft, gain * s_FoldGain );
+					addSpeaker( inputChannel, Speaker::BackRight, gain * s_FoldGain );
+				} else if ( findSpeaker( Speaker::SideLeft ) >= 0 ) {
+					addSpeaker( inputChannel, Speaker::SideLeft, gain * s_FoldGain );
+					addSpeaker( inputChannel, Speaker::SideRight, gain * s_FoldGain );
+				} else {
+					addSpeaker( inputChannel, Speaker::FrontLeft, gain * s_FoldGain );
+					addSpeaker( inputChannel, Speaker::FrontRight, gain * s_FoldGain );
+				}
+				break;
+			}
+			default : {
+				// The low frequency channel is dropped when there is no output speaker for it.
+				break;
+			}
+		}
+	};
+
+	if ( ( 1 == m_InputChannels ) && ( findSpeaker( Speaker::FrontLeft ) >= 0 ) && ( findSpeaker( Speaker::FrontRight ) >= 0 ) ) {
+		// Mono sources are played at full volume on the front left & right speakers.
+		m_RemixMatrix[ findSpeaker( Speaker::FrontLeft ) * m_InputChannels ] = 1.0f;
+		m_RemixMatrix[ findSpeaker( Speaker::FrontRight ) * m_InputChannels ] = 1.0f;
+	} else {
+		for ( long inputChannel = 0; inputChannel < m_InputChannels; inputChannel++ ) {
+			addSpeaker( inputChannel, inputLayout[ inputChannel ], 1.0f );
+		}
+	}
+}
+
+void Resampler::CreateFilter()
+{
+	// When downsampling, the cutoff is lowered to the output Nyquist frequency, and the filter is lengthened to keep the same transition band.
+	const double ratio = std::min( 1.0, static_cast<double>( m_OutputRate ) / m_InputRate );
+	const long halfTaps = static_cast<long>( std::ceil( s_HalfTaps / ratio ) );
+	m_Taps = 2 * halfTaps;
+	m_PhaseCount = std::min( m_Interpolation, s_MaxPhases );
+	const int64_t tablePhases = ( m_PhaseCount < m_Interpolation ) ? ( m_PhaseCount + 1 ) : m_PhaseCount;
+	m_Coefficients.resize( static_cast<size_t>( tablePhases ) * m_Taps );
+
+	const double pi = std::acos( -1.0 );
+	const double windowScale = 1.0 / BesselI0( s_KaiserBeta );
+	for ( int64_t phase = 0; phase < tablePhases; phase++ ) {
+		const double fraction = static_cast<double>( phase ) / m_PhaseCount;
+		float* coefficients = m_Coefficients.data() + phase * m_Taps;
+		double total = 0;
+		for ( long tap = 0; tap < m_Taps; tap++ ) {
+			const double t = ( tap - ( halfTaps - 1 ) ) - fraction;
+			const double x = t / halfTaps;
+			const double window = ( std::fabs( x ) < 1.0 ) ? ( BesselI0( s_KaiserBeta * std::sqrt( 1.0 - x * x ) ) * windowScale ) : 0.0;
+			const double sincArgument = pi * ratio * t;
+			const double sinc = ( 0.0 == sincArgument ) ? 1.0 : ( std::sin( sincArgument ) / sincArgument );
+			const double coefficient = ratio * sinc * window;
+			coefficients[ tap ] = static_cast<float>( coefficient );
+			total += coefficient;
+		}
+
+		// Normalise each phase for unity gain at DC.
+		if ( 0.0 != total ) {
+			for ( long tap = 0; tap < m_Taps; tap++ ) {
+				coefficients[ tap ] = static_cast<float>( coefficients[ tap ] / total );
+			}
+		}
+	}
+}
+
+void Resampler::Remix( const float* input, float* output, const long frames ) const
+{
+	for ( long frame = 0; frame < frames; frame++, input += m_InputChannels, output += m_OutputChannels ) {
+		const float* matrix = m_RemixMatrix.data();
+		for ( long outputChannel = 0; outputChannel < m_OutputChannels; outputChannel++, matrix += m_InputChannels ) {
+			float value = 0;
+			for ( long inputChannel = 0; inputChannel < m_InputChannels; inputChannel++ ) {
+				value += matrix[ inputChannel ] * input[ inputChannel ];
+			}
+			output[ outputChannel ] = value;
+		}
+	}
+}
+
+bool Resampler::FillHistory()
+{
+	if ( m_InputFinished ) {
+		return false;
+	}
+
+	// Discard any history which is no longer needed.
+	if ( m_HistoryPosition > 0 ) {
+		const long framesToKeep = m_HistoryFrames - m_HistoryPosition;
+		for ( long channel = 0; channel < m_FilterChannels; channel++ ) {
+			float* history = m_History.data() + static_cast<size_t>( channel ) * m_HistoryCapacity;
+			std::memmove( history, history + m_HistoryPosition, framesToKeep * sizeof( float ) );
+		}
+		m_HistoryFrames = framesToKeep;
+		m_HistoryPosition = 0;
+	}
+
+	const long framesToRead = std::min( s_BlockFrames, m_HistoryCapacity - m_HistoryFrames );
+	const long framesRead = ( framesToRead > 0 ) ? m_ReadCallback( m_InputBuffer.data(), framesToRead ) : 0;
+	if ( framesRead > 0 ) {
+		const float* input = m_InputBuffer.data();
+		if ( m_FilterChannels < m_InputChannels ) {
+			Remix( input, m_RemixBuffer.data(), framesRead );
+			input = m_RemixBuffer.data();
+		}
+		for ( long channel = 0; channel < m_FilterChannels; channel++ ) {
+			float* history = m_History.data() + static_cast<size_t>( channel ) * m_HistoryCapacity + m_HistoryFrames;
+			const float* sample = input + channel;
+			for ( long frame = 0; frame < framesRead; frame++, sample += m_FilterChannels ) {
+				history[ frame ] = *sample;
+			}
+		}
+		m_HistoryFrames += framesRead;
+		m_InputFrames += framesRead;
+	} else {
+		// Pad the end of the stream with silence, so that the final output frames can be filtered.
+		m_InputFinished = true;
+		const long paddingFrames = std::min( m_Taps / 2, m_HistoryCapacity - m_HistoryFrames );
+		for ( long channel = 0; channel < m_FilterChannels; channel++ ) {
+			float* history = m_History.data() + static_cast<size_t>( channel ) * m_HistoryCapacity + m_HistoryFrames;
+			std::fill( history, history + paddingFrames, 0.0f );
+		}
+		m_HistoryFrames += paddingFrames;
+	}
+	return true;
+}
+
+long Resampler::Resample( float* buffer, const long frames )
+{
+	const bool remixOutput = ( m_FilterChannels < m_OutputChannels );
+	long framesRead = 0;
+	while ( framesRead < frames ) {
+		if ( m_InputFinished && ( ( m_OutputFrames * m_Decimation ) >= ( m_InputFrames * m_Interpolation ) ) ) {
+			break;
+		}
+		if ( ( m_HistoryPosition + m_Taps ) > m_HistoryFrames ) {
+			if ( !FillHistory() ) {
+				break;
+			}
+			continue;
+		}
+
+		// Use the nearest phase in the coefficient table (rounding, rather than truncating, halves the timing error).
+		const int64_t phase = ( m_PhaseCount == m_Interpolation ) ? m_Phase : ( ( m_Phase * m_PhaseCount + m_Interpolation / 2 ) / m_Interpolation );
+		const float* coefficients = m_Coefficients.data() + phase * m_Taps;
+		float* output = remixOutput ? m_FilteredFrame.data() : ( buffer + static_cast<size_t>( framesRead ) * m_OutputChannels );
+		for ( long channel = 0; channel < m_FilterChannels; channel++ ) {
+			const float* history = m_History.data() + static_cast<size_t>( channel ) * m_HistoryCapacity + m_HistoryPosition;
+			output[ channel ] = DSPKernels::DotProduct( history, coefficients, static_cast<size_t>( m_Taps ) );
+		}
+		if ( remixOutput ) {
+			Remix( m_FilteredFrame.data(), buffer + static_cast<size_t>( framesRead ) * m_OutputChannels, 1 );
+		}
+
+		++framesRead;
+		++m_OutputFrames;
+		m_Phase += m_Decimation;
+		m_HistoryPosition += static_cast<long>( m_Phase / m_Interpolation );
+		m_Phase %= m_Interpolation;
+	}
+	return framesRead;
+}
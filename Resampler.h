@@ -0,0 +1,139 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// Converts interleaved sample data from one sample rate & channel count to another.
+// Resampling uses a polyphase windowed sinc filter, and channel remixing uses the default speaker layout for each channel count.
+// Once constructed, reads do not allocate, so the converter can be used on the output path.
+class Resampler
+{
+public:
+	// Callback which reads sample data in the input format.
+	// 'buffer' - output buffer (floating point format scaled to +/-1.0f).
+	// 'frames' - number of sample frames to read.
+	// Returns the number of sample frames read, or zero if the stream has ended.
+	using ReadCallback = std::function<long( float* buffer, const long frames )>;
+
+	// 'inputRate' - input sample rate.
+	// 'inputChannels' - input channel count.
+	// 'outputRate' - output sample rate.
+	// 'outputChannels' - output channel count.
+	// 'readCallback' - reads sample data in the input format.
+	// Throws a std::runtime_error exception if the conversion is not supported.
+	Resampler( const long inputRate, const long inputChannels, const long outputRate, const long outputChannels, ReadCallback readCallback );
+
+	virtual ~Resampler();
+
+	// Reads sample data in the output format.
+	// 'buffer' - output buffer (floating point format scaled to +/-1.0f).
+	// 'frames' - number of sample frames to read.
+	// Returns the number of sample frames read, or zero if the stream has ended.
+	long Read( float* buffer, const long frames );
+
+	// Clears the filter history (e.g. after the input stream has been repositioned).
+	void Reset();
+
+	// Returns the input sample rate.
+	long GetInputRate() const;
+
+	// Returns the input channel count.
+	long GetInputChannels() const;
+
+	// Returns the output sample rate.
+	long GetOutputRate() const;
+
+	// Returns the output channel count.
+	long GetOutputChannels() const;
+
+private:
+	// Builds the channel remix matrix.
+	void CreateRemixMatrix();
+
+	// Builds the polyphase filter coefficients.
+	void CreateFilter();
+
+	// Remixes sample frames from the input channel count to the output channel count.
+	// 'input' - input sample data.
+	// 'output' - output sample data.
+	// 'frames' - number of sample frames.
+	void Remix( const float* input, float* output, const long frames ) const;
+
+	// Reads the next block of input sample data into the filter history.
+	// Returns false if there is no more input sample data.
+	bool FillHistory();
+
+	// Sample rate conversion of up to 'frames' of sample data into 'buffer'.
+	// Returns the number of sample frames read.
+	long Resample( float* buffer, const long frames );
+
+	// Input sample rate.
+	const long m_InputRate;
+
+	// Input channel count.
+	const long m_InputChannels;
+
+	// Output sample rate.
+	const long m_OutputRate;
+
+	// Output channel count.
+	const long m_OutputChannels;
+
+	// Reads sample data in the input format.
+	const ReadCallback m_ReadCallback;
+
+	// The number of channels passed through the filter (remixing is done on whichever side of the filter has fewer channels).
+	const long m_FilterChannels;
+
+	// Channel remix matrix (output channel major), or empty if the channel count is unchanged.
+	std::vector<float> m_RemixMatrix;
+
+	// Interpolation factor (the output rate divided by the greatest common divisor of the sample rates).
+	int64_t m_Interpolation;
+
+	// Decimation factor (the input rate divided by the greatest common divisor of the sample rates).
+	int64_t m_Decimation;
+
+	// Number of filter phases per input frame held in the coefficient table (when this is less than the interpolation factor, the table holds one extra phase).
+	int64_t m_PhaseCount;
+
+	// Number of filter taps per phase.
+	long m_Taps;
+
+	// Filter coefficients, phase major.
+	std::vector<float> m_Coefficients;
+
+	// Filter history, one block per filter channel (planar, so that the filter can be applied to contiguous samples).
+	std::vector<float> m_History;
+
+	// Capacity of the filter history for each channel, in sample frames.
+	long m_HistoryCapacity;
+
+	// Number of valid sample frames in the filter history.
+	long m_HistoryFrames;
+
+	// The filter history position of the first tap for the next output frame.
+	long m_HistoryPosition;
+
+	// The filter phase for the next output frame, in the range [0, interpolation factor).
+	int64_t m_Phase;
+
+	// Input sample data, before any remixing.
+	std::vector<float> m_InputBuffer;
+
+	// Input sample data, after any remixing.
+	std::vector<float> m_RemixBuffer;
+
+	// Filtered sample frame, before any remixing.
+	std::vector<float> m_FilteredFrame;
+
+	// Total number of input sample frames read since the last reset.
+	int64_t m_InputFrames;
+
+	// Total number of output sample frames produced since the last reset.
+	int64_t m_OutputFrames;
+
+	// Indicates whether the input stream has ended.
+	bool m_InputFinished;
+};
@@ -0,0 +1,79 @@
+#include "RingBuffer.h"
+
+#include <algorithm>
+
+RingBuffer::RingBuffer( const size_t capacity ) :
+	m_Buffer( RoundUpToPowerOfTwo( capacity ) ),
+	m_Mask( m_Buffer.size() - 1 ),
+	m_WritePosition( 0 ),
+	m_ReadPosition( 0 )
+{
+}
+
+RingBuffer::~RingBuffer()
+{
+}
+
+size_t RingBuffer::RoundUpToPowerOfTwo( const size_t value )
+{
+	size_t result = 1;
+	while ( result < value ) {
+		result <<= 1;
+	}
+	return result;
+}
+
+size_t RingBuffer::Write( const float* samples, const size_t count )
+{
+	const uint64_t writePosition = m_WritePosition.load( std::memory_order_relaxed );
+	const uint64_t readPosition = m_ReadPosition.load( std::memory_order_acquire );
+	const size_t available = m_Buffer.size() - static_cast<size_t>( writePosition - readPosition );
+	const size_t samplesToWrite = std::min( count, available );
+	if ( samplesToWrite > 0 ) {
+		const size_t index = static_cast<size_t>( writePosition ) & m_Mask;
+		const size_t firstPart = std::min( samplesToWrite, m_Buffer.size() - index );
+		std::copy( samples, samples + firstPart, m_Buffer.begin() + index );
+		std::copy( samples + firstPart, samples + samplesToWrite, m_Buffer.begin() );
+		m_WritePosition.store( writePosition + samplesToWrite, std::memory_order_release );
+	}
+	return samplesToWrite;
+}
+
+size_t RingBuffer::Read( float* samples, const size_t count )
+{
+	const uint64_t readPosition = m_ReadPosition.load( std::memory_order_relaxed );
+	const uint64_t writePosition = m_WritePosition.load( std::memory_order_acquire );
+	const size_t available = static_cast<size_t>( writePosition - readPosition );
+	const size_t samplesToRead = std::min( count, available );
+	if ( samplesToRead > 0 ) {
+		const size_t index = static_cast<size_t>( readPosition ) & m_Mask;
+		const size_t firstPart = std::min( samplesToRead, m_Buffer.size() - index );
+		std::copy( m_Buffer.begin() + index, m_Buffer.begin() + index + firstPart, samples );
+		std::copy( m_Buffer.begin(), m_Buffer.begin() + ( samplesToRead - firstPart ), samples + firstPart );
+		m_ReadPosition.store( readPosition + samplesToRead, std::memory_order_release );
+	}
+	return samplesToRead;
+}
+
+size_t RingBuffer::GetReadAvailable() const
+{
+	const uint64_t readPosition = m_ReadPosition.load( std::memory_order_acquire );
+	const uint64_t writePosition = m_WritePosition.load( std::memory_order_acquire );
+	return static_cast<size_t>( writePosition - readPosition );
+}
+
+size_t RingBuffer::GetWriteAvailable() const
+{
+	return m_Buffer.size() - GetReadAvailable();
+}
+
+size_t RingBuffer::GetCapacity() const
+{
+	return m_Buffer.size();
+}
+
+void RingBuffer::Reset()
+{
+	m_WritePosition.store( 0, std::memory_order_relaxed );
+	m_ReadPosition.store( 0, std::memory_order_relaxed );
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+// Wait-free single producer, single consumer ring buffer of floating point samples.
+// A single thread may write to the buffer while another thread reads from it, without either thread taking a lock.
+class RingBuffer
+{
+public:
+	// 'capacity' - the minimum number of samples the buffer can hold (this is rounded up to a power of two).
+	explicit RingBuffer( const size_t capacity );
+
+	virtual ~RingBuffer();
+
+	// Writes samples to the buffer (only to be called from the producer thread).
+	// 'samples' - sample data.
+	// 'count' - number of samples to write.
+	// Returns the number of samples written, which can be less than 'count' if the buffer is full.
+	size_t Write( const float* samples, const size_t count );
+
+	// Reads samples from the buffer (only to be called from the consumer thread).
+	// 'samples' - out, sample data.
+	// 'count' - number of samples to read.
+	// Returns the number of samples read, which can be less than 'count' if the buffer is empty.
+	size_t Read( float* samples, const size_t count );
+
+	// Returns the number of samples available to read.
+	size_t GetReadAvailable() const;
+
+	// Returns the number of samples that can be written.
+	size_t GetWriteAvailable() const;
+
+	// Returns the buffer capacity, in samples.
+	size_t GetCapacity() const;
+
+	// Empties the buffer (only to be called when neither the producer nor the consumer thread is active).
+	void Reset();
+
+private:
+	// Cache line size, used to separate the read and write positions.
+	static constexpr size_t kCacheLineSize = 64;
+
+	// Returns the smallest power of two which is not less than 'value'.
+	static size_t RoundUpToPowerOfTwo( const size_t value );
+
+	// Sample data.
+	std::vector<float> m_Buffer;
+
+	// Mask to convert a position into a buffer index.
+	const size_t m_Mask;
+
+	// Total number of samples written, only modified by the producer thread.
+	alignas( kCacheLineSize ) std::atomic<uint64_t> m_WritePosition;
+
+	// Total number of samples read, only modified by the consumer thread.
+	alignas( kCacheLineSize ) std::atomic<uint64_t> m_ReadPosition;
+};
@@ -0,0 +1,720 @@
+#include "SampleConversion.h"
+
+#include "DSPKernels.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <tuple>
+
+#if defined( _M_IX86 ) || defined( _M_X64 )
+#define SAMPLECONVERSION_X86
+#include <immintrin.h>
+#endif
+
+// Number of sample frames converted at a time when interleaving planar sample data.
+constexpr size_t s_BlockFrames = 256;
+
+// Scale factors for converting integer samples to floating point (powers of two, so that scaling matches the division used by the scalar helper functions).
+constexpr float s_Scale8 = 1.0f / 0x80;
+constexpr float s_Scale16 = 1.0f / 0x8000;
+constexpr float s_Scale32 = 1.0f / 0x80000000ul;
+
+// Returns the scale factor for converting right-justified integer samples with 'bitsPerSample' to floating point.
+static float GetScale( const long bitsPerSample )
+{
+	return 1.0f / static_cast<float>( 1ull << ( std::clamp( bitsPerSample, 1l, 32l ) - 1 ) );
+}
+
+// Returns the scale factor, minimum and maximum values for converting floating point samples to right-justified integers with 'bitsPerSample'.
+static std::tuple<float, float, float> GetRange( const long bitsPerSample )
+{
+	const float scale = static_cast<float>( 1l << ( std::clamp( bitsPerSample, 8l, 24l ) - 1 ) );
+	return { scale, -scale, scale - 1 };
+}
+
+void SampleConversion::ToFloat( const uint8_t* input, float* output, const size_t count )
+{
+	switch ( DSPKernels::GetInstructionSet() ) {
+		case DSPKernels::InstructionSet::AVX2 : {
+			ToFloatAVX2( input, output, count );
+			break;
+		}
+		case DSPKernels::InstructionSet::SSE2 : {
+			ToFloatSSE2( input, output, count );
+			break;
+		}
+		default : {
+			ToFloatScalar( input, output, count );
+			break;
+		}
+	}
+}
+
+void SampleConversion::ToFloat( const int16_t* input, float* output, const size_t count )
+{
+	switch ( DSPKernels::GetInstructionSet() ) {
+		case DSPKernels::InstructionSet::AVX2 : {
+			ToFloatAVX2( input, output, count );
+			break;
+		}
+		case DSPKernels::InstructionSet::SSE2 : {
+			ToFloatSSE2( input, output, count );
+			break;
+		}
+		default : {
+			ToFloatScalar( input, output, count );
+			break;
+		}
+	}
+}
+
+void SampleConversion::ToFloat( const int32_t* input, float* output, const size_t count, const long bitsPerSample )
+{
+	switch ( DSPKernels::GetInstructionSet() ) {
+		case DSPKernels::InstructionSet::AVX2 : {
+			ToFloatAVX2( input, output, count, bitsPerSample );
+			break;
+		}
+		case DSPKernels::InstructionSet::SSE2 : {
+			ToFloatSSE2( input, output, count, bitsPerSample );
+			break;
+		}
+		default : {
+			ToFloatScalar( input, output, count, bitsPerSample );
+			break;
+		}
+	}
+}
+
+void SampleConversion::ToFloat( const int64_t* input, float* output, const size_t count )
+{
+	// There is no vectorised 64-bit integer conversion below AVX-512, and the format is rare, so this is always scalar.
+	for ( size_t n = 0; n < count; n++ ) {
+		output[ n ] = Signed64ToFloat( input[ n ] );
+	}
+}
+
+void SampleConversion::ToFloat( const float* input, float* output, const size_t count )
+{
+	if ( input != output ) {
+		std::memcpy( output, input, count * sizeof( float ) );
+	}
+}
+
+void SampleConversion::ToFloat( const double* input, float* output, const size_t count )
+{
+	switch ( DSPKernels::GetInstructionSet() ) {
+		case DSPKernels::InstructionSet::AVX2 : {
+			ToFloatAVX2( input, output, count );
+			break;
+		}
+		case DSPKernels::InstructionSet::SSE2 : {
+			ToFloatSSE2( input, output, count );
+			break;
+		}
+		default : {
+			ToFloatScalar( input, output, count );
+			break;
+		}
+	}
+}
+
+void SampleConversion::Packed24ToFloat( const uint8_t* input, float* output, const size_t count )
+{
+	if ( DSPKernels::InstructionSet::AVX2 == DSPKernels::GetInstructionSet() ) {
+		Packed24ToFloatAVX2( input, output, count );
+	} else {
+		// SSE2 has no byte shuffle, so there is no benefit over the scalar implementation.
+		Packed24ToFloatScalar( input, output, count );
+	}
+}
+
+void SampleConversion::InterleaveToFloat( const uint8_t* const* input, const size_t offset, float* output, const size_t frames, const long channels )
+{
+	InterleaveBlocks( input, offset, output, frames, channels, [] ( const uint8_t* in, float* out, const size_t count ) { ToFloat( in, out, count ); } );
+}
+
+void SampleConversion::InterleaveToFloat( const int16_t* const* input, const size_t offset, float* output, const size_t frames, const long channels )
+{
+	InterleaveBlocks( input, offset, output, frames, channels, [] ( const int16_t* in, float* out, const size_t count ) { ToFloat( in, out, count ); } );
+}
+
+void SampleConversion::InterleaveToFloat( const int32_t* const* input, const size_t offset, float* output, const size_t frames, const long channels, const long bitsPerSample )
+{
+	InterleaveBlocks( input, offset, output, frames, channels, [ bitsPerSample ] ( const int32_t* in, float* out, const size_t count ) { ToFloat( in, out, count, bitsPerSample ); } );
+}
+
+void SampleConversion::InterleaveToFloat( const int64_t* const* input, const size_t offset, float* output, const size_t frames, const long channels )
+{
+	InterleaveBlocks( input, offset, output, frames, channels, [] ( const int64_t* in, float* out, const size_t count ) { ToFloat( in, out, count ); } );
+}
+
+void SampleConversion::InterleaveToFloat( const float* const* input, const size_t offset, float* output, const size_t frames, const long channels )
+{
+	if ( 2 == channels ) {
+		// No conversion is needed, so interleave directly from the input planes.
+		const float* planes[ 2 ] = { input[ 0 ] + offset, input[ 1 ] + offset };
+		Interleave( planes, output, frames, channels );
+	} else {
+		InterleaveBlocks( input, offset, output, frames, channels, [] ( const float* in, float* out, const size_t count ) { ToFloat( in, out, count ); } );
+	}
+}
+
+void SampleConversion::InterleaveToFloat( const double* const* input, const size_t offset, float* output, const size_t frames, const long channels )
+{
+	InterleaveBlocks( input, offset, output, frames, channels, [] ( const double* in, float* out, const size_t count ) { ToFloat( in, out, count ); } );
+}
+
+void SampleConversion::Interleave( const float* const* input, float* output, const size_t frames, const long channels )
+{
+	if ( 2 == channels ) {
+		switch ( DSPKernels::GetInstructionSet() ) {
+			case DSPKernels::InstructionSet::AVX2 : {
+				InterleaveStereoAVX2( input, output, frames );
+				break;
+			}
+			case DSPKernels::InstructionSet::SSE2 : {
+				InterleaveStereoSSE2( input, output, frames );
+				break;
+			}
+			default : {
+				InterleaveScalar( input, output, frames, channels );
+				break;
+			}
+		}
+	} else {
+		InterleaveScalar( input, output, frames, channels );
+	}
+}
+
+void SampleConversion::FromFloat( const float* input, uint8_t* output, const size_t count )
+{
+	switch ( DSPKernels::GetInstructionSet() ) {
+		case DSPKernels::InstructionSet::AVX2 : {
+			FromFloatAVX2( input, output, count );
+			break;
+		}
+		case DSPKernels::InstructionSet::SSE2 : {
+			FromFloatSSE2( input, output, count );
+			break;
+		}
+		default : {
+			FromFloatScalar( input, output, count );
+			break;
+		}
+	}
+}
+
+void SampleConversion::FromFloat( const float* input, int16_t* output, const size_t count )
+{
+	switch ( DSPKernels::GetInstructionSet() ) {
+		case DSPKernels::InstructionSet::AVX2 : {
+			FromFloatAVX2( input, output, count );
+			break;
+		}
+		case DSPKernels::InstructionSet::SSE2 : {
+			FromFloatSSE2( input, output, count );
+			break;
+		}
+		default : {
+			FromFloatScalar( input, output, count );
+			break;
+		}
+	}
+}
+
+void SampleConversion::FromFloat( const float* input, int32_t* output, const size_t count, const long bitsPerSample )
+{
+	switch ( DSPKernels::GetInstructionSet() ) {
+		case DSPKernels::InstructionSet::AVX2 : {
+			FromFloatAVX2( input, output, count, bitsPerSample );
+			break;
+		}
+		case DSPKernels::InstructionSet::SSE2 : {
+			FromFloatSSE2( input, output, count, bitsPerSample );
+			break;
+		}
+		default : {
+			FromFloatScalar( input, output, count, bitsPerSample );
+			break;
+		}
+	}
+}
+
+void SampleConversion::FloatToPacked24( const float* input, uint8_t* output, const size_t count )
+{
+	// Convert a block at a time to 32-bit, then pack down to 24-bit.
+	std::array<int32_t, s_BlockFrames> block;
+	for ( size_t position = 0; position < count; position += s_BlockFrames ) {
+		const size_t blockCount = std::min( s_BlockFrames, count - position );
+		FromFloat( input + position, block.data(), blockCount, 24 );
+		for ( size_t n = 0; n < blockCount; n++ ) {
+			const int32_t value = block[ n ];
+			*output++ = value & 0xff;
+			*output++ = ( value >> 8 ) & 0xff;
+			*output++ = ( value >> 16 ) & 0xff;
+		}
+	}
+}
+
+template <typename T, typename Convert>
+void SampleConversion::InterleaveBlocks( const T* const* input, const size_t offset, float* output, const size_t frames, const long channels, Convert convert )
+{
+	if ( 1 == channels ) {
+		convert( input[ 0 ] + offset, output, frames );
+	} else if ( channels > 1 ) {
+		std::array<float, 2 * s_BlockFrames> block;
+		for ( size_t position = 0; position < frames; position += s_BlockFrames ) {
+			const size_t blockFrames = std::min( s_BlockFrames, frames - position );
+			if ( 2 == channels ) {
+				const float* planes[ 2 ] = { block.data(), block.data() + s_BlockFrames };
+				convert( input[ 0 ] + offset + position, block.data(), blockFrames );
+				convert( input[ 1 ] + offset + position, block.data() + s_BlockFrames, blockFrames );
+				Interleave( planes, output + position * 2, blockFrames, 2 );
+			} else {
+				for ( long channel = 0; channel < channels; channel++ ) {
+					convert( input[ channel ] + offset + position, block.data(), blockFrames );
+					float* destination = output + position * channels + channel;
+					for ( size_t frame = 0; frame < blockFrames; frame++, destination += channels ) {
+						*destination = block[ frame ];
+					}
+				}
+			}
+		}
+	}
+}
+
+void SampleConversion::ToFloatScalar( const uint8_t* input, float* output, const size_t count )
+{
+	for ( size_t n = 0; n < count; n++ ) {
+		output[ n ] = Unsigned8ToFloat( input[ n ] );
+	}
+}
+
+void SampleConversion::ToFloatScalar( const int16_t* input, float* output, const size_t count )
+{
+	for ( size_t n = 0; n < count; n++ ) {
+		output[ n ] = Signed16ToFloat( input[ n ] );
+	}
+}
+
+void SampleConversion::ToFloatScalar( const int32_t* input, float* output, const size_t count, const long bitsPerSample )
+{
+	if ( 32 == bitsPerSample ) {
+		for ( size_t n = 0; n < count; n++ ) {
+			output[ n ] = Signed32ToFloat( input[ n ] );
+		}
+	} else {
+		const float scale = GetScale( bitsPerSample );
+		for ( size_t n = 0; n < count; n++ ) {
+			output[ n ] = static_cast<float>( input[ n ] ) * scale;
+		}
+	}
+}
+
+void SampleConversion::ToFloatScalar( const double* input, float* output, const size_t count )
+{
+	for ( size_t n = 0; n < count; n++ ) {
+		output[ n ] = static_cast<float>( input[ n ] );
+	}
+}
+
+void SampleConversion::Packed24ToFloatScalar( const uint8_t* input, float* output, const size_t count )
+{
+	for ( size_t n = 0; n < count; n++, input += 3 ) {
+		output[ n ] = Signed32ToFloat( static_cast<int32_t>( ( static_cast<uint32_t>( input[ 2 ] ) << 24 ) | ( static_cast<uint32_t>( input[ 1 ] ) << 16 ) | ( static_cast<uint32_t>( input[ 0 ] ) << 8 ) ) );
+	}
+}
+
+void SampleConversion::InterleaveScalar( const float* const* input, float* output, const size_t frames, const long channels )
+{
+	for ( size_t frame = 0; frame < frames; frame++ ) {
+		for ( long channel = 0; channel < channels; channel++ ) {
+			*output++ = input[ channel ][ frame ];
+		}
+	}
+}
+
+void SampleConversion::FromFloatScalar( const float* input, uint8_t* output, const size_t count )
+{
+	for ( size_t n = 0; n < count; n++ ) {
+		output[ n ] = FloatToUnsigned8( input[ n ] );
+	}
+}
+
+void SampleConversion::FromFloatScalar( const float* input, int16_t* output, const size_t count )
+{
+	for ( size_t n = 0; n < count; n++ ) {
+		output[ n ] = FloatTo16( input[ n ] );
+	}
+}
+
+void SampleConversion::FromFloatScalar( const float* input, int32_t* output, const size_t count, const long bitsPerSample )
+{
+	switch ( bitsPerSample ) {
+		case 8 : {
+			for ( size_t n = 0; n < count; n++ ) {
+				output[ n ] = FloatToSigned8( input[ n ] );
+			}
+			break;
+		}
+		case 16 : {
+			for ( size_t n = 0; n < count; n++ ) {
+				output[ n ] = FloatTo16( input[ n ] );
+			}
+			break;
+		}
+		case 24 : {
+			for ( size_t n = 0; n < count; n++ ) {
+				output[ n ] = FloatTo24( input[ n ] );
+			}
+			break;
+		}
+		default : {
+			const auto [ scale, minimum, maximum ] = GetRange( bitsPerSample );
+			for ( size_t n = 0; n < count; n++ ) {
+				const float scaledValue = input[ n ] * scale;
+				output[ n ] = ( scaledValue > maximum ) ? static_cast<int32_t>( maximum ) : ( ( scaledValue < minimum ) ? static_cast<int32_t>( minimum ) : static_cast<int32_t>( scaledValue ) );
+			}
+			break;
+		}
+	}
+}
+
+#ifdef SAMPLECONVERSION_X86
+
+void SampleConversion::ToFloatSSE2( const uint8_t* input, float* output, const size_t count )
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i bias = _mm_set1_epi32( 0x80 );
+	const __m128 scale = _mm_set1_ps( s_Scale8 );
+	size_t n = 0;
+	for ( ; ( n + 16 ) <= count; n += 16 ) {
+		const __m128i bytes = _mm_loadu_si128( reinterpret_cast<const __m128i*>( input + n ) );
+		const __m128i low = _mm_unpacklo_epi8( bytes, zero );
+		const __m128i high = _mm_unpackhi_epi8( bytes, zero );
+		_mm_storeu_ps( output + n, _mm_mul_ps( _mm_cvtepi32_ps( _mm_sub_epi32( _mm_unpacklo_epi16( low, zero ), bias ) ), scale ) );
+		_mm_storeu_ps( output + n + 4, _mm_mul_ps( _mm_cvtepi32_ps( _mm_sub_epi32( _mm_unpackhi_epi16( low, zero ), bias ) ), scale ) );
+		_mm_storeu_ps( output + n + 8, _mm_mul_ps( _mm_cvtepi32_ps( _mm_sub_epi32( _mm_unpacklo_epi16( high, zero ), bias ) ), scale ) );
+		_mm_storeu_ps( output + n + 12, _mm_mul_ps( _mm_cvtepi32_ps( _mm_sub_epi32( _mm_unpackhi_epi16( high, zero ), bias ) ), scale ) );
+	}
+	ToFloatScalar( input + n, output + n, count - n );
+}
+
+void SampleConversion::ToFloatSSE2( const int16_t* input, float* output, const size_t count )
+{
+	const __m128 scale = _mm_set1_ps( s_Scale16 );
+	size_t n = 0;
+	for ( ; ( n + 8 ) <= count; n += 8 ) {
+		const __m128i samples = _mm_loadu_si128( reinterpret_cast<const __m128i*>( input + n ) );
+		// Sign extend by placing each sample in the upper half of a 32-bit value, then shifting back down.
+		const __m128i low = _mm_srai_epi32( _mm_unpacklo_epi16( samples, samples ), 16 );
+		const __m128i high = _mm_srai_epi32( _mm_unpackhi_epi16( samples, samples ), 16 );
+		_mm_storeu_ps( output + n, _mm_mul_ps( _mm_cvtepi32_ps( low ), scale ) );
+		_mm_storeu_ps( output + n + 4, _mm_mul_ps( _mm_cvtepi32_ps( high ), scale ) );
+	}
+	ToFloatScalar( input + n, output + n, count - n );
+}
+
+void SampleConversion::ToFloatSSE2( const int32_t* input, float* output, const size_t count, const long bitsPerSample )
+{
+	const __m128 scale = _mm_set1_ps( ( 32 == bitsPerSample ) ? s_Scale32 : GetScale( bitsPerSample ) );
+	size_t n = 0;
+	for ( ; ( n + 4 ) <= count; n += 4 ) {
+		const __m128i samples = _mm_loadu_si128( reinterpret_cast<const __m128i*>( input + n ) );
+		_mm_storeu_ps( output + n, _mm_mul_ps( _mm_cvtepi32_ps( samples ), scale ) );
+	}
+	ToFloatScalar( input + n, output + n, count - n, bitsPerSample );
+}
+
+void SampleConversion::ToFloatSSE2( const double* input, float* output, const size_t count )
+{
+	size_t n = 0;
+	for ( ; ( n + 4 ) <= count; n += 4 ) {
+		const __m128 low = _mm_cvtpd_ps( _mm_loadu_pd( input + n ) );
+		const __m128 high = _mm_cvtpd_ps( _mm_loadu_pd( input + n + 2 ) );
+		_mm_storeu_ps( output + n, _mm_movelh_ps( low, high ) );
+	}
+	ToFloatScalar( input + n, output + n, count - n );
+}
+
+void SampleConversion::InterleaveStereoSSE2( const float* const* input, float* output, const size_t frames )
+{
+	const float* left = input[ 0 ];
+	const float* right = input[ 1 ];
+	size_t frame = 0;
+	for ( ; ( frame + 4 ) <= frames; frame += 4 ) {
+		const __m128 l = _mm_loadu_ps( left + frame );
+		const __m128 r = _mm_loadu_ps( right + frame );
+		_mm_storeu_ps( output + frame * 2, _mm_unpacklo_ps( l, r ) );
+		_mm_storeu_ps( output + frame * 2 + 4, _mm_unpackhi_ps( l, r ) );
+	}
+	const float* remaining[ 2 ] = { left + frame, right + frame };
+	InterleaveScalar( remaining, output + frame * 2, frames - frame, 2 );
+}
+
+void SampleConversion::FromFloatSSE2( const float* input, uint8_t* output, const size_t count )
+{
+	const __m128 one = _mm_set1_ps( 1.0f );
+	const __m128 scale = _mm_set1_ps( 128.0f );
+	const __m128 minimum = _mm_setzero_ps();
+	const __m128 maximum = _mm_set1_ps( 255.0f );
+	size_t n = 0;
+	for ( ; ( n + 16 ) <= count; n += 16 ) {
+		__m128i values[ 4 ];
+		for ( size_t i = 0; i < 4; i++ ) {
+			const __m128 scaled = _mm_mul_ps( _mm_add_ps( _mm_loadu_ps( input + n + i * 4 ), one ), scale );
+			values[ i ] = _mm_cvttps_epi32( _mm_min_ps( _mm_max_ps( scaled, minimum ), maximum ) );
+		}
+		const __m128i packed = _mm_packus_epi16( _mm_packs_epi32( values[ 0 ], values[ 1 ] ), _mm_packs_epi32( values[ 2 ], values[ 3 ] ) );
+		_mm_storeu_si128( reinterpret_cast<__m128i*>( output + n ), packed );
+	}
+	FromFloatScalar( input + n, output + n, count - n );
+}
+
+void SampleConversion::FromFloatSSE2( const float* input, int16_t* output, const size_t count )
+{
+	const __m128 scale = _mm_set1_ps( 32768.0f );
+	const __m128 minimum = _mm_set1_ps( -32768.0f );
+	const __m128 maximum = _mm_set1_ps( 32767.0f );
+	size_t n = 0;
+	for ( ; ( n + 8 ) <= count; n += 8 ) {
+		const __m128i low = _mm_cvttps_epi32( _mm_min_ps( _mm_max_ps( _mm_mul_ps( _mm_loadu_ps( input + n ), scale ), minimum ), maximum ) );
+		const __m128i high = _mm_cvttps_epi32( _mm_min_ps( _mm_max_ps( _mm_mul_ps( _mm_loadu_ps( input + n + 4 ), scale ), minimum ), maximum ) );
+		_mm_storeu_si128( reinterpret_cast<__m128i*>( output + n ), _mm_packs_epi32( low, high ) );
+	}
+	FromFloatScalar( input + n, output + n, count - n );
+}
+
+void SampleConversion::FromFloatSSE2( const float* input, int32_t* output, const size_t count, const long bitsPerSample )
+{
+	const auto [ scaleValue, minimumValue, maximumValue ] = GetRange( bitsPerSample );
+	const __m128 scale = _mm_set1_ps( scaleValue );
+	const __m128 minimum = _mm_set1_ps( minimumValue );
+	const __m128 maximum = _mm_set1_ps( maximumValue );
+	size_t n = 0;
+	for ( ; ( n + 4 ) <= count; n += 4 ) {
+		const __m128 scaled = _mm_mul_ps( _mm_loadu_ps( input + n ), scale );
+		_mm_storeu_si128( reinterpret_cast<__m128i*>( output + n ), _mm_cvttps_epi32( _mm_min_ps( _mm_max_ps( scaled, minimum ), maximum ) ) );
+	}
+	FromFloatScalar( input + n, output + n, count - n, bitsPerSample );
+}
+
+void SampleConversion::ToFloatAVX2( const uint8_t* input, float* output, const size_t count )
+{
+	const __m256i bias = _mm256_set1_epi32( 0x80 );
+	const __m256 scale = _mm256_set1_ps( s_Scale8 );
+	size_t n = 0;
+	for ( ; ( n + 8 ) <= count; n += 8 ) {
+		const __m256i samples = _mm256_cvtepu8_epi32( _mm_loadl_epi64( reinterpret_cast<const __m128i*>( input + n ) ) );
+		_mm256_storeu_ps( output + n, _mm256_mul_ps( _mm256_cvtepi32_ps( _mm256_sub_epi32( samples, bias ) ), scale ) );
+	}
+	ToFloatScalar( input + n, output + n, count - n );
+}
+
+void SampleConversion::ToFloatAVX2( const int16_t* input, float* output, const size_t count )
+{
+	const __m256 scale = _mm256_set1_ps( s_Scale16 );
+	size_t n = 0;
+	for ( ; ( n + 8 ) <= count; n += 8 ) {
+		const __m256i samples = _mm256_cvtepi16_epi32( _mm_loadu_si128( reinterpret_cast<const __m128i*>( input + n ) ) );
+		_mm256_storeu_ps( output + n, _mm256_mul_ps( _mm256_cvtepi32_ps( samples ), scale ) );
+	}
+	ToFloatScalar( input + n, output + n, count - n );
+}
+
+void SampleConversion::ToFloatAVX2( const int32_t* input, float* output, const size_t count, const long bitsPerSample )
+{
+	const __m256 scale = _mm256_set1_ps( ( 32 == bitsPerSample ) ? s_Scale32 : GetScale( bitsPerSample ) );
+	size_t n = 0;
+	for ( ; ( n + 8 ) <= count; n += 8 ) {
+		const __m256i samples = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( input + n ) );
+		_mm256_storeu_ps( output + n, _mm256_mul_ps( _mm256_cvtepi32_ps( samples ), scale ) );
+	}
+	ToFloatScalar( input + n, output + n, count - n, bitsPerSample );
+}
+
+void SampleConversion::Packed24ToFloatAVX2( const uint8_t* input, float* output, const size_t count )
+{
+	// Shuffles four packed 24-bit samples into the upper three bytes of four 32-bit values (so that they are sign extended, and scaled as 32-bit).
+	const __m128i shuffle = _mm_setr_epi8( -1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11 );
+	const __m256 scale = _mm256_set1_ps( s_Scale32 );
+	size_t n = 0;
+	// Each iteration loads 28 bytes (30 bytes are available, as 10 samples remain), which covers the 24 bytes of the 8 samples being converted.
+	for ( ; ( n + 10 ) <= count; n += 8 ) {
+		const __m128i low = _mm_shuffle_epi8( _mm_loadu_si128( reinterpret_cast<const __m128i*>( input + n * 3 ) ), shuffle );
+		const __m128i high = _mm_shuffle_epi8( _mm_loadu_si128( reinterpret_cast<const __m128i*>( input + n * 3 + 12 ) ), shuffle );
+		const __m256i samples = _mm256_inserti128_si256( _mm256_castsi128_si256( low ), high, 1 );
+		_mm256_storeu_ps( output + n, _mm256_mul_ps( _mm256_cvtepi32_ps( samples ), scale ) );
+	}
+	Packed24ToFloatScalar( input + n * 3, output + n, count - n );
+}
+
+void SampleConversion::ToFloatAVX2( const double* input, float* output, const size_t count )
+{
+	size_t n = 0;
+	for ( ; ( n + 8 ) <= count; n += 8 ) {
+		const __m128 low = _mm256_cvtpd_ps( _mm256_loadu_pd( input + n ) );
+		const __m128 high = _mm256_cvtpd_ps( _mm256_loadu_pd( input + n + 4 ) );
+		_mm256_storeu_ps( output + n, _mm256_insertf128_ps( _mm256_castps128_ps256( low ), high, 1 ) );
+	}
+	ToFloatScalar( input + n, output + n, count - n );
+}
+
+void SampleConversion::InterleaveStereoAVX2( const float* const* input, float* output, const size_t frames )
+{
+	const float* left = input[ 0 ];
+	const float* right = input[ 1 ];
+	size_t frame = 0;
+	for ( ; ( frame + 8 ) <= frames; frame += 8 ) {
+		const __m256 l = _mm256_loadu_ps( left + frame );
+		const __m256 r = _mm256_loadu_ps( right + frame );
+		// Unpacking works within each 128-bit lane, so the lanes need recombining afterwards.
+		const __m256 low = _mm256_unpacklo_ps( l, r );
+		const __m256 high = _mm256_unpackhi_ps( l, r );
+		_mm256_storeu_ps( output + frame * 2, _mm256_permute2f128_ps( low, high, 0x20 ) );
+		_mm256_storeu_ps( output + frame * 2 + 8, _mm256_permute2f128_ps( low, high, 0x31 ) );
+	}
+	const float* remaining[ 2 ] = { left + frame, right + frame };
+	InterleaveScalar( remaining, output + frame * 2, frames - frame, 2 );
+}
+
+void SampleConversion::FromFloatAVX2( const float* input, uint8_t* output, const size_t count )
+{
+	const __m256 one = _mm256_set1_ps( 1.0f );
+	const __m256 scale = _mm256_set1_ps( 128.0f );
+	const __m256 minimum = _mm256_setzero_ps();
+	const __m256 maximum = _mm256_set1_ps( 255.0f );
+	size_t n = 0;
+	for ( ; ( n + 16 ) <= count; n += 16 ) {
+		const __m256 low = _mm256_mul_ps( _mm256_add_ps( _mm256_loadu_ps( input + n ), one ), scale );
+		const __m256 high = _mm256_mul_ps( _mm256_add_ps( _mm256_loadu_ps( input + n + 8 ), one ), scale );
+		const __m256i lowValues = _mm256_cvttps_epi32( _mm256_min_ps( _mm256_max_ps( low, minimum ), maximum ) );
+		const __m256i highValues = _mm256_cvttps_epi32( _mm256_min_ps( _mm256_max_ps( high, minimum ), maximum ) );
+		// Packing works within each 128-bit lane, so the lanes are reordered afterwards.
+		const __m256i words = _mm256_permute4x64_epi64( _mm256_packs_epi32( lowValues, highValues ), _MM_SHUFFLE( 3, 1, 2, 0 ) );
+		const __m128i bytes = _mm_packus_epi16( _mm256_castsi256_si128( words ), _mm256_extracti128_si256( words, 1 ) );
+		_mm_storeu_si128( reinterpret_cast<__m128i*>( output + n ), bytes );
+	}
+	FromFloatScalar( input + n, output + n, count - n );
+}
+
+void SampleConversion::FromFloatAVX2( const float* input, int16_t* output, const size_t count )
+{
+	const __m256 scale = _mm256_set1_ps( 32768.0f );
+	const __m256 minimum = _mm256_set1_ps( -32768.0f );
+	const __m256 maximum = _mm256_set1_ps( 32767.0f );
+	size_t n = 0;
+	for ( ; ( n + 16 ) <= count; n += 16 ) {
+		const __m256i low = _mm256_cvttps_epi32( _mm256_min_ps( _mm256_max_ps( _mm256_mul_ps( _mm256_loadu_ps( input + n ), scale ), minimum ), maximum ) );
+		const __m256i high = _mm256_cvttps_epi32( _mm256_min_ps( _mm256_max_ps( _mm256_mul_ps( _mm256_loadu_ps( input + n + 8 ), scale ), minimum ), maximum ) );
+		// Packing works within each 128-bit lane, so the lanes are reordered afterwards.
+		const __m256i packed = _mm256_permute4x64_epi64( _mm256_packs_epi32( low, high ), _MM_SHUFFLE( 3, 1, 2, 0 ) );
+		_mm256_storeu_si256( reinterpret_cast<__m256i*>( output + n ), packed );
+	}
+	FromFloatScalar( input + n, output + n, count - n );
+}
+
+void SampleConversion::FromFloatAVX2( const float* input, int32_t* output, const size_t count, const long bitsPerSample )
+{
+	const auto [ scaleValue, minimumValue, maximumValue ] = GetRange( bitsPerSample );
+	const __m256 scale = _mm256_set1_ps( scaleValue );
+	const __m256 minimum = _mm256_set1_ps( minimumValue );
+	const __m256 maximum = _mm256_set1_ps( maximumValue );
+	size_t n = 0;
+	for ( ; ( n + 8 ) <= count; n += 8 ) {
+		const __m256 scaled = _mm256_mul_ps( _mm256_loadu_ps( input + n ), scale );
+		_mm256_storeu_si256( reinterpret_cast<__m256i*>( output + n ), _mm256_cvttps_epi32( _mm256_min_ps( _mm256_max_ps( scaled, minimum ), maximum ) ) );
+	}
+	FromFloatScalar( input + n, output + n, count - n, bitsPerSample );
+}
+
+#else
+
+void SampleConversion::ToFloatSSE2( const uint8_t* input, float* output, const size_t count )
+{
+	ToFloatScalar( input, output, count );
+}
+
+void SampleConversion::ToFloatSSE2( const int16_t* input, float* output, const size_t count )
+{
+	ToFloatScalar( input, output, count );
+}
+
+void SampleConversion::ToFloatSSE2( const int32_t* input, float* output, const size_t count, const long bitsPerSample )
+{
+	ToFloatScalar( input, output, count, bitsPerSample );
+}
+
+void SampleConversion::ToFloatSSE2( const double* input, float* output, const size_t count )
+{
+	ToFloatScalar( input, output, count );
+}
+
+void SampleConversion::InterleaveStereoSSE2( const float* const* input, float* output, const size_t frames )
+{
+	InterleaveScalar( input, output, frames, 2 );
+}
+
+void SampleConversion::FromFloatSSE2( const float* input, uint8_t* output, const size_t count )
+{
+	FromFloatScalar( input, output, count );
+}
+
+void SampleConversion::FromFloatSSE2( const float* input, int16_t* output, const size_t count )
+{
+	FromFloatScalar( input, output, count );
+}
+
+void SampleConversion::FromFloatSSE2( const float* input, int32_t* output, const size_t count, const long bitsPerSample )
+{
+	FromFloatScalar( input, output, count, bitsPerSample );
+}
+
+void SampleConversion::ToFloatAVX2( const uint8_t* input, float* output, const size_t count )
+{
+	ToFloatScalar( input, output, count );
+}
+
+void SampleConversion::ToFloatAVX2( const int16_t* input, float* output, const size_t count )
+{
+	ToFloatScalar( input, output, count );
+}
+
+void SampleConversion::ToFloatAVX2( const int32_t* input, float* output, const size_t count, const long bitsPerSample )
+{
+	ToFloatScalar( input, output, count, bitsPerSample );
+}
+
+void SampleConversion::ToFloatAVX2( const double* input, float* output, const size_t count )
+{
+	ToFloatScalar( input, output, count );
+}
+
+void SampleConversion::Packed24ToFloatAVX2( const uint8_t* input, float* output, const size_t count )
+{
+	Packed24ToFloatScalar( input, output, count );
+}
+
+void SampleConversion::InterleaveStereoAVX2( const float* const* input, float* output, const size_t frames )
+{
+	InterleaveScalar( input, output, frames, 2 );
+}
+
+void SampleConversion::FromFloatAVX2( const float* input, uint8_t* output, const size_t count )
+{
+	FromFloatScalar( input, output, count );
+}
+
+void SampleConversion::FromFloatAVX2( const float* input, int16_t* output, const size_t count )
+{
+	FromFloatScalar( input, output, count );
+}
+
+void SampleConversion::FromFloatAVX2( const float* input, int32_t* output, const size_t count, const long bitsPerSample )
+{
+	FromFloatScalar( input, output, count, bitsPerSample );
+}
+
+#endif
@@ -0,0 +1,185 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Converts a floating point sample 'value' to 24-bit (clamping any value outside the range -1.0 to +1.0).
+inline int32_t FloatTo24( const float value )
+{
+	const float scaledValue = value * 8388608;
+	const int32_t result = ( scaledValue > static_cast<float>( 8388607 ) ) ? 8388607 :
+		( ( scaledValue < static_cast<float>( -8388608 ) ) ? -8388608 : static_cast<int32_t>( scaledValue ) );
+	return result;
+}
+
+// Converts a floating point sample 'value' to 16-bit (clamping any value outside the range -1.0 to +1.0).
+inline int16_t FloatTo16( const float value )
+{
+	const float scaledValue = value * 32768;
+	const int16_t result = ( scaledValue > static_cast<float>( 32767 ) ) ? 32767 :
+		( ( scaledValue < static_cast<float>( -32768 ) ) ? -32768 : static_cast<int16_t>( scaledValue ) );
+	return result;
+}
+
+// Converts a floating point sample 'value' to signed 8-bit (clamping any value outside the range -1.0 to +1.0).
+inline int8_t FloatToSigned8( const float value )
+{
+	const float scaledValue = value * 128;
+	const int8_t result = ( scaledValue > static_cast<float>( 127 ) ) ? 127 :
+		( ( scaledValue < static_cast<float>( -128 ) ) ? -128 : static_cast<int8_t>( scaledValue ) );
+	return result;
+}
+
+// Converts a floating point sample 'value' to unsigned 8-bit (clamping any value outside the range -1.0 to +1.0).
+inline uint8_t FloatToUnsigned8( const float value )
+{
+	const float scaledValue = ( value + 1.0f ) * 128;
+	const uint8_t result = ( scaledValue > static_cast<float>( 255 ) ) ? 255 :
+		( ( scaledValue < static_cast<float>( 0 ) ) ? 0 : static_cast<uint8_t>( scaledValue ) );
+	return result;
+}
+
+// Converts a signed 64-bit 'value' to a floating point value in the range -1.0 to +1.0.
+inline float Signed64ToFloat( const int64_t value )
+{
+	return static_cast<float>( value ) / 0x8000000000000000ull;
+}
+
+// Converts a signed 32-bit 'value' to a floating point value in the range -1.0 to +1.0.
+inline float Signed32ToFloat( const int32_t value )
+{
+	return static_cast<float>( value ) / 0x80000000ul;
+}
+
+// Converts a signed 16-bit 'value' to a floating point value in the range -1.0 to +1.0.
+inline float Signed16ToFloat( const int16_t value )
+{
+	return static_cast<float>( value ) / 0x8000;
+}
+
+// Converts an unsigned 8-bit 'value' to a floating point value in the range -1.0 to +1.0.
+inline float Unsigned8ToFloat( const uint8_t value )
+{
+	return static_cast<float>( static_cast<int>( value ) - 0x80 ) / 0x80;
+}
+
+// Sample format conversion kernels for the decoders & encoders.
+// Each kernel has a scalar implementation, along with SSE2 & AVX2 implementations which are selected at runtime (using the DSPKernels instruction set).
+// Conversions produce exactly the same values as the scalar helper functions above.
+class SampleConversion
+{
+public:
+	// Converts interleaved (or mono) sample data to floating point format scaled to +/-1.0f.
+	// 'input' - input sample data.
+	// 'output' - output sample data.
+	// 'count' - number of samples.
+	static void ToFloat( const uint8_t* input, float* output, const size_t count );
+	static void ToFloat( const int16_t* input, float* output, const size_t count );
+	static void ToFloat( const int64_t* input, float* output, const size_t count );
+	static void ToFloat( const float* input, float* output, const size_t count );
+	static void ToFloat( const double* input, float* output, const size_t count );
+
+	// Converts interleaved (or mono) right-justified integer sample data to floating point format scaled to +/-1.0f.
+	// 'input' - input sample data.
+	// 'output' - output sample data (which can be the same buffer as the input sample data).
+	// 'count' - number of samples.
+	// 'bitsPerSample' - number of significant bits in each input sample.
+	static void ToFloat( const int32_t* input, float* output, const size_t count, const long bitsPerSample = 32 );
+
+	// Converts interleaved (or mono) packed 24-bit little endian sample data to floating point format scaled to +/-1.0f.
+	// 'input' - input sample data.
+	// 'output' - output sample data.
+	// 'count' - number of samples.
+	static void Packed24ToFloat( const uint8_t* input, float* output, const size_t count );
+
+	// Converts planar sample data to interleaved floating point format scaled to +/-1.0f.
+	// 'input' - input sample data, one plane per channel.
+	// 'offset' - offset into each plane of the first sample frame to convert.
+	// 'output' - output sample data.
+	// 'frames' - number of sample frames.
+	// 'channels' - number of channels.
+	static void InterleaveToFloat( const uint8_t* const* input, const size_t offset, float* output, const size_t frames, const long channels );
+	static void InterleaveToFloat( const int16_t* const* input, const size_t offset, float* output, const size_t frames, const long channels );
+	static void InterleaveToFloat( const int64_t* const* input, const size_t offset, float* output, const size_t frames, const long channels );
+	static void InterleaveToFloat( const float* const* input, const size_t offset, float* output, const size_t frames, const long channels );
+	static void InterleaveToFloat( const double* const* input, const size_t offset, float* output, const size_t frames, const long channels );
+
+	// Converts planar right-justified integer sample data to interleaved floating point format scaled to +/-1.0f.
+	// 'input' - input sample data, one plane per channel.
+	// 'offset' - offset into each plane of the first sample frame to convert.
+	// 'output' - output sample data.
+	// 'frames' - number of sample frames.
+	// 'channels' - number of channels.
+	// 'bitsPerSample' - number of significant bits in each input sample.
+	static void InterleaveToFloat( const int32_t* const* input, const size_t offset, float* output, const size_t frames, const long channels, const long bitsPerSample = 32 );
+
+	// Interleaves planar floating point sample data.
+	// 'input' - input sample data, one plane per channel.
+	// 'output' - output sample data.
+	// 'frames' - number of sample frames.
+	// 'channels' - number of channels.
+	static void Interleave( const float* const* input, float* output, const size_t frames, const long channels );
+
+
+	// Converts floating point sample data to unsigned 8-bit (clamping any value outside the range -1.0 to +1.0).
+	// 'input' - input sample data.
+	// 'output' - output sample data.
+	// 'count' - number of samples.
+	static void FromFloat( const float* input, uint8_t* output, const size_t count );
+
+	// Converts floating point sample data to signed 16-bit (clamping any value outside the range -1.0 to +1.0).
+	// 'input' - input sample data.
+	// 'output' - output sample data.
+	// 'count' - number of samples.
+	static void FromFloat( const float* input, int16_t* output, const size_t count );
+
+	// Converts floating point sample data to right-justified signed integers (clamping any value outside the range -1.0 to +1.0).
+	// 'input' - input sample data.
+	// 'output' - output sample data.
+	// 'count' - number of samples.
+	// 'bitsPerSample' - number of significant bits in each output sample, from 8 to 24.
+	static void FromFloat( const float* input, int32_t* output, const size_t count, const long bitsPerSample );
+
+	// Converts floating point sample data to packed 24-bit little endian (clamping any value outside the range -1.0 to +1.0).
+	// 'input' - input sample data.
+	// 'output' - output sample data (three bytes per sample).
+	// 'count' - number of samples.
+	static void FloatToPacked24( const float* input, uint8_t* output, const size_t count );
+
+private:
+	// Converts planar sample data to interleaved floating point format, one block at a time using the 'convert' function for each plane.
+	template <typename T, typename Convert>
+	static void InterleaveBlocks( const T* const* input, const size_t offset, float* output, const size_t frames, const long channels, Convert convert );
+
+	// Scalar implementations.
+	static void ToFloatScalar( const uint8_t* input, float* output, const size_t count );
+	static void ToFloatScalar( const int16_t* input, float* output, const size_t count );
+	static void ToFloatScalar( const int32_t* input, float* output, const size_t count, const long bitsPerSample );
+	static void ToFloatScalar( const double* input, float* output, const size_t count );
+	static void Packed24ToFloatScalar( const uint8_t* input, float* output, const size_t count );
+	static void InterleaveScalar( const float* const* input, float* output, const size_t frames, const long channels );
+	static void FromFloatScalar( const float* input, uint8_t* output, const size_t count );
+	static void FromFloatScalar( const float* input, int16_t* output, const size_t count );
+	static void FromFloatScalar( const float* input, int32_t* output, const size_t count, const long bitsPerSample );
+
+	// SSE2 implementations.
+	static void ToFloatSSE2( const uint8_t* input, float* output, const size_t count );
+	static void ToFloatSSE2( const int16_t* input, float* output, const size_t count );
+	static void ToFloatSSE2( const int32_t* input, float* output, const size_t count, const long bitsPerSample );
+	static void ToFloatSSE2( const double* input, float* output, const size_t count );
+	static void InterleaveStereoSSE2( const float* const* input, float* output, const size_t frames );
+	static void FromFloatSSE2( const float* input, uint8_t* output, const size_t count );
+	static void FromFloatSSE2( const float* input, int16_t* output, const size_t count );
+	static void FromFloatSSE2( const float* input, int32_t* output, const size_t count, const long bitsPerSample );
+
+	// AVX2 implementations.
+	static void ToFloatAVX2( const uint8_t* input, float* output, const size_t count );
+	static void ToFloatAVX2( const int16_t* input, float* output, const size_t count );
+	static void ToFloatAVX2( const int32_t* input, float* output, const size_t count, const long bitsPerSample );
+	static void ToFloatAVX2( const double* input, float* output, const size_t count );
+	static void Packed24ToFloatAVX2( const uint8_t* input, float* output, const size_t count );
+	static void InterleaveStereoAVX2( const float* const* input, float* output, const size_t frames );
+	static void FromFloatAVX2( const float* input, uint8_t* output, const size_t count );
+	static void FromFloatAVX2( const float* input, int16_t* output, const size_t count );
+	static void FromFloatAVX2( const float* input, int32_t* output, const size_t count, const long bitsPerSample );
+};
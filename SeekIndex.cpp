@@ -0,0 +1,103 @@
+#include "SeekIndex.h"
+
+#include <algorithm>
+
+// Appends a little endian 'value' to 'data'.
+template <typename T>
+static void AppendValue( std::vector<uint8_t>& data, const T value )
+{
+	for ( size_t byte = 0; byte < sizeof( T ); byte++ ) {
+		data.push_back( static_cast<uint8_t>( value >> ( 8 * byte ) ) );
+	}
+}
+
+// Reads a little endian 'value' from 'data' at 'position', advancing the position.
+// Returns whether the value was read.
+template <typename T>
+static bool ReadValue( const std::vector<uint8_t>& data, size_t& position, T& value )
+{
+	bool success = false;
+	if ( ( position + sizeof( T ) ) <= data.size() ) {
+		value = 0;
+		for ( size_t byte = 0; byte < sizeof( T ); byte++ ) {
+			value |= static_cast<T>( data[ position + byte ] ) << ( 8 * byte );
+		}
+		position += sizeof( T );
+		success = true;
+	}
+	return success;
+}
+
+SeekIndex::SeekIndex( const uint64_t interval ) :
+	m_Interval( std::max<uint64_t>( 1, interval ) ),
+	m_Points()
+{
+}
+
+SeekIndex::~SeekIndex()
+{
+}
+
+SeekIndex::Ptr SeekIndex::FromData( const std::vector<uint8_t>& data )
+{
+	Ptr index;
+	size_t position = 0;
+	uint32_t version = 0;
+	uint64_t interval = 0;
+	uint64_t count = 0;
+	if ( ReadValue( data, position, version ) && ( s_Version == version ) && ReadValue( data, position, interval ) && ReadValue( data, position, count ) &&
+			( count <= ( ( data.size() - position ) / ( 2 * sizeof( uint64_t ) ) ) ) && ( ( data.size() - position ) == count * 2 * sizeof( uint64_t ) ) ) {
+		index = std::make_shared<SeekIndex>( interval );
+		index->m_Points.reserve( static_cast<size_t>( count ) );
+		Point point;
+		while ( ReadValue( data, position, point.Sample ) && ReadValue( data, position, point.Offset ) ) {
+			if ( !index->m_Points.empty() && ( point.Sample <= index->m_Points.back().Sample ) ) {
+				index.reset();
+				break;
+			}
+			index->m_Points.push_back( point );
+		}
+	}
+	return index;
+}
+
+std::vector<uint8_t> SeekIndex::GetData() const
+{
+	std::vector<uint8_t> data;
+	data.reserve( sizeof( uint32_t ) + 2 * sizeof( uint64_t ) + m_Points.size() * 2 * sizeof( uint64_t ) );
+	AppendValue( data, s_Version );
+	AppendValue( data, m_Interval );
+	AppendValue( data, static_cast<uint64_t>( m_Points.size() ) );
+	for ( const auto& point : m_Points ) {
+		AppendValue( data, point.Sample );
+		AppendValue( data, point.Offset );
+	}
+	return data;
+}
+
+void SeekIndex::Add( const uint64_t sample, const uint64_t offset )
+{
+	if ( m_Points.empty() || ( sample >= ( m_Points.back().Sample + m_Interval ) ) ) {
+		m_Points.push_back( { sample, offset } );
+	}
+}
+
+std::optional<SeekIndex::Point> SeekIndex::Find( const uint64_t sample ) const
+{
+	std::optional<Point> result;
+	auto point = std::upper_bound( m_Points.begin(), m_Points.end(), sample, [] ( const uint64_t value, const Point& entry ) { return value < entry.Sample; } );
+	if ( m_Points.begin() != point ) {
+		result = *( --point );
+	}
+	return result;
+}
+
+bool SeekIndex::IsEmpty() const
+{
+	return m_Points.empty();
+}
+
+uint64_t SeekIndex::GetInterval() const
+{
+	return m_Interval;
+}
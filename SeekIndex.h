@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+// Maps sample positions to byte offsets within a file, at regular intervals.
+// A decoder can then seek directly to the index point before any sample, and decode forward to the exact sample, rather than searching the file.
+class SeekIndex
+{
+public:
+	// Seek index shared pointer type.
+	using Ptr = std::shared_ptr<SeekIndex>;
+
+	// An index point.
+	struct Point {
+		// Sample position (in sample frames from the start of the stream).
+		uint64_t Sample = 0;
+
+		// Byte offset, from the start of the file, of the frame which starts at the sample position.
+		uint64_t Offset = 0;
+	};
+
+	// 'interval' - minimum number of samples between index points.
+	explicit SeekIndex( const uint64_t interval );
+
+	virtual ~SeekIndex();
+
+	// Creates a seek index from serialised 'data', returning nullptr if the data is not valid.
+	static Ptr FromData( const std::vector<uint8_t>& data );
+
+	// Returns the seek index as serialised data.
+	std::vector<uint8_t> GetData() const;
+
+	// Adds an index point, if it is at least the index interval beyond the previous point.
+	// Points must be added in increasing sample order.
+	// 'sample' - sample position.
+	// 'offset' - byte offset of the frame which starts at the sample position.
+	void Add( const uint64_t sample, const uint64_t offset );
+
+	// Returns the last index point at or before 'sample', or nullopt if there is no such point.
+	std::optional<Point> Find( const uint64_t sample ) const;
+
+	// Returns whether the index contains any points.
+	bool IsEmpty() const;
+
+	// Returns the minimum number of samples between index points.
+	uint64_t GetInterval() const;
+
+private:
+	// Serialised data format version.
+	static constexpr uint32_t s_Version = 1;
+
+	// Minimum number of samples between index points.
+	const uint64_t m_Interval;
+
+	// Index points, in increasing sample order.
+	std::vector<Point> m_Points;
+};
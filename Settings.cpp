@@ -29,9 +29,9 @@ std::optional<T> Settings::ReadSetting( const std::string& name )
 {
 	std::optional<T> value;
 	if ( sqlite3* database = m_Database.GetDatabase(); nullptr != database ) {
-		sqlite3_stmt* stmt = nullptr;
 		const std::string query = "SELECT Value FROM Settings WHERE Setting=?1;";
-		if ( SQLITE_OK == sqlite3_prepare_v2( database, query.c_str(), -1 /*nByte*/, &stmt, nullptr /*tail*/ ) ) {
+		Database::Statement stmt( m_Database, query );
+		if ( nullptr != stmt ) {
 			if ( SQLITE_OK == sqlite3_bind_text( stmt, 1, name.c_str(), -1 /*strLen*/, SQLITE_STATIC ) ) {
 				if ( SQLITE_ROW == sqlite3_step( stmt ) ) {
 					constexpr int kColumnIndex = 0;
@@ -58,7 +58,6 @@ std::optional<T> Settings::ReadSetting( const std::string& name )
 					}
 				}
 			}
-			sqlite3_finalize( stmt );
 		}
 	}
 	return value;
@@ -69,8 +68,8 @@ void Settings::WriteSetting( const std::string& name, const T& value )
 {
 	if ( sqlite3* database = m_Database.GetDatabase(); nullptr != database ) {
 		const std::string query = "REPLACE INTO Settings (Setting,Value) VALUES (?1,?2);";
-		sqlite3_stmt* stmt = nullptr;
-		if ( SQLITE_OK == sqlite3_prepare_v2( database, query.c_str(), -1 /*nByte*/, &stmt, nullptr /*tail*/ ) ) {
+		Database::Statement stmt( m_Database, query );
+		if ( nullptr != stmt ) {
 			sqlite3_bind_text( stmt, 1, name.c_str(), -1 /*strLen*/, SQLITE_STATIC );
 			if constexpr ( std::is_floating_point_v<T> ) {
 				sqlite3_bind_double( stmt, 2, value );
@@ -88,7 +87,6 @@ void Settings::WriteSetting( const std::string& name, const T& value )
 				static_assert( !sizeof( T ), "Settings::WriteSetting - unsupported type" );
 			}
 			sqlite3_step( stmt );
-			sqlite3_finalize( stmt );
 		}
 	}
 }
@@ -722,7 +720,8 @@ void Settings::SavePlaylist( Playlist& playlist )
 			clearTableQuery += playlistID + "\";";
 			sqlite3_exec( database, clearTableQuery.c_str(), NULL /*callback*/, NULL /*arg*/, NULL /*errMsg*/ );
 
-			sqlite3_exec( database, "BEGIN TRANSACTION;", NULL /*callback*/, NULL /*arg*/, NULL /*errMsg*/ );
+			// Use a savepoint, rather than a transaction, as the library might already have a batch transaction open on the same connection.
+			sqlite3_exec( database, "SAVEPOINT SavePlaylist;", NULL /*callback*/, NULL /*arg*/, NULL /*errMsg*/ );
 			std::string insertFileQuery = "INSERT INTO \"";
 			insertFileQuery += playlistID;
 			insertFileQuery += "\" (File, Pending) VALUES (?1,?2);";
@@ -752,7 +751,7 @@ void Settings::SavePlaylist( Playlist& playlist )
 				}
 				sqlite3_finalize( stmt );
 			}
-			sqlite3_exec( database, "END TRANSACTION;", NULL /*callback*/, NULL /*arg*/, NULL /*errMsg*/ );
+			sqlite3_exec( database, "RELEASE SavePlaylist;", NULL /*callback*/, NULL /*arg*/, NULL /*errMsg*/ );
 
 			if ( Playlist::Type::Favourites != playlist.GetType() ) {
 				const std::string insertPlaylistQuery = "REPLACE INTO Playlists (ID,Name) VALUES (?1,?2);";
@@ -1592,6 +1591,21 @@ void Settings::SetStopAtTrackEnd( const bool enabled )
 	WriteSetting( "StopAtTrackEnd", enabled );
 }
 
+float Settings::GetSilenceThreshold()
+{
+	// The default level is just below the quietest non-zero 16-bit sample value.
+	constexpr float kDefaultThreshold = -91.0f;
+	constexpr float kMinThreshold = -150.0f;
+	constexpr float kMaxThreshold = -40.0f;
+
+	return std::clamp( ReadSetting<float>( "SilenceThreshold" ).value_or( kDefaultThreshold ), kMinThreshold, kMaxThreshold );
+}
+
+void Settings::SetSilenceThreshold( const float threshold )
+{
+	WriteSetting( "SilenceThreshold", threshold );
+}
+
 bool Settings::GetRetainPitchBalance()
 {
 	return ReadSetting<bool>( "RetainPitchBalance" ).value_or( false );
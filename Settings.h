@@ -562,6 +562,12 @@ public:
 	// Sets whether the 'stop at track end' setting is enabled.
 	void SetStopAtTrackEnd( const bool enabled );
 
+	// Returns the level, in dBFS, at or below which sample data is considered silent (when skipping leading silence, and for track analysis).
+	float GetSilenceThreshold();
+
+	// Sets the level, in dBFS, at or below which sample data is considered silent.
+	void SetSilenceThreshold( const float threshold );
+
 	// Returns whether the pitch and balance levels should be retained on startup.
 	bool GetRetainPitchBalance();
 
@@ -0,0 +1,170 @@
+#include "TrackAnalyser.h"
+
+#include "DSPKernels.h"
+
+#include "ebur128.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Number of sample frames to decode at a time.
+constexpr long s_BlockSize = 4096;
+
+// The relative volume at which to set the crossfade position on a track.
+constexpr double s_CrossfadeVolume = 0.3;
+
+// The crossfade window length, in seconds.
+constexpr double s_CrossfadeWindow = 0.1;
+
+std::optional<TrackAnalyser::Result> TrackAnalyser::Analyse( Decoder& decoder, const float silenceThreshold, Decoder::CanContinue canContinue )
+{
+	std::optional<Result> result;
+	const long channels = decoder.GetChannels();
+	const long samplerate = decoder.GetSampleRate();
+	if ( ( channels > 0 ) && ( samplerate > 0 ) ) {
+		ebur128_state* r128State = ebur128_init( static_cast<unsigned int>( channels ), static_cast<unsigned int>( samplerate ), EBUR128_MODE_I );
+		int errorState = ( nullptr != r128State ) ? EBUR128_SUCCESS : EBUR128_ERROR_NOMEM;
+
+		float samplePeak = 0;
+		int64_t frameCount = 0;
+		std::optional<int64_t> leadingSilenceFrame;
+		int64_t trailingSilenceFrame = 0;
+
+		// The crossfade calculation only starts from the first non-silent sample.
+		const long windowSize = std::max( 1l, static_cast<long>( samplerate * s_CrossfadeWindow ) );
+		long windowFrames = 0;
+		double windowTotal = 0;
+		double cumulativeTotal = 0;
+		int64_t cumulativeCount = 0;
+		int64_t crossfadeFrame = 0;
+
+		std::vector<float> buffer( s_BlockSize * channels );
+		bool cancelled = false;
+		long framesRead = decoder.Read( buffer.data(), s_BlockSize );
+		while ( framesRead > 0 ) {
+			if ( !canContinue() ) {
+				cancelled = true;
+				break;
+			}
+
+			if ( EBUR128_SUCCESS == errorState ) {
+				errorState = ebur128_add_frames_float( r128State, buffer.data(), static_cast<size_t>( framesRead ) );
+			}
+
+			// Scan the whole block for the first & last non-silent samples, rather than checking each sample frame.
+			const size_t blockSamples = static_cast<size_t>( framesRead ) * channels;
+			if ( const size_t lastAudible = DSPKernels::FindLastAbove( buffer.data(), blockSamples, silenceThreshold ); lastAudible > 0 ) {
+				if ( !leadingSilenceFrame.has_value() ) {
+					leadingSilenceFrame = frameCount + static_cast<int64_t>( DSPKernels::FindFirstAbove( buffer.data(), blockSamples, silenceThreshold ) / channels );
+				}
+				trailingSilenceFrame = frameCount + static_cast<int64_t>( ( lastAudible - 1 ) / channels ) + 1;
+			}
+
+			const float* sample = buffer.data();
+			for ( long frame = 0; frame < framesRead; frame++, frameCount++ ) {
+				double frameTotal = 0;
+				for ( long channel = 0; channel < channels; channel++, sample++ ) {
+					const float value = *sample;
+					samplePeak = std::max( samplePeak, std::fabs( value ) );
+					frameTotal += static_cast<double>( value ) * value;
+				}
+
+				if ( leadingSilenceFrame.has_value() && ( frameCount >= *leadingSilenceFrame ) ) {
+					windowTotal += frameTotal;
+					cumulativeTotal += frameTotal;
+					cumulativeCount += channels;
+					if ( ++windowFrames == windowSize ) {
+						if ( IsCrossfadeWindow( windowTotal, static_cast<int64_t>( windowFrames ) * channels, cumulativeTotal, cumulativeCount ) ) {
+							crossfadeFrame = frameCount + 1;
+						}
+						windowFrames = 0;
+						windowTotal = 0;
+					}
+				}
+			}
+
+			framesRead = decoder.Read( buffer.data(), s_BlockSize );
+		}
+
+		if ( !cancelled ) {
+			if ( ( windowFrames > 0 ) && IsCrossfadeWindow( windowTotal, static_cast<int64_t>( windowFrames ) * channels, cumulativeTotal, cumulativeCount ) ) {
+				crossfadeFrame = frameCount;
+			}
+
+			Result analysis;
+			if ( EBUR128_SUCCESS == errorState ) {
+				double loudness = 0;
+				if ( ( EBUR128_SUCCESS == ebur128_loudness_global( r128State, &loudness ) ) && std::isfinite( loudness ) ) {
+					analysis.Loudness = static_cast<float>( loudness );
+				}
+			}
+			analysis.SamplePeak = samplePeak;
+			analysis.LeadingSilence = static_cast<float>( leadingSilenceFrame.value_or( frameCount ) ) / samplerate;
+			analysis.TrailingSilence = static_cast<float>( leadingSilenceFrame.has_value() ? trailingSilenceFrame : frameCount ) / samplerate;
+			analysis.CrossfadePosition = static_cast<float>( crossfadeFrame ) / samplerate;
+			analysis.Index = decoder.GetSeekIndex();
+			result = analysis;
+		}
+
+		if ( nullptr != r128State ) {
+			ebur128_destroy( &r128State );
+		}
+	}
+	return result;
+}
+
+std::optional<TrackAnalyser::Result> TrackAnalyser::Analyse( const std::wstring& filename, const Handlers& handlers, const float silenceThreshold, Decoder::CanContinue canContinue )
+{
+	std::optional<Result> result;
+	if ( Decoder::Ptr decoder = handlers.OpenDecoder( filename ); decoder ) {
+		result = Analyse( *decoder, silenceThreshold, canContinue );
+	}
+	return result;
+}
+
+bool TrackAnalyser::HasAnalysis( const MediaInfo& mediaInfo )
+{
+	const bool hasAnalysis = mediaInfo.GetSamplePeak().has_value() && mediaInfo.GetLeadingSilence().has_value() &&
+		mediaInfo.GetTrailingSilence().has_value() && mediaInfo.GetCrossfadePosition().has_value();
+	return hasAnalysis;
+}
+
+std::optional<std::pair<float /*crossfadePosition*/, float /*leadingSilence*/>> TrackAnalyser::GetCrossfadeInfo( const MediaInfo& mediaInfo )
+{
+	std::optional<std::pair<float, float>> crossfadeInfo;
+	if ( const auto crossfadePosition = mediaInfo.GetCrossfadePosition(), leadingSilence = mediaInfo.GetLeadingSilence(); crossfadePosition.has_value() && leadingSilence.has_value() ) {
+		crossfadeInfo = std::make_pair( *crossfadePosition, *leadingSilence );
+	}
+	return crossfadeInfo;
+}
+
+void TrackAnalyser::CopyAnalysis( const MediaInfo& source, MediaInfo& mediaInfo )
+{
+	mediaInfo.SetSamplePeak( source.GetSamplePeak() );
+	mediaInfo.SetLeadingSilence( source.GetLeadingSilence() );
+	mediaInfo.SetTrailingSilence( source.GetTrailingSilence() );
+	mediaInfo.SetCrossfadePosition( source.GetCrossfadePosition() );
+}
+
+void TrackAnalyser::UpdateMediaInfo( const Result& result, MediaInfo& mediaInfo )
+{
+	if ( !mediaInfo.GetGainTrack().has_value() && result.Loudness.has_value() ) {
+		mediaInfo.SetGainTrack( LOUDNESS_REFERENCE - result.Loudness.value() );
+	}
+	mediaInfo.SetSamplePeak( result.SamplePeak );
+	mediaInfo.SetLeadingSilence( result.LeadingSilence );
+	mediaInfo.SetTrailingSilence( result.TrailingSilence );
+	mediaInfo.SetCrossfadePosition( result.CrossfadePosition );
+}
+
+bool TrackAnalyser::IsCrossfadeWindow( const double windowTotal, const int64_t windowCount, const double cumulativeTotal, const int64_t cumulativeCount )
+{
+	bool isCrossfadeWindow = false;
+	if ( ( windowCount > 0 ) && ( cumulativeCount > 0 ) ) {
+		const double windowRMS = std::sqrt( windowTotal / windowCount );
+		const double cumulativeRMS = std::sqrt( cumulativeTotal / cumulativeCount );
+		isCrossfadeWindow = ( windowRMS > cumulativeRMS ) || ( ( cumulativeRMS > 0 ) && ( ( windowRMS / cumulativeRMS ) > s_CrossfadeVolume ) );
+	}
+	return isCrossfadeWindow;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "Decoder.h"
+#include "Handlers.h"
+#include "MediaInfo.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+
+// Decodes a track once, to determine its loudness, sample peak, silence offsets and crossfade position.
+// The analyser only requires a decoder, so it can be used without any audio output (e.g. to batch analyse a media library).
+class TrackAnalyser
+{
+public:
+	// Analysis version, stored alongside the results so that results from an earlier version of the analyser are ignored (version 2 compares against the silence threshold, rather than exact zero).
+	static constexpr int s_Version = 2;
+
+	// Track analysis results.
+	struct Result
+	{
+		// Integrated loudness, in LUFS (or nullopt if the loudness could not be determined).
+		std::optional<float> Loudness;
+
+		// Sample peak, as a linear value (where 1.0 is full scale).
+		float SamplePeak = 0;
+
+		// Position of the first non-silent sample, in seconds from the start of the track.
+		float LeadingSilence = 0;
+
+		// Position at which any trailing silence starts, in seconds from the start of the track.
+		float TrailingSilence = 0;
+
+		// Crossfade position, in seconds from the start of the track (or zero if there is no crossfade position).
+		float CrossfadePosition = 0;
+
+		// Seek index built by the decoder during the analysis (or nullptr if the decoder does not build one).
+		SeekIndex::Ptr Index;
+	};
+
+	// Analyses a track.
+	// 'decoder' - decoder, positioned at the start of the track.
+	// 'silenceThreshold' - linear sample value at or below which a sample is considered silent.
+	// 'canContinue' - callback which returns whether the analysis can continue.
+	// Returns the analysis results, or nullopt if the analysis failed or was cancelled.
+	static std::optional<Result> Analyse( Decoder& decoder, const float silenceThreshold, Decoder::CanContinue canContinue );
+
+	// Analyses a track.
+	// 'filename' - media filename.
+	// 'handlers' - media handlers.
+	// 'silenceThreshold' - linear sample value at or below which a sample is considered silent.
+	// 'canContinue' - callback which returns whether the analysis can continue.
+	// Returns the analysis results, or nullopt if the file could not be opened, or the analysis failed or was cancelled.
+	static std::optional<Result> Analyse( const std::wstring& filename, const Handlers& handlers, const float silenceThreshold, Decoder::CanContinue canContinue );
+
+	// Returns whether 'mediaInfo' contains the results of a track analysis.
+	static bool HasAnalysis( const MediaInfo& mediaInfo );
+
+	// Returns the stored crossfade position & leading silence for 'mediaInfo', in seconds from the start of the track, or nullopt if the track has not been analysed.
+	static std::optional<std::pair<float /*crossfadePosition*/, float /*leadingSilence*/>> GetCrossfadeInfo( const MediaInfo& mediaInfo );
+
+	// Copies the track analysis results (but not the gain) from 'source' to 'mediaInfo'.
+	static void CopyAnalysis( const MediaInfo& source, MediaInfo& mediaInfo );
+
+	// Updates 'mediaInfo' with an analysis 'result'.
+	// The track gain is only updated if 'mediaInfo' does not already have a track gain (e.g. from a file tag).
+	static void UpdateMediaInfo( const Result& result, MediaInfo& mediaInfo );
+
+private:
+	// Returns whether the crossfade position should be set at the end of a window.
+	// 'windowTotal' - sum of the squared sample values in the window.
+	// 'windowCount' - number of samples in the window.
+	// 'cumulativeTotal' - sum of the squared sample values up to, and including, the window.
+	// 'cumulativeCount' - number of samples up to, and including, the window.
+	static bool IsCrossfadeWindow( const double windowTotal, const int64_t windowCount, const double cumulativeTotal, const int64_t cumulativeCount );
+};
@@ -171,66 +171,6 @@ FILETIME GetLastModifiedTime( const std::filesystem::path& filepath );
 // Sets the last modified time for a file.
 void SetLastModifiedTime( const std::filesystem::path& filepath, const FILETIME lastModified );
 
-// Converts a floating point sample 'value' to 24-bit (clamping any value outside the range -1.0 to +1.0).
-inline int32_t FloatTo24( const float value )
-{
-	const float scaledValue = value * 8388608;
-	const int32_t result = ( scaledValue > static_cast<float>( 8388607 ) ) ? 8388607 :
-		( ( scaledValue < static_cast<float>( -8388608 ) ) ? -8388608 : static_cast<int32_t>( scaledValue ) );
-	return result;
-}
-
-// Converts a floating point sample 'value' to 16-bit (clamping any value outside the range -1.0 to +1.0).
-inline int16_t FloatTo16( const float value )
-{
-	const float scaledValue = value * 32768;
-	const int16_t result = ( scaledValue > static_cast<float>( 32767 ) ) ? 32767 :
-		( ( scaledValue < static_cast<float>( -32768 ) ) ? -32768 : static_cast<int16_t>( scaledValue ) );
-	return result;
-}
-
-// Converts a floating point sample 'value' to signed 8-bit (clamping any value outside the range -1.0 to +1.0).
-inline int8_t FloatToSigned8( const float value )
-{
-	const float scaledValue = value * 128;
-	const int8_t result = ( scaledValue > static_cast<float>( 127 ) ) ? 127 :
-		( ( scaledValue < static_cast<float>( -128 ) ) ? -128 : static_cast<int8_t>( scaledValue ) );
-	return result;
-}
-
-// Converts a floating point sample 'value' to unsigned 8-bit (clamping any value outside the range -1.0 to +1.0).
-inline uint8_t FloatToUnsigned8( const float value )
-{
-	const float scaledValue = ( value + 1.0f ) * 128;
-	const uint8_t result = ( scaledValue > static_cast<float>( 255 ) ) ? 255 :
-		( ( scaledValue < static_cast<float>( 0 ) ) ? 0 : static_cast<uint8_t>( scaledValue ) );
-	return result;
-}
-
-// Converts a signed 64-bit 'value' to a floating point value in the range -1.0 to +1.0.
-inline float Signed64ToFloat( const int64_t value )
-{
-	return static_cast<float>( value ) / 0x8000000000000000ull;
-}
-
-// Converts a signed 32-bit 'value' to a floating point value in the range -1.0 to +1.0.
-inline float Signed32ToFloat( const int32_t value )
-{
-	return static_cast<float>( value ) / 0x80000000ul;
-}
-
-// Converts a signed 16-bit 'value' to a floating point value in the range -1.0 to +1.0.
-inline float Signed16ToFloat( const int16_t value )
-{
-	return static_cast<float>( value ) / 0x8000;
-}
-
-// Converts an unsigned 8-bit 'value' to a floating point value in the range -1.0 to +1.0.
-inline float Unsigned8ToFloat( const uint8_t value )
-{
-	return static_cast<float>( static_cast<int>( value ) - 0x80 ) / 0x80;
-}
-
 // Returns the current timestamp (the number of 100-nanosecond intervals since January 1, 1601 UTC).
 inline long long GetCurrentTimestamp()
 {
@@ -5,6 +5,7 @@
 
 #include "DlgConvert.h"
 #include "DlgOptions.h"
+#include "DlgSearchLibrary.h"
 #include "DlgTrackInfo.h"
 
 #include "Utility.h"
@@ -51,19 +52,22 @@ static const wchar_t s_Database[] = L"VUPlayerDebug.db";
 static const wchar_t s_Database[] = L"VUPlayer.db";
 #endif
 
+// Output diagnostics log filename.
+static const wchar_t s_DiagnosticsLog[] = L"VUPlayerDiagnostics.log";
+
 VUPlayer* VUPlayer::Get()
 {
 	return s_VUPlayer;
 }
 
 VUPlayer::VUPlayer( const HINSTANCE instance, const HWND hwnd, const std::list<std::wstring>& startupFilenames,
-		const bool portable, const Database::Mode databaseMode ) :
+		const bool portable, const Database::Mode databaseMode, const bool diagnostics ) :
 	m_hInst( instance ),
 	m_hWnd( hwnd ),
 	m_hAccel( LoadAccelerators( m_hInst, MAKEINTRESOURCE( IDC_VUPLAYER ) ) ),
 	m_hAccelEditLabel( CreateModifiedAcceleratorTable() ),
 	m_Handlers(),
-	m_Database( ( portable ? ( ApplicationFolder() / s_Database ) : ( DocumentsFolder() / s_Database ) ), databaseMode ),
+	m_Database( DatabaseFilename( portable ), databaseMode ),
 	m_Library( m_Database, m_Handlers ),
 	m_Maintainer( m_hInst, m_Library, m_Handlers ),
 	m_Settings( m_Database, m_Library ),
@@ -108,7 +112,8 @@ VUPlayer::VUPlayer( const HINSTANCE instance, const HWND hwnd, const std::list<s
 	m_IsTreeLabelEdit( false ),
 	m_IsFirstTimeStartup( true ),
 	m_IsEditingLabel( false ),
-	m_IsConverting( false )
+	m_IsConverting( false ),
+	m_DiagnosticsFilename( diagnostics ? ( DatabaseFilename( portable ).parent_path() / s_DiagnosticsLog ) : std::filesystem::path() )
 {
 	s_VUPlayer = this;
 
@@ -120,6 +125,7 @@ VUPlayer::VUPlayer( const HINSTANCE instance, const HWND hwnd, const std::list<s
 		iter = RGB( 0xff /*red*/, 0xff /*green*/, 0xff /*blue*/ );
 	}
 
+	m_Output.GetDiagnostics().SetEnabled( !m_DiagnosticsFilename.empty() );
 	m_Output.SetPlaylistChangeCallback( [ this ] ( Playlist::Ptr playlist ) { m_Tree.OnOutputPlaylistChange( playlist ); } );
 	m_Tree.Initialise();
 
@@ -155,6 +161,12 @@ VUPlayer::VUPlayer( const HINSTANCE instance, const HWND hwnd, const std::list<s
 
 VUPlayer::~VUPlayer()
 {
+	if ( !m_DiagnosticsFilename.empty() ) {
+		std::wofstream log( m_DiagnosticsFilename, std::ios::binary | std::ios::trunc );
+		log << m_Output.GetDiagnostics().GetReport();
+		log << m_Handlers.GetOpenReport();
+		log << m_Database.GetStatementReport();
+	}
 }
 
 void VUPlayer::ReadWindowSettings()
@@ -258,6 +270,11 @@ std::filesystem::path VUPlayer::ApplicationFolder()
 	return folder;
 }
 
+std::filesystem::path VUPlayer::DatabaseFilename( const bool portable )
+{
+	return portable ? ( ApplicationFolder() / s_Database ) : ( DocumentsFolder() / s_Database );
+}
+
 void VUPlayer::OnSize( WPARAM wParam, LPARAM lParam )
 {
 	if ( SIZE_MINIMIZED == wParam ) {
@@ -891,6 +908,10 @@ void VUPlayer::OnCommand( const int commandID )
 			m_Tree.RenameSelectedPlaylist();
 			break;
 		}
+		case ID_FILE_SEARCHLIBRARY : {
+			OnSearchLibrary();
+			break;
+		}
 		case ID_FILE_IMPORTPLAYLIST : {
 			m_Tree.ImportPlaylist();
 			SetFocus( m_Tree.GetWindowHandle() );
@@ -1380,6 +1401,12 @@ void VUPlayer::OnMediaUpdated( const MediaInfo& previousMediaInfo, const MediaIn
 	PostMessage( m_hWnd, MSG_MEDIAUPDATED, reinterpret_cast<WPARAM>( previousInfo ), reinterpret_cast<LPARAM>( updatedInfo ) );
 }
 
+void VUPlayer::OnMediaUpdated( const Library::MediaUpdates& updates )
+{
+	Library::MediaUpdates* batch = new Library::MediaUpdates( updates );
+	PostMessage( m_hWnd, MSG_MEDIAUPDATEDBATCH, 0 /*wParam*/, reinterpret_cast<LPARAM>( batch ) );
+}
+
 void VUPlayer::OnHandleMediaUpdate( const MediaInfo* previousMediaInfo, const MediaInfo* updatedMediaInfo )
 {
 	if ( ( nullptr != previousMediaInfo ) && ( nullptr != updatedMediaInfo ) && ( previousMediaInfo->GetSource() == updatedMediaInfo->GetSource() ) ) {
@@ -1634,6 +1661,33 @@ std::wstring VUPlayer::GetBassVersion() const
 	return version;
 }
 
+void VUPlayer::OnSearchLibrary()
+{
+	const DlgSearchLibrary dlg( m_hInst, m_hWnd );
+	const std::wstring& text = dlg.GetText();
+	if ( !text.empty() ) {
+		const MediaInfo::List mediaList = m_Library.Search( text );
+		const int bufferSize = 256;
+		WCHAR buffer[ bufferSize ] = {};
+		if ( mediaList.empty() ) {
+			LoadString( m_hInst, IDS_SEARCH_NOMATCHES_CAPTION, buffer, bufferSize );
+			const std::wstring caption = buffer;
+			LoadString( m_hInst, IDS_SEARCH_NOMATCHES_TEXT, buffer, bufferSize );
+			const std::wstring message = buffer + text;
+			MessageBox( m_hWnd, message.c_str(), caption.c_str(), MB_OK | MB_ICONINFORMATION );
+		} else {
+			// Add the matching tracks, in order of relevance, to a new playlist named after the search.
+			Playlist::Ptr playlist( new Playlist( m_Library, Playlist::Type::User ) );
+			for ( const auto& mediaInfo : mediaList ) {
+				playlist->AddItem( mediaInfo );
+			}
+			LoadString( m_hInst, IDS_SEARCH_PLAYLIST, buffer, bufferSize );
+			playlist->SetName( buffer + text );
+			m_Tree.AddPlaylist( playlist );
+		}
+	}
+}
+
 void VUPlayer::OnAddToFavourites()
 {
 	Playlist::Ptr favourites = m_Tree.GetPlaylistFavourites();
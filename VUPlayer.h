@@ -47,6 +47,11 @@
 // 'lParam' : pointer to updated MediaInfo, to be deleted by the message handler.
 static constexpr UINT MSG_MEDIAUPDATED = WM_APP + 77;
 
+// Message ID for signalling that a batch of media information has been updated.
+// 'wParam' : unused.
+// 'lParam' : pointer to Library::MediaUpdates, to be deleted by the message handler.
+static constexpr UINT MSG_MEDIAUPDATEDBATCH = WM_APP + 78;
+
 // Message ID for signalling that the list of available optical discs has been refreshed.
 // 'wParam' : unused.
 // 'lParam' : unused.
@@ -73,13 +78,18 @@ public:
 	// Returns the application folder.
 	static std::filesystem::path ApplicationFolder();
 
+	// Returns the database filename.
+	// 'portable' - whether to use the application folder for database storage.
+	static std::filesystem::path DatabaseFilename( const bool portable );
+
 	// 'instance' - module instance handle.
 	// 'hwnd' - main window handle.
 	// 'startupFilenames' - tracks to play (or the playlist to open) on startup.
 	// 'portable' - whether to run in 'portable' mode (i.e. no persistent database).
 	// 'databaseMode' - database access mode.
+	// 'diagnostics' - whether to collect output diagnostics, which are written to a log file (alongside the database) on exit.
 	VUPlayer( const HINSTANCE instance, const HWND hwnd, const std::list<std::wstring>& startupFilenames,
-		const bool portable, const Database::Mode databaseMode );
+		const bool portable, const Database::Mode databaseMode, const bool diagnostics );
 
 	virtual ~VUPlayer();
 
@@ -121,6 +131,10 @@ public:
 	// 'updatedMediaInfo' - the updated media information.
 	void OnMediaUpdated( const MediaInfo& previousMediaInfo, const MediaInfo& updatedMediaInfo );
 
+	// Called when a batch of information in the media database is updated.
+	// 'updates' - the media updates.
+	void OnMediaUpdated( const Library::MediaUpdates& updates );
+
 	// Handles the update of 'previousMediaInfo' to 'updatedMediaInfo', from the main thread.
 	void OnHandleMediaUpdate( const MediaInfo* previousMediaInfo, const MediaInfo* updatedMediaInfo );
 
@@ -242,6 +256,9 @@ private:
 	// Called when the Calculate Gain command is received.
 	void OnCalculateGain();
 
+	// Called when the Search Library command is received, adding any matching tracks to a new playlist.
+	void OnSearchLibrary();
+
 	// Called when the Add to Favourites command is received.
 	void OnAddToFavourites();
 
@@ -431,4 +448,7 @@ private:
 
 	// Whether the application is currently converting files.
 	bool m_IsConverting;
+
+	// Output diagnostics log filename, or an empty path if diagnostics are not being collected.
+	const std::filesystem::path m_DiagnosticsFilename;
 };
\ No newline at end of file
@@ -1,10 +1,18 @@
 #include "stdafx.h"
 
+#include "DecoderBenchmark.h"
+#include "LibraryBenchmark.h"
 #include "Utility.h"
 #include "VUPlayer.h"
 
+#include <algorithm>
+#include <cmath>
 #include <fstream>
+#include <iomanip>
+#include <numeric>
+#include <optional>
 #include <sstream>
+#include <vector>
 
 #define MAX_LOADSTRING 100
 
@@ -33,6 +41,27 @@ static const TCHAR s_portableCmdLineSwitch[] = L"-portable";
 // Command line switch to set the database access mode.
 static const TCHAR s_databasemodeCmdLineSwitch[] = L"-mode";
 
+// Command line switch to render the command line files offline (followed by the WAV file to write, or '-' to discard the output).
+static const TCHAR s_renderCmdLineSwitch[] = L"-render";
+
+// Command line switch to collect output diagnostics (written to a log file on exit).
+static const TCHAR s_diagnosticsCmdLineSwitch[] = L"-diagnostics";
+
+// Command line switch to benchmark the decoders for the command line files, or for a set of generated reference files if there are none (followed by the results file to write).
+static const TCHAR s_benchmarkCmdLineSwitch[] = L"-benchmark";
+
+// Command line switch to benchmark media library updates, lookups & scans for each database access mode (followed by the results file to write).
+static const TCHAR s_libraryBenchmarkCmdLineSwitch[] = L"-librarybenchmark";
+
+// Command line switch to set the size of the folder tree generated by the library benchmark (followed by '<artists>,<albums per artist>,<tracks per album>[,<sample frames per track>]').
+static const TCHAR s_libraryTreeCmdLineSwitch[] = L"-librarytree";
+
+// Command line switch to set the file formats of the folder tree generated by the library benchmark (followed by a comma separated list of format names, e.g. 'FLAC,Opus').
+static const TCHAR s_libraryFormatsCmdLineSwitch[] = L"-libraryformats";
+
+// Render output filename which discards the rendered sample data.
+static const TCHAR s_renderDiscardFilename[] = L"-";
+
 // Makes a basic check to see whether a command line entry represents Audio CD autoplay.
 // Returns the Audio CD path to autoplay, or an empty string otherwise.
 std::wstring AutoplayAudioCD( LPCWSTR cmdLineEntry )
@@ -52,6 +81,153 @@ std::wstring AutoplayAudioCD( LPCWSTR cmdLineEntry )
 	return autoplay;
 }
 
+// Writes offline render 'statistics' to the console of the parent process (or to the debugger, if there is no console).
+// 'success' - whether the render was successful.
+void WriteRenderReport( const Output::RenderStatistics& statistics, const bool success )
+{
+	std::wstringstream report;
+	report << std::fixed << std::setprecision( 3 );
+	report << L"Render " << ( success ? L"completed" : L"failed" ) << L"\r\n";
+	report << L"Format: " << statistics.SampleRate << L"Hz, " << statistics.Channels << L" channels\r\n";
+	const float renderedSeconds = ( statistics.SampleRate > 0 ) ? ( static_cast<float>( statistics.SampleFrames ) / statistics.SampleRate ) : 0;
+	report << L"Rendered: " << statistics.SampleFrames << L" sample frames (" << renderedSeconds << L"s) in " << statistics.ElapsedSeconds << L"s\r\n";
+	if ( statistics.ElapsedSeconds > 0 ) {
+		report << L"Throughput: " << static_cast<long long>( statistics.SampleFrames / statistics.ElapsedSeconds ) << L" sample frames/s (" << ( renderedSeconds / statistics.ElapsedSeconds ) << L"x realtime)\r\n";
+	}
+
+	report << L"Transitions: " << statistics.TransitionErrors.size() << L" (" << statistics.Restarts << L" restarts)\r\n";
+	if ( !statistics.TransitionErrors.empty() ) {
+		float maxError = 0;
+		float totalError = 0;
+		for ( const auto error : statistics.TransitionErrors ) {
+			maxError = std::max( maxError, std::fabs( error ) );
+			totalError += std::fabs( error );
+		}
+		report << L"Transition error: mean " << 1000 * totalError / statistics.TransitionErrors.size() << L"ms, max " << 1000 * maxError << L"ms\r\n";
+	}
+
+	if ( !statistics.CallbackTimes.empty() ) {
+		std::vector<float> callbackTimes = statistics.CallbackTimes;
+		std::sort( callbackTimes.begin(), callbackTimes.end() );
+		const float mean = std::accumulate( callbackTimes.begin(), callbackTimes.end(), 0.0f ) / callbackTimes.size();
+		const float percentile99 = callbackTimes[ ( callbackTimes.size() - 1 ) * 99 / 100 ];
+		report << L"Callbacks: " << callbackTimes.size() << L", mean " << 1000 * mean << L"ms, 99th percentile " << 1000 * percentile99 << L"ms, max " << 1000 * callbackTimes.back() << L"ms\r\n";
+	}
+
+	report << statistics.Diagnostics;
+
+	const std::wstring text = report.str();
+	bool written = false;
+	if ( AttachConsole( ATTACH_PARENT_PROCESS ) ) {
+		const HANDLE console = CreateFile( L"CONOUT$", GENERIC_WRITE, FILE_SHARE_WRITE, NULL /*security*/, OPEN_EXISTING, 0 /*flags*/, NULL /*template*/ );
+		if ( INVALID_HANDLE_VALUE != console ) {
+			DWORD charsWritten = 0;
+			written = WriteConsole( console, text.c_str(), static_cast<DWORD>( text.size() ), &charsWritten, NULL /*reserved*/ );
+			CloseHandle( console );
+		}
+		FreeConsole();
+	}
+	if ( !written ) {
+		OutputDebugString( text.c_str() );
+	}
+}
+
+// Renders the command line 'filenames' offline, without creating the main window.
+// 'instance' - module instance handle.
+// 'outputFilename' - WAV file to write, or an empty string to discard the rendered sample data.
+// 'portable' - whether to run in 'portable' mode.
+// 'mode' - database access mode.
+// Returns the process exit code.
+int RenderCommandLineFiles( const HINSTANCE instance, const std::list<std::wstring>& filenames, const std::wstring& outputFilename, const bool portable, const Database::Mode mode )
+{
+	CoInitializeEx( NULL /*reserved*/, COINIT_APARTMENTTHREADED );
+
+	bool success = false;
+	Output::RenderStatistics statistics;
+	{
+		Handlers handlers;
+		Database database( VUPlayer::DatabaseFilename( portable ), mode );
+		Library library( database, handlers );
+		Settings settings( database, library );
+		Output output( instance, NULL /*hwnd*/, handlers, settings );
+
+		Playlist::Ptr playlist = std::make_shared<Playlist>( library, Playlist::Type::User );
+		for ( const auto& filename : filenames ) {
+			MediaInfo mediaInfo( filename );
+			if ( library.GetMediaInfo( mediaInfo ) ) {
+				playlist->AddItem( mediaInfo );
+			}
+		}
+		success = output.Render( playlist, outputFilename, statistics );
+	}
+	WriteRenderReport( statistics, success );
+
+	sqlite3_shutdown();
+	CoUninitialize();
+
+	return success ? 0 : 1;
+}
+
+// Splits a comma separated command line 'argument' into its values.
+std::vector<std::wstring> SplitCommandLineList( const std::wstring& argument )
+{
+	std::vector<std::wstring> values;
+	std::wstringstream stream( argument );
+	std::wstring value;
+	while ( std::getline( stream, value, L',' ) ) {
+		values.push_back( value );
+	}
+	return values;
+}
+
+// Benchmarks the decoders for the command line 'filenames' (or for a set of generated reference files, if there are no command line files), without creating the main window.
+// The decoders use the default settings, from an in-memory database, so that the benchmark neither reads nor modifies the media library.
+// 'outputFilename' - results file to write.
+// Returns the process exit code.
+int BenchmarkCommandLineFiles( const std::list<std::wstring>& filenames, const std::wstring& outputFilename )
+{
+	CoInitializeEx( NULL /*reserved*/, COINIT_APARTMENTTHREADED );
+
+	bool success = false;
+	{
+		Handlers handlers;
+		Database database( std::wstring() /*filename*/, Database::Mode::Memory );
+		Library library( database, handlers );
+		Settings settings( database, library );
+		handlers.Init( settings );
+
+		const DecoderBenchmark benchmark( handlers, settings.GetSilenceThreshold() );
+		success = filenames.empty() ? benchmark.RunReference( outputFilename ) : benchmark.Run( filenames, outputFilename );
+	}
+
+	sqlite3_shutdown();
+	CoUninitialize();
+
+	return success ? 0 : 1;
+}
+
+// Benchmarks media library updates, lookups & scans, without creating the main window.
+// 'instance' - module instance handle.
+// 'outputFilename' - results file to write.
+// 'treeSettings' - settings for the folder tree generated by the scan & probe benchmarks.
+// Returns the process exit code.
+int BenchmarkLibrary( const HINSTANCE instance, const std::wstring& outputFilename, const LibraryBenchmark::TreeSettings& treeSettings )
+{
+	CoInitializeEx( NULL /*reserved*/, COINIT_APARTMENTTHREADED );
+
+	bool success = false;
+	{
+		Handlers handlers;
+		const LibraryBenchmark benchmark( instance, handlers, treeSettings );
+		success = benchmark.Run( outputFilename );
+	}
+
+	sqlite3_shutdown();
+	CoUninitialize();
+
+	return success ? 0 : 1;
+}
+
 // Entry point
 int APIENTRY wWinMain( _In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance, _In_ LPWSTR lpCmdLine, _In_ int nCmdShow )
 {
@@ -65,7 +241,12 @@ int APIENTRY wWinMain( _In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstanc
 	// Parse command line
 	std::list<std::wstring> cmdLineFiles;
 	bool portable = false;
+	bool diagnostics = false;
 	Database::Mode mode = Database::Mode::Disk;
+	std::optional<std::wstring> renderFilename;
+	std::optional<std::wstring> benchmarkFilename;
+	std::optional<std::wstring> libraryBenchmarkFilename;
+	LibraryBenchmark::TreeSettings libraryTreeSettings;
 
 	int numArgs = 0;
 	LPWSTR* args = CommandLineToArgvW( GetCommandLine(), &numArgs );
@@ -74,6 +255,9 @@ int APIENTRY wWinMain( _In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstanc
 			if ( 0 == _wcsicmp( args[ argc ], s_portableCmdLineSwitch ) ) {
 				// Portable mode.
 				portable = true;
+			} else if ( 0 == _wcsicmp( args[ argc ], s_diagnosticsCmdLineSwitch ) ) {
+				// Output diagnostics.
+				diagnostics = true;
 			} else if ( 0 == _wcsicmp( args[ argc ], s_databasemodeCmdLineSwitch ) ) {
 				// Handle the '-mode' command-line switch (and the following database access mode argument).
 				if ( ( argc + 1 ) < numArgs ) {
@@ -86,6 +270,55 @@ int APIENTRY wWinMain( _In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstanc
 					} catch ( const std::logic_error& ) {
 					}
 				}
+			} else if ( 0 == _wcsicmp( args[ argc ], s_renderCmdLineSwitch ) ) {
+				// Handle the '-render' command-line switch (and the following output filename argument).
+				if ( ( argc + 1 ) < numArgs ) {
+					++argc;
+					renderFilename = ( 0 == wcscmp( args[ argc ], s_renderDiscardFilename ) ) ? std::wstring() : std::wstring( args[ argc ] );
+				}
+			} else if ( 0 == _wcsicmp( args[ argc ], s_benchmarkCmdLineSwitch ) ) {
+				// Handle the '-benchmark' command-line switch (and the following results filename argument).
+				if ( ( argc + 1 ) < numArgs ) {
+					++argc;
+					benchmarkFilename = args[ argc ];
+				}
+			} else if ( 0 == _wcsicmp( args[ argc ], s_libraryBenchmarkCmdLineSwitch ) ) {
+				// Handle the '-librarybenchmark' command-line switch (and the following results filename argument).
+				if ( ( argc + 1 ) < numArgs ) {
+					++argc;
+					libraryBenchmarkFilename = args[ argc ];
+				}
+			} else if ( 0 == _wcsicmp( args[ argc ], s_libraryTreeCmdLineSwitch ) ) {
+				// Handle the '-librarytree' command-line switch (and the following tree size argument).
+				if ( ( argc + 1 ) < numArgs ) {
+					++argc;
+					const std::vector<std::wstring> values = SplitCommandLineList( args[ argc ] );
+					try {
+						if ( values.size() >= 3 ) {
+							libraryTreeSettings.Artists = std::max( 1l, std::stol( values[ 0 ] ) );
+							libraryTreeSettings.AlbumsPerArtist = std::max( 1l, std::stol( values[ 1 ] ) );
+							libraryTreeSettings.TracksPerAlbum = std::max( 1l, std::stol( values[ 2 ] ) );
+						}
+						if ( values.size() >= 4 ) {
+							libraryTreeSettings.TrackFrames = std::max( 1l, std::stol( values[ 3 ] ) );
+						}
+					} catch ( const std::logic_error& ) {
+					}
+				}
+			} else if ( 0 == _wcsicmp( args[ argc ], s_libraryFormatsCmdLineSwitch ) ) {
+				// Handle the '-libraryformats' command-line switch (and the following format list argument).
+				if ( ( argc + 1 ) < numArgs ) {
+					++argc;
+					std::list<BenchmarkFile::Format> formats;
+					for ( const auto& value : SplitCommandLineList( args[ argc ] ) ) {
+						if ( const auto format = BenchmarkFile::GetFormat( value ); format.has_value() ) {
+							formats.push_back( format.value() );
+						}
+					}
+					if ( !formats.empty() ) {
+						libraryTreeSettings.Formats = formats;
+					}
+				}
 			} else {
 				const DWORD attributes = GetFileAttributes( args[ argc ] );
 				if ( ( INVALID_FILE_ATTRIBUTES != attributes ) && !( FILE_ATTRIBUTE_DIRECTORY & attributes ) ) {
@@ -102,6 +335,17 @@ int APIENTRY wWinMain( _In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstanc
 		LocalFree( args );
 	}
 
+	// Offline rendering runs without a window, and alongside any existing instance.
+	if ( renderFilename.has_value() ) {
+		return RenderCommandLineFiles( hInstance, cmdLineFiles, renderFilename.value(), portable, mode );
+	}
+	if ( benchmarkFilename.has_value() ) {
+		return BenchmarkCommandLineFiles( cmdLineFiles, benchmarkFilename.value() );
+	}
+	if ( libraryBenchmarkFilename.has_value() ) {
+		return BenchmarkLibrary( hInstance, libraryBenchmarkFilename.value(), libraryTreeSettings );
+	}
+
 	// Limit application to a single instance
 	const HANDLE hMutex = CreateMutex( NULL /*attributes*/, FALSE /*initialOwner*/, g_szWindowClass );
 	if ( ( NULL != hMutex ) && ( ERROR_ALREADY_EXISTS == GetLastError() ) ) {
@@ -153,7 +397,7 @@ int APIENTRY wWinMain( _In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstanc
 
 	SetErrorMode( SEM_FAILCRITICALERRORS );
 
-	VUPlayer* vuplayer = new VUPlayer( g_hInst, g_hWnd, cmdLineFiles, portable, mode );
+	VUPlayer* vuplayer = new VUPlayer( g_hInst, g_hWnd, cmdLineFiles, portable, mode, diagnostics );
 
 	SetWindowLongPtr( g_hWnd, GWLP_USERDATA, reinterpret_cast<LONG_PTR>( vuplayer ) );
 	MSG msg;
@@ -372,6 +616,19 @@ LRESULT CALLBACK WndProc( HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam
 			}
 			break;
 		}
+		case MSG_MEDIAUPDATEDBATCH : {
+			if ( nullptr != vuplayer ) {
+				const Library::MediaUpdates* updates = reinterpret_cast<const Library::MediaUpdates*>( lParam );
+				if ( nullptr != updates ) {
+					for ( const auto& [ previousMediaInfo, updatedMediaInfo ] : *updates ) {
+						vuplayer->OnHandleMediaUpdate( &previousMediaInfo, &updatedMediaInfo );
+					}
+				}
+				delete updates;
+				updates = nullptr;
+			}
+			break;
+		}
 		case MSG_DISCREFRESHED : {
 			if ( nullptr != vuplayer ) {
 				vuplayer->OnHandleDiscRefreshed();
@@ -0,0 +1,245 @@
+#include "DSPKernels.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <vector>
+
+// Sample rates to measure.
+static const std::vector<long> s_SampleRates = { 44100, 48000, 96000, 192000, 384000 };
+
+// Channel counts to measure.
+static const std::vector<long> s_ChannelCounts = { 2, 6, 8 };
+
+// Length of the test signal, in seconds.
+constexpr long s_SignalSeconds = 1;
+
+// Length of each block processed, in seconds (about the size of an output callback).
+constexpr double s_BlockSeconds = 0.01;
+
+// Number of times each implementation processes the test signal (the fastest pass is reported).
+constexpr long s_Passes = 10;
+
+// Linear gain applied by the gain kernels (large enough that some samples are clipped).
+constexpr float s_Gain = 1.5f;
+
+// The maximum difference between each SIMD implementation and the scalar implementation.
+constexpr float s_MaxKernelError = 1e-6f;
+
+// The maximum difference between the scalar implementation and the baseline loop (the fade kernels step the fade position, rather than dividing for every frame, and approximate the equal power curve).
+constexpr float s_MaxBaselineError = 1e-5f;
+
+// The SIMD instruction sets to compare against the baseline loops.
+static const std::vector<std::pair<DSPKernels::InstructionSet, const char*>> s_InstructionSets = {
+	{ DSPKernels::InstructionSet::Scalar, "Scalar" },
+	{ DSPKernels::InstructionSet::SSE2, "SSE2" },
+	{ DSPKernels::InstructionSet::AVX2, "AVX2" }
+};
+
+// Processes a block of interleaved sample data.
+// 'buffer' - in/out, sample data.
+// 'source' - sample data to mix in (for the mix kernel).
+// 'frames' - number of sample frames.
+// 'channels' - number of channels.
+// 'sampleRate' - sample rate.
+// 'position' - frame position of the block in the test signal (the fade kernels fade out over the length of the test signal).
+using Process = std::function<void( float* buffer, const float* source, const size_t frames, const long channels, const long sampleRate, const size_t position )>;
+
+// A kernel to measure, along with the loop it replaced on the output path.
+struct Kernel {
+	const char* Name;
+	Process Baseline;
+	Process Implementation;
+};
+
+// Returns the linear fade position of the first frame of a block at 'position', fading out over the length of the test signal.
+static float GetFadeStart( const long sampleRate, const size_t position )
+{
+	return 1.0f - static_cast<float>( position ) / ( sampleRate * s_SignalSeconds );
+}
+
+// Returns the change in linear fade position per frame, fading out over the length of the test signal.
+static float GetFadeStep( const long sampleRate )
+{
+	return -1.0f / ( sampleRate * s_SignalSeconds );
+}
+
+// The kernels to measure.
+// The gain, linear fade & mix baselines are the loops used by Output::ApplyGain & Output::ReadSampleData before the kernels were added.
+// There was no equal power fade on the output path, so its baseline evaluates the curve directly.
+static const std::vector<Kernel> s_Kernels = {
+	{ "Gain",
+		[] ( float* buffer, const float*, const size_t frames, const long channels, const long, const size_t )
+		{
+			const long totalSamples = static_cast<long>( frames * channels );
+			for ( long sampleIndex = 0; sampleIndex < totalSamples; sampleIndex++ ) {
+				buffer[ sampleIndex ] *= s_Gain;
+			}
+		},
+		[] ( float* buffer, const float*, const size_t frames, const long channels, const long, const size_t )
+		{
+			DSPKernels::Gain( buffer, frames * channels, s_Gain );
+		} },
+	{ "Gain & clip",
+		[] ( float* buffer, const float*, const size_t frames, const long channels, const long, const size_t )
+		{
+			const long totalSamples = static_cast<long>( frames * channels );
+			for ( long sampleIndex = 0; sampleIndex < totalSamples; sampleIndex++ ) {
+				buffer[ sampleIndex ] *= s_Gain;
+			}
+			for ( long sampleIndex = 0; sampleIndex < totalSamples; sampleIndex++ ) {
+				if ( buffer[ sampleIndex ] < -1.0f ) {
+					buffer[ sampleIndex ] = -1.0f;
+				} else if ( buffer[ sampleIndex ] > 1.0f ) {
+					buffer[ sampleIndex ] = 1.0f;
+				}
+			}
+		},
+		[] ( float* buffer, const float*, const size_t frames, const long channels, const long, const size_t )
+		{
+			DSPKernels::GainClip( buffer, frames * channels, s_Gain );
+		} },
+	{ "Linear fade",
+		[] ( float* buffer, const float*, const size_t frames, const long channels, const long sampleRate, const size_t position )
+		{
+			const float fadeOutDuration = static_cast<float>( s_SignalSeconds );
+			const float currentPos = static_cast<float>( position ) / sampleRate;
+			const long sampleCount = static_cast<long>( frames );
+			for ( long sampleIndex = 0; sampleIndex < sampleCount; sampleIndex++ ) {
+				const float pos = static_cast<float>( sampleIndex ) / sampleRate;
+				float scale = static_cast<float>( fadeOutDuration - currentPos - pos ) / fadeOutDuration;
+				if ( ( scale < 0 ) || ( scale > 1.0f ) ) {
+					scale = 0;
+				}
+				for ( long channel = 0; channel < channels; channel++ ) {
+					buffer[ sampleIndex * channels + channel ] *= scale;
+				}
+			}
+		},
+		[] ( float* buffer, const float*, const size_t frames, const long channels, const long sampleRate, const size_t position )
+		{
+			DSPKernels::Fade( buffer, frames, channels, GetFadeStart( sampleRate, position ), GetFadeStep( sampleRate ), DSPKernels::FadeCurve::Linear );
+		} },
+	{ "Equal power fade",
+		[] ( float* buffer, const float*, const size_t frames, const long channels, const long sampleRate, const size_t position )
+		{
+			const float halfPi = static_cast<float>( std::acos( -1.0 ) / 2 );
+			const float start = GetFadeStart( sampleRate, position );
+			const float step = GetFadeStep( sampleRate );
+			for ( size_t frame = 0; frame < frames; frame++ ) {
+				const float scale = std::sin( std::clamp( start + frame * step, 0.0f, 1.0f ) * halfPi );
+				for ( long channel = 0; channel < channels; channel++ ) {
+					buffer[ frame * channels + channel ] *= scale;
+				}
+			}
+		},
+		[] ( float* buffer, const float*, const size_t frames, const long channels, const long sampleRate, const size_t position )
+		{
+			DSPKernels::Fade( buffer, frames, channels, GetFadeStart( sampleRate, position ), GetFadeStep( sampleRate ), DSPKernels::FadeCurve::EqualPower );
+		} },
+	{ "Mix",
+		[] ( float* buffer, const float* source, const size_t frames, const long channels, const long, const size_t )
+		{
+			const long crossfadingSamplesRead = static_cast<long>( frames );
+			for ( long sample = 0; sample < crossfadingSamplesRead * channels; sample++ ) {
+				buffer[ sample ] += source[ sample ];
+			}
+		},
+		[] ( float* buffer, const float* source, const size_t frames, const long channels, const long, const size_t )
+		{
+			DSPKernels::MixAdd( buffer, source, frames * channels );
+		} }
+};
+
+// Returns 'count' random sample values in the range -1.0 to +1.0 (with a fixed seed, so that any failure can be reproduced).
+static std::vector<float> GetRandomSamples( const size_t count, const unsigned int seed )
+{
+	std::mt19937 random( seed );
+	std::uniform_real_distribution<float> distribution( -1.0f, 1.0f );
+	std::vector<float> samples( count );
+	for ( auto& sample : samples ) {
+		sample = distribution( random );
+	}
+	return samples;
+}
+
+// Returns the largest difference between two sample buffers.
+static float GetMaxError( const std::vector<float>& first, const std::vector<float>& second )
+{
+	float maxError = 0;
+	for ( size_t index = 0; index < first.size(); index++ ) {
+		maxError = std::max( maxError, std::abs( first[ index ] - second[ index ] ) );
+	}
+	return maxError;
+}
+
+// Processes the test signal with the 'process' function, a block at a time, 'output' receiving the processed signal from the last pass.
+// Returns the fastest pass, in seconds.
+static double Measure( const Process& process, const std::vector<float>& input, const std::vector<float>& source, const long sampleRate, const long channels, std::vector<float>& output )
+{
+	const size_t totalFrames = input.size() / channels;
+	const size_t blockFrames = static_cast<size_t>( sampleRate * s_BlockSeconds );
+	double fastest = 0;
+	for ( long pass = 0; pass < s_Passes; pass++ ) {
+		output = input;
+		const auto start = std::chrono::steady_clock::now();
+		for ( size_t position = 0; position < totalFrames; position += blockFrames ) {
+			const size_t frames = std::min( blockFrames, totalFrames - position );
+			process( output.data() + position * channels, source.data() + position * channels, frames, channels, sampleRate, position );
+		}
+		const double seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+		if ( ( 0 == pass ) || ( seconds < fastest ) ) {
+			fastest = seconds;
+		}
+	}
+	return fastest;
+}
+
+// Measures the 'kernel' with each supported instruction set against its baseline loop, at the 'sampleRate' & number of 'channels', reporting the throughput.
+// Returns whether the outputs of each implementation agree.
+static bool MeasureKernel( const Kernel& kernel, const long sampleRate, const long channels )
+{
+	const size_t sampleCount = static_cast<size_t>( sampleRate * s_SignalSeconds * channels );
+	const std::vector<float> input = GetRandomSamples( sampleCount, 1 );
+	const std::vector<float> source = GetRandomSamples( sampleCount, 2 );
+	const double samples = static_cast<double>( sampleCount );
+
+	std::vector<float> baselineOutput;
+	const double baselineSeconds = Measure( kernel.Baseline, input, source, sampleRate, channels, baselineOutput );
+	printf( "%-16s %6ldHz/%ldch: baseline %8.1f Msamples/s", kernel.Name, sampleRate, channels, samples / baselineSeconds / 1e6 );
+
+	bool success = true;
+	std::vector<float> scalarOutput;
+	for ( const auto& [ instructionSet, name ] : s_InstructionSets ) {
+		if ( instructionSet == DSPKernels::SetInstructionSet( instructionSet ) ) {
+			std::vector<float> output;
+			const double seconds = Measure( kernel.Implementation, input, source, sampleRate, channels, output );
+			if ( DSPKernels::InstructionSet::Scalar == instructionSet ) {
+				success = ( GetMaxError( output, baselineOutput ) <= s_MaxBaselineError ) && success;
+				scalarOutput = output;
+			} else {
+				success = ( GetMaxError( output, scalarOutput ) <= s_MaxKernelError ) && success;
+			}
+			printf( ", %s %8.1f (%4.1fx)", name, samples / seconds / 1e6, baselineSeconds / seconds );
+		}
+	}
+	DSPKernels::SetInstructionSet( DSPKernels::GetSupportedInstructionSet() );
+	printf( " %s\n", success ? "passed" : "FAILED" );
+	return success;
+}
+
+int main()
+{
+	bool success = true;
+	for ( const auto& kernel : s_Kernels ) {
+		for ( const long sampleRate : s_SampleRates ) {
+			for ( const long channels : s_ChannelCounts ) {
+				success = MeasureKernel( kernel, sampleRate, channels ) && success;
+			}
+		}
+	}
+	return success ? 0 : 1;
+}
@@ -0,0 +1,239 @@
+#include "MediaSearch.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+// Number of generated media table rows searched by the benchmark.
+constexpr long s_BenchmarkRows = 500000;
+
+// Number of distinct words used for the generated titles.
+constexpr long s_Vocabulary = 20000;
+
+// Number of times each benchmark query is run (the median time is reported).
+constexpr int s_QueryRuns = 5;
+
+// Maximum number of results returned by each query (as for the library search).
+constexpr int s_ResultLimit = 1000;
+
+// The maximum acceptable median query time, in milliseconds.
+constexpr double s_MaxQueryMilliseconds = 10.0;
+
+// Query which creates a media table with the searched columns.
+static const char s_CreateMediaQuery[] = "CREATE TABLE Media(Filename,Artist,Title,Album,Genre,Comment,Year, PRIMARY KEY(Filename ASC));";
+
+// Query which adds or updates a media table row in place (as for the library, so that the row ID is kept).
+static const char s_UpsertMediaQuery[] = "INSERT INTO Media(Filename,Artist,Title,Album,Genre,Comment,Year) VALUES(?1,?2,?3,?4,?5,?6,?7) "
+	"ON CONFLICT(Filename) DO UPDATE SET Artist=excluded.Artist,Title=excluded.Title,Album=excluded.Album,Genre=excluded.Genre,Comment=excluded.Comment,Year=excluded.Year;";
+
+// A generated media table row.
+struct Row {
+	std::string Filename;
+	std::string Artist;
+	std::string Title;
+	std::string Album;
+	std::string Genre;
+	std::string Comment;
+	long Year;
+};
+
+// Returns a generated word, built from a number of syllables chosen by the word 'index'.
+static std::string GetWord( const long index )
+{
+	static const std::vector<std::string> syllables = { "ka", "lo", "mi", "ren", "sta", "vo", "del", "bri", "an", "tor", "el", "qu", "sun", "mar", "ne", "zo" };
+	std::string word;
+	long value = index;
+	do {
+		word += syllables[ value % syllables.size() ];
+		value /= static_cast<long>( syllables.size() );
+	} while ( value > 0 );
+	return word;
+}
+
+// Returns the generated media table row with the 'index'.
+static Row GetRow( const long index )
+{
+	// Seed the random number generator with the row index, so that the same row is generated each time.
+	std::mt19937 random( static_cast<unsigned int>( index ) );
+	std::uniform_int_distribution<long> wordDistribution( 0, s_Vocabulary - 1 );
+	const long album = index / 12;
+	const long artist = album / 8;
+	Row row;
+	row.Artist = GetWord( artist ) + " " + GetWord( artist * 7 + 3 );
+	row.Album = GetWord( album * 3 + 1 ) + " " + GetWord( wordDistribution( random ) );
+	row.Title = GetWord( wordDistribution( random ) );
+	for ( int word = wordDistribution( random ) % 3; word >= 0; word-- ) {
+		row.Title += " " + GetWord( wordDistribution( random ) );
+	}
+	row.Genre = "Genre" + std::to_string( artist % 40 );
+	row.Comment = ( 0 == index % 10 ) ? ( "Remastered " + std::to_string( 1990 + index % 30 ) ) : std::string();
+	row.Filename = "D:\\Music\\" + row.Artist + "\\" + row.Album + "\\" + std::to_string( 1 + index % 12 ) + " " + row.Title + ".flac";
+	row.Year = 1950 + album % 70;
+	return row;
+}
+
+// Adds or updates the 'row' in the media table.
+// Returns whether the row was written.
+static bool WriteRow( sqlite3* database, const Row& row )
+{
+	bool success = false;
+	sqlite3_stmt* stmt = nullptr;
+	if ( SQLITE_OK == sqlite3_prepare_v2( database, s_UpsertMediaQuery, -1 /*nByte*/, &stmt, nullptr /*tail*/ ) ) {
+		sqlite3_bind_text( stmt, 1, row.Filename.c_str(), -1 /*strLen*/, SQLITE_TRANSIENT );
+		sqlite3_bind_text( stmt, 2, row.Artist.c_str(), -1 /*strLen*/, SQLITE_TRANSIENT );
+		sqlite3_bind_text( stmt, 3, row.Title.c_str(), -1 /*strLen*/, SQLITE_TRANSIENT );
+		sqlite3_bind_text( stmt, 4, row.Album.c_str(), -1 /*strLen*/, SQLITE_TRANSIENT );
+		sqlite3_bind_text( stmt, 5, row.Genre.c_str(), -1 /*strLen*/, SQLITE_TRANSIENT );
+		sqlite3_bind_text( stmt, 6, row.Comment.c_str(), -1 /*strLen*/, SQLITE_TRANSIENT );
+		sqlite3_bind_int( stmt, 7, row.Year );
+		success = ( SQLITE_DONE == sqlite3_step( stmt ) );
+		sqlite3_finalize( stmt );
+	}
+	return success;
+}
+
+// Searches for the 'text', as the library does.
+// Returns the filenames of the matching rows, in rank order.
+static std::vector<std::string> Search( sqlite3* database, const std::string& text )
+{
+	std::vector<std::string> filenames;
+	const std::string matchQuery = MediaSearch::GetMatchQuery( text );
+	sqlite3_stmt* stmt = nullptr;
+	const bool ranked = MediaSearch::CanRank( database, matchQuery );
+	if ( !matchQuery.empty() && ( SQLITE_OK == sqlite3_prepare_v2( database, MediaSearch::GetSelectQuery( ranked ).c_str(), -1 /*nByte*/, &stmt, nullptr /*tail*/ ) ) ) {
+		sqlite3_bind_text( stmt, 1, matchQuery.c_str(), -1 /*strLen*/, SQLITE_TRANSIENT );
+		sqlite3_bind_int( stmt, 2, s_ResultLimit );
+		while ( SQLITE_ROW == sqlite3_step( stmt ) ) {
+			filenames.push_back( reinterpret_cast<const char*>( sqlite3_column_text( stmt, 0 /*columnIndex*/ ) ) );
+		}
+		sqlite3_finalize( stmt );
+	}
+	return filenames;
+}
+
+// Returns the number of milliseconds elapsed since 'start'.
+static double GetElapsedMilliseconds( const std::chrono::steady_clock::time_point& start )
+{
+	return std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - start ).count();
+}
+
+// Checks conversion of search text to full text queries.
+// Returns whether the checks passed.
+static bool TestMatchQuery()
+{
+	bool success = true;
+	success = success && MediaSearch::GetMatchQuery( "" ).empty();
+	success = success && MediaSearch::GetMatchQuery( " \t\r\n" ).empty();
+	success = success && MediaSearch::GetMatchQuery( "\"\" \"" ).empty();
+	success = success && ( "\"abba\"*" == MediaSearch::GetMatchQuery( "abba" ) );
+	success = success && ( "\"dancing\"* \"queen\"*" == MediaSearch::GetMatchQuery( "  dancing\tqueen " ) );
+	success = success && ( "\"ac/dc\"* \"OR\"* \"NOT\"*" == MediaSearch::GetMatchQuery( "ac/dc OR NOT" ) );
+	success = success && ( "\"sigur\"* \"r\xc3\xb3s\"*" == MediaSearch::GetMatchQuery( "si\"gur r\xc3\xb3s" ) );
+	return success;
+}
+
+// Checks that the search index follows inserts, updates & deletes on the media table, and that a missing index or trigger causes the index to be rebuilt.
+// Returns whether the checks passed.
+static bool TestIndex()
+{
+	bool success = false;
+	sqlite3* database = nullptr;
+	if ( SQLITE_OK == sqlite3_open( ":memory:", &database ) ) {
+		// Rows which exist before the index is created.
+		success = ( SQLITE_OK == sqlite3_exec( database, s_CreateMediaQuery, NULL /*callback*/, NULL /*arg*/, NULL /*errMsg*/ ) );
+		success = success && WriteRow( database, { "C:\\Music\\1.flac", "ABBA", "Dancing Queen", "Arrival", "Pop", "", 1976 } );
+		success = success && WriteRow( database, { "C:\\Music\\2.flac", "Sigur R\xc3\xb3s", "Hoppipolla", "Takk...", "Post-rock", "", 2005 } );
+		success = success && MediaSearch::CreateIndex( database );
+		success = success && ( std::vector<std::string>{ "C:\\Music\\1.flac" } == Search( database, "dan que" ) );
+		success = success && ( std::vector<std::string>{ "C:\\Music\\2.flac" } == Search( database, "ros" ) );
+		success = success && MediaSearch::CreateIndex( database );
+
+		// Artist & title matches rank above filename matches.
+		success = success && WriteRow( database, { "C:\\Music\\Hoppipolla\\3.flac", "Other", "Other", "Other", "", "", 2000 } );
+		success = success && ( std::vector<std::string>{ "C:\\Music\\2.flac", "C:\\Music\\Hoppipolla\\3.flac" } == Search( database, "hoppipolla" ) );
+
+		// Updating a row in place replaces its index entry, and deleting a row removes it.
+		success = success && WriteRow( database, { "C:\\Music\\1.flac", "ABBA", "Money, Money, Money", "Arrival", "Pop", "", 1976 } );
+		success = success && Search( database, "dancing" ).empty() && ( 1 == Search( database, "money" ).size() );
+		success = success && ( SQLITE_OK == sqlite3_exec( database, "UPDATE Media SET Year=1977;", NULL /*callback*/, NULL /*arg*/, NULL /*errMsg*/ ) );
+		success = success && ( 1 == Search( database, "money" ).size() );
+		success = success && ( SQLITE_OK == sqlite3_exec( database, "DELETE FROM Media WHERE Filename='C:\\Music\\1.flac';", NULL /*callback*/, NULL /*arg*/, NULL /*errMsg*/ ) );
+		success = success && Search( database, "money" ).empty() && Search( database, "abba" ).empty();
+
+		// A missing trigger causes the index to be rebuilt, so that it includes any changes made in the meantime.
+		success = success && ( SQLITE_OK == sqlite3_exec( database, "DROP TRIGGER MediaSearchInsert;", NULL /*callback*/, NULL /*arg*/, NULL /*errMsg*/ ) );
+		success = success && WriteRow( database, { "C:\\Music\\4.flac", "Kraftwerk", "Autobahn", "Autobahn", "Electronic", "", 1974 } );
+		success = success && Search( database, "kraftwerk" ).empty();
+		success = success && MediaSearch::CreateIndex( database );
+		success = success && ( 1 == Search( database, "kraftwerk" ).size() );
+
+		// The index is consistent with the media table.
+		success = success && ( SQLITE_OK == sqlite3_exec( database, "INSERT INTO MediaSearch(MediaSearch,rank) VALUES('integrity-check',1);", NULL /*callback*/, NULL /*arg*/, NULL /*errMsg*/ ) );
+		sqlite3_close( database );
+	}
+	return success;
+}
+
+// Builds the search index over a generated media table, and measures the time taken by a range of queries, from selective to very broad.
+// Returns whether each query completed within the maximum acceptable time.
+static bool Benchmark()
+{
+	bool success = false;
+	sqlite3* database = nullptr;
+	if ( SQLITE_OK == sqlite3_open( ":memory:", &database ) ) {
+		success = ( SQLITE_OK == sqlite3_exec( database, s_CreateMediaQuery, NULL /*callback*/, NULL /*arg*/, NULL /*errMsg*/ ) );
+		success = success && ( SQLITE_OK == sqlite3_exec( database, "BEGIN;", NULL /*callback*/, NULL /*arg*/, NULL /*errMsg*/ ) );
+		for ( long index = 0; success && ( index < s_BenchmarkRows ); index++ ) {
+			success = WriteRow( database, GetRow( index ) );
+		}
+		success = success && ( SQLITE_OK == sqlite3_exec( database, "COMMIT;", NULL /*callback*/, NULL /*arg*/, NULL /*errMsg*/ ) );
+
+		const auto buildStart = std::chrono::steady_clock::now();
+		success = success && MediaSearch::CreateIndex( database );
+		printf( "Index build: %ld rows in %.0fms\n", s_BenchmarkRows, GetElapsedMilliseconds( buildStart ) );
+
+		const Row sample = GetRow( s_BenchmarkRows / 2 );
+		const std::vector<std::string> queries = {
+			sample.Artist,
+			sample.Artist + " " + sample.Title.substr( 0, 3 ),
+			sample.Title,
+			sample.Album.substr( 0, 4 ),
+			"remastered 2000",
+			"genre1",
+			sample.Title.substr( 0, 3 ),
+			sample.Title.substr( 0, 2 ),
+			sample.Title.substr( 0, 1 ),
+			"music",
+			"music flac " + sample.Artist
+		};
+		for ( const auto& query : queries ) {
+			std::vector<double> times;
+			size_t results = 0;
+			for ( int run = 0; run < s_QueryRuns; run++ ) {
+				const auto start = std::chrono::steady_clock::now();
+				results = Search( database, query ).size();
+				times.push_back( GetElapsedMilliseconds( start ) );
+			}
+			std::sort( times.begin(), times.end() );
+			const double median = times[ times.size() / 2 ];
+			const bool passed = ( results > 0 ) && ( median <= s_MaxQueryMilliseconds );
+			printf( "\"%s\": %zu results in %.2fms %s\n", query.c_str(), results, median, passed ? "passed" : "FAILED" );
+			success = success && passed;
+		}
+		sqlite3_close( database );
+	}
+	return success;
+}
+
+int main()
+{
+	const bool matchQuery = TestMatchQuery();
+	printf( "Match query: %s\n", matchQuery ? "passed" : "FAILED" );
+	const bool index = TestIndex();
+	printf( "Index maintenance: %s\n", index ? "passed" : "FAILED" );
+	const bool benchmark = Benchmark();
+	return ( matchQuery && index && benchmark ) ? 0 : 1;
+}
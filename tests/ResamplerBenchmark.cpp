@@ -0,0 +1,101 @@
+#include "Resampler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+// Frequency of the test tone, in Hz.
+constexpr double s_ToneFrequency = 997.0;
+
+// Amplitude of the test tone.
+constexpr double s_ToneAmplitude = 0.5;
+
+// Length of the test signal, in seconds.
+constexpr double s_SignalSeconds = 10.0;
+
+// Number of output frames to read at a time (about the size of an output callback).
+constexpr long s_ReadFrames = 512;
+
+// Number of output frames at each end of the signal which are excluded from the quality measurement (covering the filter start up & tail).
+constexpr long s_EdgeFrames = 4096;
+
+// The minimum acceptable signal to noise ratio of the resampled test tone, in dB (truncating to the filter phase below the interpolation point gives around 82dB for 44.1kHz -> 47.999kHz).
+constexpr double s_MinSignalToNoise = 85.0;
+
+// A sample rate & channel count conversion to measure.
+struct Conversion {
+	long InputRate;
+	long InputChannels;
+	long OutputRate;
+	long OutputChannels;
+};
+
+// Conversions to measure (including a ratio which needs more filter phases than are held in the coefficient table).
+static const std::vector<Conversion> s_Conversions = {
+	{ 44100, 2, 48000, 2 },
+	{ 48000, 2, 44100, 2 },
+	{ 96000, 2, 44100, 2 },
+	{ 44100, 2, 96000, 2 },
+	{ 44100, 2, 47999, 2 },
+	{ 48000, 6, 44100, 2 },
+	{ 44100, 1, 48000, 2 }
+};
+
+// Resamples a test tone with the 'conversion', reporting the signal to noise ratio of the first output channel and the throughput.
+// Returns whether the signal to noise ratio is acceptable.
+static bool MeasureConversion( const Conversion& conversion )
+{
+	const double pi = std::acos( -1.0 );
+	const long inputFrames = static_cast<long>( s_SignalSeconds * conversion.InputRate );
+	long inputPosition = 0;
+	Resampler resampler( conversion.InputRate, conversion.InputChannels, conversion.OutputRate, conversion.OutputChannels,
+		[ &inputPosition, inputFrames, &conversion, pi ] ( float* buffer, const long frames )
+		{
+			const long framesRead = std::min( frames, inputFrames - inputPosition );
+			for ( long frame = 0; frame < framesRead; frame++, inputPosition++ ) {
+				const float value = static_cast<float>( s_ToneAmplitude * std::sin( 2 * pi * s_ToneFrequency * inputPosition / conversion.InputRate ) );
+				// The tone is only in the first channel, which each of the remix layouts passes to the first output channel at unity gain.
+				*buffer++ = value;
+				for ( long channel = 1; channel < conversion.InputChannels; channel++ ) {
+					*buffer++ = 0;
+				}
+			}
+			return framesRead;
+		} );
+
+	std::vector<float> block( static_cast<size_t>( s_ReadFrames ) * conversion.OutputChannels );
+	const long expectedFrames = static_cast<long>( s_SignalSeconds * conversion.OutputRate );
+	long outputPosition = 0;
+	double signalPower = 0;
+	double noisePower = 0;
+	const auto start = std::chrono::steady_clock::now();
+	while ( const long framesRead = resampler.Read( block.data(), s_ReadFrames ) ) {
+		for ( long frame = 0; frame < framesRead; frame++, outputPosition++ ) {
+			if ( ( outputPosition >= s_EdgeFrames ) && ( outputPosition < ( expectedFrames - s_EdgeFrames ) ) ) {
+				const double expected = s_ToneAmplitude * std::sin( 2 * pi * s_ToneFrequency * outputPosition / conversion.OutputRate );
+				const double error = block[ static_cast<size_t>( frame ) * conversion.OutputChannels ] - expected;
+				signalPower += expected * expected;
+				noisePower += error * error;
+			}
+		}
+	}
+	const double seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+	const double signalToNoise = ( noisePower > 0 ) ? ( 10 * std::log10( signalPower / noisePower ) ) : 999.0;
+	const bool success = ( signalToNoise >= s_MinSignalToNoise ) && ( std::abs( outputPosition - expectedFrames ) <= 1 );
+	printf( "%ldHz/%ldch -> %ldHz/%ldch: SNR %.1fdB, %ld frames in %.3fs (%.0fx real time) %s\n",
+		conversion.InputRate, conversion.InputChannels, conversion.OutputRate, conversion.OutputChannels, signalToNoise,
+		outputPosition, seconds, ( seconds > 0 ) ? ( s_SignalSeconds / seconds ) : 0.0, success ? "passed" : "FAILED" );
+	return success;
+}
+
+int main()
+{
+	bool success = true;
+	for ( const auto& conversion : s_Conversions ) {
+		success = MeasureConversion( conversion ) && success;
+	}
+	return success ? 0 : 1;
+}
@@ -0,0 +1,119 @@
+#include "RingBuffer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+// The number of samples passed from the producer to the consumer in the stress test.
+constexpr uint64_t s_StressSampleCount = 1ull << 27;
+
+// The ring buffer capacity used in the stress test (about half a second of stereo 44.1kHz audio).
+constexpr size_t s_StressCapacity = 1 << 15;
+
+// The maximum number of samples written or read at a time in the stress test.
+constexpr size_t s_MaxBlockSize = 4096;
+
+// Returns the sample value at 'position' in the test sequence (exactly representable as a float).
+static float GetSampleValue( const uint64_t position )
+{
+	return static_cast<float>( position & 0xffffff );
+}
+
+// Checks single threaded behaviour: capacity rounding, partial reads & writes, and wrap around.
+// Returns whether the checks passed.
+static bool TestSingleThreaded()
+{
+	bool success = true;
+	RingBuffer buffer( 100 );
+	success = success && ( 128 == buffer.GetCapacity() ) && ( 0 == buffer.GetReadAvailable() ) && ( 128 == buffer.GetWriteAvailable() );
+
+	std::vector<float> input( 200 );
+	for ( size_t index = 0; index < input.size(); index++ ) {
+		input[ index ] = GetSampleValue( index );
+	}
+	std::vector<float> output( 200 );
+
+	// A write to a full buffer is truncated, and a read from an empty buffer returns nothing.
+	success = success && ( 128 == buffer.Write( input.data(), input.size() ) ) && ( 0 == buffer.Write( input.data(), 1 ) );
+	success = success && ( 100 == buffer.Read( output.data(), 100 ) ) && std::equal( input.begin(), input.begin() + 100, output.begin() );
+	success = success && ( 28 == buffer.GetReadAvailable() ) && ( 100 == buffer.GetWriteAvailable() );
+
+	// Wrap around the end of the buffer.
+	success = success && ( 100 == buffer.Write( input.data() + 128, 100 ) );
+	success = success && ( 128 == buffer.Read( output.data(), output.size() ) ) && std::equal( input.begin() + 100, input.begin() + 200, output.begin() );
+	success = success && ( 0 == buffer.Read( output.data(), output.size() ) );
+
+	buffer.Write( input.data(), 10 );
+	buffer.Reset();
+	success = success && ( 0 == buffer.GetReadAvailable() ) && ( 128 == buffer.GetWriteAvailable() );
+	return success;
+}
+
+// Passes a known sequence from a producer thread to a consumer thread, with varying block sizes, checking that every sample arrives in order.
+// Reports the throughput and the worst case time taken by a consumer read.
+// Returns whether the sequence was received intact.
+static bool TestProducerConsumer()
+{
+	RingBuffer buffer( s_StressCapacity );
+
+	std::thread producer( [ &buffer ] ()
+		{
+			std::vector<float> block( s_MaxBlockSize );
+			uint64_t position = 0;
+			size_t blockSize = 1;
+			while ( position < s_StressSampleCount ) {
+				blockSize = 1 + ( blockSize * 7 + 3 ) % s_MaxBlockSize;
+				const size_t count = static_cast<size_t>( std::min<uint64_t>( blockSize, s_StressSampleCount - position ) );
+				for ( size_t index = 0; index < count; index++ ) {
+					block[ index ] = GetSampleValue( position + index );
+				}
+				size_t written = 0;
+				while ( written < count ) {
+					const size_t samples = buffer.Write( block.data() + written, count - written );
+					if ( 0 == samples ) {
+						std::this_thread::yield();
+					}
+					written += samples;
+				}
+				position += count;
+			}
+		} );
+
+	bool success = true;
+	std::vector<float> block( s_MaxBlockSize );
+	uint64_t position = 0;
+	size_t blockSize = 1;
+	std::chrono::nanoseconds maxReadTime( 0 );
+	const auto start = std::chrono::steady_clock::now();
+	while ( success && ( position < s_StressSampleCount ) ) {
+		blockSize = 1 + ( blockSize * 13 + 5 ) % s_MaxBlockSize;
+		const auto readStart = std::chrono::steady_clock::now();
+		const size_t samples = buffer.Read( block.data(), blockSize );
+		maxReadTime = std::max( maxReadTime, std::chrono::steady_clock::now() - readStart );
+		for ( size_t index = 0; success && ( index < samples ); index++ ) {
+			success = ( GetSampleValue( position + index ) == block[ index ] );
+		}
+		position += samples;
+		if ( 0 == samples ) {
+			std::this_thread::yield();
+		}
+	}
+	const double seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+	producer.join();
+
+	printf( "Producer/consumer: %llu samples in %.3fs (%.1f million samples/s), worst case read %.1fus\n",
+		static_cast<unsigned long long>( position ), seconds, ( seconds > 0 ) ? ( position / seconds / 1e6 ) : 0.0,
+		std::chrono::duration<double, std::micro>( maxReadTime ).count() );
+	return success && ( s_StressSampleCount == position );
+}
+
+int main()
+{
+	const bool singleThreaded = TestSingleThreaded();
+	printf( "Single threaded: %s\n", singleThreaded ? "passed" : "FAILED" );
+	const bool producerConsumer = TestProducerConsumer();
+	printf( "Producer/consumer: %s\n", producerConsumer ? "passed" : "FAILED" );
+	return ( singleThreaded && producerConsumer ) ? 0 : 1;
+}
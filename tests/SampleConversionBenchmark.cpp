@@ -0,0 +1,131 @@
+#include "SampleConversion.h"
+
+#include "DSPKernels.h"
+
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <vector>
+
+// The number of samples converted by each pass (about 12 seconds of 44.1kHz stereo).
+constexpr size_t s_Samples = 1 << 20;
+
+// The number of channels used for the planar conversions.
+constexpr long s_Channels = 2;
+
+// Number of times each conversion is made with each instruction set (the fastest pass is reported).
+constexpr long s_Passes = 10;
+
+// The instruction sets to measure.
+static const std::vector<std::pair<DSPKernels::InstructionSet, const char*>> s_InstructionSets = {
+	{ DSPKernels::InstructionSet::Scalar, "Scalar" },
+	{ DSPKernels::InstructionSet::SSE2, "SSE2" },
+	{ DSPKernels::InstructionSet::AVX2, "AVX2" }
+};
+
+// Random number generator for the test data (with a fixed seed, so that each run converts the same data).
+static std::mt19937 s_Random( 1 );
+
+// Returns 'count' random integers in the range 'minimum' to 'maximum'.
+template <typename T>
+static std::vector<T> GetRandomIntegers( const size_t count, const int64_t minimum, const int64_t maximum )
+{
+	std::uniform_int_distribution<int64_t> distribution( minimum, maximum );
+	std::vector<T> values( count );
+	for ( auto& value : values ) {
+		value = static_cast<T>( distribution( s_Random ) );
+	}
+	return values;
+}
+
+// Returns 'count' random floating point values in the range -1.0 to +1.0.
+template <typename T>
+static std::vector<T> GetRandomFloats( const size_t count )
+{
+	std::uniform_real_distribution<double> distribution( -1.0, 1.0 );
+	std::vector<T> values( count );
+	for ( auto& value : values ) {
+		value = static_cast<T>( distribution( s_Random ) );
+	}
+	return values;
+}
+
+// Returns pointers to each of the 'channels' planes of 'planar' sample data.
+template <typename T>
+static std::vector<const T*> GetPlanes( const std::vector<T>& planar, const long channels )
+{
+	std::vector<const T*> planes( channels );
+	for ( long channel = 0; channel < channels; channel++ ) {
+		planes[ channel ] = planar.data() + channel * ( planar.size() / channels );
+	}
+	return planes;
+}
+
+// Measures the 'convert' function (which converts 's_Samples' samples) with each supported instruction set, reporting the throughput.
+// 'name' - name of the conversion, for reporting.
+static void Measure( const char* name, const std::function<void()>& convert )
+{
+	printf( "%-28s", name );
+	double scalarSeconds = 0;
+	for ( const auto& [ instructionSet, instructionSetName ] : s_InstructionSets ) {
+		if ( instructionSet == DSPKernels::SetInstructionSet( instructionSet ) ) {
+			double fastest = 0;
+			for ( long pass = 0; pass < s_Passes; pass++ ) {
+				const auto start = std::chrono::steady_clock::now();
+				convert();
+				const double seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+				if ( ( 0 == pass ) || ( seconds < fastest ) ) {
+					fastest = seconds;
+				}
+			}
+			if ( DSPKernels::InstructionSet::Scalar == instructionSet ) {
+				scalarSeconds = fastest;
+				printf( " %s %8.1f Msamples/s", instructionSetName, s_Samples / fastest / 1e6 );
+			} else {
+				printf( ", %s %8.1f (%4.1fx)", instructionSetName, s_Samples / fastest / 1e6, scalarSeconds / fastest );
+			}
+		}
+	}
+	DSPKernels::SetInstructionSet( DSPKernels::GetSupportedInstructionSet() );
+	printf( "\n" );
+}
+
+int main()
+{
+	const size_t frames = s_Samples / s_Channels;
+	std::vector<float> floatOutput( s_Samples );
+	std::vector<uint8_t> unsigned8Output( s_Samples );
+	std::vector<int16_t> signed16Output( s_Samples );
+	std::vector<int32_t> signed32Output( s_Samples );
+	std::vector<uint8_t> packed24Output( s_Samples * 3 );
+
+	const auto unsigned8 = GetRandomIntegers<uint8_t>( s_Samples, 0, 255 );
+	const auto signed16 = GetRandomIntegers<int16_t>( s_Samples, -32768, 32767 );
+	const auto signed24 = GetRandomIntegers<int32_t>( s_Samples, -( 1 << 23 ), ( 1 << 23 ) - 1 );
+	const auto signed32 = GetRandomIntegers<int32_t>( s_Samples, INT32_MIN, INT32_MAX );
+	const auto packed24 = GetRandomIntegers<uint8_t>( s_Samples * 3, 0, 255 );
+	const auto floats = GetRandomFloats<float>( s_Samples );
+	const auto doubles = GetRandomFloats<double>( s_Samples );
+	const auto signed16Planes = GetPlanes( signed16, s_Channels );
+	const auto signed24Planes = GetPlanes( signed24, s_Channels );
+	const auto floatPlanes = GetPlanes( floats, s_Channels );
+
+	// Decoder conversions.
+	Measure( "ToFloat (8-bit)", [ & ] () { SampleConversion::ToFloat( unsigned8.data(), floatOutput.data(), s_Samples ); } );
+	Measure( "ToFloat (16-bit)", [ & ] () { SampleConversion::ToFloat( signed16.data(), floatOutput.data(), s_Samples ); } );
+	Measure( "ToFloat (24-bit)", [ & ] () { SampleConversion::ToFloat( signed24.data(), floatOutput.data(), s_Samples, 24 ); } );
+	Measure( "ToFloat (32-bit)", [ & ] () { SampleConversion::ToFloat( signed32.data(), floatOutput.data(), s_Samples ); } );
+	Measure( "ToFloat (double)", [ & ] () { SampleConversion::ToFloat( doubles.data(), floatOutput.data(), s_Samples ); } );
+	Measure( "Packed24ToFloat", [ & ] () { SampleConversion::Packed24ToFloat( packed24.data(), floatOutput.data(), s_Samples ); } );
+	Measure( "InterleaveToFloat (16-bit)", [ & ] () { SampleConversion::InterleaveToFloat( signed16Planes.data(), 0 /*offset*/, floatOutput.data(), frames, s_Channels ); } );
+	Measure( "InterleaveToFloat (24-bit)", [ & ] () { SampleConversion::InterleaveToFloat( signed24Planes.data(), 0 /*offset*/, floatOutput.data(), frames, s_Channels, 24 ); } );
+	Measure( "InterleaveToFloat (float)", [ & ] () { SampleConversion::InterleaveToFloat( floatPlanes.data(), 0 /*offset*/, floatOutput.data(), frames, s_Channels ); } );
+
+	// Encoder conversions.
+	Measure( "FromFloat (8-bit)", [ & ] () { SampleConversion::FromFloat( floats.data(), unsigned8Output.data(), s_Samples ); } );
+	Measure( "FromFloat (16-bit)", [ & ] () { SampleConversion::FromFloat( floats.data(), signed16Output.data(), s_Samples ); } );
+	Measure( "FromFloat (24-bit)", [ & ] () { SampleConversion::FromFloat( floats.data(), signed32Output.data(), s_Samples, 24 ); } );
+	Measure( "FloatToPacked24", [ & ] () { SampleConversion::FloatToPacked24( floats.data(), packed24Output.data(), s_Samples ); } );
+	return 0;
+}
@@ -0,0 +1,175 @@
+#include "SampleConversion.h"
+
+#include "DSPKernels.h"
+
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+// The number of sample frames converted by each check (not a multiple of any vector width, so that the scalar tail handling is covered).
+constexpr size_t s_Frames = 1031;
+
+// The offset into each plane used when checking conversions from planar sample data.
+constexpr size_t s_PlaneOffset = 5;
+
+// The SIMD instruction sets to compare against the scalar implementations.
+static const std::vector<std::pair<DSPKernels::InstructionSet, const char*>> s_InstructionSets = {
+	{ DSPKernels::InstructionSet::SSE2, "SSE2" },
+	{ DSPKernels::InstructionSet::AVX2, "AVX2" }
+};
+
+// Random number generator for the test data (with a fixed seed, so that any failure can be reproduced).
+static std::mt19937 s_Random( 1 );
+
+// Returns 'count' random integers in the range 'minimum' to 'maximum'.
+template <typename T>
+static std::vector<T> GetRandomIntegers( const size_t count, const int64_t minimum, const int64_t maximum )
+{
+	std::uniform_int_distribution<int64_t> distribution( minimum, maximum );
+	std::vector<T> values( count );
+	for ( auto& value : values ) {
+		value = static_cast<T>( distribution( s_Random ) );
+	}
+	return values;
+}
+
+// Returns 'count' random floating point values, mostly in the range -1.0 to +1.0, but including values which need clamping and the exact range limits.
+template <typename T>
+static std::vector<T> GetRandomFloats( const size_t count )
+{
+	std::uniform_real_distribution<double> distribution( -1.25, 1.25 );
+	std::vector<T> values( count );
+	for ( auto& value : values ) {
+		value = static_cast<T>( distribution( s_Random ) );
+	}
+	if ( count >= 4 ) {
+		values[ 0 ] = 1;
+		values[ 1 ] = -1;
+		values[ 2 ] = 0;
+		values[ 3 ] = static_cast<T>( -0.0 );
+	}
+	return values;
+}
+
+// Converts with each supported SIMD instruction set using the 'convert' function, checking that the 'count' output values exactly match the scalar implementation.
+// 'name' - name of the conversion, for reporting.
+// Returns whether the outputs match.
+template <typename Output, typename Convert>
+static bool CompareImplementations( const char* name, const size_t count, Convert convert )
+{
+	std::vector<Output> expected( count );
+	DSPKernels::SetInstructionSet( DSPKernels::InstructionSet::Scalar );
+	convert( expected.data() );
+
+	bool success = true;
+	std::vector<Output> actual( count );
+	for ( const auto& [ instructionSet, instructionSetName ] : s_InstructionSets ) {
+		if ( instructionSet == DSPKernels::SetInstructionSet( instructionSet ) ) {
+			std::fill( actual.begin(), actual.end(), Output() );
+			convert( actual.data() );
+			if ( 0 != memcmp( expected.data(), actual.data(), count * sizeof( Output ) ) ) {
+				printf( "%s: %s output does not match scalar output\n", name, instructionSetName );
+				success = false;
+			}
+		}
+	}
+	DSPKernels::SetInstructionSet( DSPKernels::GetSupportedInstructionSet() );
+	return success;
+}
+
+// Checks conversions from interleaved sample data to floating point.
+// Returns whether the checks passed.
+static bool TestToFloat()
+{
+	bool success = true;
+	const auto unsigned8 = GetRandomIntegers<uint8_t>( s_Frames, 0, 255 );
+	success = CompareImplementations<float>( "ToFloat (8-bit)", s_Frames, [ &unsigned8 ] ( float* output ) { SampleConversion::ToFloat( unsigned8.data(), output, s_Frames ); } ) && success;
+
+	const auto signed16 = GetRandomIntegers<int16_t>( s_Frames, -32768, 32767 );
+	success = CompareImplementations<float>( "ToFloat (16-bit)", s_Frames, [ &signed16 ] ( float* output ) { SampleConversion::ToFloat( signed16.data(), output, s_Frames ); } ) && success;
+
+	for ( const long bitsPerSample : { 16l, 20l, 24l, 32l } ) {
+		const auto signed32 = GetRandomIntegers<int32_t>( s_Frames, -( 1ll << ( bitsPerSample - 1 ) ), ( 1ll << ( bitsPerSample - 1 ) ) - 1 );
+		success = CompareImplementations<float>( "ToFloat (32-bit)", s_Frames, [ &signed32, bitsPerSample ] ( float* output ) { SampleConversion::ToFloat( signed32.data(), output, s_Frames, bitsPerSample ); } ) && success;
+	}
+
+	const auto signed64 = GetRandomIntegers<int64_t>( s_Frames, INT64_MIN, INT64_MAX );
+	success = CompareImplementations<float>( "ToFloat (64-bit)", s_Frames, [ &signed64 ] ( float* output ) { SampleConversion::ToFloat( signed64.data(), output, s_Frames ); } ) && success;
+
+	const auto doubles = GetRandomFloats<double>( s_Frames );
+	success = CompareImplementations<float>( "ToFloat (double)", s_Frames, [ &doubles ] ( float* output ) { SampleConversion::ToFloat( doubles.data(), output, s_Frames ); } ) && success;
+
+	const auto packed24 = GetRandomIntegers<uint8_t>( s_Frames * 3, 0, 255 );
+	success = CompareImplementations<float>( "Packed24ToFloat", s_Frames, [ &packed24 ] ( float* output ) { SampleConversion::Packed24ToFloat( packed24.data(), output, s_Frames ); } ) && success;
+	return success;
+}
+
+// Checks conversions from planar sample data to interleaved floating point, for a number of 'channels'.
+// Returns whether the checks passed.
+static bool TestInterleaveToFloat( const long channels )
+{
+	bool success = true;
+	const size_t count = s_Frames * channels;
+	const size_t planeSize = s_Frames + s_PlaneOffset;
+
+	// Returns pointers to each plane of 'planar' sample data.
+	auto getPlanes = [ channels, planeSize ] ( auto& planar )
+	{
+		std::vector<decltype( planar.data() )> planes( channels );
+		for ( long channel = 0; channel < channels; channel++ ) {
+			planes[ channel ] = planar.data() + channel * planeSize;
+		}
+		return planes;
+	};
+
+	const auto unsigned8 = GetRandomIntegers<uint8_t>( planeSize * channels, 0, 255 );
+	const auto unsigned8Planes = getPlanes( unsigned8 );
+	success = CompareImplementations<float>( "InterleaveToFloat (8-bit)", count, [ &unsigned8Planes, channels ] ( float* output ) { SampleConversion::InterleaveToFloat( unsigned8Planes.data(), s_PlaneOffset, output, s_Frames, channels ); } ) && success;
+
+	const auto signed16 = GetRandomIntegers<int16_t>( planeSize * channels, -32768, 32767 );
+	const auto signed16Planes = getPlanes( signed16 );
+	success = CompareImplementations<float>( "InterleaveToFloat (16-bit)", count, [ &signed16Planes, channels ] ( float* output ) { SampleConversion::InterleaveToFloat( signed16Planes.data(), s_PlaneOffset, output, s_Frames, channels ); } ) && success;
+
+	const auto signed32 = GetRandomIntegers<int32_t>( planeSize * channels, -( 1 << 23 ), ( 1 << 23 ) - 1 );
+	const auto signed32Planes = getPlanes( signed32 );
+	success = CompareImplementations<float>( "InterleaveToFloat (24-bit)", count, [ &signed32Planes, channels ] ( float* output ) { SampleConversion::InterleaveToFloat( signed32Planes.data(), s_PlaneOffset, output, s_Frames, channels, 24 ); } ) && success;
+
+	const auto floats = GetRandomFloats<float>( planeSize * channels );
+	const auto floatPlanes = getPlanes( floats );
+	success = CompareImplementations<float>( "InterleaveToFloat (float)", count, [ &floatPlanes, channels ] ( float* output ) { SampleConversion::InterleaveToFloat( floatPlanes.data(), s_PlaneOffset, output, s_Frames, channels ); } ) && success;
+
+	const auto doubles = GetRandomFloats<double>( planeSize * channels );
+	const auto doublePlanes = getPlanes( doubles );
+	success = CompareImplementations<float>( "InterleaveToFloat (double)", count, [ &doublePlanes, channels ] ( float* output ) { SampleConversion::InterleaveToFloat( doublePlanes.data(), s_PlaneOffset, output, s_Frames, channels ); } ) && success;
+	return success;
+}
+
+// Checks conversions from floating point sample data.
+// Returns whether the checks passed.
+static bool TestFromFloat()
+{
+	bool success = true;
+	const auto floats = GetRandomFloats<float>( s_Frames );
+	success = CompareImplementations<uint8_t>( "FromFloat (8-bit)", s_Frames, [ &floats ] ( uint8_t* output ) { SampleConversion::FromFloat( floats.data(), output, s_Frames ); } ) && success;
+	success = CompareImplementations<int16_t>( "FromFloat (16-bit)", s_Frames, [ &floats ] ( int16_t* output ) { SampleConversion::FromFloat( floats.data(), output, s_Frames ); } ) && success;
+	for ( const long bitsPerSample : { 8l, 16l, 20l, 24l } ) {
+		success = CompareImplementations<int32_t>( "FromFloat (32-bit)", s_Frames, [ &floats, bitsPerSample ] ( int32_t* output ) { SampleConversion::FromFloat( floats.data(), output, s_Frames, bitsPerSample ); } ) && success;
+	}
+	success = CompareImplementations<uint8_t>( "FloatToPacked24", s_Frames * 3, [ &floats ] ( uint8_t* output ) { SampleConversion::FloatToPacked24( floats.data(), output, s_Frames ); } ) && success;
+	return success;
+}
+
+int main()
+{
+	const DSPKernels::InstructionSet supported = DSPKernels::GetSupportedInstructionSet();
+	printf( "Comparing scalar conversions against: %s\n", ( DSPKernels::InstructionSet::AVX2 == supported ) ? "SSE2 & AVX2" : ( ( DSPKernels::InstructionSet::SSE2 == supported ) ? "SSE2" : "(no SIMD support)" ) );
+
+	bool success = TestToFloat();
+	for ( const long channels : { 1l, 2l, 3l, 6l } ) {
+		success = TestInterleaveToFloat( channels ) && success;
+	}
+	success = TestFromFloat() && success;
+	printf( "Scalar/SIMD equivalence: %s\n", success ? "passed" : "FAILED" );
+	return success ? 0 : 1;
+}
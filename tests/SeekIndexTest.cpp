@@ -0,0 +1,99 @@
+#include "SeekIndex.h"
+
+#include <cstdio>
+#include <vector>
+
+// Size of the serialised data header (version, interval & point count).
+constexpr size_t s_HeaderSize = sizeof( uint32_t ) + 2 * sizeof( uint64_t );
+
+// Offset of the point count within the serialised data header.
+constexpr size_t s_CountOffset = sizeof( uint32_t ) + sizeof( uint64_t );
+
+// Overwrites the little endian 'value' in 'data' at 'position'.
+static void SetValue( std::vector<uint8_t>& data, const size_t position, const uint64_t value )
+{
+	for ( size_t byte = 0; byte < sizeof( uint64_t ); byte++ ) {
+		data[ position + byte ] = static_cast<uint8_t>( value >> ( 8 * byte ) );
+	}
+}
+
+// Checks adding & finding index points.
+// Returns whether the checks passed.
+static bool TestFind()
+{
+	bool success = true;
+	SeekIndex index( 100 );
+	success = success && index.IsEmpty() && !index.Find( 0 );
+
+	// Points closer than the interval to the previous point are not added.
+	index.Add( 0, 10 );
+	index.Add( 50, 20 );
+	index.Add( 100, 30 );
+	index.Add( 250, 40 );
+	success = success && !index.IsEmpty() && ( 100 == index.GetInterval() );
+
+	const auto first = index.Find( 99 );
+	success = success && first && ( 0 == first->Sample ) && ( 10 == first->Offset );
+	const auto exact = index.Find( 100 );
+	success = success && exact && ( 100 == exact->Sample ) && ( 30 == exact->Offset );
+	const auto last = index.Find( 1000000 );
+	success = success && last && ( 250 == last->Sample ) && ( 40 == last->Offset );
+
+	SeekIndex later( 100 );
+	later.Add( 500, 1000 );
+	success = success && !later.Find( 499 ) && later.Find( 500 );
+	return success;
+}
+
+// Checks serialisation, and that invalid serialised data is rejected.
+// Returns whether the checks passed.
+static bool TestData()
+{
+	bool success = true;
+	SeekIndex index( 44100 );
+	for ( uint64_t point = 0; point < 10; point++ ) {
+		index.Add( point * 44100, point * 4096 + 42 );
+	}
+	const std::vector<uint8_t> data = index.GetData();
+	success = success && ( ( s_HeaderSize + 10 * 2 * sizeof( uint64_t ) ) == data.size() );
+
+	const SeekIndex::Ptr copy = SeekIndex::FromData( data );
+	success = success && copy && ( copy->GetData() == data ) && ( 44100 == copy->GetInterval() );
+	const auto point = copy ? copy->Find( 5 * 44100 + 1 ) : std::nullopt;
+	success = success && point && ( ( 5 * 44100 ) == point->Sample ) && ( ( 5 * 4096 + 42 ) == point->Offset );
+
+	// Empty, truncated & extended data.
+	success = success && !SeekIndex::FromData( {} );
+	success = success && !SeekIndex::FromData( std::vector<uint8_t>( data.begin(), data.begin() + s_HeaderSize - 1 ) );
+	success = success && !SeekIndex::FromData( std::vector<uint8_t>( data.begin(), data.end() - 1 ) );
+	std::vector<uint8_t> extended( data );
+	extended.push_back( 0 );
+	success = success && !SeekIndex::FromData( extended );
+
+	// Unsupported version.
+	std::vector<uint8_t> version( data );
+	version[ 0 ] ^= 0xff;
+	success = success && !SeekIndex::FromData( version );
+
+	// Point counts which do not match the data size, including a count which overflows to the correct size in bytes.
+	for ( const uint64_t count : { 9ull, 11ull, 0ull, 0x100000000000000aull, 0x8000000000000000ull, ~0ull } ) {
+		std::vector<uint8_t> invalid( data );
+		SetValue( invalid, s_CountOffset, count );
+		success = success && !SeekIndex::FromData( invalid );
+	}
+
+	// Points not in increasing sample order.
+	std::vector<uint8_t> unordered( data );
+	SetValue( unordered, s_HeaderSize + 2 * 2 * sizeof( uint64_t ), 0 );
+	success = success && !SeekIndex::FromData( unordered );
+	return success;
+}
+
+int main()
+{
+	const bool find = TestFind();
+	printf( "Find: %s\n", find ? "passed" : "FAILED" );
+	const bool data = TestData();
+	printf( "Serialised data: %s\n", data ? "passed" : "FAILED" );
+	return ( find && data ) ? 0 : 1;
+}
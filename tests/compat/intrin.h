@@ -0,0 +1,14 @@
+#pragma once
+
+// Provides the MSVC processor feature intrinsics used by DSPKernels, for building the SIMD implementations with GCC or Clang.
+
+// The compiler's cpuid.h provides __cpuidex, but defines __cpuid as a macro with a different signature.
+#include <cpuid.h>
+
+#undef __cpuid
+
+// Queries the processor features for the 'function', into 'info' (EAX, EBX, ECX, EDX).
+inline void __cpuid( int info[ 4 ], const int function )
+{
+	__cpuid_count( function, 0, info[ 0 ], info[ 1 ], info[ 2 ], info[ 3 ] );
+}